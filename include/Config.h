@@ -17,9 +17,17 @@ struct UserConfig
     char dtuPassword[64]          = "dtubiPassword";
 
     char dtuHostIpDomain[128]     = "192.168.0.254";
+    char dtuSiteHosts[192]        = "";     // additional DTUs of the site - comma separated
     int dtuCloudPauseTime         = 40;
     boolean dtuCloudPauseActive   = true;
-    unsigned int dtuUpdateTime    = 31;
+    unsigned int dtuUpdateTime    = 31;     // fixed update time - if adaptive update is off
+    boolean dtuUpdateAdaptive     = true;   // update time follows the change rate of power values
+    unsigned int dtuUpdateTimeMin = 31;     // lower bound of the adaptive update time - below 31 s at own risk (DTU)
+    unsigned int dtuUpdateTimeMax = 60;
+    unsigned int dtuReconnectMaxDelay = 60; // cap of the reconnect backoff in seconds
+    unsigned int dtuHeartbeatInterval = 31; // s between two heartbeats - after a missed one the next follows after 5 s
+    uint8_t dtuHeartbeatMaxMissed = 3;      // missed heartbeats in a row until the connection is closed as dead
+    unsigned int dtuUnchangedRefresh = 300; // seconds until unchanged values are sent to the APIs again
 
     char openhabHostIpDomain[128] = "192.168.1.100";
     char openItemPrefix[32]       = "inverter";
@@ -35,6 +43,17 @@ struct UserConfig
     boolean mqttActive            = false;
 
     boolean remoteDisplayActive   = false;  // remote display to get data from mqtt
+
+    boolean zeroExportActive      = false;  // control power limit by household meter (mqtt)
+    char zeroExportMeterTopic[64] = "meter/power"; // grid power in W - positive: import, negative: export
+    int zeroExportTarget          = 0;      // grid power to hold in W
+    unsigned int zeroExportInverterPower = 800; // inverter power at 100 % limit in W
+    unsigned int zeroExportDeadband = 15;   // W
+    unsigned int zeroExportMaxStep = 100;   // max change of inverter power per meter value in W
+    unsigned int zeroExportMinCommandTime = 31; // s between two power limit commands - below 31 s at own risk (DTU)
+    float zeroExportKp            = 0.3;
+    float zeroExportKi            = 0.5;    // per second
+    float zeroExportKd            = 0;
     
     uint8_t displayConnected      = 0;      // OLED default
     uint16_t displayOrientation   = 0;      // OLED 0,180 degrees - TFT 0,90,180,270 degrees
@@ -38,8 +38,6 @@ struct baseDataStruct
   unsigned long currentNTPtime = 0;
   String currentNTPtimeFormatted = "not set";
 
-  unsigned long dtuNextUpdateCounterSeconds = 1704063600;
-
   boolean rebootRequested = false;
   uint8_t rebootRequestedInSec = 0;
   boolean rebootStarted = false;
@@ -0,0 +1,116 @@
+#ifndef SEQLOCKSNAPSHOT_H
+#define SEQLOCKSNAPSHOT_H
+
+#include <stdint.h>
+#include <atomic>
+
+// a reader copy is valid as long as the writer did not start a second publish since its start
+#define SEQLOCK_SNAPSHOT_MAX_LAG 2
+
+/**
+ * Versioned snapshot of a data block that is written in one context (e.g. async TCP callbacks) and
+ * read in others (loop, web handlers, render task). The writer fills the back buffer of a double
+ * buffer and publishes it with a sequence counter (odd while writing). Readers copy the front buffer
+ * and check the counter afterwards - the copy is consistent unless the writer published twice during
+ * it, then it is repeated. Readers never block the writer and never see a half updated block.
+ * The returned version counts the publishes, so consumers can skip work if nothing changed.
+ * Only one writer at a time - concurrent writers have to be serialized by the owner.
+ */
+template <typename T>
+class SeqlockSnapshot {
+public:
+    // writer side - the back buffer holds the last but one version, fill it completely before publish()
+    T &beginWrite()
+    {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return buffers[((seq >> 1) + 1) & 1];
+    }
+    void publish()
+    {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    void publish(const T &value)
+    {
+        beginWrite() = value;
+        publish();
+    }
+
+    // reader side - consistent copy of the latest published version, returns its version
+    uint32_t read(T &copy) const
+    {
+        for (;;)
+        {
+            uint32_t start = sequence.load(std::memory_order_acquire);
+            copy = buffers[(start >> 1) & 1];
+            if (isValid(start))
+                return start >> 1;
+        }
+    }
+    // consistent copy of one member of the latest version - readers that do not need the large parts
+    template <typename M>
+    uint32_t read(M T::*member, M &copy) const
+    {
+        for (;;)
+        {
+            uint32_t start = sequence.load(std::memory_order_acquire);
+            copy = buffers[(start >> 1) & 1].*member;
+            if (isValid(start))
+                return start >> 1;
+        }
+    }
+    uint32_t getVersion() const { return sequence.load(std::memory_order_acquire) >> 1; }
+    uint32_t getRetries() const { return retries.load(std::memory_order_relaxed); }
+
+private:
+    // the copy started at sequence start is valid if the writer did not overwrite its buffer meanwhile
+    bool isValid(uint32_t start) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t end = sequence.load(std::memory_order_relaxed);
+        if (uint32_t(end - (start & ~uint32_t(1))) <= SEQLOCK_SNAPSHOT_MAX_LAG)
+            return true;
+        retries.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    T buffers[2];
+    std::atomic<uint32_t> sequence{0}; // 2 * version, +1 while the next version is written
+    mutable std::atomic<uint32_t> retries{0};
+};
+
+// attempts of a reader of SeqlockVersion before it gives up (writer preempted on the same core)
+#define SEQLOCK_VERSION_READ_ATTEMPTS 3
+
+/**
+ * Sequence counter of a data block that is read in place - for blocks too large for the double
+ * buffer of SeqlockSnapshot (power curve, trace ring). The single writer brackets every change with
+ * beginWrite()/ endWrite(), a reader takes beginRead() before and checks endRead() after reading
+ * and reads again if the block changed meanwhile. Readers never block the writer.
+ */
+class SeqlockVersion {
+public:
+    void beginWrite()
+    {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    void endWrite()
+    {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint32_t beginRead() const { return sequence.load(std::memory_order_acquire); }
+    // true if the values read since beginRead() belong to one version
+    bool endRead(uint32_t start) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return (start & 1) == 0 && sequence.load(std::memory_order_relaxed) == start;
+    }
+
+private:
+    std::atomic<uint32_t> sequence{0}; // odd while the writer changes the block
+};
+
+#endif // SEQLOCKSNAPSHOT_H
@@ -0,0 +1,79 @@
+#ifndef SNAPSHOTHANDOFF_H
+#define SNAPSHOTHANDOFF_H
+
+#include <stdint.h>
+#include <atomic>
+
+// bit in the shared slot - the buffer behind it was published and not yet taken by the reader
+#define SNAPSHOT_HANDOFF_FRESH 0x4
+#define SNAPSHOT_HANDOFF_INDEX 0x3
+
+struct snapshotHandoffStats
+{
+  uint32_t published = 0;   // snapshots handed over by the writer
+  uint32_t consumed = 0;    // snapshots taken by the reader
+  uint32_t overwritten = 0; // published snapshots replaced before the reader took them
+};
+
+/**
+ * Lock-free handoff of immutable snapshots from one writer to one reader in another task/ core
+ * (triple buffer). The writer fills its own buffer and publishes it by swapping it with the shared
+ * slot, the reader swaps its buffer with the shared slot if a fresh one is there. Both sides are
+ * wait-free, nobody ever sees a buffer while the other side writes it, and the reader always gets the
+ * latest complete snapshot - older ones that were not taken in time are dropped (counted).
+ * Only std::atomic is used, so it builds the same on the ESP32 (FreeRTOS tasks) and on the host
+ * (std::thread).
+ */
+template <typename T>
+class SnapshotHandoff {
+public:
+    SnapshotHandoff() : shared(2) {}
+
+    // writer side - buffer for the next snapshot, owned by the writer until publish()
+    T &beginWrite() { return buffers[writeIndex]; }
+    void publish()
+    {
+        uint32_t last = shared.exchange(writeIndex | SNAPSHOT_HANDOFF_FRESH, std::memory_order_acq_rel);
+        writeIndex = last & SNAPSHOT_HANDOFF_INDEX;
+        publishedCount.fetch_add(1, std::memory_order_relaxed);
+        if (last & SNAPSHOT_HANDOFF_FRESH)
+            overwrittenCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void publish(const T &snapshot)
+    {
+        beginWrite() = snapshot;
+        publish();
+    }
+
+    // reader side - takes the latest snapshot if there is a new one, read() stays valid until the next consume()
+    bool consume()
+    {
+        if (!(shared.load(std::memory_order_relaxed) & SNAPSHOT_HANDOFF_FRESH))
+            return false;
+        uint32_t last = shared.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = last & SNAPSHOT_HANDOFF_INDEX;
+        consumedCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    const T &read() const { return buffers[readIndex]; }
+
+    snapshotHandoffStats getStats() const
+    {
+        snapshotHandoffStats stats;
+        stats.published = publishedCount.load(std::memory_order_relaxed);
+        stats.consumed = consumedCount.load(std::memory_order_relaxed);
+        stats.overwritten = overwrittenCount.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    T buffers[3];
+    std::atomic<uint32_t> shared; // index of the buffer in the middle | SNAPSHOT_HANDOFF_FRESH
+    uint32_t writeIndex = 0;      // only touched by the writer
+    uint32_t readIndex = 1;       // only touched by the reader
+    std::atomic<uint32_t> publishedCount{0};
+    std::atomic<uint32_t> consumedCount{0};
+    std::atomic<uint32_t> overwrittenCount{0};
+};
+
+#endif // SNAPSHOTHANDOFF_H
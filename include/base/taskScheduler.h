@@ -0,0 +1,79 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <Arduino.h>
+
+// fixed budget - main loop jobs, web server and 4 jobs per DTU of the site (DTU_SITE_MAX_DTUS)
+#if defined(ESP32)
+#define TASK_SCHEDULER_MAX_TASKS 48
+#else
+#define TASK_SCHEDULER_MAX_TASKS 20
+#endif
+#define TASK_SCHEDULER_NO_TASK 0xFF
+
+typedef void (*taskCallback)(void *arg);
+
+struct schedulerTaskStats
+{
+  uint32_t runs = 0;
+  uint64_t totalUs = 0;        // cpu time of all runs
+  uint32_t lastUs = 0;
+  uint32_t maxUs = 0;
+  uint32_t missedDeadlines = 0; // run finished later than release + deadline
+  uint32_t skippedReleases = 0; // releases dropped because the task was behind for a whole period
+  uint32_t maxLatenessMs = 0;   // start of a run after its release
+};
+
+struct schedulerTask
+{
+  const char *name = nullptr;
+  taskCallback callback = nullptr;
+  void *arg = nullptr;
+  uint32_t periodMs = 0;   // 0 - one shot, armed with runIn()
+  uint32_t deadlineMs = 0; // 0 - the period (no check for one shots)
+  uint32_t nextRelease = 0;
+  boolean enabled = false;
+  schedulerTaskStats stats;
+};
+
+/**
+ * Cooperative scheduler for everything that runs periodically in the main loop. Each task has a
+ * period, a phase (delay of its first release) and a deadline. run() is called from loop() and
+ * executes the due tasks - the one released first first - each to completion. Releases follow
+ * a fixed rate (release + period) so a late run does not shift the following ones, a task that is
+ * behind for whole periods skips them. Runtime, lateness and missed deadlines are kept per task.
+ * Tasks can be (re)armed from other contexts (async TCP callbacks), so on ESP32 the task table is
+ * guarded by a critical section.
+ */
+class TaskScheduler {
+public:
+    // returns the task id - TASK_SCHEDULER_NO_TASK if the budget is exhausted
+    uint8_t addTask(const char *name, taskCallback callback, void *arg, uint32_t periodMs, uint32_t phaseMs = 0, uint32_t deadlineMs = 0, boolean enabled = true);
+
+    // (re)start a task - next release after delayMs, periodic tasks continue with their period
+    void runIn(uint8_t id, uint32_t delayMs);
+    void disable(uint8_t id);
+    void setPeriod(uint8_t id, uint32_t periodMs);
+    boolean isEnabled(uint8_t id) const;
+
+    // executes all due tasks - to be called in loop()
+    void run();
+
+    uint8_t getTaskCount() const { return taskCount; }
+    const schedulerTask &getTask(uint8_t id) const { return tasks[id]; }
+    uint32_t getBusyMs() const { return uint32_t(busyUs / 1000); }
+    void resetStats();
+    void printStats() const;
+
+private:
+    schedulerTask tasks[TASK_SCHEDULER_MAX_TASKS];
+    uint8_t taskCount = 0;
+    uint64_t busyUs = 0; // cpu time of all tasks
+
+    uint8_t nextDueTask(uint32_t now);
+    void execute(uint8_t id, uint32_t now);
+};
+
+extern TaskScheduler taskScheduler;
+
+#endif // TASKSCHEDULER_H
@@ -19,12 +19,15 @@
 #define U_PART U_SPIFFS
 #endif
 
-#include <Ticker.h>
-
 #include <base/platformData.h>
+#include <base/taskScheduler.h>
 #include <Config.h>
 #include <dtuInterface.h>
+#include <dtuSite.h>
 #include <mqttHandler.h>
+#include <zeroExportController.h>
+#include <displayRenderer.h>
+#include <outputSink.h>
 
 #include "web/index_html.h"
 #include "web/jquery_min_js.h"
@@ -42,8 +45,12 @@ public:
 
 private:
     AsyncWebServer asyncDtuWebServer{80}; // Assuming port 80 for the web server
-    Ticker webServerTimer; // Timer object
-    static void backgroundTask(DTUwebserver* instance);
+    uint8_t backgroundTaskId = TASK_SCHEDULER_NO_TASK; // reboot countdown every second
+    static void backgroundTask(void* instance);
+    // server sent events - a message per DTU event, browsers reload the data right away
+    AsyncEventSource pushEvents{"/api/events"};
+    uint8_t pushSubscriberId = DTU_EVENT_NO_SUBSCRIBER;
+    static void onDtuEvent(const dtuEvent &event, void *context);
 
     static void handleRoot(AsyncWebServerRequest *request);
     static void handleCSS(AsyncWebServerRequest *request);
@@ -55,6 +62,14 @@ private:
     
     static void handleDataJson(AsyncWebServerRequest *request);
     static void handleInfojson(AsyncWebServerRequest *request);
+    static void handleHistoryJson(AsyncWebServerRequest *request);
+    static void handleEnergyHistoryJson(AsyncWebServerRequest *request);
+    static void handleTasksJson(AsyncWebServerRequest *request);
+    static void handleSiteJson(AsyncWebServerRequest *request);
+    static void handleDtuTraceJson(AsyncWebServerRequest *request);
+    // JSON of the blocks written in the loop - repeated by the handlers if the version changed
+    static String getHistoryJson(const DTUPowerHistory &history);
+    static String getDtuTraceJson(const DTUConnectionFsm &fsm);
 
     static void handleUpdateWifiSettings(AsyncWebServerRequest *request);
     static void handleUpdateDtuSettings(AsyncWebServerRequest *request);
@@ -2,6 +2,7 @@
 #define DISPLAY_H
 
 #include <U8g2lib.h>
+#include <displayRenderer.h>
 
 // OLED display
 
@@ -25,7 +26,8 @@ class Display {
         Display();
         ~Display();
         void setup();
-        void renderScreen(String time, String version);
+        // function has to be called every 50 milliseconds - draws only from the snapshot
+        void renderScreen(const displaySnapshot &snapshot);
         void drawFactoryMode(String version, String apName, String ip);
         void drawUpdateMode(String text,String text2="");
 
@@ -46,6 +48,7 @@ class Display {
         void setBrightnessAuto();
 
         // private member variables
+        displaySnapshot currentData;
         DisplayData lastDisplayData;
         uint8_t brightness=BRIGHTNESS_MAX;
         u8g2_uint_t offset_x = 0; // shifting for anti burn in effect
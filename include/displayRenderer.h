@@ -0,0 +1,106 @@
+#ifndef DISPLAYRENDERER_H
+#define DISPLAYRENDERER_H
+
+#include <Arduino.h>
+#include <base/snapshotHandoff.h>
+
+#define DISPLAY_RENDER_PERIOD_MS 50
+
+#if defined(ESP32)
+// the Arduino loop (DTU, MQTT, OpenHAB, web) runs on ARDUINO_RUNNING_CORE - rendering on the other one
+#ifndef ARDUINO_RUNNING_CORE
+#define ARDUINO_RUNNING_CORE 1
+#endif
+#ifndef DISPLAY_RENDER_CORE
+#if CONFIG_FREERTOS_UNICORE
+#define DISPLAY_RENDER_CORE 0
+#else
+#define DISPLAY_RENDER_CORE (ARDUINO_RUNNING_CORE == 0 ? 1 : 0)
+#endif
+#endif
+// below lwIP/ WiFi and the async TCP task on that core
+#define DISPLAY_RENDER_PRIORITY 1
+#define DISPLAY_RENDER_STACK 4096
+#endif
+
+#define DISPLAY_SCREEN_NORMAL 0
+#define DISPLAY_SCREEN_MESSAGE 1 // reboot/ update messages with one or two lines
+
+#define DISPLAY_TYPE_OLED 0
+#define DISPLAY_TYPE_TFT 1
+
+// everything a display needs for one frame - filled in the loop, read by the render task
+struct displaySnapshot
+{
+  uint32_t sequence = 0; // 0 - nothing published yet
+  uint8_t screen = DISPLAY_SCREEN_NORMAL;
+  char text[24] = "";
+  char text2[24] = "";
+  char formattedTime[9] = "00:00:00";
+  const char *version = "";
+  unsigned long currentNTPtime = 0;
+  float gridPower = -1;
+  float dailyEnergy = 0;
+  float totalEnergy = 0;
+  uint8_t powerLimit = 254;
+  uint8_t rssiGW = 0;
+  uint8_t rssiDTU = 0;
+  uint8_t dtuConnectState = 0;
+  boolean dtuConnectionOnline = false;
+};
+
+struct displayRenderStats
+{
+  uint32_t frames = 0;
+  uint32_t lastUs = 0;
+  uint32_t maxUs = 0;
+  uint64_t totalUs = 0;
+  int8_t core = -1;           // core of the last frame
+  uint32_t stackFreeBytes = 0; // min. free stack of the render task
+};
+
+class Display;
+class DisplayTFT;
+
+/**
+ * Rendering of the OLED/ TFT display from telemetry snapshots. The main loop fills a snapshot and
+ * publishes it over a lock-free handoff, the display is drawn only from the snapshot - never from the
+ * globals. On ESP32 the drawing runs in an own FreeRTOS task pinned to the core without the Arduino
+ * loop, so the SPI/ I2C transfers do not delay MQTT, OpenHAB and the DTU jobs. On ESP8266 the frame
+ * is drawn right after the publish in the loop.
+ */
+class DisplayRenderer {
+public:
+    void begin(uint8_t displayType, Display *oled, DisplayTFT *tft);
+
+    // writer side (loop) - the returned buffer has to be filled completely before publish()
+    displaySnapshot &beginSnapshot() { return handoff.beginWrite(); }
+    void publish();
+    // message screen (reboot, update) - drawn once per change
+    void publishMessage(const char *text, const char *text2 = "");
+
+    boolean isTaskRunning() const { return taskRunning; }
+    const displayRenderStats &getStats() const { return stats; }
+    snapshotHandoffStats getHandoffStats() const { return handoff.getStats(); }
+
+private:
+    SnapshotHandoff<displaySnapshot> handoff;
+    uint32_t sequence = 0;
+    uint8_t displayType = DISPLAY_TYPE_OLED;
+    Display *oled = nullptr;
+    DisplayTFT *tft = nullptr;
+    boolean taskRunning = false;
+    char lastText[24] = ""; // message on the screen - empty if the normal screen is shown
+    char lastText2[24] = "";
+    displayRenderStats stats;
+
+    // reader side - render task (ESP32) or loop (ESP8266)
+    void renderFrame();
+#if defined(ESP32)
+    static void renderTask(void *instance);
+#endif
+};
+
+extern DisplayRenderer displayRenderer;
+
+#endif // DISPLAYRENDERER_H
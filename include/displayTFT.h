@@ -3,6 +3,7 @@
 
 #include <SPI.h>
 #include <TFT_eSPI.h>
+#include <displayRenderer.h>
 
 // TFT display
 
@@ -35,7 +36,7 @@ class DisplayTFT {
     public:
         DisplayTFT();
         void setup();
-        void renderScreen(String time, String version);
+        void renderScreen(const displaySnapshot &snapshot);
         void drawFactoryMode(String version, String apName, String ip);
         void drawUpdateMode(String text,String text2="", boolean blank=true);
         void setRemoteDisplayMode(bool remoteDisplayActive);
@@ -53,6 +54,7 @@ class DisplayTFT {
         void setBrightnessAuto();
 
         // private member variables
+        displaySnapshot currentData;
         DisplayDataTFT lastDisplayData;
         uint8_t brightness=BRIGHTNESS_TFT_MIN;
         uint8_t offset_x = 0; // shifting for anti burn in effect
@@ -0,0 +1,47 @@
+#ifndef DTUCRC16_H
+#define DTUCRC16_H
+
+#include <Arduino.h>
+
+// CRC16/MODBUS - reflected polynome 0x8005 (0xA001), init 0xFFFF, no final xor
+#define DTU_CRC16_INITIAL 0xFFFF
+#define DTU_CRC16_POLYNOME_REFLECTED 0xA001
+
+// one table entry - shifts the 8 bits of the index through the reflected polynome
+constexpr uint16_t dtuCRC16TableEntry(uint16_t crc, uint8_t bits = 8)
+{
+    return bits == 0 ? crc : dtuCRC16TableEntry((crc & 1) ? (crc >> 1) ^ DTU_CRC16_POLYNOME_REFLECTED : (crc >> 1), bits - 1);
+}
+
+/**
+ * Byte wise table driven CRC16/MODBUS as used in the header of every DTU frame.
+ * The table is built at compile time. A slice-by-N variant is not used - DTU frames are only
+ * a few hundred bytes and the additional tables would cost several kB of RAM on the ESP8266.
+ */
+class DTUCRC16 {
+public:
+    // calc crc over data - pass the result of a previous call as crc to continue over several chunks
+    static uint16_t calc(const uint8_t *data, size_t len, uint16_t crc = DTU_CRC16_INITIAL);
+
+    static inline uint16_t update(uint16_t crc, uint8_t data)
+    {
+        return (crc >> 8) ^ table[(crc ^ data) & 0xFF];
+    }
+
+    static constexpr uint16_t table[256] = {
+#define DTU_CRC16_T4(i) dtuCRC16TableEntry(i), dtuCRC16TableEntry(i + 1), dtuCRC16TableEntry(i + 2), dtuCRC16TableEntry(i + 3)
+#define DTU_CRC16_T16(i) DTU_CRC16_T4(i), DTU_CRC16_T4(i + 4), DTU_CRC16_T4(i + 8), DTU_CRC16_T4(i + 12)
+#define DTU_CRC16_T64(i) DTU_CRC16_T16(i), DTU_CRC16_T16(i + 16), DTU_CRC16_T16(i + 32), DTU_CRC16_T16(i + 48)
+        DTU_CRC16_T64(0), DTU_CRC16_T64(64), DTU_CRC16_T64(128), DTU_CRC16_T64(192)
+#undef DTU_CRC16_T64
+#undef DTU_CRC16_T16
+#undef DTU_CRC16_T4
+    };
+};
+
+// spot checks against the well known CRC16/MODBUS table
+static_assert(DTUCRC16::table[0x01] == 0xC0C1, "CRC16 table broken");
+static_assert(DTUCRC16::table[0x80] == 0xA001, "CRC16 table broken");
+static_assert(DTUCRC16::table[0xFF] == 0x4040, "CRC16 table broken");
+
+#endif // DTUCRC16_H
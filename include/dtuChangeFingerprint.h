@@ -0,0 +1,62 @@
+#ifndef DTUCHANGEFINGERPRINT_H
+#define DTUCHANGEFINGERPRINT_H
+
+#include <Arduino.h>
+
+// 32 bit FNV-1a
+#define DTU_FINGERPRINT_OFFSET 2166136261UL
+#define DTU_FINGERPRINT_PRIME 16777619UL
+// responses in a row with the same values until the DTU counts as hanging
+#define DTU_FINGERPRINT_HISTORY 10
+// default for the max. time without an update to the APIs if nothing changed
+#define DTU_FINGERPRINT_REFRESH_SECONDS 300
+
+struct fingerprintStats
+{
+  uint32_t forwarded = 0;  // poll cycles sent to the APIs
+  uint32_t suppressed = 0; // poll cycles without any change - not sent
+  uint32_t refreshes = 0;  // forwarded without a change - refresh time reached
+  uint32_t lastFingerprint = 0;
+  uint16_t unchangedInRow = 0; // RealDataNew responses with the values of the one before
+};
+
+/**
+ * Change detection of the measurements of one DTU. Every RealDataNew response is reduced to an
+ * FNV-1a hash over its measurement fields (without any time) while it is decoded. A response with
+ * the hash of the one before needs no conversion, and a poll cycle where neither the measurements nor
+ * the GetConfig values changed is not sent to the APIs - except every refresh seconds. The last
+ * DTU_FINGERPRINT_HISTORY hashes are kept to detect a DTU that hangs with frozen values.
+ */
+class DTUChangeFingerprint {
+public:
+    DTUChangeFingerprint();
+
+    static uint32_t add(uint32_t hash, uint32_t value);
+    static uint32_t add(uint32_t hash, uint64_t value);
+    static uint32_t add(uint32_t hash, int32_t value) { return add(hash, uint32_t(value)); }
+
+    // hash of a RealDataNew response - returns true if the values differ from the last response
+    boolean addRealData(uint32_t fingerprint);
+    // all of the last DTU_FINGERPRINT_HISTORY responses had the same values
+    boolean isHanging() const;
+
+    // end of a poll cycle - true if the cycle has to be sent to the APIs (changed or refresh due)
+    boolean checkForward(uint32_t configFingerprint, uint32_t timestamp, uint16_t refreshSeconds);
+    // the data block was changed elsewhere (e.g. zero values at night) - next response is converted and sent
+    void invalidate() { valid = false; }
+
+    const fingerprintStats &getStats() const { return stats; }
+
+private:
+    uint32_t history[DTU_FINGERPRINT_HISTORY];
+    uint8_t historyIndex = 0;
+    uint8_t historyCount = 0;
+    boolean valid = false;
+    boolean changePending = true; // changed response not yet forwarded
+    uint32_t lastConfigFingerprint = 0;
+    uint32_t lastForwardTime = 0;
+
+    fingerprintStats stats;
+};
+
+#endif // DTUCHANGEFINGERPRINT_H
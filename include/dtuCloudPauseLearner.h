@@ -0,0 +1,71 @@
+#ifndef DTUCLOUDPAUSELEARNER_H
+#define DTUCLOUDPAUSELEARNER_H
+
+#include <Arduino.h>
+
+// bounds of the learned pause length - the upper bound is the configured cloud pause time
+#define DTU_CLOUD_PAUSE_MIN_SECONDS 10
+// added to an observed upload time
+#define DTU_CLOUD_PAUSE_MARGIN_SECONDS 5
+// the pause is shortened by this step after every pause without any sign of a running upload
+#define DTU_CLOUD_PAUSE_SHRINK_SECONDS 2
+// a connect taking longer than this after the pause counts as delayed by the upload
+#define DTU_CLOUD_PAUSE_CONNECT_DELAY_MS 3000
+
+struct cloudPauseStats
+{
+  uint32_t pauses = 0;
+  uint32_t busyPauses = 0;          // DTU was still busy at the end of the pause (refused, delayed, stale data)
+  uint16_t lastBusySeconds = 0;     // pause start until the DTU delivered fresh data - of the last busy pause
+  uint16_t maxBusySeconds = 0;
+  uint32_t lastConnectDelayMs = 0;  // end of pause until connected
+  uint32_t failedConnects = 0;      // connects refused/ timed out right after a pause
+};
+
+/**
+ * Learns the length of the cloud pause of one DTU. The pause starts at the fixed position in the
+ * quarter hour, the end is probed: after every pause where the DTU accepted the connection right
+ * away and answered with fresh data, the next pause is a bit shorter. If the DTU refuses or delays
+ * the connection or still sends the old timestamp, the time until fresh data arrived is taken as
+ * the upload time and the pause is set to it plus a safety margin.
+ * Also keeps the time the connection was up to report the data availability.
+ */
+class DTUCloudPauseLearner {
+public:
+    void setMaxSeconds(uint16_t seconds);
+    uint16_t getPauseSeconds() const { return pauseSeconds; }
+
+    void pauseStarted(unsigned long now);
+    void pauseEnded(unsigned long now);
+    void connectFailed();
+    void connected(unsigned long now);
+    // first RealDataNew after a pause - fresh: timestamp differs from the last response
+    void dataReceived(unsigned long now, boolean fresh);
+
+    // connection up/ down - for the data availability
+    void setOnline(boolean online, unsigned long now);
+    // share of the time since start with an established connection (0 ... 1)
+    float getDataAvailability(unsigned long now) const;
+
+    const cloudPauseStats &getStats() const { return stats; }
+
+private:
+    uint16_t maxSeconds = 40;
+    uint16_t pauseSeconds = 40;
+
+    boolean observing = false; // pause ended, waiting for the first fresh data
+    boolean busy = false;
+    unsigned long pauseStart = 0;
+    unsigned long pauseEnd = 0;
+
+    boolean online = false;
+    unsigned long onlineSince = 0;
+    unsigned long trackingStart = 0;
+    uint64_t onlineMs = 0;
+
+    cloudPauseStats stats;
+
+    void finishObservation(unsigned long now);
+};
+
+#endif // DTUCLOUDPAUSELEARNER_H
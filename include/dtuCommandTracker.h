@@ -0,0 +1,92 @@
+#ifndef DTUCOMMANDTRACKER_H
+#define DTUCOMMANDTRACKER_H
+
+#include <Arduino.h>
+
+// lifecycle of a power limit command
+#define DTU_CMD_STATE_IDLE 0      // no command sent yet
+#define DTU_CMD_STATE_IN_FLIGHT 1 // written to the DTU, waiting for the command response
+#define DTU_CMD_STATE_ACKED 2     // accepted by the DTU (err_code 0), waiting for GetConfig to show the new limit
+#define DTU_CMD_STATE_CONFIRMED 3 // GetConfig reports the new limit
+#define DTU_CMD_STATE_FAILED 4    // rejected or not effective after all retries
+
+// retries of one command (rejected, no response or not effective in time)
+#define DTU_CMD_MAX_RETRIES 3
+#define DTU_CMD_ACK_TIMEOUT_MS 10000
+#define DTU_CMD_CONFIRM_TIMEOUT_MS 30000
+// a failed limit is sent again at the earliest after this time
+#define DTU_CMD_FAILED_HOLDOFF_MS 60000
+
+// latency histograms - upper bound (ms) of each bucket, last bucket takes everything above
+#define DTU_CMD_LATENCY_BUCKETS 7
+#define DTU_CMD_ACK_BOUNDS {100, 250, 500, 1000, 2500, 5000, 0xFFFFFFFF}
+#define DTU_CMD_EFFECTIVE_BOUNDS {1000, 2500, 5000, 10000, 20000, 30000, 0xFFFFFFFF}
+
+struct commandStats
+{
+  uint32_t commands = 0;   // new limit targets
+  uint32_t sent = 0;       // written to the DTU incl. retries
+  uint32_t retries = 0;
+  uint32_t suppressed = 0; // set requests for a limit already on the way
+  uint32_t acked = 0;
+  uint32_t rejected = 0;   // command response with err_code != 0
+  uint32_t confirmed = 0;
+  uint32_t failed = 0;
+  int32_t lastErrCode = 0;
+  uint32_t lastAckMs = 0;       // set until command response
+  uint32_t lastEffectiveMs = 0; // set until GetConfig reports the new limit
+  uint32_t ackHistogram[DTU_CMD_LATENCY_BUCKETS] = {0};
+  uint32_t effectiveHistogram[DTU_CMD_LATENCY_BUCKETS] = {0};
+};
+
+/**
+ * Tracks the power limit command of one DTU from the set request until the DTU reports the new
+ * limit with GetConfig. A set request for the limit that is already on the way is suppressed - the
+ * command is only sent again by a retry after a rejection or a timeout, up to DTU_CMD_MAX_RETRIES
+ * times - while a retry is pending a set request for the same limit does not start over. Latencies are measured from the (first) set request of a limit.
+ */
+class DTUCommandTracker {
+public:
+    // new set request - returns true if a command has to be sent
+    boolean request(uint8_t limit, unsigned long now);
+    // command was written to the DTU
+    void sent(int64_t tid, unsigned long now);
+    // command response - returns false if no command was on the way
+    boolean acked(int64_t tid, int32_t errCode, unsigned long now);
+    // limit reported by GetConfig
+    void limitReported(uint8_t limit, unsigned long now);
+    // returns true if the command has to be sent again (timeout/ rejection within the retry budget)
+    boolean checkRetry(unsigned long now);
+    // ms until the next timeout of the running command - 0 if none is running
+    uint32_t getTimeout(unsigned long now) const;
+    // connection lost - a command in flight gets no response anymore
+    void connectionLost();
+
+    uint8_t getState() const { return state; }
+    uint8_t getTarget() const { return target; }
+    uint8_t getRetries() const { return retries; }
+    // millis() of the last command response
+    unsigned long getAckMillis() const { return ackAt; }
+    const commandStats &getStats() const { return stats; }
+    static const char *getStateName(uint8_t state);
+    static uint32_t getAckBound(uint8_t bucket);
+    static uint32_t getEffectiveBound(uint8_t bucket);
+
+private:
+    uint8_t state = DTU_CMD_STATE_IDLE;
+    uint8_t target = 0;
+    uint8_t retries = 0;
+    boolean retryDue = false;
+    boolean retryQueued = false; // retry handed to the request queue, not yet sent
+    int64_t tid = 0;
+    unsigned long setAt = 0;
+    unsigned long sentAt = 0;
+    unsigned long ackAt = 0;
+    unsigned long failedAt = 0;
+    commandStats stats;
+
+    void retryOrFail(unsigned long now, const char *reason);
+    static void addToHistogram(uint32_t *histogram, const uint32_t *bounds, uint32_t value);
+};
+
+#endif // DTUCOMMANDTRACKER_H
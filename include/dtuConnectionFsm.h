@@ -0,0 +1,86 @@
+#ifndef DTUCONNECTIONFSM_H
+#define DTUCONNECTIONFSM_H
+
+#include <Arduino.h>
+#include <base/seqlockSnapshot.h>
+
+#define DTU_STATE_OFFLINE 0
+#define DTU_STATE_CONNECTED 1
+#define DTU_STATE_CLOUD_PAUSE 2
+#define DTU_STATE_TRY_RECONNECT 3
+#define DTU_STATE_DTU_REBOOT 4
+#define DTU_STATE_CONNECT_ERROR 5
+#define DTU_STATE_STOPPED 6
+#define DTU_STATE_ANY 0xFE
+
+#define DTU_TXRX_STATE_IDLE 0
+#define DTU_TXRX_STATE_WAIT_APPGETHISTPOWER 1
+#define DTU_TXRX_STATE_WAIT_REALDATANEW 2
+#define DTU_TXRX_STATE_WAIT_GETCONFIG 3
+#define DTU_TXRX_STATE_WAIT_COMMAND 4
+#define DTU_TXRX_STATE_WAIT_RESTARTDEVICE 5
+#define DTU_TXRX_STATE_WAIT_HEARTBEAT 6
+#define DTU_TXRX_STATE_ERROR 99
+
+// events of the connection state machine
+#define DTU_EV_CONNECT_START 0
+#define DTU_EV_CONNECTED 1
+#define DTU_EV_CONNECT_FAILED 2
+#define DTU_EV_CONNECT_TIMEOUT 3
+#define DTU_EV_ERROR 4
+#define DTU_EV_DISCONNECTED 5
+#define DTU_EV_CLOUD_PAUSE 6
+#define DTU_EV_REBOOT 7
+#define DTU_EV_DATA_TIMEOUT 8
+#define DTU_EV_LINK_DEAD 9
+#define DTU_EV_STOP 10
+#define DTU_EV_ANY 0xFE
+
+#define DTU_FSM_TRACE_SIZE 32
+#define DTU_FSM_TRACE_CONNECTION 0
+#define DTU_FSM_TRACE_TXRX 1
+
+struct fsmTraceEntry
+{
+  uint32_t millis = 0;
+  uint8_t type = DTU_FSM_TRACE_CONNECTION;
+  uint8_t from = 0;
+  uint8_t to = 0;
+  uint8_t event = DTU_EV_ANY; // only for connection transitions
+};
+
+/**
+ * Table driven state machine of the DTU connection (DTU_STATE_*). Events are handled right where
+ * they happen (TCP callbacks, timer wheel) - the first matching row of the transition table
+ * decides the next state, events without a row leave the state untouched.
+ * Connection transitions and tx/rx state changes are kept with their millis() in a small ring
+ * buffer for the trace api.
+ */
+class DTUConnectionFsm {
+public:
+    // returns true if the event changed the state
+    boolean handleEvent(uint8_t event, uint8_t &state, unsigned long now);
+    void traceTxRx(uint8_t from, uint8_t to, unsigned long now);
+
+    // oldest entry first
+    uint8_t getTraceCount() const { return traceCount; }
+    const fsmTraceEntry &getTrace(uint8_t index) const;
+    uint32_t getTransitions() const { return transitions; }
+    // trace written in the loop - readers in other contexts (web) check their read with the version
+    const SeqlockVersion &getVersion() const { return version; }
+
+    static const char *getStateName(uint8_t state);
+    static const char *getTxRxStateName(uint8_t state);
+    static const char *getEventName(uint8_t event);
+
+private:
+    fsmTraceEntry trace[DTU_FSM_TRACE_SIZE];
+    uint8_t traceHead = 0;
+    uint8_t traceCount = 0;
+    uint32_t transitions = 0;
+    SeqlockVersion version;
+
+    void addTrace(uint8_t type, uint8_t from, uint8_t to, uint8_t event, unsigned long now);
+};
+
+#endif // DTUCONNECTIONFSM_H
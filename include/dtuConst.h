@@ -2,38 +2,41 @@
 //
 // """Constants for the Hoymiles WiFi integration."""
 // 
+#ifndef DTUCONST_H
+#define DTUCONST_H
+
 #define DTU_PORT 10081
 // 
 // # App -> DTU start with 0xa3, responses start 0xa2
 const byte CMD_HEADER[] = {};
-const byte CMD_APP_INFO_DATA_RES_DTO[] = {0xa3,0x01};
-const byte CMD_HB_RES_DTO[] = {0xa3,0x02};
-const byte CMD_REAL_DATA_RES_DTO[] = {0xa3,0x03};
-const byte CMD_W_INFO_RES_DTO[] = {0xa3,0x04};
-const byte CMD_COMMAND_RES_DTO[] = {0xa3,0x05};
-const byte CMD_COMMAND_STATUS_RES_DTO[] = {0xa3,0x06};
-const byte CMD_DEV_CONFIG_FETCH_RES_DTO[] = {0xa3,0x07};
-const byte CMD_DEV_CONFIG_PUT_RES_DTO[] = {0xa3,0x08};
-const byte CMD_GET_CONFIG[] = {0xa3,0x09};
-const byte CMD_SET_CONFIG[] = {0xa3,0x10};
-const byte CMD_REAL_RES_DTO[] = {0xa3,0x11};
-const byte CMD_GPST_RES_DTO[] = {0xa3,0x12};
-const byte CMD_AUTO_SEARCH[] = {0xa3,0x13};
-const byte CMD_NETWORK_INFO_RES[] = {0xa3,0x14};
-const byte CMD_APP_GET_HIST_POWER_RES[] = {0xa3,0x15};
-const byte CMD_APP_GET_HIST_ED_RES[] = {0xa3,0x16};
-const byte CMD_HB_RES_DTO_ALT[] = {0x83,0x01};
-const byte CMD_REGISTER_RES_DTO[] = {0x83,0x02};
-const byte CMD_STORAGE_DATA_RES[] = {0x83,0x03};
-const byte CMD_COMMAND_RES_DTO_2[] = {0x83,0x05};
-const byte CMD_COMMAND_STATUS_RES_DTO_2[] = {0x83,0x06};
-const byte CMD_DEV_CONFIG_FETCH_RES_DTO_2[] = {0x83,0x07};
-const byte CMD_DEV_CONFIG_PUT_RES_DTO_2[] = {0x83,0x08};
-const byte CMD_GET_CONFIG_RES[] = {0xdb,0x08};
-const byte CMD_SET_CONFIG_RES[] = {0xdb,0x07};
+constexpr byte CMD_APP_INFO_DATA_RES_DTO[] = {0xa3,0x01};
+constexpr byte CMD_HB_RES_DTO[] = {0xa3,0x02};
+constexpr byte CMD_REAL_DATA_RES_DTO[] = {0xa3,0x03};
+constexpr byte CMD_W_INFO_RES_DTO[] = {0xa3,0x04};
+constexpr byte CMD_COMMAND_RES_DTO[] = {0xa3,0x05};
+constexpr byte CMD_COMMAND_STATUS_RES_DTO[] = {0xa3,0x06};
+constexpr byte CMD_DEV_CONFIG_FETCH_RES_DTO[] = {0xa3,0x07};
+constexpr byte CMD_DEV_CONFIG_PUT_RES_DTO[] = {0xa3,0x08};
+constexpr byte CMD_GET_CONFIG[] = {0xa3,0x09};
+constexpr byte CMD_SET_CONFIG[] = {0xa3,0x10};
+constexpr byte CMD_REAL_RES_DTO[] = {0xa3,0x11};
+constexpr byte CMD_GPST_RES_DTO[] = {0xa3,0x12};
+constexpr byte CMD_AUTO_SEARCH[] = {0xa3,0x13};
+constexpr byte CMD_NETWORK_INFO_RES[] = {0xa3,0x14};
+constexpr byte CMD_APP_GET_HIST_POWER_RES[] = {0xa3,0x15};
+constexpr byte CMD_APP_GET_HIST_ED_RES[] = {0xa3,0x16};
+constexpr byte CMD_HB_RES_DTO_ALT[] = {0x83,0x01};
+constexpr byte CMD_REGISTER_RES_DTO[] = {0x83,0x02};
+constexpr byte CMD_STORAGE_DATA_RES[] = {0x83,0x03};
+constexpr byte CMD_COMMAND_RES_DTO_2[] = {0x83,0x05};
+constexpr byte CMD_COMMAND_STATUS_RES_DTO_2[] = {0x83,0x06};
+constexpr byte CMD_DEV_CONFIG_FETCH_RES_DTO_2[] = {0x83,0x07};
+constexpr byte CMD_DEV_CONFIG_PUT_RES_DTO_2[] = {0x83,0x08};
+constexpr byte CMD_GET_CONFIG_RES[] = {0xdb,0x08};
+constexpr byte CMD_SET_CONFIG_RES[] = {0xdb,0x07};
 // 
-const byte CMD_CLOUD_INFO_DATA_RES_DTO[] = {0x23,0x01};
-const byte CMD_CLOUD_COMMAND_RES_DTO[] = {0x23,0x05};
+constexpr byte CMD_CLOUD_INFO_DATA_RES_DTO[] = {0x23,0x01};
+constexpr byte CMD_CLOUD_COMMAND_RES_DTO[] = {0x23,0x05};
 // 
 #define CMD_ACTION_MICRO_DEFAULT 0
 #define CMD_ACTION_DTU_REBOOT 1
@@ -116,4 +119,6 @@ const byte CMD_CLOUD_COMMAND_RES_DTO[] = {0x23,0x05};
 // )
 // 
 #define MAX_POWER_LIMIT 100
-// 
\ No newline at end of file
+// 
+
+#endif // DTUCONST_H
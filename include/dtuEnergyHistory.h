@@ -0,0 +1,70 @@
+#ifndef DTUENERGYHISTORY_H
+#define DTUENERGYHISTORY_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// days kept - one fixed size record per day
+#if defined(ESP32)
+#define DTU_ENERGY_HISTORY_DAYS 366
+#else
+#define DTU_ENERGY_HISTORY_DAYS 180
+#endif
+#define DTU_ENERGY_HISTORY_FILE_MAGIC 0x44454831 // 'DEH1'
+
+// record as stored in RAM and in the file
+struct dayEnergyRecord
+{
+  uint32_t day = 0;      // days since 1970 (local DTU time) - 0: record empty
+  uint32_t energyWh = 0;
+};
+
+struct energyHistoryStats
+{
+  uint32_t fileWrites = 0;    // records written to the file
+  boolean fileLoaded = false;
+};
+
+/**
+ * Energy per day of one DTU for the last DTU_ENERGY_HISTORY_DAYS days. Each day has a fixed slot
+ * (day % days) tagged with its day number like the slots of DTUPowerHistory, so an old record is
+ * overwritten by the new day without any shifting. The table is filled from the live daily energy -
+ * days the gateway was offline stay empty (the day history of the DTU is not requested).
+ * If a file is given the table is persisted to LittleFS with the same fixed layout - only changed
+ * records are written. The updates only mark a save as pending (they run in the async TCP context),
+ * save() is called by the owner from the main loop.
+ */
+class DTUEnergyHistory {
+public:
+    DTUEnergyHistory();
+
+    // load the table from the file (or create it) - without a file the history is kept in RAM only
+    void begin(const char *filePath);
+    // write changed records to the file
+    void save();
+    // end of a day - changed records should go to the file
+    boolean isSavePending() const { return savePending; }
+
+    // daily energy of the running day (kWh) - from RealDataNew
+    void addLiveEnergy(uint32_t timestamp, float dailyEnergy);
+
+    // records from newest (index 0) to oldest - false if no record at this position
+    boolean getRecord(uint16_t index, dayEnergyRecord &record) const;
+    uint16_t getRecordCount() const;
+
+    const energyHistoryStats &getStats() const { return stats; }
+
+private:
+    dayEnergyRecord records[DTU_ENERGY_HISTORY_DAYS];
+    uint8_t dirty[(DTU_ENERGY_HISTORY_DAYS + 7) / 8];
+    uint32_t newestDay = 0;
+    const char *filePath = nullptr;
+    volatile boolean savePending = false;
+
+    energyHistoryStats stats;
+
+    boolean setRecord(uint32_t day, uint32_t energyWh);
+    boolean createFile();
+};
+
+#endif // DTUENERGYHISTORY_H
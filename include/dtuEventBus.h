@@ -0,0 +1,98 @@
+#ifndef DTUEVENTBUS_H
+#define DTUEVENTBUS_H
+
+#include <Arduino.h>
+
+#define DTU_EVENT_NEW_SAMPLE 0        // poll cycle with new (or refreshed) values to be sent to the APIs
+#define DTU_EVENT_STATE_CHANGE 1      // connection state or online summary changed - value: new state
+#define DTU_EVENT_LIMIT_ACK 2         // power limit command accepted by the DTU - value: limit in %
+#define DTU_EVENT_CLOUD_PAUSE_START 3 // connection closed for the cloud upload
+#define DTU_EVENT_CLOUD_PAUSE_END 4
+#define DTU_EVENT_TYPES 5
+#define DTU_EVENT_MASK(type) (1 << (type))
+#define DTU_EVENT_MASK_ALL ((1 << DTU_EVENT_TYPES) - 1)
+
+#define DTU_EVENT_QUEUE_SIZE 16
+#define DTU_EVENT_MAX_SUBSCRIBERS 8
+#define DTU_EVENT_NO_SUBSCRIBER 0xFF
+
+class DTUInterface;
+
+struct dtuEvent
+{
+  uint32_t sequence = 0; // counted per post - all subscribers of one event see the same number
+  uint8_t type = DTU_EVENT_NEW_SAMPLE;
+  DTUInterface *source = nullptr;
+  int32_t value = 0;
+  uint32_t originUs = 0; // new sample: decode of the RealDataNew response - else: post of the event
+};
+
+typedef void (*dtuEventHandler)(const dtuEvent &event, void *context);
+
+struct eventSubscriberStats
+{
+  uint32_t events = 0;
+  uint32_t lastLatencyUs = 0; // origin of the event until the handler finished
+  uint32_t maxLatencyUs = 0;
+  uint64_t sumLatencyUs = 0;
+  uint32_t lastRuntimeUs = 0; // handler only
+  uint32_t maxRuntimeUs = 0;
+};
+
+struct eventSubscriber
+{
+  const char *name = nullptr;
+  uint8_t typeMask = 0;
+  dtuEventHandler handler = nullptr;
+  void *context = nullptr;
+  eventSubscriberStats stats;
+};
+
+struct eventBusStats
+{
+  uint32_t posted = 0;
+  uint32_t dispatched = 0;
+  uint32_t dropped = 0; // queue full - the oldest event was lost
+  uint8_t maxQueued = 0;
+};
+
+/**
+ * Publish/ subscribe of the DTU events. The DTU interfaces post typed events in their async TCP and
+ * scheduler contexts, the events are queued and delivered to the subscribers in the main loop - in the
+ * order of subscription, each subscriber only gets the types of its mask. So the outputs react right
+ * when a value arrives instead of polling a flag. Per subscriber the latency from the origin of the
+ * event (decode of the values for a new sample) until its handler finished is measured.
+ * On ESP32 the queue is guarded by a critical section.
+ */
+class DTUEventBus {
+public:
+    // returns the subscriber id - DTU_EVENT_NO_SUBSCRIBER if the budget is exhausted
+    uint8_t subscribe(const char *name, uint8_t typeMask, dtuEventHandler handler, void *context = nullptr);
+
+    // any context - originUs 0: now
+    void post(uint8_t type, DTUInterface *source, int32_t value = 0, uint32_t originUs = 0);
+    // delivers all queued events - to be called in loop()
+    void dispatch();
+
+    uint8_t getSubscriberCount() const { return subscriberCount; }
+    const eventSubscriber &getSubscriber(uint8_t id) const { return subscribers[id]; }
+    const eventBusStats &getStats() const { return stats; }
+    void resetStats();
+    void printStats() const;
+
+    static const char *getTypeName(uint8_t type);
+
+private:
+    dtuEvent queue[DTU_EVENT_QUEUE_SIZE];
+    uint8_t queueHead = 0; // next event to deliver
+    uint8_t queueCount = 0;
+    eventSubscriber subscribers[DTU_EVENT_MAX_SUBSCRIBERS];
+    uint8_t subscriberCount = 0;
+    eventBusStats stats;
+
+    boolean takeNext(dtuEvent &event);
+};
+
+extern DTUEventBus dtuEventBus;
+
+#endif // DTUEVENTBUS_H
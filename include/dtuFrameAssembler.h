@@ -0,0 +1,87 @@
+#ifndef DTUFRAMEASSEMBLER_H
+#define DTUFRAMEASSEMBLER_H
+
+#include <Arduino.h>
+
+#include "pb_decode.h"
+#include "dtuCRC16.h"
+#include "dtuReceiveQueue.h"
+#include "dtuTelemetry.h"
+
+// every DTU frame: "HM" | cmd (2) | 0x00 0x01 | crc16 of payload (2) | total length incl. header (2) | payload
+#define DTU_FRAME_HEADER_SIZE 10
+#define DTU_FRAME_LOG_INTERVAL_MS 10000 // max. one log line per interval for rejected frames
+
+// encoded size of RealDataNew entries (tag, length and message) with every field set and every varint at
+// its max. length - serials of 12 hex digits, int32 0x7FFFFFFF, negative reactive power/ power factor/
+// temperature/ meter power
+#define DTU_REALDATA_MAX_HEADER_SIZE 54 // device serial, timestamp, power and energy of the DTU
+#define DTU_REALDATA_MAX_GRID_SIZE 145  // TGSMO - SGSMO is 104
+#define DTU_REALDATA_MAX_PV_SIZE 52     // PvMO
+#define DTU_REALDATA_MAX_METER_SIZE 190 // MeterMO
+// longest RealDataNew frame within the telemetry budget - 3268 bytes for 8 inverters with 4 ports (ESP8266: 4 inverters, 1856 bytes)
+#define DTU_FRAME_MAX_LENGTH (DTU_FRAME_HEADER_SIZE + DTU_REALDATA_MAX_HEADER_SIZE +        \
+                              DTU_TELEMETRY_MAX_INVERTERS * DTU_REALDATA_MAX_GRID_SIZE + \
+                              DTU_TELEMETRY_MAX_PORTS * DTU_REALDATA_MAX_PV_SIZE +        \
+                              DTU_TELEMETRY_MAX_METERS * DTU_REALDATA_MAX_METER_SIZE)
+// GetConfig response - sent pipelined with RealDataNew, the longest of the other responses
+#define DTU_FRAME_CONFIG_MAX_LENGTH 528
+
+// a valid frame always fits into the receive queue - together with the second response of the poll
+static_assert(DTU_FRAME_MAX_LENGTH + DTU_FRAME_CONFIG_MAX_LENGTH <= DTU_RX_BUFFER_SIZE, "receive buffer too small for the max frame length");
+
+struct dtuFrameHeader
+{
+  uint8_t cmdHigh = 0;
+  uint8_t cmdLow = 0;
+  uint16_t crc = 0;
+  uint16_t length = 0; // total length incl. header
+};
+
+struct frameAssemblerStats
+{
+  uint32_t framesOk = 0;
+  uint32_t framesRejected = 0; // bad length or crc
+  uint32_t resyncBytes = 0;    // bytes skipped while searching for "HM" or cut off by a closed connection
+};
+
+/**
+ * Reassembles DTU frames from a TCP byte stream, independent of how the
+ * stream was segmented. The frames are parsed in place in the ring of the
+ * receive queue, a frame is handed out once the length in header bytes 8-9
+ * is complete and the CRC16 in bytes 6-7 matches. The payload is read by
+ * nanopb directly from the ring - the received bytes are not copied again.
+ * Runs in the loop only, like all other readers of the receive queue.
+ */
+class DTUFrameAssembler {
+public:
+    explicit DTUFrameAssembler(DTUReceiveQueue &queue);
+
+    // returns true if a complete and valid frame is available before the stream position limit
+    // payload stream stays valid until releaseFrame() is called
+    bool nextFrame(dtuFrameHeader &header, pb_istream_t &payload, uint32_t limit);
+    // sets payload back to the start of the frame handed out - false if there is none
+    bool rewindFrame(pb_istream_t &payload);
+    void releaseFrame();
+    // drops the bytes up to the stream position limit - the rest of a frame of a closed connection
+    void discard(uint32_t limit);
+
+    const frameAssemblerStats &getStats() const { return stats; }
+
+private:
+    DTUReceiveQueue &queue;
+
+    size_t currentFrameLen = 0;
+    size_t streamOffset = 0; // read offset of the payload stream from the start of the frame
+
+    frameAssemblerStats stats;
+    uint32_t lastRejectLogMs = 0;
+    uint32_t rejectsNotLogged = 0;
+
+    void rejectFrame(const char *reason, size_t frameLen);
+    uint16_t calcPayloadCRC(size_t frameLen) const;
+
+    static bool readPayload(pb_istream_t *stream, pb_byte_t *buf, size_t count);
+};
+
+#endif // DTUFRAMEASSEMBLER_H
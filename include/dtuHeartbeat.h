@@ -0,0 +1,62 @@
+#ifndef DTUHEARTBEAT_H
+#define DTUHEARTBEAT_H
+
+#include <Arduino.h>
+
+// default seconds between two heartbeats (dtu.heartbeatInterval) - the DTU handles about one request per 31 s
+#define DTU_HEARTBEAT_INTERVAL 31
+// seconds until the next beat after a missed one - a dead link is found quickly without beating fast all the time
+#define DTU_HEARTBEAT_RETRY_INTERVAL 5
+// RTT histogram - upper bound (ms) of each bucket, last bucket takes everything above
+#define DTU_HEARTBEAT_RTT_BUCKETS 8
+#define DTU_HEARTBEAT_RTT_BOUNDS {25, 50, 100, 200, 500, 1000, 2000, 0xFFFFFFFF}
+
+struct heartbeatStats
+{
+  uint32_t sent = 0;
+  uint32_t answered = 0;
+  uint32_t missed = 0;
+  uint8_t missedInRow = 0;
+  uint32_t deadLinks = 0; // connections closed after too many missed beats
+  uint32_t lastRttMs = 0;
+  uint32_t minRttMs = 0;
+  uint32_t maxRttMs = 0;
+  uint32_t sumRttMs = 0; // with answered -> average RTT
+  uint32_t rttHistogram[DTU_HEARTBEAT_RTT_BUCKETS] = {0};
+};
+
+/**
+ * Heartbeat bookkeeping of one DTU connection. Every beat is a CMD_HB_RES_DTO request - the time
+ * from writing it to the response is the round trip time of the link. A beat that is still
+ * unanswered when the next one is due counts as missed - the beat after a miss is sent after
+ * DTU_HEARTBEAT_RETRY_INTERVAL instead of the full interval. The dead link detection is armed with the
+ * first answered beat of a connection, so a DTU firmware without heartbeat support is never
+ * disconnected by it.
+ */
+class DTUHeartbeat {
+public:
+    // new connection - counters of the last one are kept, the miss state starts over
+    void reset();
+
+    // next beat is due - counts the last one as missed if it is still unanswered
+    void startBeat();
+    // beat request was written to the DTU
+    void beatSent(unsigned long now);
+    // heartbeat response received - returns false if no beat was on the way
+    boolean beatAnswered(unsigned long now);
+
+    // true if at least maxMissed beats in a row were not answered (0 - detection off)
+    boolean isLinkDead(uint8_t maxMissed) const;
+    void countDeadLink() { stats.deadLinks++; }
+
+    const heartbeatStats &getStats() const { return stats; }
+    static uint32_t getBucketBound(uint8_t bucket);
+
+private:
+    boolean awaiting = false;
+    boolean armed = false;
+    unsigned long sentAt = 0;
+    heartbeatStats stats;
+};
+
+#endif // DTUHEARTBEAT_H
@@ -13,7 +13,6 @@
 #include <AsyncTCP.h>
 #endif
 
-#include <Ticker.h>
 
 #include "pb_encode.h"
 #include "pb_decode.h"
@@ -21,22 +20,35 @@
 #include "RealtimeDataNew.pb.h"
 #include "GetConfig.pb.h"
 #include "CommandPB.pb.h"
-#include "CRC16.h"
+#include "dtuCRC16.h"
 #include "dtuConst.h"
+#include "dtuFrameAssembler.h"
+#include "dtuReceiveQueue.h"
+#include "dtuRequest.h"
+#include "dtuRequestQueue.h"
+#include "dtuPollScheduler.h"
+#include "dtuPowerHistory.h"
+#include "dtuEnergyHistory.h"
+#include "dtuRealDataDecoder.h"
+#include "dtuTelemetry.h"
+#include "dtuHeartbeat.h"
+#include "dtuReconnectPolicy.h"
+#include "dtuConnectionFsm.h"
+#include "dtuTimerWheel.h"
+#include "dtuCloudPauseLearner.h"
+#include "dtuCommandTracker.h"
+#include "dtuChangeFingerprint.h"
+#include "dtuEventBus.h"
 
 #include <base/platformData.h>
+#include <base/taskScheduler.h>
+#include <base/seqlockSnapshot.h>
 #include <Config.h>
 
 #define DTU_TIME_OFFSET 28800
-#define DTU_CLOUD_UPLOAD_SECONDS 40
-
-#define DTU_STATE_OFFLINE 0
-#define DTU_STATE_CONNECTED 1
-#define DTU_STATE_CLOUD_PAUSE 2
-#define DTU_STATE_TRY_RECONNECT 3
-#define DTU_STATE_DTU_REBOOT 4
-#define DTU_STATE_CONNECT_ERROR 5
-#define DTU_STATE_STOPPED 6
+#define DTU_CLOUD_UPLOAD_SECONDS 40 // initial pause length - learned per DTU (connectionControl::cloudPauseSeconds)
+// cloud pause starts every quarter hour at minute 14/29/44/59 and second 40
+#define DTU_CLOUD_PAUSE_START_IN_QUARTER (14 * 60 + 40)
 
 #define DTU_ERROR_NO_ERROR 0
 #define DTU_ERROR_NO_TIME 1
@@ -44,28 +56,28 @@
 #define DTU_ERROR_DATA_NO_CHANGE 3
 #define DTU_ERROR_LAST_SEND 4
 
-#define DTU_TXRX_STATE_IDLE 0
-#define DTU_TXRX_STATE_WAIT_APPGETHISTPOWER 1
-#define DTU_TXRX_STATE_WAIT_REALDATANEW 2
-#define DTU_TXRX_STATE_WAIT_GETCONFIG 3
-#define DTU_TXRX_STATE_WAIT_COMMAND 4
-#define DTU_TXRX_STATE_WAIT_RESTARTDEVICE 5
-#define DTU_TXRX_STATE_ERROR 99
+// timers of the connection on the timer wheel
+#define DTU_TIMER_RECONNECT 0       // next connect attempt/ end of cloud pause
+#define DTU_TIMER_CONNECT_TIMEOUT 1 // connect attempt without any answer of the TCP stack
+#define DTU_TIMER_OFFLINE_GRACE 2   // time until a lost connection is reported as offline
+#define DTU_TIMER_CLOUD_PAUSE 3     // start of the next cloud pause window
+#define DTU_TIMER_COMMAND 4         // response/ effect of the power limit command
+
+#define DTU_CONNECT_TIMEOUT_MS 10000
+#define DTU_OFFLINE_GRACE_MS 90000
 
 
 struct connectionControl
 {
   boolean preventCloudErrors = true;
   boolean dtuActiveOffToCloudUpdate = false;
+  uint16_t cloudPauseSeconds = DTU_CLOUD_UPLOAD_SECONDS; // current length of the cloud pause window
   boolean dtuConnectionOnline = true;          // true if connection is online as valued a summary
   uint8_t dtuConnectState = DTU_STATE_OFFLINE;
   uint8_t dtuErrorState = DTU_ERROR_NO_ERROR;
   uint8_t dtuTxRxState = DTU_TXRX_STATE_IDLE;
   uint8_t dtuTxRxStateLast = DTU_TXRX_STATE_IDLE;
   unsigned long dtuTxRxStateLastChange = 0;
-  uint8_t dtuConnectRetriesShort = 0;
-  uint8_t dtuConnectRetriesLong = 0;
-  unsigned long pauseStartTime = 0;
 };
 
 struct baseData
@@ -93,7 +105,6 @@ struct inverterData
   uint32_t lastRespTimestamp = 1704063600; // init with start time stamp > 0
   uint32_t currentTimestamp = 1704063600; // init with start time stamp > 0
   boolean uptodate = false;
-  boolean updateReceived = false;
   int dtuResetRequested = 0;
 };
 
@@ -102,12 +113,22 @@ struct inverterData
 extern inverterData dtuGlobalData;
 extern connectionControl dtuConnection;
 
+// consistent copy of the data and connection block of one DTU - with all inverters/ ports/ meters
+// and the power limit command of the same version
+struct dtuSnapshot
+{
+  inverterData data;
+  connectionControl connection;
+  DTUTelemetryTable telemetry;
+  DTUCommandTracker command;
+};
+
 typedef void (*DataRetrievalCallback)(const char* data, size_t dataSize, void* userContext);
 
 
 class DTUInterface {
 public:
-    DTUInterface(const char* server, uint16_t port=10081);
+    DTUInterface(const char* server, uint16_t port=10081, inverterData *data=&dtuGlobalData, connectionControl *connection=&dtuConnection);
     ~DTUInterface();
    
     void setup(const char *server);
@@ -118,64 +139,174 @@ public:
     void flushConnection();    
 
     void getDataUpdate();
-    void setPowerLimit(int limit);
+    boolean checkDataUpdateDue();
+    void requestDataUpdateIn(uint16_t seconds);
+    uint16_t getUpdateInterval() const { return pollScheduler.getInterval(); }
+    float getPowerChangeRate() const { return pollScheduler.getPowerRate(); }
+    // returns false if the same limit is already on the way to the DTU
+    boolean setPowerLimit(int limit);
     void requestRestartDevice();
 
     String getTimeStringByTimestamp(unsigned long timestamp);
-    void printDataAsTextToSerial();
-    void printDataAsJsonToSerial();  
+    void printDataAsTextToSerial(const dtuSnapshot &dtuState);
+    void printDataAsJsonToSerial(const dtuSnapshot &dtuState);
+
+    const frameAssemblerStats &getFrameStats() const { return frameAssembler.getStats(); }
+    const receiveQueueStats &getReceiveStats() const { return rxQueue.getStats(); }
+    const requestQueueStats &getRequestQueueStats() const { return requestQueue.getStats(); }
+    requestTemplateStats getRequestTemplateStats() const;
+    const DTUPowerHistory &getPowerHistory() const { return powerHistory; }
+    const DTUEnergyHistory &getEnergyHistory() const { return energyHistory; }
+    // persist the day energy table in the given file (LittleFS has to be mounted)
+    void beginEnergyHistory(const char *filePath) { energyHistory.begin(filePath); }
+    const realDataDecodeStats &getDecodeStats() const { return decodeStats; }
+    const heartbeatStats &getHeartbeatStats() const { return heartbeat.getStats(); }
+    const reconnectStats &getReconnectStats() const { return reconnectPolicy.getStats(); }
+    const DTUConnectionFsm &getConnectionFsm() const { return connectionFsm; }
+    const DTUCloudPauseLearner &getCloudPauseLearner() const { return cloudPauseLearner; }
+    const fingerprintStats &getFingerprintStats() const { return changeFingerprint.getStats(); }
+    const inverterData &getData() const { return *dtuData; }
+    const connectionControl &getConnection() const { return *dtuConn; }
+
+    // data/ connection block, telemetry and command are only written in the loop (scheduler tasks of
+    // this DTU, the async TCP callbacks hand over to them) - other contexts and the outputs read the
+    // last published snapshot, the version changes with every publish
+    // a publish without a change since the last one returns at once - every writer marks the change
+    void publishSnapshot();
+    // data/ connection block written outside of this class (gateway, web) - published with the next
+    // tx/rx run of this DTU (max. 500 ms later); the seconds counter currentTimestamp is not a change
+    void markChanged() { snapshotDirty = true; }
+    uint32_t readSnapshot(dtuSnapshot &copy) const { return snapshot.read(copy); }
+    // data/ connection block or command only - without copying the telemetry
+    uint32_t readSnapshotData(inverterData &copy) const { return snapshot.read(&dtuSnapshot::data, copy); }
+    uint32_t readSnapshotConnection(connectionControl &copy) const { return snapshot.read(&dtuSnapshot::connection, copy); }
+    uint32_t readSnapshotCommand(DTUCommandTracker &copy) const { return snapshot.read(&dtuSnapshot::command, copy); }
+    uint32_t getSnapshotVersion() const { return snapshot.getVersion(); }
+    uint32_t getSnapshotRetries() const { return snapshot.getRetries(); }
+    // writes the changed day energy records to the file - in the loop, not in the async TCP context
+    void persistEnergyHistory();
 
 private:
-    Ticker keepAliveTimer; // Timer to send keep-alive messages
-    static void keepAliveStatic(DTUInterface* dtuInterface); // Static method for timer callback
-    void keepAlive(); // Method to send keep-alive messages
-
-    Ticker loopTimer; // local loop to handle 
-    static void dtuLoopStatic(DTUInterface* instance);
+    // periodic jobs of this DTU run on the task scheduler of the main loop
+    void addTasks();
+    uint8_t loopTask = TASK_SCHEDULER_NO_TASK;
+    uint8_t txRxTask = TASK_SCHEDULER_NO_TASK;
+    uint8_t keepAliveTask = TASK_SCHEDULER_NO_TASK;
+    uint8_t timerWheelTask = TASK_SCHEDULER_NO_TASK;
+
+    static void keepAliveStatic(void* instance); // heartbeat task - started with each connection
+    void keepAlive(); // Method to send heartbeats and close dead links
+    DTUHeartbeat heartbeat;
+
+    static void dtuLoopStatic(void* instance); // supervision every 5 s
     void dtuLoop();
+
+    // connection state machine - timeouts are scheduled on the timer wheel, one one-shot task
+    // is armed to the next deadline
+    DTUConnectionFsm connectionFsm;
+    void handleConnectionEvent(uint8_t event);
+    void setTxRxState(uint8_t state);
+    void updateOnlineState(uint8_t lastState);
+    DTUTimerWheel timerWheel;
+    void scheduleTimer(uint8_t timerId, uint32_t delayMs);
+    void armTimerWheel();
+    static void timerWheelStatic(void* instance);
+    static void onTimerStatic(void* context, uint8_t timerId);
+    void onTimer(uint8_t timerId);
+
+    // connection retries with backoff and the planned reconnect at the end of a cloud pause
+    DTUReconnectPolicy reconnectPolicy;
+    void reconnect();
+    void scheduleReconnect();
+    void armCloudPauseReconnect();
+    void scheduleCloudPause();
+    void checkCloudPause();
+    // length of the cloud pause learned from the behavior of the DTU after each pause
+    DTUCloudPauseLearner cloudPauseLearner;
+    void endCloudPause();
        
 
     static void onConnect(void* arg, AsyncClient* c);
     static void onDisconnect(void* arg, AsyncClient* c);
     static void onError(void* arg, AsyncClient* c, int8_t error);
     static void onDataReceived(void* arg, AsyncClient* client, void* data, size_t len);
+    // received bytes and connection events - all decoding and state changes in the tx/rx task
+    DTUReceiveQueue rxQueue;
+    volatile boolean rxOverflow = false;
+    void processReceived();
+    void handleReceiveEvent(const receiveEvent &event);
+    void handleFrame(const dtuFrameHeader &header, pb_istream_t &istream);
 
     void handleError(uint8_t errorState = DTU_ERROR_NO_ERROR);
-    void initializeCRC();
 
-    static void txrxStateObserver();
-    boolean lastOnlineOfflineState = false;
-    unsigned long lastOnlineOfflineChange = 0;
-    void dtuConnectionObserver();
+    DTURequestQueue requestQueue;
+    DTUPollScheduler pollScheduler;
+    DTUPowerHistory powerHistory;
+    // all inverters/ ports of this DTU - dtuData keeps the first inverter for the legacy outputs
+    DTUTelemetryTable telemetry;
+    boolean historyBackfillPending = false; // fetch the power history once after (re)connect
+    static void txRxStatic(void* instance); // handles the received data, checks request timeouts and sends waiting requests - every 500 ms and on receive
+    void processRequestQueue();
 
     void checkingDataUpdate();
     void checkingForLastDataReceived();
     boolean cloudPauseActiveControl();
         
     // Protobuf functions
-    void writeReqAppGetHistPower();
+    boolean writeReqAppGetHistPower();
     void readRespAppGetHistPower(pb_istream_t istream);
+    DTUEnergyHistory energyHistory;
 
-    void writeReqRealDataNew();
+    boolean writeReqRealDataNew();
     void readRespRealDataNew(pb_istream_t istream);
+    void convertRealData(const realDataValues &values);
+    realDataDecodeStats decodeStats;
+    void updateDecodeStats(uint32_t decodeUs, boolean decoded);
     
-    void writeReqGetConfig();
+    boolean writeReqGetConfig();
     void readRespGetConfig(pb_istream_t istream);
     
+    DTUCommandTracker commandTracker;
+    void checkCommandRetry();
     boolean writeReqCommand(uint8_t setPercent);
-    boolean readRespCommand(pb_istream_t istream);
+    boolean readRespCommand(const CommandReqDTO &commandreqdto);
     
+    boolean writeReqHeartbeat();
+
     boolean writeCommandRestartDevice();
-    boolean readRespCommandRestartDevice(pb_istream_t istream);
+    boolean readRespCommandRestartDevice(const CommandReqDTO &commandreqdto);
     
     const char* serverIP;
     uint16_t serverPort;
     AsyncClient* client;
 
-    CRC16 crc;
+    // data and connection block of this DTU - the globals for the main DTU
+    inverterData *dtuData;
+    connectionControl *dtuConn;
+    SeqlockSnapshot<dtuSnapshot> snapshot;
+    volatile boolean snapshotDirty = true; // changed since the last publish - set by all writers
+#if defined(ESP32)
+    portMUX_TYPE snapshotMux = portMUX_INITIALIZER_UNLOCKED; // publish and the pending events
+    portMUX_TYPE timerArmMux = portMUX_INITIALIZER_UNLOCKED;  // next deadline and arming of the wheel task as one step
+#endif
+    // events are collected while the data is written and posted to dtuEventBus with the next
+    // publishSnapshot() - a subscriber always reads the snapshot the event belongs to
+    void emitEvent(uint8_t type, int32_t value = 0, uint32_t originUs = 0);
+    uint8_t pendingEvents = 0; // DTU_EVENT_MASK() of the types waiting for the publish
+    int32_t pendingValues[DTU_EVENT_TYPES] = {};
+    uint32_t pendingOrigins[DTU_EVENT_TYPES] = {};
+    uint32_t sampleDecodeUs = 0; // start of the last RealDataNew decode - origin of the next new sample
+
+    DTUFrameAssembler frameAssembler{rxQueue}; // parses in place in the receive queue
+    uint8_t txBuffer[DTU_TX_BUFFER_SIZE]; // requests are encoded in place - header + payload
+    // periodic requests are sent from cached frames - only time and crc are patched
+    RealDataNewTemplate realDataNewTemplate;
+    GetConfigTemplate getConfigTemplate;
+    AppGetHistPowerTemplate appGetHistPowerTemplate;
+    HeartbeatTemplate heartbeatTemplate;
     
-    float gridVoltHist[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    uint8_t gridVoltCnt = 0;
+    // unchanged responses are neither converted nor sent to the APIs - also the hanging value observer
+    DTUChangeFingerprint changeFingerprint;
     unsigned long lastSwOff = 0;
 
     static float calcValue(int32_t value, int32_t divider = 10);
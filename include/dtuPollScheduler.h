@@ -0,0 +1,55 @@
+#ifndef DTUPOLLSCHEDULER_H
+#define DTUPOLLSCHEDULER_H
+
+#include <Arduino.h>
+
+// expected power change (W) between two polls - the interval is chosen to reach this at the current rate of change
+#define DTU_POLL_TARGET_DELTA_W 20.0f
+// seconds before a cloud pause a poll is moved to / seconds after the pause to give time for reconnect
+#define DTU_POLL_PAUSE_MARGIN_BEFORE 3
+#define DTU_POLL_PAUSE_MARGIN_AFTER 10
+// default min. interval (s) of the adaptive poll - the DTU handles about one request per 31 s, shorter at own risk
+#define DTU_POLL_MIN_INTERVAL 31
+
+struct connectionControl;
+
+/**
+ * Plans the next data request to the DTU. With adaptive polling active, the interval follows the
+ * rate of change of grid and PV port power - short while the power is moving (e.g. passing clouds),
+ * growing step by step up to the max interval while it is stable.
+ * Polls that would fall into a cloud pause window are moved in front of or behind the window.
+ */
+class DTUPollScheduler {
+public:
+    // connection block of the DTU - its cloud pause setting decides if polls are moved
+    void setConnectionControl(const connectionControl *connection) { this->connection = connection; }
+
+    // new measurement from RealDataNew (power values in W, timestamp of the DTU)
+    void addSample(uint32_t timestamp, float gridPower, float pvPower0, float pvPower1);
+
+    // true if next poll is due - plans the poll after the due one
+    boolean checkPollDue(uint32_t now);
+    // request a poll in given seconds (e.g. after connect or new power limit)
+    void pollIn(uint32_t now, uint16_t seconds);
+
+    uint16_t getInterval() const { return interval; }
+    uint32_t getNextPoll() const { return nextPoll; }
+    float getPowerRate() const { return powerRate; }
+
+private:
+    const connectionControl *connection = nullptr;
+    uint16_t interval = 31;
+    uint32_t lastPoll = 0;
+    uint32_t nextPoll = 0;
+
+    uint32_t lastSampleTime = 0;
+    float lastGridPower = 0;
+    float lastPvPower0 = 0;
+    float lastPvPower1 = 0;
+    float powerRate = 0; // smoothed max. rate of change of all power values in W/s
+
+    void updateInterval();
+    uint32_t planAroundCloudPause(uint32_t plannedPoll);
+};
+
+#endif // DTUPOLLSCHEDULER_H
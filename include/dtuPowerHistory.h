@@ -0,0 +1,53 @@
+#ifndef DTUPOWERHISTORY_H
+#define DTUPOWERHISTORY_H
+
+#include <Arduino.h>
+#include <base/seqlockSnapshot.h>
+
+#define DTU_HISTORY_SLOT_SECONDS 300 // 5 min - resolution of the power curve
+#define DTU_HISTORY_SLOTS 288        // 24 h
+
+struct powerHistoryStats
+{
+  uint32_t liveSamples = 0;
+  uint32_t backfillRuns = 0;
+  uint32_t backfilledSlots = 0; // empty slots filled from the DTU history
+  uint32_t lastBackfill = 0;    // timestamp of the last merged history
+};
+
+/**
+ * Intraday power curve of the inverter with a fixed time grid of DTU_HISTORY_SLOT_SECONDS.
+ * Each slot is tagged with its slot number (timestamp / slot seconds), so a slot of an old day
+ * is recognized as empty and live and history data can be merged in any order.
+ * Live samples (RealDataNew) are averaged per slot, the power_array of AppGetHistPower only fills
+ * slots without live data - e.g. after a reconnect, a cloud pause or the night.
+ */
+class DTUPowerHistory {
+public:
+    DTUPowerHistory();
+
+    void addLiveSample(uint32_t timestamp, float power);
+    // merge the history from the DTU (power in 1/divider W) - returns the number of filled slots
+    uint16_t mergeHistory(uint32_t startTime, uint32_t stepTime, const int32_t *powerArray, size_t count, int32_t divider = 10);
+
+    // slots are numbered from 0 (oldest) to DTU_HISTORY_SLOTS - 1 (newest) - false if slot is empty
+    boolean getSample(uint16_t index, uint32_t &timestamp, float &power) const;
+
+    const powerHistoryStats &getStats() const { return stats; }
+
+    // written in the loop - readers in other contexts (web) check their read with the version
+    const SeqlockVersion &getVersion() const { return version; }
+
+private:
+    uint32_t slotNumber[DTU_HISTORY_SLOTS]; // 0 - slot empty
+    uint16_t slotPower[DTU_HISTORY_SLOTS];  // 0.1 W
+    uint8_t slotLiveCount[DTU_HISTORY_SLOTS]; // 0 - value from history
+    uint32_t newestSlot = 0;
+
+    powerHistoryStats stats;
+    SeqlockVersion version;
+
+    static uint16_t toSlotPower(float power);
+};
+
+#endif // DTUPOWERHISTORY_H
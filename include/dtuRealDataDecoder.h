@@ -0,0 +1,99 @@
+#ifndef DTUREALDATADECODER_H
+#define DTUREALDATADECODER_H
+
+#include <Arduino.h>
+
+#include "pb_decode.h"
+#include "RealtimeDataNew.pb.h"
+#include "dtuTelemetry.h"
+#include "dtuChangeFingerprint.h"
+
+// pv ports used by the telemetry model
+#define DTU_REALDATA_PV_PORTS 2
+
+struct realDataGrid
+{
+  uint64_t serial = 0;
+  uint8_t phases = DTU_INVERTER_SINGLE_PHASE;
+  int32_t voltage = 0; // phase A for TGSMO
+  int32_t frequency = 0;
+  int32_t activePower = 0;
+  int32_t current = 0; // sum of all phases for TGSMO
+  int32_t temperature = 0;
+  int32_t powerLimit = 0;
+};
+
+struct realDataPv
+{
+  uint64_t serial = 0;
+  int32_t port = 0;
+  int32_t voltage = 0;
+  int32_t current = 0;
+  int32_t power = 0;
+  int32_t energyTotal = 0;
+  int32_t energyDaily = 0;
+};
+
+struct realDataMeter
+{
+  uint64_t serial = 0;
+  int32_t deviceType = 0;
+  int32_t totalPower = 0;
+  int32_t phasePower[DTU_TELEMETRY_METER_PHASES] = {0};
+  int32_t phaseVoltage[DTU_TELEMETRY_METER_PHASES] = {0};
+  int32_t phaseCurrent[DTU_TELEMETRY_METER_PHASES] = {0};
+  int32_t powerFactor = 0;
+  int32_t energyExport = 0;
+  int32_t energyImport = 0;
+  int32_t faultCode = 0;
+};
+
+struct realDataValues
+{
+  int32_t timestamp = 0;
+  uint32_t fingerprint = DTU_FINGERPRINT_OFFSET; // hash over all decoded entries - without the timestamp
+  uint8_t gridCount = 0; // only the first SGSMO is kept
+  realDataGrid grid;
+  uint8_t pvCount = 0;
+  realDataPv pv[DTU_REALDATA_PV_PORTS];
+};
+
+struct realDataDecodeStats
+{
+  uint32_t decodes = 0;
+  uint32_t errors = 0;
+  uint32_t lastDecodeUs = 0;
+  uint32_t maxDecodeUs = 0;
+  uint32_t minLoopStackFree = 0; // lowest free stack (bytes) of the loop task seen after a decode - ESP32 only
+  uint32_t histPowerErrors = 0;  // AppGetHistPower responses that could not be decoded - not merged
+};
+
+/**
+ * Streaming decode of RealDataNewReqDTO. The fields are walked tag by tag on the payload stream,
+ * only the values used by the telemetry model are kept and everything else - meter/ rp/ rsd data -
+ * is skipped without being copied. Needs a few dozen bytes of stack instead of the full generated struct.
+ * The first SGSMO and PvMOs are returned in values, every SGSMO/ TGSMO/ PvMO/ MeterMO entry is written to
+ * the telemetry table (if given) - the number of entries is only limited by the budget of the table.
+ * All decoded entries are added to the fingerprint of values in order of appearance - with or without
+ * a table, so a first pass without it tells if the table needs an update at all.
+ */
+class DTURealDataDecoder {
+public:
+    static boolean decode(pb_istream_t &stream, realDataValues &values, DTUTelemetryTable *table = nullptr);
+
+private:
+    static boolean decodeGrid(pb_istream_t &stream, realDataGrid &grid);
+    static boolean decodeThreePhaseGrid(pb_istream_t &stream, realDataGrid &grid);
+    static boolean decodePv(pb_istream_t &stream, realDataPv &pv);
+    static boolean decodeMeter(pb_istream_t &stream, realDataMeter &meter);
+    static boolean decodeSerial(pb_istream_t &stream, pb_wire_type_t wireType, uint64_t &serial);
+    static boolean decodeInt32(pb_istream_t &stream, pb_wire_type_t wireType, int32_t &value);
+    static uint32_t fingerprint(uint32_t hash, const realDataGrid &grid);
+    static uint32_t fingerprint(uint32_t hash, const realDataPv &pv);
+    static uint32_t fingerprint(uint32_t hash, const realDataMeter &meter);
+    static void updateTelemetry(DTUTelemetryTable &table, const realDataGrid &grid, uint32_t timestamp);
+    static void updateTelemetry(DTUTelemetryTable &table, const realDataPv &pv, uint32_t timestamp);
+    static void updateTelemetry(DTUTelemetryTable &table, const realDataMeter &meter, uint32_t timestamp);
+};
+
+#endif // DTUREALDATADECODER_H
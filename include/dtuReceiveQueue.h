@@ -0,0 +1,89 @@
+#ifndef DTURECEIVEQUEUE_H
+#define DTURECEIVEQUEUE_H
+
+#include <Arduino.h>
+
+// received bytes waiting for the loop - the RealDataNew and GetConfig response of a poll
+// (max. frame length see dtuFrameAssembler.h), the frames are parsed in place
+#if defined(ESP8266)
+#define DTU_RX_BUFFER_SIZE 2560
+#else
+#define DTU_RX_BUFFER_SIZE 4096
+#endif
+#define DTU_RX_EVENT_QUEUE_SIZE 8
+
+// connection events of the async TCP client
+#define DTU_RX_EV_CONNECTED 0
+#define DTU_RX_EV_DISCONNECTED 1
+#define DTU_RX_EV_ERROR 2
+
+struct receiveQueueStats
+{
+  uint32_t bytes = 0;        // received bytes handed over to the loop
+  uint32_t droppedBytes = 0; // buffer full - the frame assembler resyncs on the next header
+  uint32_t events = 0;
+  uint32_t droppedEvents = 0;
+  uint16_t maxFill = 0;
+};
+
+struct receiveEvent
+{
+  uint8_t type = DTU_RX_EV_CONNECTED;
+  int8_t error = 0;
+  uint32_t streamPos = 0; // bytes received before the event
+};
+
+/**
+ * Handover of the async TCP client callbacks to the loop. The callbacks only append the received
+ * bytes to a ring buffer and queue the connection events, the loop takes both in the order they
+ * happened (each event carries the stream position it arrived at) and does all decoding and state
+ * changes - the data of a DTU is written in one context only. Any context may put, only the loop takes.
+ * The frame assembler parses the frames in place in the ring, bytes are consumed after decoding.
+ * On ESP32 the ring and the event queue are guarded by a critical section. Bytes below the fill level
+ * are only touched by the loop, so they are read without the lock.
+ */
+class DTUReceiveQueue {
+public:
+    // TCP callback side - returns the bytes taken, the rest is dropped (counted)
+    size_t putData(const uint8_t *data, size_t len);
+    void putEvent(uint8_t type, int8_t error = 0);
+
+    // loop side - next event if its stream position is reached, else false
+    boolean takeEvent(receiveEvent &event);
+    // stream position the loop reads up to - all bytes received so far or the position of the next
+    // event, returns true in the latter case
+    boolean getStreamPos(uint32_t &pos) const;
+    // bytes from the read position up to the stream position limit
+    size_t available(uint32_t limit) const;
+    // byte at offset from the read position - offset below available()
+    uint8_t peekByte(size_t offset) const { return buffer[(head + offset) % DTU_RX_BUFFER_SIZE]; }
+    // contiguous bytes at offset from the read position, max. len - less at the end of the ring
+    // valid until consume(), the bytes have to be available()
+    size_t peek(size_t offset, size_t len, const uint8_t *&data) const;
+    void consume(size_t len);
+    // position of the loop in the stream
+    uint32_t getReadPos() const { return readPos; }
+
+    // drops all waiting bytes and events
+    void clear();
+
+    const receiveQueueStats &getStats() const { return stats; }
+
+private:
+    uint8_t buffer[DTU_RX_BUFFER_SIZE];
+    uint16_t head = 0; // next byte to read
+    uint16_t fill = 0;
+    uint32_t writePos = 0; // bytes put since start - stream position of the next byte
+    uint32_t readPos = 0;
+
+    receiveEvent events[DTU_RX_EVENT_QUEUE_SIZE];
+    uint8_t eventHead = 0;
+    uint8_t eventCount = 0;
+
+    receiveQueueStats stats;
+#if defined(ESP32)
+    mutable portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED; // put in the async TCP task, taken in the loop
+#endif
+};
+
+#endif // DTURECEIVEQUEUE_H
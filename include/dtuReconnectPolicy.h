@@ -0,0 +1,48 @@
+#ifndef DTURECONNECTPOLICY_H
+#define DTURECONNECTPOLICY_H
+
+#include <Arduino.h>
+
+// delay before the first retry after a lost connection - doubled with every failed attempt
+#define DTU_RECONNECT_BASE_DELAY_MS 1000
+
+struct reconnectStats
+{
+  uint32_t attempts = 0;
+  uint32_t connects = 0;
+  uint8_t lastAttempts = 0;   // attempts needed for the last successful connect
+  uint8_t maxAttempts = 0;
+  uint32_t lastConnectMs = 0; // connect() until TCP connection is established
+  uint32_t maxConnectMs = 0;
+  uint32_t lastOutageMs = 0;  // first attempt after a loss until connected again
+  uint32_t maxOutageMs = 0;
+  uint32_t currentDelayMs = 0;
+};
+
+/**
+ * Retry timing for the DTU connection. The delay between two attempts grows exponentially up to
+ * the configured cap, with a random part (equal jitter - half fixed, half random) so several
+ * gateways/ DTU connections losing the link at the same time do not retry in lockstep.
+ * A successful connect starts the sequence over with the base delay.
+ */
+class DTUReconnectPolicy {
+public:
+    // delay (ms) until the next attempt - counts up the backoff step
+    uint32_t nextDelay(uint32_t maxDelayMs);
+    // forget the backoff - e.g. planned reconnect after a cloud pause
+    void reset();
+
+    void attemptStarted(unsigned long now);
+    void connected(unsigned long now);
+
+    const reconnectStats &getStats() const { return stats; }
+
+private:
+    uint8_t backoffStep = 0;
+    uint8_t attemptsSinceConnect = 0;
+    unsigned long firstAttemptAt = 0;
+    unsigned long lastAttemptAt = 0;
+    reconnectStats stats;
+};
+
+#endif // DTURECONNECTPOLICY_H
@@ -0,0 +1,169 @@
+#ifndef DTUREQUEST_H
+#define DTUREQUEST_H
+
+#include <Arduino.h>
+
+#include "pb_encode.h"
+#include "pb_decode.h"
+#include "AppGetHistPower.pb.h"
+#include "APPHeartbeatPB.pb.h"
+#include "RealtimeDataNew.pb.h"
+#include "GetConfig.pb.h"
+#include "CommandPB.pb.h"
+#include "dtuConst.h"
+#include "dtuCRC16.h"
+#include "dtuFrameAssembler.h"
+
+// header + max. encoded request payload
+#define DTU_TX_BUFFER_SIZE (DTU_FRAME_HEADER_SIZE + 200)
+
+/**
+ * Encoder for one DTU request type. The protobuf message is encoded directly behind the
+ * header into the given tx buffer and the header is filled in place afterwards - the
+ * buffer can be handed to the client as it is.
+ */
+template <typename MsgType, uint8_t CmdHigh, uint8_t CmdLow>
+class DtuRequest {
+public:
+    // returns the total frame length or 0 if the message could not be encoded
+    static size_t encode(const MsgType &message, uint8_t *txBuffer, size_t bufferSize)
+    {
+        pb_ostream_t stream = pb_ostream_from_buffer(txBuffer + DTU_FRAME_HEADER_SIZE, bufferSize - DTU_FRAME_HEADER_SIZE);
+        if (!pb_encode(&stream, nanopb::MessageDescriptor<MsgType>::fields(), &message))
+            return 0;
+
+        size_t frameLen = DTU_FRAME_HEADER_SIZE + stream.bytes_written;
+        uint16_t crc16 = DTUCRC16::calc(txBuffer + DTU_FRAME_HEADER_SIZE, stream.bytes_written);
+
+        txBuffer[0] = 0x48; // 'H'
+        txBuffer[1] = 0x4d; // 'M'
+        txBuffer[2] = CmdHigh;
+        txBuffer[3] = CmdLow;
+        txBuffer[4] = 0x00;
+        txBuffer[5] = 0x01;
+        txBuffer[6] = (crc16 >> 8) & 0xFF;
+        txBuffer[7] = crc16 & 0xFF;
+        txBuffer[8] = (frameLen >> 8) & 0xFF;
+        txBuffer[9] = frameLen & 0xFF;
+        return frameLen;
+    }
+};
+
+// max. frame size of a cached request - the periodic requests are only a few bytes
+#define DTU_REQUEST_TEMPLATE_SIZE (DTU_FRAME_HEADER_SIZE + 32)
+
+struct requestTemplateStats
+{
+  uint32_t patched = 0; // sent from the cached frame - only time varint and crc written
+  uint32_t encoded = 0; // full encode (first request, varint length changed)
+};
+
+/**
+ * Cached frame of a request that only differs by its time field from send to send (RealDataNew,
+ * GetConfig, AppGetHistPower, heartbeat). The first request is encoded as usual and the position
+ * of the time varint is looked up in the payload. Following requests copy the cached frame, write
+ * the new time over the old varint and continue the CRC from the stored CRC of the bytes in front
+ * of it - pb_encode and the CRC over the complete payload are skipped.
+ * All other fields of the message have to stay the same - call invalidate() if they change. If the
+ * new time needs a varint of another length the frame is encoded again.
+ */
+template <typename MsgType, uint8_t CmdHigh, uint8_t CmdLow, uint32_t TimeTag>
+class DtuRequestTemplate {
+public:
+    // message is only encoded if the cached frame can not be used - time has to be set in it as well
+    size_t encode(const MsgType &message, uint32_t time, uint8_t *txBuffer, size_t bufferSize)
+    {
+        if (frameLen > 0 && frameLen <= bufferSize && varintLength(time) == timeLen)
+        {
+            memcpy(txBuffer, frame, frameLen);
+            uint8_t *payload = txBuffer + DTU_FRAME_HEADER_SIZE;
+            writeVarint(payload + timeStart, time);
+            uint16_t crc16 = DTUCRC16::calc(payload + timeStart, frameLen - DTU_FRAME_HEADER_SIZE - timeStart, crcPrefix);
+            txBuffer[6] = (crc16 >> 8) & 0xFF;
+            txBuffer[7] = crc16 & 0xFF;
+            stats.patched++;
+            return frameLen;
+        }
+
+        size_t len = DtuRequest<MsgType, CmdHigh, CmdLow>::encode(message, txBuffer, bufferSize);
+        stats.encoded++;
+        frameLen = 0;
+        if (len > 0 && len <= DTU_REQUEST_TEMPLATE_SIZE && findTime(txBuffer + DTU_FRAME_HEADER_SIZE, len - DTU_FRAME_HEADER_SIZE))
+        {
+            memcpy(frame, txBuffer, len);
+            crcPrefix = DTUCRC16::calc(frame + DTU_FRAME_HEADER_SIZE, timeStart);
+            frameLen = len;
+        }
+        return len;
+    }
+
+    void invalidate() { frameLen = 0; }
+    const requestTemplateStats &getStats() const { return stats; }
+
+private:
+    uint8_t frame[DTU_REQUEST_TEMPLATE_SIZE];
+    size_t frameLen = 0;   // 0 - no valid frame cached
+    size_t timeStart = 0;  // offset of the time varint in the payload
+    uint8_t timeLen = 0;
+    uint16_t crcPrefix = DTU_CRC16_INITIAL; // crc of the payload bytes in front of the time varint
+    requestTemplateStats stats;
+
+    // walks the encoded payload to the time field - false if it is not there (e.g. time 0 is not encoded)
+    boolean findTime(const uint8_t *payload, size_t len)
+    {
+        pb_istream_t stream = pb_istream_from_buffer(payload, len);
+        pb_wire_type_t wireType;
+        uint32_t tag;
+        bool eof;
+        while (pb_decode_tag(&stream, &wireType, &tag, &eof))
+        {
+            if (tag == TimeTag && wireType == PB_WT_VARINT)
+            {
+                timeStart = len - stream.bytes_left;
+                uint64_t value;
+                if (!pb_decode_varint(&stream, &value))
+                    return false;
+                timeLen = uint8_t(len - stream.bytes_left - timeStart);
+                return true;
+            }
+            if (!pb_skip_field(&stream, wireType))
+                return false;
+        }
+        return false;
+    }
+
+    static uint8_t varintLength(uint32_t value)
+    {
+        uint8_t len = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            len++;
+        }
+        return len;
+    }
+
+    static void writeVarint(uint8_t *buffer, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            *buffer++ = uint8_t(value | 0x80);
+            value >>= 7;
+        }
+        *buffer = uint8_t(value);
+    }
+};
+
+typedef DtuRequest<RealDataNewResDTO, CMD_REAL_RES_DTO[0], CMD_REAL_RES_DTO[1]> RealDataNewRequest;
+typedef DtuRequest<AppGetHistPowerResDTO, CMD_APP_GET_HIST_POWER_RES[0], CMD_APP_GET_HIST_POWER_RES[1]> AppGetHistPowerRequest;
+typedef DtuRequest<GetConfigResDTO, CMD_GET_CONFIG[0], CMD_GET_CONFIG[1]> GetConfigRequest;
+typedef DtuRequest<CommandResDTO, CMD_COMMAND_RES_DTO[0], CMD_COMMAND_RES_DTO[1]> CommandRequest;
+typedef DtuRequest<CommandResDTO, CMD_CLOUD_COMMAND_RES_DTO[0], CMD_CLOUD_COMMAND_RES_DTO[1]> RestartDeviceRequest;
+typedef DtuRequest<HBResDTO, CMD_HB_RES_DTO[0], CMD_HB_RES_DTO[1]> HeartbeatRequest;
+
+typedef DtuRequestTemplate<RealDataNewResDTO, CMD_REAL_RES_DTO[0], CMD_REAL_RES_DTO[1], RealDataNewResDTO_time_tag> RealDataNewTemplate;
+typedef DtuRequestTemplate<AppGetHistPowerResDTO, CMD_APP_GET_HIST_POWER_RES[0], CMD_APP_GET_HIST_POWER_RES[1], AppGetHistPowerResDTO_requested_time_tag> AppGetHistPowerTemplate;
+typedef DtuRequestTemplate<GetConfigResDTO, CMD_GET_CONFIG[0], CMD_GET_CONFIG[1], GetConfigResDTO_time_tag> GetConfigTemplate;
+typedef DtuRequestTemplate<HBResDTO, CMD_HB_RES_DTO[0], CMD_HB_RES_DTO[1], HBResDTO_time_tag> HeartbeatTemplate;
+
+#endif // DTUREQUEST_H
@@ -0,0 +1,93 @@
+#ifndef DTUREQUESTQUEUE_H
+#define DTUREQUESTQUEUE_H
+
+#include <Arduino.h>
+
+// request types - index into the queue
+#define DTU_REQ_NONE 0
+#define DTU_REQ_REALDATANEW 1
+#define DTU_REQ_GETCONFIG 2
+#define DTU_REQ_APPGETHISTPOWER 3
+#define DTU_REQ_COMMAND 4
+#define DTU_REQ_RESTARTDEVICE 5
+#define DTU_REQ_HEARTBEAT 6
+#define DTU_REQ_COUNT 7
+
+// max. number of requests on the wire at the same time - responses are routed by command id
+#define DTU_REQ_PIPELINE_DEPTH 2
+
+struct queuedRequest
+{
+  boolean pending = false;
+  uint8_t param = 0;            // e.g. power limit in percent for DTU_REQ_COMMAND
+  unsigned long enqueuedAt = 0; // millis
+};
+
+struct requestQueueStats
+{
+  uint8_t depth = 0;
+  uint8_t maxDepth = 0;
+  uint32_t enqueued = 0;
+  uint32_t coalesced = 0; // request of same type was already queued
+  uint32_t sent = 0;
+  uint32_t timeouts = 0;
+  uint32_t unsolicited = 0; // responses without a matching request on the wire
+  uint32_t lastWaitMs = 0;
+  uint32_t maxWaitMs = 0;
+  uint32_t sumWaitMs = 0; // with sent -> average wait time
+  uint32_t lastPollCycleMs = 0; // RealDataNew + GetConfig from request until both responses are handled
+  uint32_t maxPollCycleMs = 0;
+};
+
+/**
+ * Priority queue for DTU requests with one slot per request type. A request of a type that is
+ * already waiting is coalesced into the waiting one (newest parameter wins), so the queue can
+ * never grow beyond DTU_REQ_COUNT entries. Up to DTU_REQ_PIPELINE_DEPTH requests are on the wire
+ * at the same time, each one tracked with its own timeout - a request of a type that is still on the
+ * wire waits until its response arrived or timed out.
+ * Requests are taken, sent and finished in the loop context (the async TCP callbacks only arm the
+ * tx/rx task) - on ESP32 the slots are guarded by a critical section for callers in other tasks.
+ */
+class DTURequestQueue {
+public:
+    // returns false if a request of this type was already queued (coalesced)
+    boolean enqueue(uint8_t type, uint8_t param = 0);
+    // takes the waiting request with the highest priority that is not on the wire yet - returns DTU_REQ_NONE if there is none
+    uint8_t next(uint8_t &param);
+    void clear();
+
+    void startRequest(uint8_t type);
+    // returns false if no request of this type was on the wire
+    boolean finishRequest(uint8_t type);
+    // true if a request on the wire is waiting longer than its timeout - request is dropped then
+    boolean checkTimeout();
+    boolean isActive(uint8_t type) const { return type < DTU_REQ_COUNT && active[type]; }
+    uint8_t getActiveCount() const;
+    void countUnsolicited() { stats.unsolicited++; }
+
+    // poll cycle time measurement - started with the RealDataNew/ GetConfig pair
+    void startPollCycle();
+
+    uint8_t getDepth() const;
+    const requestQueueStats &getStats() const { return stats; }
+
+    static uint16_t getTimeout(uint8_t type);
+    static const char *getName(uint8_t type);
+
+private:
+    queuedRequest requests[DTU_REQ_COUNT];
+
+    boolean active[DTU_REQ_COUNT] = {false};
+    unsigned long activeSince[DTU_REQ_COUNT] = {0};
+
+    boolean pollCycleRunning = false;
+    unsigned long pollCycleStart = 0;
+    void checkPollCycle();
+
+    requestQueueStats stats;
+#if defined(ESP32)
+    portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+#endif // DTUREQUESTQUEUE_H
@@ -0,0 +1,59 @@
+#ifndef DTUSITE_H
+#define DTUSITE_H
+
+#include <Arduino.h>
+#include "dtuInterface.h"
+
+// max. number of DTUs per gateway incl. the main DTU - every DTU needs ~4 kB for buffers and its connection
+#if defined(ESP32)
+#define DTU_SITE_MAX_DTUS 8
+#else
+#define DTU_SITE_MAX_DTUS 2
+#endif
+#define DTU_SITE_HOST_LENGTH 64
+
+struct siteTotals
+{
+  float power = 0;
+  float dailyEnergy = 0;
+  float totalEnergy = 0;
+  uint8_t dtuCount = 0;
+  uint8_t dtusOnline = 0;
+};
+
+/**
+ * Additional DTUs of the site besides the main DTU (dtuInterface with dtuGlobalData/ dtuConnection).
+ * Every DTU runs with its own async connection, request queue, poll and cloud pause schedule
+ * and its own data block. Index 0 is always the main DTU, 1 ... getCount() - 1 the additional ones.
+ */
+class DTUSite {
+public:
+    // comma separated list of the additional DTU hosts
+    void setup(const char *hosts);
+    // 1 s tick for the local clock of the additional DTUs and their poll schedule
+    void tick();
+
+    uint8_t getCount() const { return count + 1; }
+    const char *getHost(uint8_t index) const;
+    // consistent copy of the data/ connection block of the given DTU - returns its version
+    uint32_t readSnapshotData(uint8_t index, inverterData &copy) const;
+    uint32_t readSnapshotConnection(uint8_t index, connectionControl &copy) const;
+    const requestQueueStats &getRequestQueueStats(uint8_t index) const;
+    uint16_t getUpdateInterval(uint8_t index) const;
+    // index of the DTU that posted an event (dtuEvent::source) - -1 if not part of the site
+    int8_t getIndex(const DTUInterface *source) const;
+
+    siteTotals getTotals() const;
+
+private:
+    uint8_t count = 0;
+    char hosts[DTU_SITE_MAX_DTUS - 1][DTU_SITE_HOST_LENGTH];
+    inverterData data[DTU_SITE_MAX_DTUS - 1];
+    connectionControl connection[DTU_SITE_MAX_DTUS - 1];
+    DTUInterface *dtus[DTU_SITE_MAX_DTUS - 1];
+    const DTUInterface &getDtu(uint8_t index) const;
+};
+
+extern DTUSite dtuSite;
+
+#endif // DTUSITE_H
@@ -0,0 +1,136 @@
+#ifndef DTUTELEMETRY_H
+#define DTUTELEMETRY_H
+
+#include <Arduino.h>
+
+// fixed memory budget - inverters per DTU (DTU-Pro) and max. ports per inverter (HMS-xxxx-4T)
+// also the budget of the receive buffer - a RealDataNew frame with more entries can not be received
+#if defined(ESP8266)
+#define DTU_TELEMETRY_MAX_INVERTERS 4
+#else
+#define DTU_TELEMETRY_MAX_INVERTERS 8
+#endif
+#define DTU_TELEMETRY_PORTS_PER_INVERTER 4
+#define DTU_TELEMETRY_MAX_PORTS (DTU_TELEMETRY_MAX_INVERTERS * DTU_TELEMETRY_PORTS_PER_INVERTER)
+#define DTU_TELEMETRY_NO_INDEX 0xFF
+// energy meters attached to the DTU (e.g. DDSU666/ DTSU666)
+#define DTU_TELEMETRY_MAX_METERS 2
+#define DTU_TELEMETRY_METER_PHASES 3
+
+#define DTU_INVERTER_SINGLE_PHASE 1 // values from SGSMO
+#define DTU_INVERTER_THREE_PHASE 3  // values from TGSMO
+
+// one SGSMO/ TGSMO entry - values already scaled (V, A, W, Hz, °C, %)
+struct telemetryInverterValues
+{
+  uint64_t serial = 0;
+  uint8_t phases = DTU_INVERTER_SINGLE_PHASE;
+  float voltage = 0; // phase A for three phase inverters
+  float current = 0; // sum of all phases
+  float power = 0;
+  float frequency = 0;
+  float temperature = 0;
+  float powerLimit = 0; // % - sent in 0.1 % like the GetConfig limit
+};
+
+// one PvMO entry - values already scaled (V, A, W, kWh)
+struct telemetryPortValues
+{
+  uint64_t serial = 0;
+  uint8_t port = 0; // 1 ... DTU_TELEMETRY_PORTS_PER_INVERTER
+  float voltage = 0;
+  float current = 0;
+  float power = 0;
+  float energyDaily = 0;
+  float energyTotal = 0;
+};
+
+// one MeterMO entry - values already scaled (W, V, A, kWh)
+struct telemetryMeterValues
+{
+  uint64_t serial = 0;
+  int32_t deviceType = 0;
+  float power = 0; // sum of all phases - positive: import from grid (as sent by the meter)
+  float phasePower[DTU_TELEMETRY_METER_PHASES] = {0};
+  float phaseVoltage[DTU_TELEMETRY_METER_PHASES] = {0};
+  float phaseCurrent[DTU_TELEMETRY_METER_PHASES] = {0};
+  float powerFactor = 0;
+  float energyExport = 0; // energy_total_power - fed into the grid
+  float energyImport = 0; // energy_total_consumed - taken from the grid
+  int32_t faultCode = 0;
+};
+
+/**
+ * Telemetry of all inverters and pv ports seen in the RealDataNew responses of one DTU, kept as
+ * structure of arrays - outputs iterating one value (e.g. power of all ports) read one contiguous
+ * array. Inverters are found by their serial with a small open addressing hash, the ports of an
+ * inverter have fixed slots (inverter index * ports per inverter + port - 1), so every lookup is O(1).
+ * Inverter/ port indices are handed out in order of appearance and stay stable until reset().
+ * Meters attached to the DTU are kept in their own (small) columns, found by a linear search.
+ */
+class DTUTelemetryTable {
+public:
+    DTUTelemetryTable();
+    void reset();
+
+    // returns false if the memory budget is exhausted or the port number is out of range
+    boolean updateInverter(const telemetryInverterValues &values, uint32_t timestamp);
+    boolean updatePort(const telemetryPortValues &values, uint32_t timestamp);
+    boolean updateMeter(const telemetryMeterValues &values, uint32_t timestamp);
+
+    uint8_t findInverter(uint64_t serial) const;
+    uint8_t getInverterCount() const { return inverterCount; }
+    uint8_t getMeterCount() const { return meterCount; }
+    // port slot of an inverter index (0 based port) - DTU_TELEMETRY_NO_INDEX if port was never seen
+    uint8_t getPortIndex(uint8_t inverter, uint8_t port) const;
+    uint32_t getDroppedEntries() const { return droppedEntries; }
+
+    // serial as printed on the inverter (12 hex digits)
+    static String serialToString(uint64_t serial);
+
+    // inverter columns
+    uint64_t inverterSerial[DTU_TELEMETRY_MAX_INVERTERS];
+    uint8_t inverterPhases[DTU_TELEMETRY_MAX_INVERTERS];
+    float inverterVoltage[DTU_TELEMETRY_MAX_INVERTERS];
+    float inverterCurrent[DTU_TELEMETRY_MAX_INVERTERS];
+    float inverterPower[DTU_TELEMETRY_MAX_INVERTERS];
+    float inverterFrequency[DTU_TELEMETRY_MAX_INVERTERS];
+    float inverterTemperature[DTU_TELEMETRY_MAX_INVERTERS];
+    float inverterPowerLimit[DTU_TELEMETRY_MAX_INVERTERS];
+    uint32_t inverterLastUpdate[DTU_TELEMETRY_MAX_INVERTERS];
+
+    // port columns - slot = inverter index * ports per inverter + port - 1
+    float portVoltage[DTU_TELEMETRY_MAX_PORTS];
+    float portCurrent[DTU_TELEMETRY_MAX_PORTS];
+    float portPower[DTU_TELEMETRY_MAX_PORTS];
+    float portEnergyDaily[DTU_TELEMETRY_MAX_PORTS];
+    float portEnergyTotal[DTU_TELEMETRY_MAX_PORTS];
+    uint32_t portLastUpdate[DTU_TELEMETRY_MAX_PORTS]; // 0 - port never seen
+
+    // meter columns - phase values at meter index * phases + phase
+    uint64_t meterSerial[DTU_TELEMETRY_MAX_METERS];
+    int32_t meterDeviceType[DTU_TELEMETRY_MAX_METERS];
+    float meterPower[DTU_TELEMETRY_MAX_METERS];
+    float meterPhasePower[DTU_TELEMETRY_MAX_METERS * DTU_TELEMETRY_METER_PHASES];
+    float meterPhaseVoltage[DTU_TELEMETRY_MAX_METERS * DTU_TELEMETRY_METER_PHASES];
+    float meterPhaseCurrent[DTU_TELEMETRY_MAX_METERS * DTU_TELEMETRY_METER_PHASES];
+    float meterPowerFactor[DTU_TELEMETRY_MAX_METERS];
+    float meterEnergyExport[DTU_TELEMETRY_MAX_METERS];
+    float meterEnergyImport[DTU_TELEMETRY_MAX_METERS];
+    int32_t meterFaultCode[DTU_TELEMETRY_MAX_METERS];
+    uint32_t meterLastUpdate[DTU_TELEMETRY_MAX_METERS];
+
+    // millis() of the last decoded RealDataNew response - local receive time of the values above
+    uint32_t receivedMillis;
+
+private:
+    uint8_t inverterCount = 0;
+    uint8_t meterCount = 0;
+    uint8_t serialHash[DTU_TELEMETRY_MAX_INVERTERS * 2]; // inverter index per bucket
+    uint32_t droppedEntries = 0;
+
+    uint8_t addInverter(uint64_t serial);
+    static uint8_t hashBucket(uint64_t serial);
+};
+
+#endif // DTUTELEMETRY_H
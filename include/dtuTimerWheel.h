@@ -0,0 +1,63 @@
+#ifndef DTUTIMERWHEEL_H
+#define DTUTIMERWHEEL_H
+
+#include <Arduino.h>
+
+// fixed set of timers (ids 0 ... DTU_TIMER_WHEEL_MAX_TIMERS - 1) - one pending deadline per id
+#define DTU_TIMER_WHEEL_MAX_TIMERS 8
+// 16 slots of 256 ms - one revolution covers about 4 s, longer timers stay in their slot for more revolutions
+#define DTU_TIMER_WHEEL_SLOTS 16
+#define DTU_TIMER_WHEEL_SLOT_SHIFT 8
+#define DTU_TIMER_WHEEL_NONE 0xFF
+#define DTU_TIMER_WHEEL_NO_DEADLINE 0xFFFFFFFF
+
+typedef void (*TimerWheelCallback)(void *context, uint8_t timerId);
+
+/**
+ * Hashed timer wheel for the timeouts of one DTU connection. A timer is linked into the slot of
+ * its deadline (deadline / slot width modulo slot count), advance() only walks the slots passed
+ * since the last call and fires the timers whose deadline is reached - timers of a later
+ * revolution stay linked. The owner arms a single one-shot timer to getNextDelay(), so deadlines
+ * are met with millisecond precision without a periodic tick.
+ * Expired timers are unlinked before their callback runs - callbacks can schedule timers again.
+ * The wheel can be used from several tasks - on ESP32 it is guarded by a critical section, the
+ * callbacks run outside of it.
+ */
+class DTUTimerWheel {
+public:
+    DTUTimerWheel();
+
+    void setCallback(TimerWheelCallback callback, void *context);
+    // (re)schedules the timer - a pending deadline of the same id is replaced
+    void schedule(uint8_t timerId, unsigned long now, uint32_t delayMs);
+    void cancel(uint8_t timerId);
+    boolean isScheduled(uint8_t timerId) const;
+
+    // fires all expired timers
+    void advance(unsigned long now);
+    // ms until the next deadline - DTU_TIMER_WHEEL_NO_DEADLINE if no timer is pending
+    uint32_t getNextDelay(unsigned long now) const;
+
+private:
+    struct wheelTimer
+    {
+        boolean scheduled = false;
+        unsigned long deadline = 0;
+        uint8_t next = DTU_TIMER_WHEEL_NONE;
+    };
+    wheelTimer timers[DTU_TIMER_WHEEL_MAX_TIMERS];
+    uint8_t slotHead[DTU_TIMER_WHEEL_SLOTS];
+    unsigned long lastAdvance = 0;
+
+    TimerWheelCallback callback = nullptr;
+    void *callbackContext = nullptr;
+
+#if defined(ESP32)
+    mutable portMUX_TYPE wheelMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    static uint8_t slotOf(unsigned long time) { return (time >> DTU_TIMER_WHEEL_SLOT_SHIFT) % DTU_TIMER_WHEEL_SLOTS; }
+    void unlink(uint8_t timerId);
+};
+
+#endif // DTUTIMERWHEEL_H
@@ -27,6 +27,12 @@ struct PowerLimitSet {
     boolean update = false;
 };
 
+struct MeterPowerValue {
+    float power = 0;                  // W - positive: import from grid
+    unsigned long receivedMillis = 0;
+    boolean update = false;
+};
+
 struct RemoteBaseData
 {
   float current = 0;
@@ -72,10 +78,12 @@ public:
     void setMainTopic(String mainTopicPath);
 
     void setRemoteDisplayData(boolean remoteDisplayActive);
+    void setMeterPowerTopic(const char *meterTopic);
 
     void requestMQTTconnectionReset(boolean autoDiscoveryRemoveRequested);
 
     PowerLimitSet getPowerLimitSet();
+    MeterPowerValue getMeterPower();
     RemoteInverterData getRemoteInverterData();
     void stopConnection(boolean full=false);
 
@@ -93,6 +101,7 @@ private:
     const char* espURL;
     String mqttMainTopicPath;
     String gw_ipAddress;
+    String meterPowerTopic;
         
     WiFiClient wifiClient;
     WiFiClientSecure wifiClientSecure;
@@ -106,6 +115,7 @@ private:
     unsigned long lastReconnectAttempt = 0;
 
     PowerLimitSet lastPowerLimitSet;
+    MeterPowerValue lastMeterPower;
     RemoteInverterData lastRemoteInverterData;
     
     void reconnect();
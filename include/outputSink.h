@@ -0,0 +1,127 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <Arduino.h>
+#include <base/taskScheduler.h>
+#include "dtuEventBus.h"
+
+#define OUTPUT_SINK_QUEUE_SIZE 8
+#define OUTPUT_SINK_MAX 4
+#define OUTPUT_SINK_POLICY_COALESCE 0    // a waiting event of the same type and DTU is replaced by the new one
+#define OUTPUT_SINK_POLICY_DROP_OLDEST 1 // every event is delivered - if the queue is full the oldest is dropped
+#define OUTPUT_SINK_RETRY_MS 30000       // pause of a sink after a failed delivery
+#define OUTPUT_SINK_IDLE 0xFFFFFFFF      // no event and no poll waiting
+
+#if defined(ESP32)
+#define OUTPUT_SINK_STACK 6144 // HTTP client in the worker
+#define OUTPUT_SINK_PRIORITY 1
+#endif
+
+// delivers one event - returns false if the target was not reachable, the sink pauses then
+typedef boolean (*outputSinkWorker)(const dtuEvent &event, void *context);
+// reads from the target (e.g. a set value) - returns false if it was not reachable, the sink pauses then
+typedef boolean (*outputSinkPoll)(void *context);
+
+struct outputSinkItem
+{
+  dtuEvent event;
+  uint32_t enqueuedMs = 0;
+};
+
+struct outputSinkStats
+{
+  uint32_t enqueued = 0;
+  uint32_t delivered = 0;
+  uint32_t coalesced = 0;      // replaced by a newer event while waiting
+  uint32_t dropped = 0;        // queue full - the oldest event was lost
+  uint32_t failed = 0;         // deliveries the worker reported as failed
+  uint32_t pauses = 0;
+  uint32_t polls = 0;
+  uint32_t pollsFailed = 0;
+  uint32_t lastLagMs = 0;      // enqueue until the start of the delivery
+  uint32_t maxLagMs = 0;
+  uint32_t lastLatencyUs = 0;  // origin of the event (decode of the values) until delivered
+  uint32_t maxLatencyUs = 0;
+  uint32_t lastRunUs = 0;      // worker only (deliveries)
+  uint32_t maxRunUs = 0;
+  uint64_t busyUs = 0;         // deliveries and polls
+  uint8_t maxQueued = 0;
+};
+
+/**
+ * One output of the DTU events (MQTT, OpenHAB, serial, ...) with its own bounded queue and worker.
+ * enqueue() never blocks - the events wait in the queue of the sink and are coalesced (latest value
+ * wins) or the oldest is dropped if it is full. The worker delivers one event per run: on ESP32 in an
+ * own FreeRTOS task if requested (blocking HTTP), else as one-shot task of the main loop scheduler.
+ * After a failed delivery the sink pauses for OUTPUT_SINK_RETRY_MS and only keeps the newest events,
+ * so an unreachable target costs at most one timeout per pause and never delays the other sinks.
+ * A sink can also poll its target periodically - in the same worker, so a blocking read pauses
+ * together with the deliveries and stays out of the loop on ESP32.
+ */
+class OutputSink {
+public:
+    OutputSink(const char *name, uint8_t policy);
+
+    // ownTask - worker in an own FreeRTOS task (ESP32 only), else in the main loop
+    void begin(outputSinkWorker worker, void *context = nullptr, boolean ownTask = false);
+    // periodic poll of the target in the worker - before begin(), gets the context of begin()
+    void setPoll(outputSinkPoll poll, uint32_t intervalMs);
+    // any context - returns false if an event had to be dropped
+    boolean enqueue(const dtuEvent &event);
+    // the target was not reachable outside of a delivery (e.g. a poll) - pause the sink
+    void reportFailure();
+    // false while paused after a failure
+    boolean isAvailable() const;
+
+    const char *getName() const { return name; }
+    uint8_t getPolicy() const { return policy; }
+    boolean hasOwnTask() const { return ownTask; }
+    uint8_t getQueued() const { return queueCount; }
+    const outputSinkStats &getStats() const { return stats; }
+    void resetStats();
+
+    // all sinks in the order of begin()
+    static uint8_t getCount() { return sinkCount; }
+    static OutputSink &get(uint8_t index) { return *sinks[index]; }
+    static void printStats();
+    static const char *getPolicyName(uint8_t policy);
+
+private:
+    const char *name;
+    uint8_t policy;
+    outputSinkWorker worker = nullptr;
+    void *context = nullptr;
+    boolean ownTask = false;
+    uint8_t loopTaskId = TASK_SCHEDULER_NO_TASK;
+    outputSinkPoll poll = nullptr;
+    uint32_t pollIntervalMs = 0;
+    uint32_t lastPollMs = 0; // worker only
+
+    outputSinkItem queue[OUTPUT_SINK_QUEUE_SIZE];
+    uint8_t queueHead = 0; // next event to deliver
+    volatile uint8_t queueCount = 0;
+    volatile uint32_t pausedUntil = 0; // millis() - 0: not paused
+
+    outputSinkStats stats;
+
+    boolean takeNext(outputSinkItem &item);
+    boolean work();
+    void deliverNext();
+    void pollTarget();
+    void pause();
+    uint32_t getPauseRemaining() const;
+    uint32_t getPollRemaining() const;
+    uint32_t getIdleMs() const;
+    void arm();
+    static void loopWorker(void *instance);
+#if defined(ESP32)
+    portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED; // enqueue in the loop, delivery in the worker task
+    TaskHandle_t taskHandle = nullptr;
+    static void taskWorker(void *instance);
+#endif
+
+    static OutputSink *sinks[OUTPUT_SINK_MAX];
+    static uint8_t sinkCount;
+};
+
+#endif // OUTPUTSINK_H
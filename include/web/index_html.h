@@ -148,8 +148,15 @@ const char INDEX_HTML[] PROGMEM = R"=====(
                     dtu request cycle in seconds (data update):
                 </div>
                 <div>
-                    <input type="number" id="dtuDataCycle" min="1" max="60" placeholder="31">
+                    <input type="number" id="dtuDataCycle" min="1" max="60" placeholder="31" oninput="checkDtuDataCycle()">
                 </div>
+                <div>
+                    min. dtu request cycle in seconds (adaptive data update):
+                </div>
+                <div>
+                    <input type="number" id="dtuDataCycleMin" min="1" max="60" placeholder="31" oninput="checkDtuDataCycle()">
+                </div>
+                <small id="dtuDataCycleWarning" style="color: orange; display: none;">below 31 seconds the dtu may not answer every request or hang (offline for up to 30 min) - at your own risk</small>
                 <div>
                     dtu cloud update pause (no cycle update every full 15 min):
                     <input type="checkbox" id="dtuCloudPause">
@@ -760,6 +767,8 @@ const char INDEX_HTML[] PROGMEM = R"=====(
             // get networkdata
             $('#dtuHostIpDomain').val(dtuData.dtuHostIpDomain);
             $('#dtuDataCycle').val(dtuData.dtuDataCycle);
+            $('#dtuDataCycleMin').val(dtuData.dtuDataCycleMin);
+            checkDtuDataCycle();
             if (dtuData.dtuCloudPause) {
                 $('#dtuCloudPause').prop("checked", true);
             } else {
@@ -896,9 +905,21 @@ const char INDEX_HTML[] PROGMEM = R"=====(
             return;
         }
 
+        // the dtu handles about one request per 31 s - lower values only with a warning
+        function checkDtuDataCycle() {
+            var cycle = $('#dtuDataCycle').val();
+            var cycleMin = $('#dtuDataCycleMin').val();
+            if ((cycle !== '' && Number(cycle) < 31) || (cycleMin !== '' && Number(cycleMin) < 31)) {
+                $('#dtuDataCycleWarning').show();
+            } else {
+                $('#dtuDataCycleWarning').hide();
+            }
+        }
+
         function changeDtuData() {
             var dtuHostIpDomainSend = $('#dtuHostIpDomain').val();
             var dtuDataCycleSend = $('#dtuDataCycle').val();
+            var dtuDataCycleMinSend = $('#dtuDataCycleMin').val();
             if ($("#dtuCloudPause").is(':checked')) {
                 dtuCloudPauseSend = 1;
             } else {
@@ -913,6 +934,7 @@ const char INDEX_HTML[] PROGMEM = R"=====(
             var data = {};
             data["dtuHostIpDomainSend"] = dtuHostIpDomainSend;
             data["dtuDataCycleSend"] = dtuDataCycleSend;
+            data["dtuDataCycleMinSend"] = dtuDataCycleMinSend;
             data["dtuCloudPauseSend"] = dtuCloudPauseSend;
 
             data["remoteDisplayActiveSend"] = remoteDisplayActiveSend;
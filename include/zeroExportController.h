@@ -0,0 +1,75 @@
+#ifndef ZEROEXPORTCONTROLLER_H
+#define ZEROEXPORTCONTROLLER_H
+
+#include <Arduino.h>
+
+// default min. time between two power limit commands (userConfig.zeroExportMinCommandTime) - the DTU
+// tolerates about one request per 31 s, shorter spacings react faster but risk a hanging DTU
+#define ZERO_EXPORT_MIN_COMMAND_SECONDS 31
+// meter values older than this are not used for control
+#define ZERO_EXPORT_METER_TIMEOUT_MS 30000
+// inverter power older than this does not limit the output (anti windup) - two polls of 31 s + margin
+#define ZERO_EXPORT_INVERTER_MAX_AGE_MS 65000
+// lowest power limit accepted by the inverter
+#define ZERO_EXPORT_MIN_LIMIT 2
+
+struct zeroExportStats
+{
+    uint32_t meterUpdates = 0;
+    uint32_t commands = 0;
+    uint32_t heldByDeadband = 0;
+    uint32_t heldByRateLimit = 0;
+    uint32_t clampSkipped = 0;     // anti windup skipped - inverter power too old or from before the last command
+    uint32_t acked = 0;            // commands acked by the DTU - base of the latency
+    float outputPower = 0;         // current controller output (W)
+    float trackingError = 0;       // last meter power - target (W)
+    float trackingErrorAvg = 0;    // smoothed absolute tracking error (W)
+    float trackingErrorMax = 0;    // max absolute tracking error since start (W)
+    uint32_t lastLatencyMs = 0;    // meter value received -> power limit command acked by the DTU
+    uint32_t maxLatencyMs = 0;
+    uint32_t sumLatencyMs = 0;
+};
+
+/**
+ * Closed loop control of the inverter power limit to hold the grid power of the household meter
+ * at the configured target (e.g. 0 W for zero export). Positive meter power means import from grid.
+ * Runs an incremental PID on each new meter value - the output (inverter power in W) is limited to
+ * a max step per update, changes within the deadband are ignored and commands are sent not more
+ * often than every userConfig.zeroExportMinCommandTime seconds.
+ */
+class ZeroExportController {
+public:
+    // reset the output to the current power limit of the inverter (in %)
+    void reset(uint8_t currentLimit);
+
+    // new meter value (W) received at given millis - returns true if a new power limit (%) has to be set
+    // inverterPower is the last known AC output of the inverter (W) or < 0 if unknown, received at inverterMillis
+    boolean addMeterValue(float meterPower, float inverterPower, unsigned long inverterMillis, unsigned long receivedMillis, uint8_t &newLimit);
+    // the DTU acked a power limit command at given millis - latency of the command for that limit
+    void commandAcked(uint8_t limit, unsigned long ackMillis);
+
+    boolean isInitialized() const { return initialized; }
+    // true if meter values are recent enough to control the inverter
+    boolean isActive(unsigned long now) const;
+
+    const zeroExportStats &getStats() const { return stats; }
+
+private:
+    boolean initialized = false;
+    float output = 0;          // inverter power (W)
+    float lastError = 0;
+    float lastError2 = 0;
+    unsigned long lastMeterMillis = 0;
+    unsigned long lastCommandMillis = 0;
+    unsigned long commandMeterMillis = 0; // receive time of the meter value of the command waiting for its ack
+    uint8_t lastLimit = 0;
+    boolean commandPending = false;
+
+    zeroExportStats stats;
+
+    void updateTrackingError(float error);
+};
+
+extern ZeroExportController zeroExportController;
+
+#endif // ZEROEXPORTCONTROLLER_H
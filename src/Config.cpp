@@ -119,8 +119,24 @@ void UserConfigManager::printConfigdata()
 
     Serial.print(F("\ndtu update time: \t"));
     Serial.println(userConfig.dtuUpdateTime);
+    Serial.print(F("dtu update adaptive: \t"));
+    Serial.println(userConfig.dtuUpdateAdaptive);
+    Serial.print(F("dtu update time min: \t"));
+    Serial.println(userConfig.dtuUpdateTimeMin);
+    Serial.print(F("dtu update time max: \t"));
+    Serial.println(userConfig.dtuUpdateTimeMax);
+    Serial.print(F("dtu reconnect max delay: "));
+    Serial.println(userConfig.dtuReconnectMaxDelay);
+    Serial.print(F("dtu heartbeat interval: "));
+    Serial.println(userConfig.dtuHeartbeatInterval);
+    Serial.print(F("dtu heartbeat max missed: "));
+    Serial.println(userConfig.dtuHeartbeatMaxMissed);
+    Serial.print(F("dtu unchanged refresh: \t"));
+    Serial.println(userConfig.dtuUnchangedRefresh);
     Serial.print(F("dtu host: \t\t"));
     Serial.println(userConfig.dtuHostIpDomain);
+    Serial.print(F("dtu site hosts: \t"));
+    Serial.println(userConfig.dtuSiteHosts);
     Serial.print(F("dtu ssid: \t\t"));
     Serial.println(userConfig.dtuSsid);
     Serial.print(F("dtu pass: \t\t"));
@@ -158,6 +174,23 @@ void UserConfigManager::printConfigdata()
     Serial.print(F("\nremoteDisplay: \t\t"));
     Serial.println(userConfig.remoteDisplayActive);
 
+    Serial.print(F("\nzero export active: \t"));
+    Serial.println(userConfig.zeroExportActive);
+    Serial.print(F("zero export meter: \t"));
+    Serial.println(userConfig.zeroExportMeterTopic);
+    Serial.print(F("zero export target: \t"));
+    Serial.println(userConfig.zeroExportTarget);
+    Serial.print(F("zero export inverter: \t"));
+    Serial.println(userConfig.zeroExportInverterPower);
+    Serial.print(F("zero export deadband: \t"));
+    Serial.println(userConfig.zeroExportDeadband);
+    Serial.print(F("zero export max step: \t"));
+    Serial.println(userConfig.zeroExportMaxStep);
+    Serial.print(F("zero export cmd time: \t"));
+    Serial.println(userConfig.zeroExportMinCommandTime);
+    Serial.print(F("zero export kp/ki/kd: \t"));
+    Serial.println(String(userConfig.zeroExportKp, 3) + " / " + String(userConfig.zeroExportKi, 3) + " / " + String(userConfig.zeroExportKd, 3));
+
     Serial.print(F("update channel: \t\t"));
     Serial.println(userConfig.selectedUpdateChannel);
 
@@ -193,9 +226,17 @@ JsonDocument UserConfigManager::mappingStructToJson(const UserConfig &config)
     doc["wifi"]["pass"] = config.wifiPassword;
 
     doc["dtu"]["hostIP"] = config.dtuHostIpDomain;
+    doc["dtu"]["siteHosts"] = config.dtuSiteHosts;
     doc["dtu"]["cloudPauseActive"] = config.dtuCloudPauseActive;
     doc["dtu"]["cloudPauseTime"] = config.dtuCloudPauseTime;
     doc["dtu"]["updateTime"] = config.dtuUpdateTime;
+    doc["dtu"]["updateAdaptive"] = config.dtuUpdateAdaptive;
+    doc["dtu"]["updateTimeMin"] = config.dtuUpdateTimeMin;
+    doc["dtu"]["updateTimeMax"] = config.dtuUpdateTimeMax;
+    doc["dtu"]["reconnectMaxDelay"] = config.dtuReconnectMaxDelay;
+    doc["dtu"]["heartbeatInterval"] = config.dtuHeartbeatInterval;
+    doc["dtu"]["heartbeatMaxMissed"] = config.dtuHeartbeatMaxMissed;
+    doc["dtu"]["unchangedRefresh"] = config.dtuUnchangedRefresh;
     doc["dtu"]["ssid"] = config.dtuSsid;
     doc["dtu"]["pass"] = config.dtuPassword;
 
@@ -214,6 +255,17 @@ JsonDocument UserConfigManager::mappingStructToJson(const UserConfig &config)
 
     doc["remoteDisplay"]["Active"] = config.remoteDisplayActive;
 
+    doc["zeroExport"]["active"] = config.zeroExportActive;
+    doc["zeroExport"]["meterTopic"] = config.zeroExportMeterTopic;
+    doc["zeroExport"]["target"] = config.zeroExportTarget;
+    doc["zeroExport"]["inverterPower"] = config.zeroExportInverterPower;
+    doc["zeroExport"]["deadband"] = config.zeroExportDeadband;
+    doc["zeroExport"]["maxStep"] = config.zeroExportMaxStep;
+    doc["zeroExport"]["minCommandTime"] = config.zeroExportMinCommandTime;
+    doc["zeroExport"]["kp"] = config.zeroExportKp;
+    doc["zeroExport"]["ki"] = config.zeroExportKi;
+    doc["zeroExport"]["kd"] = config.zeroExportKd;
+
     doc["display"]["type"] = config.displayConnected;
     doc["display"]["orientation"] = config.displayOrientation;
     doc["display"]["brightnessDay"] = config.displayBrightnessDay;
@@ -238,9 +290,17 @@ void UserConfigManager::mappingJsonToStruct(JsonDocument doc)
     String(doc["wifi"]["pass"].as<String>()).toCharArray(userConfig.wifiPassword, sizeof(userConfig.wifiPassword));
 
     String(doc["dtu"]["hostIP"].as<String>()).toCharArray(userConfig.dtuHostIpDomain, sizeof(userConfig.dtuHostIpDomain));
+    String(doc["dtu"]["siteHosts"].as<String>()).toCharArray(userConfig.dtuSiteHosts, sizeof(userConfig.dtuSiteHosts));
     userConfig.dtuCloudPauseActive = doc["dtu"]["cloudPauseActive"].as<bool>();
     userConfig.dtuCloudPauseTime = doc["dtu"]["cloudPauseTime"].as<int>();
     userConfig.dtuUpdateTime = doc["dtu"]["updateTime"].as<int>();
+    userConfig.dtuUpdateAdaptive = doc["dtu"]["updateAdaptive"].as<bool>();
+    userConfig.dtuUpdateTimeMin = doc["dtu"]["updateTimeMin"].as<int>();
+    userConfig.dtuUpdateTimeMax = doc["dtu"]["updateTimeMax"].as<int>();
+    userConfig.dtuReconnectMaxDelay = doc["dtu"]["reconnectMaxDelay"].as<int>();
+    userConfig.dtuHeartbeatInterval = doc["dtu"]["heartbeatInterval"].as<int>();
+    userConfig.dtuHeartbeatMaxMissed = doc["dtu"]["heartbeatMaxMissed"].as<int>();
+    userConfig.dtuUnchangedRefresh = doc["dtu"]["unchangedRefresh"].as<int>();
     String(doc["dtu"]["ssid"].as<String>()).toCharArray(userConfig.dtuSsid, sizeof(userConfig.dtuSsid));
     String(doc["dtu"]["pass"].as<String>()).toCharArray(userConfig.dtuPassword, sizeof(userConfig.dtuPassword));
 
@@ -259,6 +319,17 @@ void UserConfigManager::mappingJsonToStruct(JsonDocument doc)
 
     userConfig.remoteDisplayActive = doc["remoteDisplay"]["Active"].as<bool>();
 
+    userConfig.zeroExportActive = doc["zeroExport"]["active"].as<bool>();
+    String(doc["zeroExport"]["meterTopic"].as<String>()).toCharArray(userConfig.zeroExportMeterTopic, sizeof(userConfig.zeroExportMeterTopic));
+    userConfig.zeroExportTarget = doc["zeroExport"]["target"].as<int>();
+    userConfig.zeroExportInverterPower = doc["zeroExport"]["inverterPower"].as<int>();
+    userConfig.zeroExportDeadband = doc["zeroExport"]["deadband"].as<int>();
+    userConfig.zeroExportMaxStep = doc["zeroExport"]["maxStep"].as<int>();
+    userConfig.zeroExportMinCommandTime = doc["zeroExport"]["minCommandTime"].as<int>();
+    userConfig.zeroExportKp = doc["zeroExport"]["kp"].as<float>();
+    userConfig.zeroExportKi = doc["zeroExport"]["ki"].as<float>();
+    userConfig.zeroExportKd = doc["zeroExport"]["kd"].as<float>();
+
     userConfig.displayConnected = doc["display"]["type"];
     userConfig.displayOrientation = doc["display"]["orientation"];
     userConfig.displayBrightnessDay = doc["display"]["brightnessDay"];
@@ -0,0 +1,161 @@
+#include "base/taskScheduler.h"
+
+TaskScheduler taskScheduler;
+
+#if defined(ESP32)
+static portMUX_TYPE schedulerMux = portMUX_INITIALIZER_UNLOCKED;
+#define SCHEDULER_LOCK() portENTER_CRITICAL(&schedulerMux)
+#define SCHEDULER_UNLOCK() portEXIT_CRITICAL(&schedulerMux)
+#else
+// ESP8266 - all callbacks run in the loop context
+#define SCHEDULER_LOCK()
+#define SCHEDULER_UNLOCK()
+#endif
+
+uint8_t TaskScheduler::addTask(const char *name, taskCallback callback, void *arg, uint32_t periodMs, uint32_t phaseMs, uint32_t deadlineMs, boolean enabled)
+{
+    if (taskCount >= TASK_SCHEDULER_MAX_TASKS)
+    {
+        Serial.println("SCHEDULER:\t no free task slot for '" + String(name) + "' (max. " + String(TASK_SCHEDULER_MAX_TASKS) + ")");
+        return TASK_SCHEDULER_NO_TASK;
+    }
+    SCHEDULER_LOCK();
+    uint8_t id = taskCount;
+    schedulerTask &task = tasks[id];
+    task.name = name;
+    task.callback = callback;
+    task.arg = arg;
+    task.periodMs = periodMs;
+    task.deadlineMs = deadlineMs;
+    task.nextRelease = millis() + phaseMs;
+    task.enabled = enabled;
+    taskCount++;
+    SCHEDULER_UNLOCK();
+    return id;
+}
+
+void TaskScheduler::runIn(uint8_t id, uint32_t delayMs)
+{
+    if (id >= taskCount)
+        return;
+    SCHEDULER_LOCK();
+    tasks[id].nextRelease = millis() + delayMs;
+    tasks[id].enabled = true;
+    SCHEDULER_UNLOCK();
+}
+
+void TaskScheduler::disable(uint8_t id)
+{
+    if (id >= taskCount)
+        return;
+    SCHEDULER_LOCK();
+    tasks[id].enabled = false;
+    SCHEDULER_UNLOCK();
+}
+
+void TaskScheduler::setPeriod(uint8_t id, uint32_t periodMs)
+{
+    if (id >= taskCount)
+        return;
+    SCHEDULER_LOCK();
+    tasks[id].periodMs = periodMs;
+    SCHEDULER_UNLOCK();
+}
+
+boolean TaskScheduler::isEnabled(uint8_t id) const
+{
+    return id < taskCount && tasks[id].enabled;
+}
+
+uint8_t TaskScheduler::nextDueTask(uint32_t now)
+{
+    // earliest release first - the difference keeps it right across the millis() overflow
+    uint8_t due = TASK_SCHEDULER_NO_TASK;
+    uint32_t dueSince = 0;
+    for (uint8_t id = 0; id < taskCount; id++)
+    {
+        const schedulerTask &task = tasks[id];
+        if (!task.enabled || int32_t(now - task.nextRelease) < 0)
+            continue;
+        if (due == TASK_SCHEDULER_NO_TASK || now - task.nextRelease > dueSince)
+        {
+            due = id;
+            dueSince = now - task.nextRelease;
+        }
+    }
+    return due;
+}
+
+void TaskScheduler::run()
+{
+    // bounded number of runs per call - the loop() jobs outside of the scheduler keep running
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        uint32_t now = millis();
+        SCHEDULER_LOCK();
+        uint8_t id = nextDueTask(now);
+        SCHEDULER_UNLOCK();
+        if (id == TASK_SCHEDULER_NO_TASK)
+            break;
+        execute(id, now);
+    }
+}
+
+void TaskScheduler::execute(uint8_t id, uint32_t now)
+{
+    schedulerTask &task = tasks[id];
+
+    // plan the next release before the run - the task may re-arm or disable itself
+    SCHEDULER_LOCK();
+    uint32_t release = task.nextRelease;
+    uint32_t deadline = task.deadlineMs;
+    if (task.periodMs == 0)
+        task.enabled = false;
+    else
+    {
+        uint32_t behind = (now - release) / task.periodMs;
+        task.stats.skippedReleases += behind;
+        task.nextRelease = release + (behind + 1) * task.periodMs;
+        if (deadline == 0)
+            deadline = task.periodMs;
+    }
+    SCHEDULER_UNLOCK();
+
+    uint32_t lateness = now - release;
+    if (lateness > task.stats.maxLatenessMs)
+        task.stats.maxLatenessMs = lateness;
+
+    unsigned long start = micros();
+    task.callback(task.arg);
+    uint32_t runUs = micros() - start;
+
+    task.stats.runs++;
+    task.stats.totalUs += runUs;
+    task.stats.lastUs = runUs;
+    if (runUs > task.stats.maxUs)
+        task.stats.maxUs = runUs;
+    if (deadline > 0 && millis() - release > deadline)
+        task.stats.missedDeadlines++;
+    busyUs += runUs;
+}
+
+void TaskScheduler::resetStats()
+{
+    for (uint8_t id = 0; id < taskCount; id++)
+        tasks[id].stats = schedulerTaskStats();
+    busyUs = 0;
+}
+
+void TaskScheduler::printStats() const
+{
+    Serial.println("SCHEDULER:\t " + String(taskCount) + " tasks - busy " + String(getBusyMs()) + " ms of " + String(millis()) + " ms");
+    for (uint8_t id = 0; id < taskCount; id++)
+    {
+        const schedulerTask &task = tasks[id];
+        const schedulerTaskStats &stats = task.stats;
+        Serial.printf("SCHEDULER:\t %2u %-16s %6lu ms %s runs: %8lu cpu: %8lu ms max: %7lu us late: %6lu ms missed: %5lu skipped: %5lu\n",
+                      id, task.name, (unsigned long)task.periodMs, task.enabled ? "on " : "off", (unsigned long)stats.runs,
+                      (unsigned long)(stats.totalUs / 1000), (unsigned long)stats.maxUs, (unsigned long)stats.maxLatenessMs,
+                      (unsigned long)stats.missedDeadlines, (unsigned long)stats.skippedReleases);
+    }
+}
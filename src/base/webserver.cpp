@@ -11,11 +11,10 @@ DTUwebserver::DTUwebserver()
 
 DTUwebserver::~DTUwebserver()
 {
-    stop();                  // Ensure the server is stopped and resources are cleaned up
-    webServerTimer.detach(); // Stop the timer
+    stop(); // Ensure the server is stopped and resources are cleaned up
 }
 
-void DTUwebserver::backgroundTask(DTUwebserver *instance)
+void DTUwebserver::backgroundTask(void *instance)
 {
     if (platformData.rebootRequested)
     {
@@ -36,6 +35,19 @@ void DTUwebserver::backgroundTask(DTUwebserver *instance)
     // }
 }
 
+void DTUwebserver::onDtuEvent(const dtuEvent &event, void *context)
+{
+    DTUwebserver *server = static_cast<DTUwebserver *>(context);
+    if (server->pushEvents.count() == 0)
+        return;
+    String JSON = "{";
+    JSON = JSON + "\"dtu\": " + int(dtuSite.getIndex(event.source)) + ",";
+    JSON = JSON + "\"value\": " + event.value + ",";
+    JSON = JSON + "\"dataVersion\": " + event.source->getSnapshotVersion();
+    JSON = JSON + "}";
+    server->pushEvents.send(JSON.c_str(), DTUEventBus::getTypeName(event.type), event.sequence);
+}
+
 void DTUwebserver::start()
 {
     // Initialize the web server and define routes as before
@@ -60,6 +72,17 @@ void DTUwebserver::start()
     // api GETs
     asyncDtuWebServer.on("/api/data.json", handleDataJson);
     asyncDtuWebServer.on("/api/info.json", handleInfojson);
+    asyncDtuWebServer.on("/api/history.json", handleHistoryJson);
+    asyncDtuWebServer.on("/api/site.json", handleSiteJson);
+    asyncDtuWebServer.on("/api/dtuTrace.json", handleDtuTraceJson);
+    asyncDtuWebServer.on("/api/energyHistory.json", handleEnergyHistoryJson);
+    asyncDtuWebServer.on("/api/tasks.json", handleTasksJson);
+    // push of the DTU events
+    if (pushSubscriberId == DTU_EVENT_NO_SUBSCRIBER)
+    {
+        asyncDtuWebServer.addHandler(&pushEvents);
+        pushSubscriberId = dtuEventBus.subscribe("webPush", DTU_EVENT_MASK_ALL, DTUwebserver::onDtuEvent, this);
+    }
 
     // OTA direct update
     asyncDtuWebServer.on("/updateOTASettings", handleUpdateOTASettings);
@@ -73,7 +96,10 @@ void DTUwebserver::start()
     asyncDtuWebServer.onNotFound(notFound);
 
     asyncDtuWebServer.begin(); // Start the web server
-    webServerTimer.attach(1, DTUwebserver::backgroundTask, this);
+    if (backgroundTaskId == TASK_SCHEDULER_NO_TASK)
+        backgroundTaskId = taskScheduler.addTask("webBackground", DTUwebserver::backgroundTask, this, 1000, 1000);
+    else
+        taskScheduler.runIn(backgroundTaskId, 1000);
 #ifdef ESP32
     Update.onProgress(printProgress);
 #endif
@@ -81,8 +107,8 @@ void DTUwebserver::start()
 
 void DTUwebserver::stop()
 {
-    asyncDtuWebServer.end(); // Stop the web server
-    webServerTimer.detach(); // Stop the timer
+    asyncDtuWebServer.end();                 // Stop the web server
+    taskScheduler.disable(backgroundTaskId); // Stop the background task
 }
 
 // base pages
@@ -221,46 +247,117 @@ void DTUwebserver::handleConfigPage(AsyncWebServerRequest *request)
 // serve json as api
 void DTUwebserver::handleDataJson(AsyncWebServerRequest *request)
 {
+    // the handler runs in the async TCP context - only the published snapshot is consistent
+    // static - too large for the stack of the async TCP task, which runs one handler at a time
+    // the only full copy in the web context, the other handlers read the parts they need
+    static dtuSnapshot dtuState;
+    uint32_t dataVersion = dtuInterface.readSnapshot(dtuState);
+    const inverterData &dtuData = dtuState.data;
+
     String JSON = "{";
-    JSON = JSON + "\"localtime\": " + String(dtuGlobalData.currentTimestamp) + ",";
+    JSON = JSON + "\"dataVersion\": " + dataVersion + ",";
+    JSON = JSON + "\"localtime\": " + String(dtuData.currentTimestamp) + ",";
     JSON = JSON + "\"ntpStamp\": " + String(platformData.currentNTPtime - userConfig.timezoneOffest) + ",";
 
-    JSON = JSON + "\"lastResponse\": " + dtuGlobalData.lastRespTimestamp + ",";
-    JSON = JSON + "\"dtuConnState\": " + dtuConnection.dtuConnectState + ",";
-    JSON = JSON + "\"dtuErrorState\": " + dtuConnection.dtuErrorState + ",";
+    JSON = JSON + "\"lastResponse\": " + dtuData.lastRespTimestamp + ",";
+    JSON = JSON + "\"dtuConnState\": " + dtuState.connection.dtuConnectState + ",";
+    JSON = JSON + "\"dtuErrorState\": " + dtuState.connection.dtuErrorState + ",";
 
     JSON = JSON + "\"starttime\": " + String(platformData.dtuGWstarttime - userConfig.timezoneOffest) + ",";
 
     JSON = JSON + "\"inverter\": {";
-    JSON = JSON + "\"pLim\": " + ((dtuGlobalData.powerLimit == 254) ? ("\"--\"") : (String(dtuGlobalData.powerLimit))) + ",";
-    JSON = JSON + "\"pLimSet\": " + String(dtuGlobalData.powerLimitSet) + ",";
-    JSON = JSON + "\"temp\": " + String(dtuGlobalData.inverterTemp) + ",";
-    JSON = JSON + "\"uptodate\": " + String(dtuGlobalData.uptodate);
+    JSON = JSON + "\"pLim\": " + ((dtuData.powerLimit == 254) ? ("\"--\"") : (String(dtuData.powerLimit))) + ",";
+    JSON = JSON + "\"pLimSet\": " + String(dtuData.powerLimitSet) + ",";
+    JSON = JSON + "\"temp\": " + String(dtuData.inverterTemp) + ",";
+    JSON = JSON + "\"uptodate\": " + String(dtuData.uptodate);
     JSON = JSON + "},";
 
     JSON = JSON + "\"grid\": {";
-    JSON = JSON + "\"v\": " + String(dtuGlobalData.grid.voltage) + ",";
-    JSON = JSON + "\"c\": " + String(dtuGlobalData.grid.current) + ",";
-    JSON = JSON + "\"p\": " + ((dtuGlobalData.grid.power == -1) ? ("\"--\"") : (String(dtuGlobalData.grid.power))) + ",";
-    JSON = JSON + "\"dE\": " + String(dtuGlobalData.grid.dailyEnergy, 3) + ",";
-    JSON = JSON + "\"tE\": " + String(dtuGlobalData.grid.totalEnergy, 3);
+    JSON = JSON + "\"v\": " + String(dtuData.grid.voltage) + ",";
+    JSON = JSON + "\"c\": " + String(dtuData.grid.current) + ",";
+    JSON = JSON + "\"p\": " + ((dtuData.grid.power == -1) ? ("\"--\"") : (String(dtuData.grid.power))) + ",";
+    JSON = JSON + "\"dE\": " + String(dtuData.grid.dailyEnergy, 3) + ",";
+    JSON = JSON + "\"tE\": " + String(dtuData.grid.totalEnergy, 3);
     JSON = JSON + "},";
 
     JSON = JSON + "\"pv0\": {";
-    JSON = JSON + "\"v\": " + String(dtuGlobalData.pv0.voltage) + ",";
-    JSON = JSON + "\"c\": " + String(dtuGlobalData.pv0.current) + ",";
-    JSON = JSON + "\"p\": " + ((dtuGlobalData.pv0.power == -1) ? ("\"--\"") : (String(dtuGlobalData.pv0.power))) + ",";
-    JSON = JSON + "\"dE\": " + String(dtuGlobalData.pv0.dailyEnergy, 3) + ",";
-    JSON = JSON + "\"tE\": " + String(dtuGlobalData.pv0.totalEnergy, 3);
+    JSON = JSON + "\"v\": " + String(dtuData.pv0.voltage) + ",";
+    JSON = JSON + "\"c\": " + String(dtuData.pv0.current) + ",";
+    JSON = JSON + "\"p\": " + ((dtuData.pv0.power == -1) ? ("\"--\"") : (String(dtuData.pv0.power))) + ",";
+    JSON = JSON + "\"dE\": " + String(dtuData.pv0.dailyEnergy, 3) + ",";
+    JSON = JSON + "\"tE\": " + String(dtuData.pv0.totalEnergy, 3);
     JSON = JSON + "},";
 
     JSON = JSON + "\"pv1\": {";
-    JSON = JSON + "\"v\": " + String(dtuGlobalData.pv1.voltage) + ",";
-    JSON = JSON + "\"c\": " + String(dtuGlobalData.pv1.current) + ",";
-    JSON = JSON + "\"p\": " + ((dtuGlobalData.pv1.power == -1) ? ("\"--\"") : (String(dtuGlobalData.pv1.power))) + ",";
-    JSON = JSON + "\"dE\": " + String(dtuGlobalData.pv1.dailyEnergy, 3) + ",";
-    JSON = JSON + "\"tE\": " + String(dtuGlobalData.pv1.totalEnergy, 3);
-    JSON = JSON + "}";
+    JSON = JSON + "\"v\": " + String(dtuData.pv1.voltage) + ",";
+    JSON = JSON + "\"c\": " + String(dtuData.pv1.current) + ",";
+    JSON = JSON + "\"p\": " + ((dtuData.pv1.power == -1) ? ("\"--\"") : (String(dtuData.pv1.power))) + ",";
+    JSON = JSON + "\"dE\": " + String(dtuData.pv1.dailyEnergy, 3) + ",";
+    JSON = JSON + "\"tE\": " + String(dtuData.pv1.totalEnergy, 3);
+    JSON = JSON + "},";
+
+    // all inverters and ports of the DTU - same version as the values above
+    const DTUTelemetryTable &telemetry = dtuState.telemetry;
+    JSON = JSON + "\"inverters\": [";
+    for (uint8_t i = 0; i < telemetry.getInverterCount(); i++)
+    {
+        JSON = JSON + (i > 0 ? "," : "") + "{";
+        JSON = JSON + "\"serial\": \"" + DTUTelemetryTable::serialToString(telemetry.inverterSerial[i]) + "\",";
+        JSON = JSON + "\"phases\": " + String(telemetry.inverterPhases[i]) + ",";
+        JSON = JSON + "\"lastUpdate\": " + String(telemetry.inverterLastUpdate[i]) + ",";
+        JSON = JSON + "\"v\": " + String(telemetry.inverterVoltage[i]) + ",";
+        JSON = JSON + "\"c\": " + String(telemetry.inverterCurrent[i]) + ",";
+        JSON = JSON + "\"p\": " + String(telemetry.inverterPower[i]) + ",";
+        JSON = JSON + "\"f\": " + String(telemetry.inverterFrequency[i]) + ",";
+        JSON = JSON + "\"temp\": " + String(telemetry.inverterTemperature[i]) + ",";
+        JSON = JSON + "\"pLim\": " + String(telemetry.inverterPowerLimit[i], 1) + ",";
+        JSON = JSON + "\"ports\": [";
+        boolean firstPort = true;
+        for (uint8_t port = 0; port < DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+        {
+            uint8_t slot = telemetry.getPortIndex(i, port);
+            if (slot == DTU_TELEMETRY_NO_INDEX)
+                continue;
+            JSON = JSON + (firstPort ? "" : ",") + "{";
+            JSON = JSON + "\"port\": " + String(port + 1) + ",";
+            JSON = JSON + "\"v\": " + String(telemetry.portVoltage[slot]) + ",";
+            JSON = JSON + "\"c\": " + String(telemetry.portCurrent[slot]) + ",";
+            JSON = JSON + "\"p\": " + String(telemetry.portPower[slot]) + ",";
+            JSON = JSON + "\"dE\": " + String(telemetry.portEnergyDaily[slot], 3) + ",";
+            JSON = JSON + "\"tE\": " + String(telemetry.portEnergyTotal[slot], 3);
+            JSON = JSON + "}";
+            firstPort = false;
+        }
+        JSON = JSON + "]}";
+    }
+    JSON = JSON + "],";
+    // energy meters attached to the DTU
+    JSON = JSON + "\"meters\": [";
+    for (uint8_t i = 0; i < telemetry.getMeterCount(); i++)
+    {
+        JSON = JSON + (i > 0 ? "," : "") + "{";
+        JSON = JSON + "\"serial\": \"" + DTUTelemetryTable::serialToString(telemetry.meterSerial[i]) + "\",";
+        JSON = JSON + "\"type\": " + String(telemetry.meterDeviceType[i]) + ",";
+        JSON = JSON + "\"lastUpdate\": " + String(telemetry.meterLastUpdate[i]) + ",";
+        JSON = JSON + "\"p\": " + String(telemetry.meterPower[i]) + ",";
+        JSON = JSON + "\"pf\": " + String(telemetry.meterPowerFactor[i], 3) + ",";
+        JSON = JSON + "\"eImport\": " + String(telemetry.meterEnergyImport[i], 2) + ",";
+        JSON = JSON + "\"eExport\": " + String(telemetry.meterEnergyExport[i], 2) + ",";
+        JSON = JSON + "\"fault\": " + String(telemetry.meterFaultCode[i]) + ",";
+        JSON = JSON + "\"phases\": [";
+        for (uint8_t phase = 0; phase < DTU_TELEMETRY_METER_PHASES; phase++)
+        {
+            uint8_t slot = i * DTU_TELEMETRY_METER_PHASES + phase;
+            JSON = JSON + (phase > 0 ? "," : "") + "{";
+            JSON = JSON + "\"v\": " + String(telemetry.meterPhaseVoltage[slot]) + ",";
+            JSON = JSON + "\"c\": " + String(telemetry.meterPhaseCurrent[slot]) + ",";
+            JSON = JSON + "\"p\": " + String(telemetry.meterPhasePower[slot]);
+            JSON = JSON + "}";
+        }
+        JSON = JSON + "]}";
+    }
+    JSON = JSON + "],";
+    JSON = JSON + "\"telemetryDropped\": " + String(telemetry.getDroppedEntries());
     JSON = JSON + "}";
 
     request->send(200, "application/json; charset=utf-8", JSON);
@@ -268,6 +365,9 @@ void DTUwebserver::handleDataJson(AsyncWebServerRequest *request)
 
 void DTUwebserver::handleInfojson(AsyncWebServerRequest *request)
 {
+    inverterData dtuData;
+    dtuInterface.readSnapshotData(dtuData);
+
     String JSON = "{";
     JSON = JSON + "\"chipid\": " + String(platformData.chipID) + ",";
     JSON = JSON + "\"chipType\": \"" + platformData.chipType + "\",";
@@ -304,18 +404,184 @@ void DTUwebserver::handleInfojson(AsyncWebServerRequest *request)
 
     JSON = JSON + "\"dtuConnection\": {";
     JSON = JSON + "\"dtuHostIpDomain\": \"" + String(userConfig.dtuHostIpDomain) + "\",";
-    JSON = JSON + "\"dtuRssi\": " + dtuGlobalData.dtuRssi + ",";
+    JSON = JSON + "\"dtuRssi\": " + dtuData.dtuRssi + ",";
     JSON = JSON + "\"dtuDataCycle\": " + userConfig.dtuUpdateTime + ",";
-    JSON = JSON + "\"dtuResetRequested\": " + dtuGlobalData.dtuResetRequested + ",";
+    JSON = JSON + "\"dtuDataCycleAdaptive\": " + userConfig.dtuUpdateAdaptive + ",";
+    JSON = JSON + "\"dtuDataCycleMin\": " + userConfig.dtuUpdateTimeMin + ",";
+    JSON = JSON + "\"dtuDataCycleMax\": " + userConfig.dtuUpdateTimeMax + ",";
+    JSON = JSON + "\"dtuDataCycleCurrent\": " + dtuInterface.getUpdateInterval() + ",";
+    JSON = JSON + "\"dtuPowerChangeRate\": " + String(dtuInterface.getPowerChangeRate(), 2) + ",";
+    JSON = JSON + "\"dtuResetRequested\": " + dtuData.dtuResetRequested + ",";
     JSON = JSON + "\"dtuCloudPause\": " + userConfig.dtuCloudPauseActive + ",";
     JSON = JSON + "\"dtuCloudPauseTime\": " + userConfig.dtuCloudPauseTime + ",";
     JSON = JSON + "\"dtuRemoteDisplay\": " + userConfig.remoteDisplayActive;
     JSON = JSON + "},";
 
+    const frameAssemblerStats &frameStats = dtuInterface.getFrameStats();
+    JSON = JSON + "\"dtuFrames\": {";
+    JSON = JSON + "\"ok\": " + frameStats.framesOk + ",";
+    JSON = JSON + "\"rejected\": " + frameStats.framesRejected + ",";
+    JSON = JSON + "\"resyncBytes\": " + frameStats.resyncBytes;
+    JSON = JSON + "},";
+
+    const receiveQueueStats &rxStats = dtuInterface.getReceiveStats();
+    JSON = JSON + "\"dtuReceive\": {";
+    JSON = JSON + "\"bytes\": " + rxStats.bytes + ",";
+    JSON = JSON + "\"droppedBytes\": " + rxStats.droppedBytes + ",";
+    JSON = JSON + "\"events\": " + rxStats.events + ",";
+    JSON = JSON + "\"droppedEvents\": " + rxStats.droppedEvents + ",";
+    JSON = JSON + "\"maxFill\": " + rxStats.maxFill;
+    JSON = JSON + "},";
+
+    const realDataDecodeStats &decodeStats = dtuInterface.getDecodeStats();
+    JSON = JSON + "\"dtuDecode\": {";
+    JSON = JSON + "\"decodes\": " + decodeStats.decodes + ",";
+    JSON = JSON + "\"errors\": " + decodeStats.errors + ",";
+    JSON = JSON + "\"lastDecodeUs\": " + decodeStats.lastDecodeUs + ",";
+    JSON = JSON + "\"maxDecodeUs\": " + decodeStats.maxDecodeUs + ",";
+    JSON = JSON + "\"loopStackFreeBytes\": " + decodeStats.minLoopStackFree + ",";
+    JSON = JSON + "\"histPowerErrors\": " + decodeStats.histPowerErrors;
+    JSON = JSON + "},";
+
+    const fingerprintStats &fpStats = dtuInterface.getFingerprintStats();
+    JSON = JSON + "\"dtuDataUpdates\": {";
+    JSON = JSON + "\"forwarded\": " + fpStats.forwarded + ",";
+    JSON = JSON + "\"suppressed\": " + fpStats.suppressed + ",";
+    JSON = JSON + "\"refreshes\": " + fpStats.refreshes + ",";
+    JSON = JSON + "\"unchangedInRow\": " + fpStats.unchangedInRow + ",";
+    JSON = JSON + "\"refreshSeconds\": " + userConfig.dtuUnchangedRefresh;
+    JSON = JSON + "},";
+
+    const heartbeatStats &hbStats = dtuInterface.getHeartbeatStats();
+    JSON = JSON + "\"dtuHeartbeat\": {";
+    JSON = JSON + "\"intervalSeconds\": " + userConfig.dtuHeartbeatInterval + ",";
+    JSON = JSON + "\"sent\": " + hbStats.sent + ",";
+    JSON = JSON + "\"answered\": " + hbStats.answered + ",";
+    JSON = JSON + "\"missed\": " + hbStats.missed + ",";
+    JSON = JSON + "\"missedInRow\": " + hbStats.missedInRow + ",";
+    JSON = JSON + "\"deadLinks\": " + hbStats.deadLinks + ",";
+    JSON = JSON + "\"lastRttMs\": " + hbStats.lastRttMs + ",";
+    JSON = JSON + "\"minRttMs\": " + hbStats.minRttMs + ",";
+    JSON = JSON + "\"maxRttMs\": " + hbStats.maxRttMs + ",";
+    JSON = JSON + "\"avgRttMs\": " + (hbStats.answered > 0 ? hbStats.sumRttMs / hbStats.answered : 0) + ",";
+    // histogram as [upper bound ms, count] - last bucket is open (-1)
+    JSON = JSON + "\"rttHistogram\": [";
+    for (uint8_t i = 0; i < DTU_HEARTBEAT_RTT_BUCKETS; i++)
+    {
+        String bound = (i == DTU_HEARTBEAT_RTT_BUCKETS - 1) ? String("-1") : String(DTUHeartbeat::getBucketBound(i));
+        JSON = JSON + (i > 0 ? "," : "") + "[" + bound + "," + hbStats.rttHistogram[i] + "]";
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "},";
+
+    const reconnectStats &rcStats = dtuInterface.getReconnectStats();
+    JSON = JSON + "\"dtuReconnect\": {";
+    JSON = JSON + "\"attempts\": " + rcStats.attempts + ",";
+    JSON = JSON + "\"connects\": " + rcStats.connects + ",";
+    JSON = JSON + "\"lastAttempts\": " + rcStats.lastAttempts + ",";
+    JSON = JSON + "\"maxAttempts\": " + rcStats.maxAttempts + ",";
+    JSON = JSON + "\"lastConnectMs\": " + rcStats.lastConnectMs + ",";
+    JSON = JSON + "\"maxConnectMs\": " + rcStats.maxConnectMs + ",";
+    JSON = JSON + "\"lastOutageMs\": " + rcStats.lastOutageMs + ",";
+    JSON = JSON + "\"maxOutageMs\": " + rcStats.maxOutageMs + ",";
+    JSON = JSON + "\"currentDelayMs\": " + rcStats.currentDelayMs;
+    JSON = JSON + "},";
+
+    DTUCommandTracker cmdTracker;
+    dtuInterface.readSnapshotCommand(cmdTracker);
+    const commandStats &cmdStats = cmdTracker.getStats();
+    JSON = JSON + "\"dtuPowerLimitCommand\": {";
+    JSON = JSON + "\"state\": \"" + DTUCommandTracker::getStateName(cmdTracker.getState()) + "\",";
+    JSON = JSON + "\"target\": " + cmdTracker.getTarget() + ",";
+    JSON = JSON + "\"retries\": " + cmdTracker.getRetries() + ",";
+    JSON = JSON + "\"commands\": " + cmdStats.commands + ",";
+    JSON = JSON + "\"sent\": " + cmdStats.sent + ",";
+    JSON = JSON + "\"suppressed\": " + cmdStats.suppressed + ",";
+    JSON = JSON + "\"acked\": " + cmdStats.acked + ",";
+    JSON = JSON + "\"rejected\": " + cmdStats.rejected + ",";
+    JSON = JSON + "\"confirmed\": " + cmdStats.confirmed + ",";
+    JSON = JSON + "\"failed\": " + cmdStats.failed + ",";
+    JSON = JSON + "\"totalRetries\": " + cmdStats.retries + ",";
+    JSON = JSON + "\"lastErrCode\": " + cmdStats.lastErrCode + ",";
+    JSON = JSON + "\"lastAckMs\": " + cmdStats.lastAckMs + ",";
+    JSON = JSON + "\"lastEffectiveMs\": " + cmdStats.lastEffectiveMs + ",";
+    // histograms as [upper bound ms, count] - last bucket is open (-1)
+    JSON = JSON + "\"ackHistogram\": [";
+    for (uint8_t i = 0; i < DTU_CMD_LATENCY_BUCKETS; i++)
+    {
+        String bound = (i == DTU_CMD_LATENCY_BUCKETS - 1) ? String("-1") : String(DTUCommandTracker::getAckBound(i));
+        JSON = JSON + (i > 0 ? "," : "") + "[" + bound + "," + cmdStats.ackHistogram[i] + "]";
+    }
+    JSON = JSON + "],";
+    JSON = JSON + "\"effectiveHistogram\": [";
+    for (uint8_t i = 0; i < DTU_CMD_LATENCY_BUCKETS; i++)
+    {
+        String bound = (i == DTU_CMD_LATENCY_BUCKETS - 1) ? String("-1") : String(DTUCommandTracker::getEffectiveBound(i));
+        JSON = JSON + (i > 0 ? "," : "") + "[" + bound + "," + cmdStats.effectiveHistogram[i] + "]";
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "},";
+
+    const DTUCloudPauseLearner &pauseLearner = dtuInterface.getCloudPauseLearner();
+    const cloudPauseStats &cpStats = pauseLearner.getStats();
+    JSON = JSON + "\"dtuCloudPauseLearned\": {";
+    JSON = JSON + "\"pauseSeconds\": " + pauseLearner.getPauseSeconds() + ",";
+    JSON = JSON + "\"maxSeconds\": " + userConfig.dtuCloudPauseTime + ",";
+    JSON = JSON + "\"pauses\": " + cpStats.pauses + ",";
+    JSON = JSON + "\"busyPauses\": " + cpStats.busyPauses + ",";
+    JSON = JSON + "\"failedConnects\": " + cpStats.failedConnects + ",";
+    JSON = JSON + "\"lastBusySeconds\": " + cpStats.lastBusySeconds + ",";
+    JSON = JSON + "\"maxBusySeconds\": " + cpStats.maxBusySeconds + ",";
+    JSON = JSON + "\"lastConnectDelayMs\": " + cpStats.lastConnectDelayMs + ",";
+    JSON = JSON + "\"dataAvailability\": " + String(pauseLearner.getDataAvailability(millis()), 3);
+    JSON = JSON + "},";
+
+    const requestQueueStats &queueStats = dtuInterface.getRequestQueueStats();
+    JSON = JSON + "\"dtuRequestQueue\": {";
+    JSON = JSON + "\"depth\": " + queueStats.depth + ",";
+    JSON = JSON + "\"maxDepth\": " + queueStats.maxDepth + ",";
+    JSON = JSON + "\"enqueued\": " + queueStats.enqueued + ",";
+    JSON = JSON + "\"coalesced\": " + queueStats.coalesced + ",";
+    JSON = JSON + "\"sent\": " + queueStats.sent + ",";
+    JSON = JSON + "\"timeouts\": " + queueStats.timeouts + ",";
+    JSON = JSON + "\"unsolicited\": " + queueStats.unsolicited + ",";
+    JSON = JSON + "\"lastPollCycleMs\": " + queueStats.lastPollCycleMs + ",";
+    JSON = JSON + "\"maxPollCycleMs\": " + queueStats.maxPollCycleMs + ",";
+    JSON = JSON + "\"lastWaitMs\": " + queueStats.lastWaitMs + ",";
+    JSON = JSON + "\"maxWaitMs\": " + queueStats.maxWaitMs + ",";
+    JSON = JSON + "\"avgWaitMs\": " + (queueStats.sent > 0 ? queueStats.sumWaitMs / queueStats.sent : 0) + ",";
+    // requests sent from the cached frames vs. full encodes
+    const requestTemplateStats templateStats = dtuInterface.getRequestTemplateStats();
+    JSON = JSON + "\"templatePatched\": " + templateStats.patched + ",";
+    JSON = JSON + "\"templateEncoded\": " + templateStats.encoded;
+    JSON = JSON + "},";
+
+    const zeroExportStats &zeroStats = zeroExportController.getStats();
+    JSON = JSON + "\"zeroExport\": {";
+    JSON = JSON + "\"active\": " + userConfig.zeroExportActive + ",";
+    JSON = JSON + "\"controlling\": " + zeroExportController.isActive(millis()) + ",";
+    JSON = JSON + "\"meterTopic\": \"" + String(userConfig.zeroExportMeterTopic) + "\",";
+    JSON = JSON + "\"target\": " + userConfig.zeroExportTarget + ",";
+    JSON = JSON + "\"minCommandTime\": " + userConfig.zeroExportMinCommandTime + ",";
+    JSON = JSON + "\"outputPower\": " + String(zeroStats.outputPower, 1) + ",";
+    JSON = JSON + "\"meterUpdates\": " + zeroStats.meterUpdates + ",";
+    JSON = JSON + "\"commands\": " + zeroStats.commands + ",";
+    JSON = JSON + "\"heldByDeadband\": " + zeroStats.heldByDeadband + ",";
+    JSON = JSON + "\"heldByRateLimit\": " + zeroStats.heldByRateLimit + ",";
+    JSON = JSON + "\"clampSkipped\": " + zeroStats.clampSkipped + ",";
+    JSON = JSON + "\"acked\": " + zeroStats.acked + ",";
+    JSON = JSON + "\"trackingError\": " + String(zeroStats.trackingError, 1) + ",";
+    JSON = JSON + "\"trackingErrorAvg\": " + String(zeroStats.trackingErrorAvg, 1) + ",";
+    JSON = JSON + "\"trackingErrorMax\": " + String(zeroStats.trackingErrorMax, 1) + ",";
+    JSON = JSON + "\"lastLatencyMs\": " + zeroStats.lastLatencyMs + ",";
+    JSON = JSON + "\"maxLatencyMs\": " + zeroStats.maxLatencyMs + ",";
+    JSON = JSON + "\"avgLatencyMs\": " + (zeroStats.acked > 0 ? zeroStats.sumLatencyMs / zeroStats.acked : 0);
+    JSON = JSON + "},";
+
     JSON = JSON + "\"wifiConnection\": {";
     JSON = JSON + "\"wifiSsid\": \"" + String(userConfig.wifiSsid) + "\",";
     JSON = JSON + "\"wifiPassword\": \"" + String(userConfig.wifiPassword) + "\",";
-    JSON = JSON + "\"rssiGW\": " + dtuGlobalData.wifi_rssi_gateway + ",";
+    JSON = JSON + "\"rssiGW\": " + dtuData.wifi_rssi_gateway + ",";
     JSON = JSON + "\"wifiScanIsRunning\": " + wifiScanIsRunning + ",";
     JSON = JSON + "\"networkCount\": " + platformData.wifiNetworkCount + ",";
     JSON = JSON + "\"foundNetworks\":" + platformData.wifiFoundNetworks;
@@ -326,6 +592,311 @@ void DTUwebserver::handleInfojson(AsyncWebServerRequest *request)
     request->send(200, "application/json; charset=utf-8", JSON);
 }
 
+void DTUwebserver::handleHistoryJson(AsyncWebServerRequest *request)
+{
+    // the curve is written in the loop - read in place and again if it changed meanwhile
+    const DTUPowerHistory &history = dtuInterface.getPowerHistory();
+    String JSON;
+    boolean consistent = false;
+    for (uint8_t attempt = 0; attempt < SEQLOCK_VERSION_READ_ATTEMPTS && !consistent; attempt++)
+    {
+        uint32_t version = history.getVersion().beginRead();
+        JSON = getHistoryJson(history);
+        consistent = history.getVersion().endRead(version);
+    }
+    if (!consistent)
+    {
+        request->send(503, "application/json; charset=utf-8", "{\"error\": \"history busy - retry\"}");
+        return;
+    }
+    request->send(200, "application/json; charset=utf-8", JSON);
+}
+
+String DTUwebserver::getHistoryJson(const DTUPowerHistory &history)
+{
+    const powerHistoryStats &historyStats = history.getStats();
+
+    String JSON = "{";
+    JSON = JSON + "\"step\": " + DTU_HISTORY_SLOT_SECONDS + ",";
+    JSON = JSON + "\"liveSamples\": " + historyStats.liveSamples + ",";
+    JSON = JSON + "\"backfillRuns\": " + historyStats.backfillRuns + ",";
+    JSON = JSON + "\"backfilledSlots\": " + historyStats.backfilledSlots + ",";
+    JSON = JSON + "\"lastBackfill\": " + historyStats.lastBackfill + ",";
+    // [timestamp, power in W] of all filled slots - oldest first
+    JSON = JSON + "\"power\": [";
+    boolean first = true;
+    for (uint16_t i = 0; i < DTU_HISTORY_SLOTS; i++)
+    {
+        uint32_t timestamp;
+        float power;
+        if (!history.getSample(i, timestamp, power))
+            continue;
+        if (!first)
+            JSON = JSON + ",";
+        JSON = JSON + "[" + timestamp + "," + String(power, 1) + "]";
+        first = false;
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "}";
+    return JSON;
+}
+
+void DTUwebserver::handleEnergyHistoryJson(AsyncWebServerRequest *request)
+{
+    const DTUEnergyHistory &history = dtuInterface.getEnergyHistory();
+    const energyHistoryStats &historyStats = history.getStats();
+
+    // pages of days - page 0 starts with the newest day
+    uint16_t pageSize = 31;
+    uint16_t page = 0;
+    if (request->hasParam("size"))
+    {
+        long size = request->getParam("size")->value().toInt();
+        pageSize = size < 1 ? 1 : (size > 100 ? 100 : uint16_t(size));
+    }
+    if (request->hasParam("page"))
+    {
+        long pageParam = request->getParam("page")->value().toInt();
+        page = pageParam < 0 ? 0 : uint16_t(pageParam);
+    }
+    uint16_t pages = (DTU_ENERGY_HISTORY_DAYS + pageSize - 1) / pageSize;
+
+    String JSON = "{";
+    JSON = JSON + "\"days\": " + history.getRecordCount() + ",";
+    JSON = JSON + "\"maxDays\": " + DTU_ENERGY_HISTORY_DAYS + ",";
+    JSON = JSON + "\"page\": " + page + ",";
+    JSON = JSON + "\"pageSize\": " + pageSize + ",";
+    JSON = JSON + "\"pages\": " + pages + ",";
+    JSON = JSON + "\"fileWrites\": " + historyStats.fileWrites + ",";
+    // [start of day timestamp, energy in kWh] - newest first, days without value are left out
+    JSON = JSON + "\"energy\": [";
+    boolean first = true;
+    for (uint32_t i = uint32_t(page) * pageSize; i < uint32_t(page + 1) * pageSize && i < DTU_ENERGY_HISTORY_DAYS; i++)
+    {
+        dayEnergyRecord record;
+        if (!history.getRecord(i, record))
+            continue;
+        if (!first)
+            JSON = JSON + ",";
+        JSON = JSON + "[" + (record.day * 86400UL) + "," + String(record.energyWh / 1000.0, 3) + "]";
+        first = false;
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "}";
+
+    request->send(200, "application/json; charset=utf-8", JSON);
+}
+
+void DTUwebserver::handleTasksJson(AsyncWebServerRequest *request)
+{
+    String JSON = "{";
+    JSON = JSON + "\"uptimeMs\": " + millis() + ",";
+    JSON = JSON + "\"busyMs\": " + taskScheduler.getBusyMs() + ",";
+    JSON = JSON + "\"tasks\": [";
+    for (uint8_t id = 0; id < taskScheduler.getTaskCount(); id++)
+    {
+        const schedulerTask &task = taskScheduler.getTask(id);
+        const schedulerTaskStats &stats = task.stats;
+        if (id > 0)
+            JSON = JSON + ",";
+        JSON = JSON + "{";
+        JSON = JSON + "\"name\": \"" + task.name + "\",";
+        JSON = JSON + "\"periodMs\": " + task.periodMs + ",";
+        JSON = JSON + "\"deadlineMs\": " + (task.deadlineMs > 0 ? task.deadlineMs : task.periodMs) + ",";
+        JSON = JSON + "\"enabled\": " + (task.enabled ? "true" : "false") + ",";
+        JSON = JSON + "\"runs\": " + stats.runs + ",";
+        JSON = JSON + "\"cpuMs\": " + uint32_t(stats.totalUs / 1000) + ",";
+        JSON = JSON + "\"lastUs\": " + stats.lastUs + ",";
+        JSON = JSON + "\"maxUs\": " + stats.maxUs + ",";
+        JSON = JSON + "\"maxLatenessMs\": " + stats.maxLatenessMs + ",";
+        JSON = JSON + "\"missedDeadlines\": " + stats.missedDeadlines + ",";
+        JSON = JSON + "\"skippedReleases\": " + stats.skippedReleases;
+        JSON = JSON + "}";
+    }
+    JSON = JSON + "],";
+    // display rendering - own task on ESP32
+    const displayRenderStats &render = displayRenderer.getStats();
+    snapshotHandoffStats handoff = displayRenderer.getHandoffStats();
+    JSON = JSON + "\"render\": {";
+    JSON = JSON + "\"ownTask\": " + (displayRenderer.isTaskRunning() ? "true" : "false") + ",";
+    JSON = JSON + "\"core\": " + render.core + ",";
+    JSON = JSON + "\"frames\": " + render.frames + ",";
+    JSON = JSON + "\"cpuMs\": " + uint32_t(render.totalUs / 1000) + ",";
+    JSON = JSON + "\"lastUs\": " + render.lastUs + ",";
+    JSON = JSON + "\"maxUs\": " + render.maxUs + ",";
+    JSON = JSON + "\"stackFreeBytes\": " + render.stackFreeBytes + ",";
+    JSON = JSON + "\"snapshotsPublished\": " + handoff.published + ",";
+    JSON = JSON + "\"snapshotsConsumed\": " + handoff.consumed + ",";
+    JSON = JSON + "\"snapshotsOverwritten\": " + handoff.overwritten;
+    JSON = JSON + "},";
+    // DTU events - latency from the decode of the values (or the post) until each subscriber is done
+    const eventBusStats &events = dtuEventBus.getStats();
+    JSON = JSON + "\"events\": {";
+    JSON = JSON + "\"posted\": " + events.posted + ",";
+    JSON = JSON + "\"dispatched\": " + events.dispatched + ",";
+    JSON = JSON + "\"dropped\": " + events.dropped + ",";
+    JSON = JSON + "\"maxQueued\": " + events.maxQueued + ",";
+    JSON = JSON + "\"subscribers\": [";
+    for (uint8_t id = 0; id < dtuEventBus.getSubscriberCount(); id++)
+    {
+        const eventSubscriber &subscriber = dtuEventBus.getSubscriber(id);
+        const eventSubscriberStats &subStats = subscriber.stats;
+        if (id > 0)
+            JSON = JSON + ",";
+        JSON = JSON + "{";
+        JSON = JSON + "\"name\": \"" + subscriber.name + "\",";
+        JSON = JSON + "\"events\": " + subStats.events + ",";
+        JSON = JSON + "\"lastLatencyUs\": " + subStats.lastLatencyUs + ",";
+        JSON = JSON + "\"avgLatencyUs\": " + uint32_t(subStats.events > 0 ? subStats.sumLatencyUs / subStats.events : 0) + ",";
+        JSON = JSON + "\"maxLatencyUs\": " + subStats.maxLatencyUs + ",";
+        JSON = JSON + "\"lastRuntimeUs\": " + subStats.lastRuntimeUs + ",";
+        JSON = JSON + "\"maxRuntimeUs\": " + subStats.maxRuntimeUs;
+        JSON = JSON + "}";
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "},";
+    // outputs - own queue and worker per sink
+    JSON = JSON + "\"sinks\": [";
+    for (uint8_t i = 0; i < OutputSink::getCount(); i++)
+    {
+        const OutputSink &sink = OutputSink::get(i);
+        const outputSinkStats &sinkStats = sink.getStats();
+        if (i > 0)
+            JSON = JSON + ",";
+        JSON = JSON + "{";
+        JSON = JSON + "\"name\": \"" + sink.getName() + "\",";
+        JSON = JSON + "\"policy\": \"" + OutputSink::getPolicyName(sink.getPolicy()) + "\",";
+        JSON = JSON + "\"ownTask\": " + (sink.hasOwnTask() ? "true" : "false") + ",";
+        JSON = JSON + "\"available\": " + (sink.isAvailable() ? "true" : "false") + ",";
+        JSON = JSON + "\"queued\": " + sink.getQueued() + ",";
+        JSON = JSON + "\"maxQueued\": " + sinkStats.maxQueued + ",";
+        JSON = JSON + "\"enqueued\": " + sinkStats.enqueued + ",";
+        JSON = JSON + "\"delivered\": " + sinkStats.delivered + ",";
+        JSON = JSON + "\"coalesced\": " + sinkStats.coalesced + ",";
+        JSON = JSON + "\"dropped\": " + sinkStats.dropped + ",";
+        JSON = JSON + "\"failed\": " + sinkStats.failed + ",";
+        JSON = JSON + "\"pauses\": " + sinkStats.pauses + ",";
+        JSON = JSON + "\"polls\": " + sinkStats.polls + ",";
+        JSON = JSON + "\"pollsFailed\": " + sinkStats.pollsFailed + ",";
+        JSON = JSON + "\"lastLagMs\": " + sinkStats.lastLagMs + ",";
+        JSON = JSON + "\"maxLagMs\": " + sinkStats.maxLagMs + ",";
+        JSON = JSON + "\"lastLatencyUs\": " + sinkStats.lastLatencyUs + ",";
+        JSON = JSON + "\"maxLatencyUs\": " + sinkStats.maxLatencyUs + ",";
+        JSON = JSON + "\"lastRunUs\": " + sinkStats.lastRunUs + ",";
+        JSON = JSON + "\"maxRunUs\": " + sinkStats.maxRunUs + ",";
+        JSON = JSON + "\"cpuMs\": " + uint32_t(sinkStats.busyUs / 1000);
+        JSON = JSON + "}";
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "}";
+
+    request->send(200, "application/json; charset=utf-8", JSON);
+}
+
+void DTUwebserver::handleDtuTraceJson(AsyncWebServerRequest *request)
+{
+    // the trace is written in the loop - read in place and again if it changed meanwhile
+    const DTUConnectionFsm &fsm = dtuInterface.getConnectionFsm();
+    String JSON;
+    boolean consistent = false;
+    for (uint8_t attempt = 0; attempt < SEQLOCK_VERSION_READ_ATTEMPTS && !consistent; attempt++)
+    {
+        uint32_t version = fsm.getVersion().beginRead();
+        JSON = getDtuTraceJson(fsm);
+        consistent = fsm.getVersion().endRead(version);
+    }
+    if (!consistent)
+    {
+        request->send(503, "application/json; charset=utf-8", "{\"error\": \"trace busy - retry\"}");
+        return;
+    }
+    request->send(200, "application/json; charset=utf-8", JSON);
+}
+
+String DTUwebserver::getDtuTraceJson(const DTUConnectionFsm &fsm)
+{
+    connectionControl dtuConn;
+    dtuInterface.readSnapshotConnection(dtuConn);
+
+    String JSON = "{";
+    JSON = JSON + "\"now\": " + millis() + ",";
+    JSON = JSON + "\"connectState\": \"" + DTUConnectionFsm::getStateName(dtuConn.dtuConnectState) + "\",";
+    JSON = JSON + "\"txrxState\": \"" + DTUConnectionFsm::getTxRxStateName(dtuConn.dtuTxRxState) + "\",";
+    JSON = JSON + "\"transitions\": " + fsm.getTransitions() + ",";
+    // oldest first - time in ms since start
+    JSON = JSON + "\"trace\": [";
+    for (uint8_t i = 0; i < fsm.getTraceCount(); i++)
+    {
+        fsmTraceEntry entry = fsm.getTrace(i);
+        if (i > 0)
+            JSON = JSON + ",";
+        JSON = JSON + "{\"ms\": " + entry.millis + ",";
+        if (entry.type == DTU_FSM_TRACE_CONNECTION)
+        {
+            JSON = JSON + "\"type\": \"connection\",";
+            JSON = JSON + "\"event\": \"" + DTUConnectionFsm::getEventName(entry.event) + "\",";
+            JSON = JSON + "\"from\": \"" + DTUConnectionFsm::getStateName(entry.from) + "\",";
+            JSON = JSON + "\"to\": \"" + DTUConnectionFsm::getStateName(entry.to) + "\"}";
+        }
+        else
+        {
+            JSON = JSON + "\"type\": \"txrx\",";
+            JSON = JSON + "\"from\": \"" + DTUConnectionFsm::getTxRxStateName(entry.from) + "\",";
+            JSON = JSON + "\"to\": \"" + DTUConnectionFsm::getTxRxStateName(entry.to) + "\"}";
+        }
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "}";
+    return JSON;
+}
+
+void DTUwebserver::handleSiteJson(AsyncWebServerRequest *request)
+{
+    siteTotals totals = dtuSite.getTotals();
+
+    String JSON = "{";
+    JSON = JSON + "\"freeHeap\": " + ESP.getFreeHeap() + ",";
+    JSON = JSON + "\"totals\": {";
+    JSON = JSON + "\"dtuCount\": " + totals.dtuCount + ",";
+    JSON = JSON + "\"dtusOnline\": " + totals.dtusOnline + ",";
+    JSON = JSON + "\"p\": " + String(totals.power) + ",";
+    JSON = JSON + "\"dE\": " + String(totals.dailyEnergy, 3) + ",";
+    JSON = JSON + "\"tE\": " + String(totals.totalEnergy, 3);
+    JSON = JSON + "},";
+
+    // index 0 - main DTU
+    JSON = JSON + "\"dtus\": [";
+    for (uint8_t i = 0; i < dtuSite.getCount(); i++)
+    {
+        inverterData siteData;
+        connectionControl siteConnection;
+        dtuSite.readSnapshotData(i, siteData);
+        dtuSite.readSnapshotConnection(i, siteConnection);
+        const requestQueueStats &queueStats = dtuSite.getRequestQueueStats(i);
+        if (i > 0)
+            JSON = JSON + ",";
+        JSON = JSON + "{";
+        JSON = JSON + "\"host\": \"" + String(dtuSite.getHost(i)) + "\",";
+        JSON = JSON + "\"dtuConnState\": " + siteConnection.dtuConnectState + ",";
+        JSON = JSON + "\"dtuErrorState\": " + siteConnection.dtuErrorState + ",";
+        JSON = JSON + "\"online\": " + siteConnection.dtuConnectionOnline + ",";
+        JSON = JSON + "\"cloudPause\": " + siteConnection.dtuActiveOffToCloudUpdate + ",";
+        JSON = JSON + "\"lastResponse\": " + siteData.lastRespTimestamp + ",";
+        JSON = JSON + "\"dataCycle\": " + dtuSite.getUpdateInterval(i) + ",";
+        JSON = JSON + "\"lastPollCycleMs\": " + queueStats.lastPollCycleMs + ",";
+        JSON = JSON + "\"maxPollCycleMs\": " + queueStats.maxPollCycleMs + ",";
+        JSON = JSON + "\"pLim\": " + ((siteData.powerLimit == 254) ? ("\"--\"") : (String(siteData.powerLimit))) + ",";
+        JSON = JSON + "\"p\": " + ((siteData.grid.power == -1) ? ("\"--\"") : (String(siteData.grid.power))) + ",";
+        JSON = JSON + "\"dE\": " + String(siteData.grid.dailyEnergy, 3) + ",";
+        JSON = JSON + "\"tE\": " + String(siteData.grid.totalEnergy, 3);
+        JSON = JSON + "}";
+    }
+    JSON = JSON + "]";
+    JSON = JSON + "}";
+
+    request->send(200, "application/json; charset=utf-8", JSON);
+}
+
 // user config
 void DTUwebserver::handleUpdateWifiSettings(AsyncWebServerRequest *request)
 {
@@ -399,6 +970,14 @@ void DTUwebserver::handleUpdateDtuSettings(AsyncWebServerRequest *request)
         userConfig.dtuUpdateTime = dtuDataCycle.toInt();
         if (userConfig.dtuUpdateTime < 1)
             userConfig.dtuUpdateTime = 1; // fix zero entry
+        // lower bound of the adaptive update - below 31 s only after the warning in the settings dialog
+        if (request->hasParam("dtuDataCycleMinSend", true))
+        {
+            long dtuDataCycleMin = request->getParam("dtuDataCycleMinSend", true)->value().toInt();
+            userConfig.dtuUpdateTimeMin = dtuDataCycleMin < 1 ? DTU_POLL_MIN_INTERVAL : dtuDataCycleMin;
+            if (userConfig.dtuUpdateTimeMax < userConfig.dtuUpdateTimeMin)
+                userConfig.dtuUpdateTimeMax = userConfig.dtuUpdateTimeMin;
+        }
         if (dtuCloudPause == "1")
             userConfig.dtuCloudPauseActive = true;
         else
@@ -420,6 +999,7 @@ void DTUwebserver::handleUpdateDtuSettings(AsyncWebServerRequest *request)
         // change the dtu interface settings
         dtuInterface.setServer(userConfig.dtuHostIpDomain);
         dtuConnection.preventCloudErrors = userConfig.dtuCloudPauseActive;
+        dtuInterface.markChanged();
 
         String JSON = "{";
         JSON = JSON + "\"dtuHostIpDomain\": \"" + userConfig.dtuHostIpDomain + "\",";
@@ -564,6 +1144,7 @@ void DTUwebserver::handleUpdatePowerLimit(AsyncWebServerRequest *request)
             else
                 dtuGlobalData.powerLimitSet = gotLimit;
             dtuGlobalData.powerLimitSetUpdate = true;
+            dtuInterface.markChanged();
 
             Serial.println("WEB:\t\t got SetLimit: " + String(dtuGlobalData.powerLimitSet) + " - current limit: " + String(dtuGlobalData.powerLimit) + " %");
 
@@ -1,5 +1,6 @@
 #include <display.h>
 #include <dtuInterface.h>
+#include <displayRenderer.h>
 
 U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
 
@@ -26,14 +27,16 @@ void Display::setRemoteDisplayMode(bool remoteDisplayActive)
     lastDisplayData.remoteDisplayActive = remoteDisplayActive;
 }
 
-void Display::renderScreen(String time, String version)
+void Display::renderScreen(const displaySnapshot &snapshot)
 {
+    currentData = snapshot;
+
     displayTicks++;
     if (displayTicks > 1200)
         displayTicks = 0; // after 1 minute restart
 
-    lastDisplayData.version = version.c_str();
-    lastDisplayData.formattedTime = time.c_str();
+    lastDisplayData.version = currentData.version;
+    lastDisplayData.formattedTime = currentData.formattedTime;
 
     // every 50 milliseconds
     checkChangedValues();
@@ -60,12 +63,12 @@ void Display::renderScreen(String time, String version)
 void Display::drawScreen()
 {
     // store last shown value
-    lastDisplayData.totalYieldDay = dtuGlobalData.grid.dailyEnergy;
-    lastDisplayData.totalYieldTotal = dtuGlobalData.grid.totalEnergy;
-    lastDisplayData.rssiGW = dtuGlobalData.wifi_rssi_gateway;
-    lastDisplayData.rssiDTU = dtuGlobalData.dtuRssi;
-    lastDisplayData.totalPower = round(dtuGlobalData.grid.power);
-    lastDisplayData.powerLimit = dtuGlobalData.powerLimit;
+    lastDisplayData.totalYieldDay = currentData.dailyEnergy;
+    lastDisplayData.totalYieldTotal = currentData.totalEnergy;
+    lastDisplayData.rssiGW = currentData.rssiGW;
+    lastDisplayData.rssiDTU = currentData.rssiDTU;
+    lastDisplayData.totalPower = round(currentData.gridPower);
+    lastDisplayData.powerLimit = currentData.powerLimit;
 
     u8g2.clearBuffer();
     if (brightness == 0)
@@ -84,9 +87,9 @@ void Display::drawScreen()
 
         // main screen
 
-        if (dtuConnection.dtuConnectState == DTU_STATE_CONNECTED)
+        if (currentData.dtuConnectState == DTU_STATE_CONNECTED)
             drawMainDTUOnline();
-        else if (dtuConnection.dtuConnectState == DTU_STATE_CLOUD_PAUSE)
+        else if (currentData.dtuConnectState == DTU_STATE_CLOUD_PAUSE)
             drawMainDTUOnline(true);
         // else if (lastDisplayData.remoteDisplayActive)
         //     drawMainDTUOnline();
@@ -122,8 +125,8 @@ void Display::drawMainDTUOnline(bool pause)
 {
     // main screen
 
-    String wattage = ((dtuGlobalData.grid.power == -1) ? ("--") : String(lastDisplayData.totalPower));
-    String powerLimit = ((dtuGlobalData.powerLimit == 254) ? ("--") : String(lastDisplayData.powerLimit));
+    String wattage = ((currentData.gridPower == -1) ? ("--") : String(lastDisplayData.totalPower));
+    String powerLimit = ((currentData.powerLimit == 254) ? ("--") : String(lastDisplayData.powerLimit));
 
     u8g2.setFont(u8g2_font_logisoso28_tf);
     u8g2_uint_t width = u8g2.getUTF8Width(wattage.c_str());
@@ -284,7 +287,7 @@ void Display::drawFooter()
 void Display::checkChangedValues()
 {
     valueChanged = false;
-    if (lastDisplayData.totalPower != round(dtuGlobalData.grid.power))
+    if (lastDisplayData.totalPower != round(currentData.gridPower))
         valueChanged = true;
 }
 
@@ -310,7 +313,7 @@ void Display::setBrightnessAuto()
 void Display::checkNightMode()
 {
     // get currentTime in minutes to 00:00 of current day from current time in minutes to 1.1.1970 00:00
-    uint16_t currentTime = (platformData.currentNTPtime / 60) % 1440;
+    uint16_t currentTime = (currentData.currentNTPtime / 60) % 1440;
     // Serial.print("current time in minutes today: " + String(currentTime) + " - start: " + String(userConfig.displayNightmodeStart) + " - end: " + String(userConfig.displayNightmodeEnd) + " - current brightness: " + String(brightness) + " - dtuState: " + String(dtuConnection.dtuConnectState));
     if (userConfig.displayNightMode)
     {
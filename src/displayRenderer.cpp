@@ -0,0 +1,98 @@
+#include <displayRenderer.h>
+#include <display.h>
+#include <displayTFT.h>
+
+DisplayRenderer displayRenderer;
+
+void DisplayRenderer::begin(uint8_t displayType, Display *oled, DisplayTFT *tft)
+{
+    this->displayType = displayType;
+    this->oled = oled;
+    this->tft = tft;
+#if defined(ESP32)
+    if (taskRunning)
+        return;
+    BaseType_t created = xTaskCreatePinnedToCore(renderTask, "render", DISPLAY_RENDER_STACK, this, DISPLAY_RENDER_PRIORITY, nullptr, DISPLAY_RENDER_CORE);
+    taskRunning = (created == pdPASS);
+    if (taskRunning)
+        Serial.println("DISPLAY:\t render task started on core " + String(DISPLAY_RENDER_CORE) + " (loop on core " + String(xPortGetCoreID()) + ")");
+    else
+        Serial.println(F("DISPLAY:\t render task could not be created - rendering in the loop"));
+#endif
+}
+
+void DisplayRenderer::publish()
+{
+    handoff.beginWrite().sequence = ++sequence;
+    handoff.publish();
+    // no render task - draw in the loop
+    if (!taskRunning)
+        renderFrame();
+}
+
+void DisplayRenderer::publishMessage(const char *text, const char *text2)
+{
+    displaySnapshot &snapshot = handoff.beginWrite();
+    snapshot.screen = DISPLAY_SCREEN_MESSAGE;
+    strlcpy(snapshot.text, text, sizeof(snapshot.text));
+    strlcpy(snapshot.text2, text2, sizeof(snapshot.text2));
+    publish();
+}
+
+void DisplayRenderer::renderFrame()
+{
+    handoff.consume();
+    const displaySnapshot &snapshot = handoff.read();
+    if (snapshot.sequence == 0)
+        return;
+
+    unsigned long start = micros();
+    if (snapshot.screen == DISPLAY_SCREEN_MESSAGE)
+    {
+        // redraw only if the text changed - the message screen is drawn on a blank screen
+        if (strcmp(snapshot.text, lastText) == 0 && strcmp(snapshot.text2, lastText2) == 0)
+            return;
+        strlcpy(lastText, snapshot.text, sizeof(lastText));
+        strlcpy(lastText2, snapshot.text2, sizeof(lastText2));
+        if (displayType == DISPLAY_TYPE_OLED)
+            oled->drawUpdateMode(snapshot.text, snapshot.text2);
+        else
+            tft->drawUpdateMode(snapshot.text, snapshot.text2);
+    }
+    else
+    {
+        lastText[0] = '\0';
+        lastText2[0] = '\0';
+        if (displayType == DISPLAY_TYPE_OLED)
+            oled->renderScreen(snapshot);
+        else
+            tft->renderScreen(snapshot);
+    }
+
+    uint32_t runtime = micros() - start;
+    stats.frames++;
+    stats.lastUs = runtime;
+    stats.totalUs += runtime;
+    if (runtime > stats.maxUs)
+        stats.maxUs = runtime;
+#if defined(ESP32)
+    stats.core = xPortGetCoreID();
+    if (taskRunning)
+        stats.stackFreeBytes = uxTaskGetStackHighWaterMark(nullptr);
+#else
+    stats.core = 0;
+#endif
+}
+
+#if defined(ESP32)
+void DisplayRenderer::renderTask(void *instance)
+{
+    DisplayRenderer *renderer = static_cast<DisplayRenderer *>(instance);
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        renderer->renderFrame();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(DISPLAY_RENDER_PERIOD_MS));
+    }
+}
+#endif
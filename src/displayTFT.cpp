@@ -1,5 +1,6 @@
 #include <displayTFT.h>
 #include <dtuInterface.h>
+#include <displayRenderer.h>
 
 #ifdef ARDUINO_ARCH_ESP8266
 ADC_MODE(ADC_VCC); // Read the supply voltage
@@ -43,14 +44,16 @@ void DisplayTFT::setRemoteDisplayMode(bool remoteDisplayActive)
 }
 
 // function has to be called every 50 milliseconds
-void DisplayTFT::renderScreen(String time, String version)
+void DisplayTFT::renderScreen(const displaySnapshot &snapshot)
 {
+    currentData = snapshot;
+
     displayTicks++;
     if (displayTicks > 1200)
         displayTicks = 0; // after 1 minute restart
 
-    lastDisplayData.version = version.c_str();
-    lastDisplayData.formattedTime = time.c_str();
+    lastDisplayData.version = currentData.version;
+    lastDisplayData.formattedTime = currentData.formattedTime;
 
     // every 50 milliseconds
     checkChangedValues();
@@ -62,7 +65,7 @@ void DisplayTFT::renderScreen(String time, String version)
     // every 0.5 second
     if (displayTicks % 10 == 0)
     {
-        drawScreen(version, time); // draw every 0.5 second
+        drawScreen(String(currentData.version), String(currentData.formattedTime)); // draw every 0.5 second
         // Serial.println("Displaying screen");
     }
 
@@ -88,29 +91,29 @@ void DisplayTFT::renderScreen(String time, String version)
 void DisplayTFT::drawScreen(String version, String time)
 {
     // store last shown value
-    lastDisplayData.totalYieldDay = dtuGlobalData.grid.dailyEnergy;
-    lastDisplayData.totalYieldTotal = dtuGlobalData.grid.totalEnergy;
-    lastDisplayData.rssiGW = dtuGlobalData.wifi_rssi_gateway;
-    lastDisplayData.rssiDTU = dtuGlobalData.dtuRssi;
-    lastDisplayData.totalPower = round(dtuGlobalData.grid.power);
-    lastDisplayData.powerLimit = dtuGlobalData.powerLimit;
+    lastDisplayData.totalYieldDay = currentData.dailyEnergy;
+    lastDisplayData.totalYieldTotal = currentData.totalEnergy;
+    lastDisplayData.rssiGW = currentData.rssiGW;
+    lastDisplayData.rssiDTU = currentData.rssiDTU;
+    lastDisplayData.totalPower = round(currentData.gridPower);
+    lastDisplayData.powerLimit = currentData.powerLimit;
 
     drawHeader(version);
 
     // main screen
     if (!isNight)
     {
-        if (dtuConnection.dtuConnectState == DTU_STATE_CONNECTED)
+        if (currentData.dtuConnectState == DTU_STATE_CONNECTED)
         {
             drawMainDTUOnline();
             displayState = 0;
         }
-        else if (dtuConnection.dtuConnectState == DTU_STATE_CLOUD_PAUSE)
+        else if (currentData.dtuConnectState == DTU_STATE_CLOUD_PAUSE)
         {
             drawMainDTUOnline(true);
             displayState = 0;
         }
-        else if (dtuConnection.dtuConnectionOnline == false)
+        else if (currentData.dtuConnectionOnline == false)
         {
             drawMainDTUOffline();
             displayState = 3;
@@ -344,7 +347,7 @@ void DisplayTFT::drawFooter(String time)
 void DisplayTFT::checkChangedValues()
 {
     valueChanged = false;
-    if (lastDisplayData.totalPower != round(dtuGlobalData.grid.power))
+    if (lastDisplayData.totalPower != round(currentData.gridPower))
         valueChanged = true;
 }
 
@@ -379,7 +382,7 @@ void DisplayTFT::checkNightMode()
     boolean isNightBySchedule = false;
     boolean isNightByOffline = false;
     // get currentTime in minutes to 00:00 of current day from current time in minutes to 1.1.1970 00:00
-    uint16_t currentTime = (platformData.currentNTPtime / 60) % 1440;
+    uint16_t currentTime = (currentData.currentNTPtime / 60) % 1440;
     // Serial.println("current time in minutes today: " + String(currentTime) + " - start: " + String(userConfig.displayNightmodeStart) + " - end: " + String(userConfig.displayNightmodeEnd) + " - current brightness: " + String(brightness) + " - dtuState: " + String(dtuConnection.dtuConnectState) + " night: " + String(isNight));
     if (userConfig.displayNightMode)
     {
@@ -399,12 +402,12 @@ void DisplayTFT::checkNightMode()
         }
 
         // offline trigger
-        if (dtuConnection.dtuConnectionOnline == true)
+        if (currentData.dtuConnectionOnline == true)
         {
             isNightByOffline = false;
             // Serial.println("DisplayTFT:\t >> night mode activated by offline trigger");
         }
-        else if (dtuConnection.dtuConnectionOnline == false)
+        else if (currentData.dtuConnectionOnline == false)
         {
             isNightByOffline = true;
             // Serial.println("DisplayTFT:\t >> day mode activated by offline trigger");
@@ -0,0 +1,12 @@
+#include "dtuCRC16.h"
+
+constexpr uint16_t DTUCRC16::table[256];
+
+uint16_t DTUCRC16::calc(const uint8_t *data, size_t len, uint16_t crc)
+{
+    while (len--)
+    {
+        crc = update(crc, *data++);
+    }
+    return crc;
+}
@@ -0,0 +1,72 @@
+#include "dtuChangeFingerprint.h"
+
+DTUChangeFingerprint::DTUChangeFingerprint()
+{
+    memset(history, 0, sizeof(history));
+}
+
+uint32_t DTUChangeFingerprint::add(uint32_t hash, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        hash ^= (value & 0xFF);
+        hash *= DTU_FINGERPRINT_PRIME;
+        value >>= 8;
+    }
+    return hash;
+}
+
+uint32_t DTUChangeFingerprint::add(uint32_t hash, uint64_t value)
+{
+    hash = add(hash, uint32_t(value));
+    return add(hash, uint32_t(value >> 32));
+}
+
+boolean DTUChangeFingerprint::addRealData(uint32_t fingerprint)
+{
+    boolean changed = !valid || fingerprint != stats.lastFingerprint;
+    valid = true;
+    stats.lastFingerprint = fingerprint;
+    if (changed)
+    {
+        changePending = true;
+        stats.unchangedInRow = 0;
+    }
+    else if (stats.unchangedInRow < 0xFFFF)
+        stats.unchangedInRow++;
+
+    history[historyIndex] = fingerprint;
+    historyIndex = (historyIndex + 1) % DTU_FINGERPRINT_HISTORY;
+    if (historyCount < DTU_FINGERPRINT_HISTORY)
+        historyCount++;
+    return changed;
+}
+
+boolean DTUChangeFingerprint::isHanging() const
+{
+    if (historyCount < DTU_FINGERPRINT_HISTORY)
+        return false;
+    for (uint8_t i = 1; i < DTU_FINGERPRINT_HISTORY; i++)
+    {
+        if (history[i] != history[0])
+            return false;
+    }
+    return true;
+}
+
+boolean DTUChangeFingerprint::checkForward(uint32_t configFingerprint, uint32_t timestamp, uint16_t refreshSeconds)
+{
+    boolean changed = !valid || changePending || configFingerprint != lastConfigFingerprint;
+    if (!changed && timestamp - lastForwardTime < refreshSeconds)
+    {
+        stats.suppressed++;
+        return false;
+    }
+    if (!changed)
+        stats.refreshes++;
+    stats.forwarded++;
+    changePending = false;
+    lastConfigFingerprint = configFingerprint;
+    lastForwardTime = timestamp;
+    return true;
+}
@@ -0,0 +1,92 @@
+#include "dtuCloudPauseLearner.h"
+
+void DTUCloudPauseLearner::setMaxSeconds(uint16_t seconds)
+{
+    maxSeconds = seconds < DTU_CLOUD_PAUSE_MIN_SECONDS ? DTU_CLOUD_PAUSE_MIN_SECONDS : seconds;
+    // start with the full configured pause - learning only shortens it
+    if (stats.pauses == 0 || pauseSeconds > maxSeconds)
+        pauseSeconds = maxSeconds;
+}
+
+void DTUCloudPauseLearner::pauseStarted(unsigned long now)
+{
+    pauseStart = now;
+    observing = false;
+    busy = false;
+    stats.pauses++;
+}
+
+void DTUCloudPauseLearner::pauseEnded(unsigned long now)
+{
+    pauseEnd = now;
+    observing = true;
+}
+
+void DTUCloudPauseLearner::connectFailed()
+{
+    if (!observing)
+        return;
+    busy = true;
+    stats.failedConnects++;
+}
+
+void DTUCloudPauseLearner::connected(unsigned long now)
+{
+    if (!observing)
+        return;
+    stats.lastConnectDelayMs = now - pauseEnd;
+    if (stats.lastConnectDelayMs > DTU_CLOUD_PAUSE_CONNECT_DELAY_MS)
+        busy = true;
+}
+
+void DTUCloudPauseLearner::dataReceived(unsigned long now, boolean fresh)
+{
+    if (!observing)
+        return;
+    // old timestamp - DTU has not measured again yet, keep waiting for fresh data
+    if (!fresh)
+    {
+        busy = true;
+        return;
+    }
+    finishObservation(now);
+}
+
+void DTUCloudPauseLearner::finishObservation(unsigned long now)
+{
+    observing = false;
+    if (busy)
+    {
+        stats.busyPauses++;
+        stats.lastBusySeconds = (now - pauseStart) / 1000;
+        if (stats.lastBusySeconds > stats.maxBusySeconds)
+            stats.maxBusySeconds = stats.lastBusySeconds;
+        uint32_t learned = uint32_t(stats.lastBusySeconds) + DTU_CLOUD_PAUSE_MARGIN_SECONDS;
+        pauseSeconds = learned > maxSeconds ? maxSeconds : uint16_t(learned);
+    }
+    else if (pauseSeconds >= DTU_CLOUD_PAUSE_MIN_SECONDS + DTU_CLOUD_PAUSE_SHRINK_SECONDS)
+    {
+        pauseSeconds -= DTU_CLOUD_PAUSE_SHRINK_SECONDS;
+    }
+}
+
+void DTUCloudPauseLearner::setOnline(boolean online, unsigned long now)
+{
+    if (trackingStart == 0)
+        trackingStart = now;
+    if (online == this->online)
+        return;
+    if (this->online)
+        onlineMs += now - onlineSince;
+    else
+        onlineSince = now;
+    this->online = online;
+}
+
+float DTUCloudPauseLearner::getDataAvailability(unsigned long now) const
+{
+    if (trackingStart == 0 || now == trackingStart)
+        return 0;
+    uint64_t total = onlineMs + (online ? now - onlineSince : 0);
+    return float(total) / float(now - trackingStart);
+}
@@ -0,0 +1,171 @@
+#include "dtuCommandTracker.h"
+
+static const uint32_t ackBounds[DTU_CMD_LATENCY_BUCKETS] = DTU_CMD_ACK_BOUNDS;
+static const uint32_t effectiveBounds[DTU_CMD_LATENCY_BUCKETS] = DTU_CMD_EFFECTIVE_BOUNDS;
+
+boolean DTUCommandTracker::request(uint8_t limit, unsigned long now)
+{
+    if (limit == target)
+    {
+        // a retry of this limit is due or already queued - keep its retry count
+        if (retryDue || retryQueued)
+        {
+            stats.suppressed++;
+            return false;
+        }
+        boolean running = state == DTU_CMD_STATE_IN_FLIGHT || state == DTU_CMD_STATE_ACKED;
+        boolean holdOff = state == DTU_CMD_STATE_FAILED && now - failedAt < DTU_CMD_FAILED_HOLDOFF_MS;
+        // a confirmed limit requested again was changed on another way (e.g. cloud) - send it again
+        if (running || holdOff)
+        {
+            stats.suppressed++;
+            return false;
+        }
+    }
+    target = limit;
+    state = DTU_CMD_STATE_IDLE;
+    retries = 0;
+    retryDue = false;
+    retryQueued = false;
+    setAt = now;
+    stats.commands++;
+    return true;
+}
+
+void DTUCommandTracker::sent(int64_t tid, unsigned long now)
+{
+    this->tid = tid;
+    state = DTU_CMD_STATE_IN_FLIGHT;
+    retryDue = false;
+    retryQueued = false;
+    sentAt = now;
+    stats.sent++;
+}
+
+boolean DTUCommandTracker::acked(int64_t tid, int32_t errCode, unsigned long now)
+{
+    if (state != DTU_CMD_STATE_IN_FLIGHT)
+        return false;
+    // tid 0 - firmware does not echo the transaction id
+    if (tid != 0 && tid != this->tid)
+        Serial.println("DTUcommand:\t response for unknown tid " + String(int32_t(tid)) + " - expected " + String(int32_t(this->tid)));
+    stats.lastErrCode = errCode;
+    if (errCode != 0)
+    {
+        stats.rejected++;
+        retryOrFail(now, "rejected");
+        return true;
+    }
+    state = DTU_CMD_STATE_ACKED;
+    ackAt = now;
+    stats.acked++;
+    stats.lastAckMs = now - setAt;
+    addToHistogram(stats.ackHistogram, ackBounds, stats.lastAckMs);
+    return true;
+}
+
+void DTUCommandTracker::limitReported(uint8_t limit, unsigned long now)
+{
+    if (limit != target || (state != DTU_CMD_STATE_IN_FLIGHT && state != DTU_CMD_STATE_ACKED))
+        return;
+    state = DTU_CMD_STATE_CONFIRMED;
+    stats.confirmed++;
+    stats.lastEffectiveMs = now - setAt;
+    addToHistogram(stats.effectiveHistogram, effectiveBounds, stats.lastEffectiveMs);
+    Serial.println("DTUcommand:\t power limit " + String(limit) + " % effective after " + String(stats.lastEffectiveMs) + " ms (retries: " + String(retries) + ")");
+}
+
+boolean DTUCommandTracker::checkRetry(unsigned long now)
+{
+    if (state == DTU_CMD_STATE_IN_FLIGHT && now - sentAt >= DTU_CMD_ACK_TIMEOUT_MS)
+        retryOrFail(now, "no response");
+    else if (state == DTU_CMD_STATE_ACKED && now - ackAt >= DTU_CMD_CONFIRM_TIMEOUT_MS)
+        retryOrFail(now, "not effective");
+    if (!retryDue)
+        return false;
+    // pending until sent() - the command waits in the request queue
+    retryDue = false;
+    retryQueued = true;
+    return true;
+}
+
+uint32_t DTUCommandTracker::getTimeout(unsigned long now) const
+{
+    unsigned long deadline;
+    if (state == DTU_CMD_STATE_IN_FLIGHT)
+        deadline = sentAt + DTU_CMD_ACK_TIMEOUT_MS;
+    else if (state == DTU_CMD_STATE_ACKED)
+        deadline = ackAt + DTU_CMD_CONFIRM_TIMEOUT_MS;
+    else
+        return 0;
+    long remaining = long(deadline - now);
+    return remaining > 0 ? uint32_t(remaining) : 1;
+}
+
+void DTUCommandTracker::connectionLost()
+{
+    // sent again with the next set request after the reconnect - the request queue is cleared
+    if (state == DTU_CMD_STATE_IN_FLIGHT)
+        state = DTU_CMD_STATE_IDLE;
+    retryDue = false;
+    retryQueued = false;
+}
+
+void DTUCommandTracker::retryOrFail(unsigned long now, const char *reason)
+{
+    if (retries < DTU_CMD_MAX_RETRIES)
+    {
+        retries++;
+        stats.retries++;
+        retryDue = true;
+        // waiting for the retry to be sent
+        state = DTU_CMD_STATE_IDLE;
+        Serial.println("DTUcommand:\t power limit " + String(target) + " % " + String(reason) + " - retry " + String(retries) + "/" + String(DTU_CMD_MAX_RETRIES));
+        return;
+    }
+    state = DTU_CMD_STATE_FAILED;
+    failedAt = now;
+    stats.failed++;
+    Serial.println("DTUcommand:\t power limit " + String(target) + " % " + String(reason) + " - failed after " + String(retries) + " retries");
+}
+
+void DTUCommandTracker::addToHistogram(uint32_t *histogram, const uint32_t *bounds, uint32_t value)
+{
+    for (uint8_t i = 0; i < DTU_CMD_LATENCY_BUCKETS; i++)
+    {
+        if (value <= bounds[i])
+        {
+            histogram[i]++;
+            return;
+        }
+    }
+}
+
+const char *DTUCommandTracker::getStateName(uint8_t state)
+{
+    switch (state)
+    {
+    case DTU_CMD_STATE_IDLE:
+        return "idle";
+    case DTU_CMD_STATE_IN_FLIGHT:
+        return "inFlight";
+    case DTU_CMD_STATE_ACKED:
+        return "acked";
+    case DTU_CMD_STATE_CONFIRMED:
+        return "confirmed";
+    case DTU_CMD_STATE_FAILED:
+        return "failed";
+    default:
+        return "unknown";
+    }
+}
+
+uint32_t DTUCommandTracker::getAckBound(uint8_t bucket)
+{
+    return bucket < DTU_CMD_LATENCY_BUCKETS ? ackBounds[bucket] : 0;
+}
+
+uint32_t DTUCommandTracker::getEffectiveBound(uint8_t bucket)
+{
+    return bucket < DTU_CMD_LATENCY_BUCKETS ? effectiveBounds[bucket] : 0;
+}
@@ -0,0 +1,164 @@
+#include "dtuConnectionFsm.h"
+
+struct fsmTransition
+{
+    uint8_t from;
+    uint8_t event;
+    uint8_t to;
+};
+
+// first matching row wins
+static const fsmTransition transitionTable[] = {
+    // stopped is final - client is freed
+    {DTU_STATE_STOPPED, DTU_EV_ANY, DTU_STATE_STOPPED},
+    {DTU_STATE_ANY, DTU_EV_STOP, DTU_STATE_STOPPED},
+
+    {DTU_STATE_OFFLINE, DTU_EV_CONNECT_START, DTU_STATE_TRY_RECONNECT},
+    {DTU_STATE_CONNECT_ERROR, DTU_EV_CONNECT_START, DTU_STATE_TRY_RECONNECT},
+    {DTU_STATE_CLOUD_PAUSE, DTU_EV_CONNECT_START, DTU_STATE_TRY_RECONNECT},
+    {DTU_STATE_DTU_REBOOT, DTU_EV_CONNECT_START, DTU_STATE_TRY_RECONNECT},
+    {DTU_STATE_TRY_RECONNECT, DTU_EV_CONNECT_FAILED, DTU_STATE_CONNECT_ERROR},
+    {DTU_STATE_TRY_RECONNECT, DTU_EV_CONNECT_TIMEOUT, DTU_STATE_CONNECT_ERROR},
+    {DTU_STATE_ANY, DTU_EV_CONNECTED, DTU_STATE_CONNECTED},
+    {DTU_STATE_ANY, DTU_EV_ERROR, DTU_STATE_CONNECT_ERROR},
+
+    {DTU_STATE_CONNECTED, DTU_EV_CLOUD_PAUSE, DTU_STATE_CLOUD_PAUSE},
+    {DTU_STATE_CONNECTED, DTU_EV_REBOOT, DTU_STATE_DTU_REBOOT},
+    {DTU_STATE_CONNECTED, DTU_EV_LINK_DEAD, DTU_STATE_OFFLINE},
+
+    // closing for the cloud pause keeps the pause state
+    {DTU_STATE_CONNECTED, DTU_EV_DISCONNECTED, DTU_STATE_OFFLINE},
+    {DTU_STATE_TRY_RECONNECT, DTU_EV_DISCONNECTED, DTU_STATE_OFFLINE},
+    {DTU_STATE_CONNECT_ERROR, DTU_EV_DISCONNECTED, DTU_STATE_OFFLINE},
+    {DTU_STATE_DTU_REBOOT, DTU_EV_DISCONNECTED, DTU_STATE_OFFLINE},
+
+    // no data for minutes (e.g. night) - values are reset and the connection counts as offline
+    {DTU_STATE_ANY, DTU_EV_DATA_TIMEOUT, DTU_STATE_OFFLINE},
+};
+
+boolean DTUConnectionFsm::handleEvent(uint8_t event, uint8_t &state, unsigned long now)
+{
+    for (uint8_t i = 0; i < sizeof(transitionTable) / sizeof(transitionTable[0]); i++)
+    {
+        const fsmTransition &row = transitionTable[i];
+        if ((row.from != DTU_STATE_ANY && row.from != state) || (row.event != DTU_EV_ANY && row.event != event))
+            continue;
+        if (row.to == state)
+            return false;
+        Serial.println("DTUfsm:\t\t " + String(getStateName(state)) + " -> " + String(getStateName(row.to)) + " (" + String(getEventName(event)) + ")");
+        version.beginWrite();
+        addTrace(DTU_FSM_TRACE_CONNECTION, state, row.to, event, now);
+        transitions++;
+        version.endWrite();
+        state = row.to;
+        return true;
+    }
+    return false;
+}
+
+void DTUConnectionFsm::traceTxRx(uint8_t from, uint8_t to, unsigned long now)
+{
+    if (from == to)
+        return;
+    version.beginWrite();
+    addTrace(DTU_FSM_TRACE_TXRX, from, to, DTU_EV_ANY, now);
+    version.endWrite();
+}
+
+void DTUConnectionFsm::addTrace(uint8_t type, uint8_t from, uint8_t to, uint8_t event, unsigned long now)
+{
+    fsmTraceEntry &entry = trace[traceHead];
+    entry.millis = now;
+    entry.type = type;
+    entry.from = from;
+    entry.to = to;
+    entry.event = event;
+    traceHead = (traceHead + 1) % DTU_FSM_TRACE_SIZE;
+    if (traceCount < DTU_FSM_TRACE_SIZE)
+        traceCount++;
+}
+
+const fsmTraceEntry &DTUConnectionFsm::getTrace(uint8_t index) const
+{
+    uint8_t oldest = (traceHead + DTU_FSM_TRACE_SIZE - traceCount) % DTU_FSM_TRACE_SIZE;
+    return trace[(oldest + index) % DTU_FSM_TRACE_SIZE];
+}
+
+const char *DTUConnectionFsm::getStateName(uint8_t state)
+{
+    switch (state)
+    {
+    case DTU_STATE_OFFLINE:
+        return "offline";
+    case DTU_STATE_CONNECTED:
+        return "connected";
+    case DTU_STATE_CLOUD_PAUSE:
+        return "cloudPause";
+    case DTU_STATE_TRY_RECONNECT:
+        return "tryReconnect";
+    case DTU_STATE_DTU_REBOOT:
+        return "dtuReboot";
+    case DTU_STATE_CONNECT_ERROR:
+        return "connectError";
+    case DTU_STATE_STOPPED:
+        return "stopped";
+    default:
+        return "unknown";
+    }
+}
+
+const char *DTUConnectionFsm::getTxRxStateName(uint8_t state)
+{
+    switch (state)
+    {
+    case DTU_TXRX_STATE_IDLE:
+        return "idle";
+    case DTU_TXRX_STATE_WAIT_APPGETHISTPOWER:
+        return "waitAppGetHistPower";
+    case DTU_TXRX_STATE_WAIT_REALDATANEW:
+        return "waitRealDataNew";
+    case DTU_TXRX_STATE_WAIT_GETCONFIG:
+        return "waitGetConfig";
+    case DTU_TXRX_STATE_WAIT_COMMAND:
+        return "waitCommand";
+    case DTU_TXRX_STATE_WAIT_RESTARTDEVICE:
+        return "waitRestartDevice";
+    case DTU_TXRX_STATE_WAIT_HEARTBEAT:
+        return "waitHeartbeat";
+    case DTU_TXRX_STATE_ERROR:
+        return "error";
+    default:
+        return "unknown";
+    }
+}
+
+const char *DTUConnectionFsm::getEventName(uint8_t event)
+{
+    switch (event)
+    {
+    case DTU_EV_CONNECT_START:
+        return "connectStart";
+    case DTU_EV_CONNECTED:
+        return "connected";
+    case DTU_EV_CONNECT_FAILED:
+        return "connectFailed";
+    case DTU_EV_CONNECT_TIMEOUT:
+        return "connectTimeout";
+    case DTU_EV_ERROR:
+        return "error";
+    case DTU_EV_DISCONNECTED:
+        return "disconnected";
+    case DTU_EV_CLOUD_PAUSE:
+        return "cloudPause";
+    case DTU_EV_REBOOT:
+        return "reboot";
+    case DTU_EV_DATA_TIMEOUT:
+        return "dataTimeout";
+    case DTU_EV_LINK_DEAD:
+        return "linkDead";
+    case DTU_EV_STOP:
+        return "stop";
+    default:
+        return "none";
+    }
+}
@@ -0,0 +1,146 @@
+#include "dtuEnergyHistory.h"
+
+#define SECONDS_PER_DAY 86400UL
+
+struct energyHistoryFileHeader
+{
+  uint32_t magic = DTU_ENERGY_HISTORY_FILE_MAGIC;
+  uint32_t days = DTU_ENERGY_HISTORY_DAYS;
+};
+
+DTUEnergyHistory::DTUEnergyHistory()
+{
+    memset(records, 0, sizeof(records));
+    memset(dirty, 0, sizeof(dirty));
+}
+
+void DTUEnergyHistory::begin(const char *filePath)
+{
+    // already loaded - e.g. services restarted after wifi reconnect
+    if (this->filePath != nullptr)
+        return;
+    this->filePath = filePath;
+    File file = LittleFS.open(filePath, "r");
+    energyHistoryFileHeader header;
+    energyHistoryFileHeader expected;
+    if (!file || file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != expected.magic || header.days != expected.days ||
+        file.read((uint8_t *)records, sizeof(records)) != sizeof(records))
+    {
+        if (file)
+            file.close();
+        Serial.println("DTUenergyHist:\t no valid history in '" + String(filePath) + "' - creating new file");
+        memset(records, 0, sizeof(records));
+        createFile();
+        return;
+    }
+    file.close();
+
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < DTU_ENERGY_HISTORY_DAYS; i++)
+    {
+        // drop records that do not belong to their slot
+        if (records[i].day != 0 && records[i].day % DTU_ENERGY_HISTORY_DAYS != i)
+            records[i] = dayEnergyRecord();
+        if (records[i].day > newestDay)
+            newestDay = records[i].day;
+        if (records[i].day != 0)
+            count++;
+    }
+    stats.fileLoaded = true;
+    Serial.println("DTUenergyHist:\t loaded " + String(count) + " days from '" + String(filePath) + "'");
+}
+
+boolean DTUEnergyHistory::createFile()
+{
+    File file = LittleFS.open(filePath, "w");
+    if (!file)
+    {
+        Serial.println("DTUenergyHist:\t failed to create '" + String(filePath) + "'");
+        return false;
+    }
+    energyHistoryFileHeader header;
+    file.write((const uint8_t *)&header, sizeof(header));
+    file.write((const uint8_t *)records, sizeof(records));
+    file.close();
+    memset(dirty, 0, sizeof(dirty));
+    return true;
+}
+
+void DTUEnergyHistory::save()
+{
+    savePending = false;
+    if (filePath == nullptr)
+        return;
+    File file = LittleFS.open(filePath, "r+");
+    if (!file)
+    {
+        createFile();
+        return;
+    }
+    for (uint16_t i = 0; i < DTU_ENERGY_HISTORY_DAYS; i++)
+    {
+        if (!(dirty[i / 8] & (1 << (i % 8))))
+            continue;
+        // cleared before the write - a record changed meanwhile is written with the next save
+        dirty[i / 8] &= ~(1 << (i % 8));
+        // fixed record position - only the changed records are written
+        file.seek(sizeof(energyHistoryFileHeader) + i * sizeof(dayEnergyRecord));
+        file.write((const uint8_t *)&records[i], sizeof(dayEnergyRecord));
+        stats.fileWrites++;
+    }
+    file.close();
+}
+
+boolean DTUEnergyHistory::setRecord(uint32_t day, uint32_t energyWh)
+{
+    // older than the table
+    if (day == 0 || day + DTU_ENERGY_HISTORY_DAYS <= newestDay)
+        return false;
+    uint16_t slot = day % DTU_ENERGY_HISTORY_DAYS;
+    if (records[slot].day == day && records[slot].energyWh == energyWh)
+        return false;
+    records[slot].day = day;
+    records[slot].energyWh = energyWh;
+    dirty[slot / 8] |= 1 << (slot % 8);
+    if (day > newestDay)
+        newestDay = day;
+    return true;
+}
+
+void DTUEnergyHistory::addLiveEnergy(uint32_t timestamp, float dailyEnergy)
+{
+    uint32_t day = timestamp / SECONDS_PER_DAY;
+    // first value of a new day - the final value of the last day goes to the file
+    if (day > newestDay && newestDay != 0)
+        savePending = true;
+    uint32_t energyWh = uint32_t(dailyEnergy * 1000 + 0.5f);
+    uint16_t slot = day % DTU_ENERGY_HISTORY_DAYS;
+    // daily energy only rises during the day - a reset before midnight must not lower the record
+    if (records[slot].day == day && records[slot].energyWh >= energyWh)
+        return;
+    setRecord(day, energyWh);
+}
+
+boolean DTUEnergyHistory::getRecord(uint16_t index, dayEnergyRecord &record) const
+{
+    if (newestDay == 0 || index >= DTU_ENERGY_HISTORY_DAYS || index > newestDay)
+        return false;
+    uint32_t day = newestDay - index;
+    const dayEnergyRecord &slot = records[day % DTU_ENERGY_HISTORY_DAYS];
+    if (slot.day != day)
+        return false;
+    record = slot;
+    return true;
+}
+
+uint16_t DTUEnergyHistory::getRecordCount() const
+{
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < DTU_ENERGY_HISTORY_DAYS; i++)
+    {
+        if (records[i].day != 0 && records[i].day + DTU_ENERGY_HISTORY_DAYS > newestDay)
+            count++;
+    }
+    return count;
+}
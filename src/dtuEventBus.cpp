@@ -0,0 +1,138 @@
+#include "dtuEventBus.h"
+
+DTUEventBus dtuEventBus;
+
+#if defined(ESP32)
+static portMUX_TYPE eventBusMux = portMUX_INITIALIZER_UNLOCKED;
+#define EVENT_BUS_LOCK() portENTER_CRITICAL(&eventBusMux)
+#define EVENT_BUS_UNLOCK() portEXIT_CRITICAL(&eventBusMux)
+#else
+// ESP8266 - async callbacks and loop do not run concurrently
+#define EVENT_BUS_LOCK()
+#define EVENT_BUS_UNLOCK()
+#endif
+
+uint8_t DTUEventBus::subscribe(const char *name, uint8_t typeMask, dtuEventHandler handler, void *context)
+{
+    if (subscriberCount >= DTU_EVENT_MAX_SUBSCRIBERS)
+    {
+        Serial.println("EVENTS:\t\t no free subscriber slot for '" + String(name) + "' (max. " + String(DTU_EVENT_MAX_SUBSCRIBERS) + ")");
+        return DTU_EVENT_NO_SUBSCRIBER;
+    }
+    EVENT_BUS_LOCK();
+    uint8_t id = subscriberCount;
+    eventSubscriber &subscriber = subscribers[id];
+    subscriber.name = name;
+    subscriber.typeMask = typeMask;
+    subscriber.handler = handler;
+    subscriber.context = context;
+    subscriberCount++;
+    EVENT_BUS_UNLOCK();
+    return id;
+}
+
+void DTUEventBus::post(uint8_t type, DTUInterface *source, int32_t value, uint32_t originUs)
+{
+    EVENT_BUS_LOCK();
+    if (queueCount == DTU_EVENT_QUEUE_SIZE)
+    {
+        // keep the newest - drop the oldest
+        queueHead = (queueHead + 1) % DTU_EVENT_QUEUE_SIZE;
+        queueCount--;
+        stats.dropped++;
+    }
+    stats.posted++;
+    dtuEvent &event = queue[(queueHead + queueCount) % DTU_EVENT_QUEUE_SIZE];
+    event.sequence = stats.posted;
+    event.type = type;
+    event.source = source;
+    event.value = value;
+    event.originUs = (originUs != 0) ? originUs : micros();
+    queueCount++;
+    if (queueCount > stats.maxQueued)
+        stats.maxQueued = queueCount;
+    EVENT_BUS_UNLOCK();
+}
+
+boolean DTUEventBus::takeNext(dtuEvent &event)
+{
+    EVENT_BUS_LOCK();
+    boolean available = queueCount > 0;
+    if (available)
+    {
+        event = queue[queueHead];
+        queueHead = (queueHead + 1) % DTU_EVENT_QUEUE_SIZE;
+        queueCount--;
+    }
+    EVENT_BUS_UNLOCK();
+    return available;
+}
+
+void DTUEventBus::dispatch()
+{
+    dtuEvent event;
+    while (takeNext(event))
+    {
+        stats.dispatched++;
+        for (uint8_t id = 0; id < subscriberCount; id++)
+        {
+            eventSubscriber &subscriber = subscribers[id];
+            if (!(subscriber.typeMask & DTU_EVENT_MASK(event.type)))
+                continue;
+            uint32_t start = micros();
+            subscriber.handler(event, subscriber.context);
+            uint32_t end = micros();
+
+            eventSubscriberStats &subStats = subscriber.stats;
+            uint32_t runtime = end - start;
+            uint32_t latency = end - event.originUs;
+            subStats.events++;
+            subStats.lastRuntimeUs = runtime;
+            if (runtime > subStats.maxRuntimeUs)
+                subStats.maxRuntimeUs = runtime;
+            subStats.lastLatencyUs = latency;
+            subStats.sumLatencyUs += latency;
+            if (latency > subStats.maxLatencyUs)
+                subStats.maxLatencyUs = latency;
+        }
+    }
+}
+
+void DTUEventBus::resetStats()
+{
+    stats = eventBusStats();
+    for (uint8_t id = 0; id < subscriberCount; id++)
+        subscribers[id].stats = eventSubscriberStats();
+}
+
+void DTUEventBus::printStats() const
+{
+    Serial.println("EVENTS:\t\t posted: " + String(stats.posted) + " - dispatched: " + String(stats.dispatched) + " - dropped: " + String(stats.dropped) + " - max. queued: " + String(stats.maxQueued));
+    for (uint8_t id = 0; id < subscriberCount; id++)
+    {
+        const eventSubscriberStats &subStats = subscribers[id].stats;
+        unsigned long avgLatency = subStats.events > 0 ? (unsigned long)(subStats.sumLatencyUs / subStats.events) : 0;
+        Serial.printf("EVENTS:\t\t %2u %-10s events: %7lu latency avg: %8lu us max: %8lu us - handler max: %7lu us\n",
+                      id, subscribers[id].name, (unsigned long)subStats.events, avgLatency,
+                      (unsigned long)subStats.maxLatencyUs, (unsigned long)subStats.maxRuntimeUs);
+    }
+}
+
+const char *DTUEventBus::getTypeName(uint8_t type)
+{
+    switch (type)
+    {
+    case DTU_EVENT_NEW_SAMPLE:
+        return "newSample";
+    case DTU_EVENT_STATE_CHANGE:
+        return "stateChange";
+    case DTU_EVENT_LIMIT_ACK:
+        return "limitAck";
+    case DTU_EVENT_CLOUD_PAUSE_START:
+        return "cloudPauseStart";
+    case DTU_EVENT_CLOUD_PAUSE_END:
+        return "cloudPauseEnd";
+    default:
+        return "unknown";
+    }
+}
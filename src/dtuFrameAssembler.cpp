@@ -0,0 +1,139 @@
+#include "dtuFrameAssembler.h"
+
+DTUFrameAssembler::DTUFrameAssembler(DTUReceiveQueue &queue) : queue(queue) {}
+
+bool DTUFrameAssembler::nextFrame(dtuFrameHeader &header, pb_istream_t &payload, uint32_t limit)
+{
+    // a frame still handed out is released implicitly
+    releaseFrame();
+
+    size_t fill = queue.available(limit);
+    while (fill >= 2)
+    {
+        // search for start of frame
+        if (queue.peekByte(0) != 0x48 || queue.peekByte(1) != 0x4d)
+        {
+            queue.consume(1);
+            fill--;
+            stats.resyncBytes++;
+            continue;
+        }
+        if (fill < DTU_FRAME_HEADER_SIZE)
+            return false;
+
+        size_t frameLen = (size_t(queue.peekByte(8)) << 8) | queue.peekByte(9);
+        if (frameLen < DTU_FRAME_HEADER_SIZE || frameLen > DTU_FRAME_MAX_LENGTH)
+        {
+            // not a valid header - skip the 'H' and search again
+            rejectFrame("invalid frame length", frameLen);
+            queue.consume(1);
+            fill--;
+            continue;
+        }
+        // wait for the rest of the frame - frameLen is below the queue size, so there is always space for it
+        if (fill < frameLen)
+            return false;
+
+        uint16_t frameCRC = (uint16_t(queue.peekByte(6)) << 8) | queue.peekByte(7);
+        if (calcPayloadCRC(frameLen) != frameCRC)
+        {
+            rejectFrame("CRC mismatch for frame with length", frameLen);
+            queue.consume(1);
+            fill--;
+            continue;
+        }
+
+        header.cmdHigh = queue.peekByte(2);
+        header.cmdLow = queue.peekByte(3);
+        header.crc = frameCRC;
+        header.length = frameLen;
+
+        currentFrameLen = frameLen;
+        streamOffset = DTU_FRAME_HEADER_SIZE;
+        payload.callback = &DTUFrameAssembler::readPayload;
+        payload.state = this;
+        payload.bytes_left = frameLen - DTU_FRAME_HEADER_SIZE;
+        payload.errmsg = NULL;
+
+        stats.framesOk++;
+        return true;
+    }
+    // single byte left which can not be the start of a frame
+    if (fill == 1 && queue.peekByte(0) != 0x48)
+    {
+        queue.consume(1);
+        stats.resyncBytes++;
+    }
+    return false;
+}
+
+bool DTUFrameAssembler::rewindFrame(pb_istream_t &payload)
+{
+    if (currentFrameLen == 0)
+        return false;
+    streamOffset = DTU_FRAME_HEADER_SIZE;
+    payload.callback = &DTUFrameAssembler::readPayload;
+    payload.state = this;
+    payload.bytes_left = currentFrameLen - DTU_FRAME_HEADER_SIZE;
+    payload.errmsg = NULL;
+    return true;
+}
+
+void DTUFrameAssembler::releaseFrame()
+{
+    if (currentFrameLen > 0)
+    {
+        queue.consume(currentFrameLen);
+        currentFrameLen = 0;
+    }
+}
+
+void DTUFrameAssembler::discard(uint32_t limit)
+{
+    releaseFrame();
+    size_t count = queue.available(limit);
+    queue.consume(count);
+    stats.resyncBytes += count;
+}
+
+void DTUFrameAssembler::rejectFrame(const char *reason, size_t frameLen)
+{
+    stats.framesRejected++;
+    // a garbage stream is rejected at every 'H' - log only one line per interval, the stats count all
+    uint32_t now = millis();
+    if (lastRejectLogMs != 0 && now - lastRejectLogMs < DTU_FRAME_LOG_INTERVAL_MS)
+    {
+        rejectsNotLogged++;
+        return;
+    }
+    Serial.println("DTUframes:\t " + String(reason) + ": " + String(frameLen) + " - resync (" + String(rejectsNotLogged) + " more rejected since the last report)");
+    lastRejectLogMs = now;
+    rejectsNotLogged = 0;
+}
+
+uint16_t DTUFrameAssembler::calcPayloadCRC(size_t frameLen) const
+{
+    // payload can wrap around the end of the ring - calc over both parts
+    const uint8_t *chunk;
+    size_t payloadLen = frameLen - DTU_FRAME_HEADER_SIZE;
+    size_t firstChunk = queue.peek(DTU_FRAME_HEADER_SIZE, payloadLen, chunk);
+    uint16_t crc16 = DTUCRC16::calc(chunk, firstChunk);
+    queue.peek(DTU_FRAME_HEADER_SIZE + firstChunk, payloadLen - firstChunk, chunk);
+    return DTUCRC16::calc(chunk, payloadLen - firstChunk, crc16);
+}
+
+bool DTUFrameAssembler::readPayload(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+    DTUFrameAssembler *assembler = static_cast<DTUFrameAssembler *>(stream->state);
+    // bytes_left is already checked by nanopb, so the payload is never overrun here
+    if (buf != NULL)
+    {
+        const uint8_t *chunk;
+        size_t firstChunk = assembler->queue.peek(assembler->streamOffset, count, chunk);
+        memcpy(buf, chunk, firstChunk);
+        assembler->queue.peek(assembler->streamOffset + firstChunk, count - firstChunk, chunk);
+        memcpy(buf + firstChunk, chunk, count - firstChunk);
+    }
+    assembler->streamOffset += count;
+    return true;
+}
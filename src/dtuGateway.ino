@@ -18,13 +18,18 @@
 
 #include <base/webserver.h>
 #include <base/platformData.h>
+#include <base/taskScheduler.h>
 
 #include <display.h>
 #include <displayTFT.h>
+#include <displayRenderer.h>
 
 #include <dtuInterface.h>
+#include <dtuSite.h>
+#include <outputSink.h>
 
 #include <mqttHandler.h>
+#include <zeroExportController.h>
 
 #include "Config.h"
 
@@ -33,20 +38,19 @@ baseDataStruct platformData;
 
 baseUpdateInfoStruct updateInfo;
 
-const long interval50ms = 50;   // interval (milliseconds)
-const long interval100ms = 100; // interval (milliseconds)
-const long intervalShort = 1;   // interval (seconds)
-const long interval5000ms = 5;  // interval (seconds)
-const long intervalLong = 60;   // interval (seconds)
-unsigned long previousMillis50ms = 0;
-unsigned long previousMillis100ms = 0;
-unsigned long previousMillisShort = 1704063600;  // in seconds
-unsigned long previousMillis5000ms = 1704063600; // in seconds
-unsigned long previousMillisLong = 1704063600;
+// periodic jobs of the main loop - run by the task scheduler
+#define TASK_DISPLAY_PERIOD_MS 50
+#define TASK_CONTROL_PERIOD_MS 100
+#define TASK_SECOND_PERIOD_MS 1000
+#define TASK_STATUS_PERIOD_MS 5000
+#define TASK_NTP_PERIOD_MS 60000
+#define LOOP_TASK_COUNT 6
+uint8_t loopTasks[LOOP_TASK_COUNT];
 
 #define WIFI_RETRY_TIME_SECONDS 30
 #define WIFI_RETRY_TIMEOUT_SECONDS 15
 #define RECONNECTS_ARRAY_SIZE 50
+#define OPENHAB_LIMIT_POLL_MS 1000 // power limit item - polled by the openhab sink worker
 unsigned long reconnects[RECONNECTS_ARRAY_SIZE];
 int reconnectsCnt = -1; // first needed run inkrement to 0
 
@@ -112,6 +116,11 @@ DisplayTFT displayTFT;
 
 DTUInterface dtuInterface("192.168.0.254"); // initialize with default IP
 
+// outputs of the DTU values - each with its own queue and worker, see addOutputSinks()
+OutputSink mqttSink("mqtt", OUTPUT_SINK_POLICY_COALESCE);
+OutputSink openhabSink("openhab", OUTPUT_SINK_POLICY_COALESCE);
+OutputSink serialSink("serial", OUTPUT_SINK_POLICY_DROP_OLDEST);
+
 MQTTHandler mqttHandler(userConfig.mqttBrokerIpDomain, userConfig.mqttBrokerPort, userConfig.mqttBrokerUser, userConfig.mqttBrokerPassword, userConfig.mqttUseTLS);
 
 boolean checkWifiTask()
@@ -537,6 +546,11 @@ String getMessageFromOpenhab(String key)
       {
         payload = http.getString();
       }
+      else if (httpCode < 0)
+      {
+        // no answer at all - not only a missing item
+        payload = "connectError";
+      }
       http.end();
       return payload;
     }
@@ -552,15 +566,28 @@ String getMessageFromOpenhab(String key)
     return "connectError";
   }
 }
+// power limit read by the openhab sink worker - taken over by the loop, see applyPowerSetFromOpenHab()
+volatile uint8_t openhabLimitSet = 0;
+volatile boolean openhabLimitSetNew = false;
+
 // get PowerSet data from openhab
+// poll of the openhab sink - ESP32: in its worker task, the blocking GET does not delay the loop
 // uint8_t lastOpenhabLimit = 255;
-boolean getPowerSetDataFromOpenHab()
+boolean getPowerSetDataFromOpenHab(void *context)
 {
+  if (!userConfig.openhabActive || userConfig.remoteDisplayActive || WiFi.status() != WL_CONNECTED)
+    return true;
+
   uint8_t gotLimit = 0;
   uint8_t newLimit = 0;
   bool conversionSuccess = false;
 
   String openhabMessage = getMessageFromOpenhab(String(userConfig.openItemPrefix) + "_PowerLimitSet");
+  if (openhabMessage == "connectError")
+  {
+    // the sink pauses - the value updates as well, the next try after the pause
+    return false;
+  }
   if (openhabMessage.length() > 0)
   {
     gotLimit = openhabMessage.toInt();
@@ -581,8 +608,24 @@ boolean getPowerSetDataFromOpenHab()
   else
   {
     Serial.println("OPENHAB:\t\t got wrong data for SetLimit: " + openhabMessage);
-    return false;
+    // host reached - no reason to pause the sink
+    return true;
   }
+  // the loop owns the DTU data - hand over the limit
+  openhabLimitSet = newLimit;
+  openhabLimitSetNew = true;
+  // lastOpenhabLimit = newLimit;
+  return true;
+}
+
+// takes over the last power limit polled from openhab - in the loop
+void applyPowerSetFromOpenHab()
+{
+  if (!openhabLimitSetNew)
+    return;
+  // flag first - a limit polled in between is taken now and again in the next run
+  openhabLimitSetNew = false;
+  uint8_t newLimit = openhabLimitSet;
   if (dtuGlobalData.powerLimitSet != newLimit)// && lastOpenhabLimit != 255)
   {
     // Serial.println("OPENHAB:\t\t got new OH Limit: " + String(dtuGlobalData.powerLimitSet) + " - last OH limit: " + String(lastOpenhabLimit) + " %");
@@ -590,120 +633,397 @@ boolean getPowerSetDataFromOpenHab()
     dtuGlobalData.powerLimitSet = newLimit;
     Serial.println(" -> got new OH Limit: " + String(dtuGlobalData.powerLimitSet) + " %");
     dtuGlobalData.powerLimitSetUpdate = true;
+    dtuInterface.markChanged();
   }
-  // lastOpenhabLimit = newLimit;
-  return true;
 }
 
 // update all values to openhab
-boolean updateValueToOpenhab()
+boolean updateValueToOpenhab(const inverterData &data)
 {
-  boolean sendOk = postMessageToOpenhab(String(userConfig.openItemPrefix) + "Grid_U", (String)dtuGlobalData.grid.voltage);
+  boolean sendOk = postMessageToOpenhab(String(userConfig.openItemPrefix) + "Grid_U", (String)data.grid.voltage);
   if (sendOk)
   {
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "Grid_I", (String)dtuGlobalData.grid.current);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "Grid_P", (String)dtuGlobalData.grid.power);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV_E_day", String(dtuGlobalData.grid.dailyEnergy, 3));
-    if (dtuGlobalData.grid.totalEnergy != 0)
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "Grid_I", (String)data.grid.current);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "Grid_P", (String)data.grid.power);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV_E_day", String(data.grid.dailyEnergy, 3));
+    if (data.grid.totalEnergy != 0)
     {
-      postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV_E_total", String(dtuGlobalData.grid.totalEnergy, 3));
+      postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV_E_total", String(data.grid.totalEnergy, 3));
     }
 
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_U", (String)dtuGlobalData.pv0.voltage);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_I", (String)dtuGlobalData.pv0.current);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_P", (String)dtuGlobalData.pv0.power);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_E_day", String(dtuGlobalData.pv0.dailyEnergy, 3));
-    if (dtuGlobalData.pv0.totalEnergy != 0)
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_U", (String)data.pv0.voltage);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_I", (String)data.pv0.current);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_P", (String)data.pv0.power);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_E_day", String(data.pv0.dailyEnergy, 3));
+    if (data.pv0.totalEnergy != 0)
     {
-      postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_E_total", String(dtuGlobalData.pv0.totalEnergy, 3));
+      postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV1_E_total", String(data.pv0.totalEnergy, 3));
     }
 
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_U", (String)dtuGlobalData.pv1.voltage);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_I", (String)dtuGlobalData.pv1.current);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_P", (String)dtuGlobalData.pv1.power);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_E_day", String(dtuGlobalData.pv1.dailyEnergy, 3));
-    if (dtuGlobalData.pv1.totalEnergy != 0)
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_U", (String)data.pv1.voltage);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_I", (String)data.pv1.current);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_P", (String)data.pv1.power);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_E_day", String(data.pv1.dailyEnergy, 3));
+    if (data.pv1.totalEnergy != 0)
     {
-      postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_E_total", String(dtuGlobalData.pv1.totalEnergy, 3));
+      postMessageToOpenhab(String(userConfig.openItemPrefix) + "PV2_E_total", String(data.pv1.totalEnergy, 3));
     }
 
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "_Temp", (String)dtuGlobalData.inverterTemp);
-    if (dtuGlobalData.powerLimit != -1)
-      postMessageToOpenhab(String(userConfig.openItemPrefix) + "_PowerLimit", (String)dtuGlobalData.powerLimit);
-    postMessageToOpenhab(String(userConfig.openItemPrefix) + "_WifiRSSI", (String)dtuGlobalData.dtuRssi);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "_Temp", (String)data.inverterTemp);
+    if (data.powerLimit != -1)
+      postMessageToOpenhab(String(userConfig.openItemPrefix) + "_PowerLimit", (String)data.powerLimit);
+    postMessageToOpenhab(String(userConfig.openItemPrefix) + "_WifiRSSI", (String)data.dtuRssi);
+    Serial.println(F("OpenHAB:\t\t updated values were sent"));
+  }
+  // first item not accepted - openhab not reachable
+  return sendOk;
+}
+
+// all inverters/ ports of the main DTU - per serial namespace (inverters/<serial>/P, inverters/<serial>/port1/P, ...)
+void updateTelemetryValuesToMqtt(const DTUTelemetryTable &telemetry)
+{
+  static uint32_t lastPublished[DTU_TELEMETRY_MAX_INVERTERS] = {0};
+  for (uint8_t i = 0; i < telemetry.getInverterCount(); i++)
+  {
+    // only inverters with new values since the last publish
+    if (telemetry.inverterLastUpdate[i] == lastPublished[i])
+      continue;
+    lastPublished[i] = telemetry.inverterLastUpdate[i];
+    String prefix = "inverters_" + DTUTelemetryTable::serialToString(telemetry.inverterSerial[i]) + "_";
+    mqttHandler.publishStandardData(prefix + "U", String(telemetry.inverterVoltage[i]));
+    mqttHandler.publishStandardData(prefix + "I", String(telemetry.inverterCurrent[i]));
+    mqttHandler.publishStandardData(prefix + "P", String(telemetry.inverterPower[i]));
+    mqttHandler.publishStandardData(prefix + "F", String(telemetry.inverterFrequency[i]));
+    mqttHandler.publishStandardData(prefix + "Temp", String(telemetry.inverterTemperature[i]));
+    mqttHandler.publishStandardData(prefix + "PowerLimit", String(telemetry.inverterPowerLimit[i], 1));
+    for (uint8_t port = 0; port < DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+    {
+      uint8_t slot = telemetry.getPortIndex(i, port);
+      if (slot == DTU_TELEMETRY_NO_INDEX)
+        continue;
+      String portPrefix = prefix + "port" + String(port + 1) + "_";
+      mqttHandler.publishStandardData(portPrefix + "U", String(telemetry.portVoltage[slot]));
+      mqttHandler.publishStandardData(portPrefix + "I", String(telemetry.portCurrent[slot]));
+      mqttHandler.publishStandardData(portPrefix + "P", String(telemetry.portPower[slot]));
+      mqttHandler.publishStandardData(portPrefix + "dailyEnergy", String(telemetry.portEnergyDaily[slot], 3));
+      if (telemetry.portEnergyTotal[slot] != 0)
+        mqttHandler.publishStandardData(portPrefix + "totalEnergy", String(telemetry.portEnergyTotal[slot], 3));
+    }
+  }
+  // energy meters attached to the DTU - meters/<serial>/P, meters/<serial>/P1, ...
+  static uint32_t lastMeterPublished[DTU_TELEMETRY_MAX_METERS] = {0};
+  for (uint8_t i = 0; i < telemetry.getMeterCount(); i++)
+  {
+    if (telemetry.meterLastUpdate[i] == lastMeterPublished[i])
+      continue;
+    lastMeterPublished[i] = telemetry.meterLastUpdate[i];
+    String prefix = "meters_" + DTUTelemetryTable::serialToString(telemetry.meterSerial[i]) + "_";
+    mqttHandler.publishStandardData(prefix + "P", String(telemetry.meterPower[i]));
+    for (uint8_t phase = 0; phase < DTU_TELEMETRY_METER_PHASES; phase++)
+    {
+      uint8_t slot = i * DTU_TELEMETRY_METER_PHASES + phase;
+      mqttHandler.publishStandardData(prefix + "P" + String(phase + 1), String(telemetry.meterPhasePower[slot]));
+      mqttHandler.publishStandardData(prefix + "U" + String(phase + 1), String(telemetry.meterPhaseVoltage[slot]));
+      mqttHandler.publishStandardData(prefix + "I" + String(phase + 1), String(telemetry.meterPhaseCurrent[slot]));
+    }
+    mqttHandler.publishStandardData(prefix + "PF", String(telemetry.meterPowerFactor[i], 3));
+    mqttHandler.publishStandardData(prefix + "energyImport", String(telemetry.meterEnergyImport[i], 2));
+    mqttHandler.publishStandardData(prefix + "energyExport", String(telemetry.meterEnergyExport[i], 2));
   }
-  Serial.println(F("OpenHAB:\t\t updated values were sent"));
-  return true;
+}
+
+// latency histogram as [[upper bound ms, count], ...] - last bucket is open (-1)
+String latencyHistogramToJson(const uint32_t *histogram, uint32_t (*getBound)(uint8_t))
+{
+  String json = "[";
+  for (uint8_t i = 0; i < DTU_CMD_LATENCY_BUCKETS; i++)
+  {
+    String bound = (i == DTU_CMD_LATENCY_BUCKETS - 1) ? String("-1") : String(getBound(i));
+    json = json + (i > 0 ? "," : "") + "[" + bound + "," + histogram[i] + "]";
+  }
+  return json + "]";
 }
 
 // mqtt client - publishing data in standard or HA mqtt auto discovery format
-void updateValuesToMqtt(boolean haAutoDiscovery = false)
+void updateValuesToMqtt(const dtuSnapshot &dtuState, boolean haAutoDiscovery = false)
 {
   Serial.println("MQTT:\t\t publish data (HA autoDiscovery = " + String(haAutoDiscovery) + ")");
   std::map<std::string, std::string> keyValueStore;
-  keyValueStore["time_stamp"] = String(dtuGlobalData.currentTimestamp).c_str();
+  keyValueStore["time_stamp"] = String(dtuState.data.currentTimestamp).c_str();
   // grid
-  keyValueStore["grid_U"] = String(dtuGlobalData.grid.voltage).c_str();
-  keyValueStore["grid_I"] = String(dtuGlobalData.grid.current).c_str();
-  keyValueStore["grid_P"] = String(dtuGlobalData.grid.power).c_str();
-  keyValueStore["grid_dailyEnergy"] = String(dtuGlobalData.grid.dailyEnergy, 3).c_str();
-  if (dtuGlobalData.grid.totalEnergy != 0)
-    keyValueStore["grid_totalEnergy"] = String(dtuGlobalData.grid.totalEnergy, 3).c_str();
+  keyValueStore["grid_U"] = String(dtuState.data.grid.voltage).c_str();
+  keyValueStore["grid_I"] = String(dtuState.data.grid.current).c_str();
+  keyValueStore["grid_P"] = String(dtuState.data.grid.power).c_str();
+  keyValueStore["grid_dailyEnergy"] = String(dtuState.data.grid.dailyEnergy, 3).c_str();
+  if (dtuState.data.grid.totalEnergy != 0)
+    keyValueStore["grid_totalEnergy"] = String(dtuState.data.grid.totalEnergy, 3).c_str();
   // pv0
-  keyValueStore["pv0_U"] = String(dtuGlobalData.pv0.voltage).c_str();
-  keyValueStore["pv0_I"] = String(dtuGlobalData.pv0.current).c_str();
-  keyValueStore["pv0_P"] = String(dtuGlobalData.pv0.power).c_str();
-  keyValueStore["pv0_dailyEnergy"] = String(dtuGlobalData.pv0.dailyEnergy, 3).c_str();
-  if (dtuGlobalData.pv0.totalEnergy != 0)
-    keyValueStore["pv0_totalEnergy"] = String(dtuGlobalData.pv0.totalEnergy, 3).c_str();
+  keyValueStore["pv0_U"] = String(dtuState.data.pv0.voltage).c_str();
+  keyValueStore["pv0_I"] = String(dtuState.data.pv0.current).c_str();
+  keyValueStore["pv0_P"] = String(dtuState.data.pv0.power).c_str();
+  keyValueStore["pv0_dailyEnergy"] = String(dtuState.data.pv0.dailyEnergy, 3).c_str();
+  if (dtuState.data.pv0.totalEnergy != 0)
+    keyValueStore["pv0_totalEnergy"] = String(dtuState.data.pv0.totalEnergy, 3).c_str();
   // pv1
-  keyValueStore["pv1_U"] = String(dtuGlobalData.pv1.voltage).c_str();
-  keyValueStore["pv1_I"] = String(dtuGlobalData.pv1.current).c_str();
-  keyValueStore["pv1_P"] = String(dtuGlobalData.pv1.power).c_str();
-  keyValueStore["pv1_dailyEnergy"] = String(dtuGlobalData.pv1.dailyEnergy, 3).c_str();
-  if (dtuGlobalData.pv0.totalEnergy != 0)
-    keyValueStore["pv1_totalEnergy"] = String(dtuGlobalData.pv1.totalEnergy, 3).c_str();
+  keyValueStore["pv1_U"] = String(dtuState.data.pv1.voltage).c_str();
+  keyValueStore["pv1_I"] = String(dtuState.data.pv1.current).c_str();
+  keyValueStore["pv1_P"] = String(dtuState.data.pv1.power).c_str();
+  keyValueStore["pv1_dailyEnergy"] = String(dtuState.data.pv1.dailyEnergy, 3).c_str();
+  if (dtuState.data.pv0.totalEnergy != 0)
+    keyValueStore["pv1_totalEnergy"] = String(dtuState.data.pv1.totalEnergy, 3).c_str();
   // inverter
-  keyValueStore["inverter_Temp"] = String(dtuGlobalData.inverterTemp).c_str();
-  keyValueStore["inverter_PowerLimit"] = String(dtuGlobalData.powerLimit).c_str();
-  keyValueStore["inverter_PowerLimitSet"] = String(dtuGlobalData.powerLimitSet).c_str();
-  keyValueStore["inverter_WifiRSSI"] = String(dtuGlobalData.dtuRssi).c_str();
-  keyValueStore["inverter_cloudPause"] = String(dtuConnection.dtuActiveOffToCloudUpdate).c_str();
-  keyValueStore["inverter_dtuConnectionOnline"] = String(dtuConnection.dtuConnectionOnline).c_str();
-  keyValueStore["inverter_dtuConnectState"] = String(dtuConnection.dtuConnectState).c_str();
+  keyValueStore["inverter_Temp"] = String(dtuState.data.inverterTemp).c_str();
+  keyValueStore["inverter_PowerLimit"] = String(dtuState.data.powerLimit).c_str();
+  keyValueStore["inverter_PowerLimitSet"] = String(dtuState.data.powerLimitSet).c_str();
+  keyValueStore["inverter_WifiRSSI"] = String(dtuState.data.dtuRssi).c_str();
+  keyValueStore["inverter_cloudPause"] = String(dtuState.connection.dtuActiveOffToCloudUpdate).c_str();
+  keyValueStore["inverter_dtuConnectionOnline"] = String(dtuState.connection.dtuConnectionOnline).c_str();
+  keyValueStore["inverter_dtuConnectState"] = String(dtuState.connection.dtuConnectState).c_str();
+  // power limit command - latency from set until the DTU response (ack) and until GetConfig shows it (effective)
+  const commandStats &cmdStats = dtuState.command.getStats();
+  keyValueStore["inverter_PowerLimitCmdState"] = DTUCommandTracker::getStateName(dtuState.command.getState());
+  keyValueStore["inverter_PowerLimitAckMs"] = String(cmdStats.lastAckMs).c_str();
+  keyValueStore["inverter_PowerLimitEffectiveMs"] = String(cmdStats.lastEffectiveMs).c_str();
+  keyValueStore["inverter_PowerLimitAckHistogram"] = latencyHistogramToJson(cmdStats.ackHistogram, DTUCommandTracker::getAckBound).c_str();
+  keyValueStore["inverter_PowerLimitEffectiveHistogram"] = latencyHistogramToJson(cmdStats.effectiveHistogram, DTUCommandTracker::getEffectiveBound).c_str();
   // copy
   for (const auto &pair : keyValueStore)
   {
     String entity = (pair.first).c_str();
     mqttHandler.publishStandardData(entity, (pair.second).c_str());
   }
+  updateTelemetryValuesToMqtt(dtuState.telemetry);
 }
 
-// update all apis according to current states and settings
-void updateDataToApis()
+// additional DTUs of the site - per DTU namespace (dtu1/grid/P, ...) and the site totals (site/P, ...)
+void updateSiteValuesToMqtt(uint8_t index)
 {
-  // if (!dtuConnection.dtuActiveOffToCloudUpdate) // normal update
-  // {
-  if (((globalControls.getDataAuto || globalControls.getDataOnce) && dtuGlobalData.uptodate) || dtuConnection.dtuErrorState == DTU_ERROR_LAST_SEND)
+  // the main DTU has its own topics - only the totals
+  if (index > 0)
   {
-    if (userConfig.openhabActive)
-      updateValueToOpenhab();
-    if (userConfig.mqttActive)
-      updateValuesToMqtt(userConfig.mqttHAautoDiscoveryON);
+    uint8_t i = index;
+    inverterData siteData;
+    connectionControl siteConnection;
+    dtuSite.readSnapshotData(i, siteData);
+    dtuSite.readSnapshotConnection(i, siteConnection);
+    String prefix = "dtu" + String(i) + "_";
+    mqttHandler.publishStandardData(prefix + "time_stamp", String(siteData.currentTimestamp));
+    mqttHandler.publishStandardData(prefix + "grid_U", String(siteData.grid.voltage));
+    mqttHandler.publishStandardData(prefix + "grid_I", String(siteData.grid.current));
+    mqttHandler.publishStandardData(prefix + "grid_P", String(siteData.grid.power));
+    mqttHandler.publishStandardData(prefix + "grid_dailyEnergy", String(siteData.grid.dailyEnergy, 3));
+    if (siteData.grid.totalEnergy != 0)
+      mqttHandler.publishStandardData(prefix + "grid_totalEnergy", String(siteData.grid.totalEnergy, 3));
+    mqttHandler.publishStandardData(prefix + "pv0_P", String(siteData.pv0.power));
+    mqttHandler.publishStandardData(prefix + "pv1_P", String(siteData.pv1.power));
+    mqttHandler.publishStandardData(prefix + "inverter_Temp", String(siteData.inverterTemp));
+    mqttHandler.publishStandardData(prefix + "inverter_PowerLimit", String(siteData.powerLimit));
+    mqttHandler.publishStandardData(prefix + "inverter_WifiRSSI", String(siteData.dtuRssi));
+    mqttHandler.publishStandardData(prefix + "inverter_cloudPause", String(siteConnection.dtuActiveOffToCloudUpdate));
+    mqttHandler.publishStandardData(prefix + "inverter_dtuConnectionOnline", String(siteConnection.dtuConnectionOnline));
+    mqttHandler.publishStandardData(prefix + "inverter_dtuConnectState", String(siteConnection.dtuConnectState));
+  }
+
+  siteTotals totals = dtuSite.getTotals();
+  mqttHandler.publishStandardData("site_P", String(totals.power));
+  mqttHandler.publishStandardData("site_dailyEnergy", String(totals.dailyEnergy, 3));
+  mqttHandler.publishStandardData("site_totalEnergy", String(totals.totalEnergy, 3));
+  mqttHandler.publishStandardData("site_dtusOnline", String(totals.dtusOnline));
+}
+
+// subscribers of the DTU events - delivered in the main loop in the order of subscription
+
+// the one copy of the main DTU snapshot for everything that runs in the loop - event subscribers,
+// sinks without an own task, zero export and display; read again only after a new publish, so all
+// subscribers of one event get the same consistent values (the snapshot is published in the loop too)
+const dtuSnapshot &getLoopState()
+{
+  static dtuSnapshot state;
+  static uint32_t stateVersion = UINT32_MAX;
+  if (dtuInterface.getSnapshotVersion() != stateVersion)
+    stateVersion = dtuInterface.readSnapshot(state);
+  return state;
+}
+
+// new values go to the APIs if requested (auto/ once) and up to date - or the zero values at night
+boolean isApiUpdateDue(const dtuSnapshot &dtuState)
+{
+  return ((globalControls.getDataAuto || globalControls.getDataOnce) && dtuState.data.uptodate) || dtuState.connection.dtuErrorState == DTU_ERROR_LAST_SEND;
+}
 
-    if (globalControls.dataFormatJSON)
+void onDtuEventDisplay(const dtuEvent &event, void *context)
+{
+  // new snapshot for the renderer right away - not only with the next display period
+  if (event.source == &dtuInterface)
+    displayTask(nullptr);
+}
+
+// the outputs only filter and queue the events in the loop - the delivery runs in the workers of the sinks
+
+void onDtuEventMqtt(const dtuEvent &event, void *context)
+{
+  if (!userConfig.mqttActive)
+    return;
+  if (event.source == &dtuInterface)
+  {
+    if (event.type == DTU_EVENT_NEW_SAMPLE && !isApiUpdateDue(getLoopState()))
+      return;
+  }
+  // additional DTUs - only for sites with more than one DTU
+  else if (dtuSite.getCount() < 2 || (event.type != DTU_EVENT_NEW_SAMPLE && event.type != DTU_EVENT_STATE_CHANGE))
+    return;
+  mqttSink.enqueue(event);
+}
+
+void onDtuEventOpenhab(const dtuEvent &event, void *context)
+{
+  if (event.source == &dtuInterface && userConfig.openhabActive && isApiUpdateDue(getLoopState()))
+    openhabSink.enqueue(event);
+}
+
+void onDtuEventHistory(const dtuEvent &event, void *context)
+{
+  // day energy records of a finished day - file access only in the loop
+  event.source->persistEnergyHistory();
+}
+
+// latency of the zero export - from the meter value until the DTU acked the command
+void onDtuEventZeroExport(const dtuEvent &event, void *context)
+{
+  if (event.source != &dtuInterface || !userConfig.zeroExportActive)
+    return;
+  const dtuSnapshot &dtuState = getLoopState();
+  zeroExportController.commandAcked(uint8_t(event.value), dtuState.command.getAckMillis());
+}
+
+// has to be the last of the API outputs - getDataOnce is reset here
+void onDtuEventSerial(const dtuEvent &event, void *context)
+{
+  if (event.source != &dtuInterface || !isApiUpdateDue(getLoopState()))
+    return;
+  serialSink.enqueue(event);
+  if (globalControls.getDataOnce)
+    globalControls.getDataOnce = false;
+}
+
+void addEventSubscribers()
+{
+  dtuEventBus.subscribe("display", DTU_EVENT_MASK(DTU_EVENT_NEW_SAMPLE) | DTU_EVENT_MASK(DTU_EVENT_STATE_CHANGE) | DTU_EVENT_MASK(DTU_EVENT_CLOUD_PAUSE_START) | DTU_EVENT_MASK(DTU_EVENT_CLOUD_PAUSE_END), onDtuEventDisplay);
+  dtuEventBus.subscribe("mqtt", DTU_EVENT_MASK_ALL, onDtuEventMqtt);
+  dtuEventBus.subscribe("openhab", DTU_EVENT_MASK(DTU_EVENT_NEW_SAMPLE), onDtuEventOpenhab);
+  dtuEventBus.subscribe("history", DTU_EVENT_MASK(DTU_EVENT_NEW_SAMPLE), onDtuEventHistory);
+  dtuEventBus.subscribe("zeroExport", DTU_EVENT_MASK(DTU_EVENT_LIMIT_ACK), onDtuEventZeroExport);
+  dtuEventBus.subscribe("serial", DTU_EVENT_MASK(DTU_EVENT_NEW_SAMPLE), onDtuEventSerial);
+}
+
+// workers of the output sinks - one event per call, the values are read from the latest snapshot
+
+boolean deliverToMqtt(const dtuEvent &event, void *context)
+{
+  // broker connection is kept by mqttHandler.loop() - publish does not wait for it
+  if (!userConfig.mqttActive || WiFi.status() != WL_CONNECTED)
+    return true;
+  int8_t index = dtuSite.getIndex(event.source);
+  if (index == 0)
+  {
+    // the worker runs in the loop (no own task)
+    const dtuSnapshot &dtuState = getLoopState();
+    if (event.type == DTU_EVENT_NEW_SAMPLE)
+    {
+      updateValuesToMqtt(dtuState, userConfig.mqttHAautoDiscoveryON);
+    }
+    else if (event.type == DTU_EVENT_LIMIT_ACK)
     {
-      dtuInterface.printDataAsJsonToSerial();
+      mqttHandler.publishStandardData("inverter_PowerLimitCmdState", DTUCommandTracker::getStateName(dtuState.command.getState()));
+      mqttHandler.publishStandardData("inverter_PowerLimitAckMs", String(dtuState.command.getStats().lastAckMs));
     }
     else
     {
-      dtuInterface.printDataAsTextToSerial();
+      // connection state and cloud pause - without waiting for the next values
+      mqttHandler.publishStandardData("inverter_cloudPause", String(dtuState.connection.dtuActiveOffToCloudUpdate));
+      mqttHandler.publishStandardData("inverter_dtuConnectionOnline", String(dtuState.connection.dtuConnectionOnline));
+      mqttHandler.publishStandardData("inverter_dtuConnectState", String(dtuState.connection.dtuConnectState));
     }
-    if (globalControls.getDataOnce)
-      globalControls.getDataOnce = false;
   }
+  if (dtuSite.getCount() > 1 && index >= 0 && (event.type == DTU_EVENT_NEW_SAMPLE || event.type == DTU_EVENT_STATE_CHANGE))
+    updateSiteValuesToMqtt(index);
+  return true;
+}
+
+// ESP32 - in the own task of the sink, the HTTP timeouts do not block the loop
+boolean deliverToOpenhab(const dtuEvent &event, void *context)
+{
+  if (WiFi.status() != WL_CONNECTED)
+    return true;
+  // data block only - the worker may run outside of the loop
+  inverterData dtuData;
+  dtuInterface.readSnapshotData(dtuData);
+  return updateValueToOpenhab(dtuData);
+}
+
+boolean deliverToSerial(const dtuEvent &event, void *context)
+{
+  const dtuSnapshot &dtuState = getLoopState();
+  Serial.print(F("---> got update from DTU - APIs will be updated"));
+  Serial.println(" --- wifi rssi: " + String(dtuState.data.dtuRssi) + " % (DTU -> cloud) - " + String(dtuState.data.wifi_rssi_gateway) + " % (client -> local wifi)");
+  if (globalControls.dataFormatJSON)
+    dtuInterface.printDataAsJsonToSerial(dtuState);
+  else
+    dtuInterface.printDataAsTextToSerial(dtuState);
+  return true;
+}
+
+void addOutputSinks()
+{
+  mqttSink.begin(deliverToMqtt);
+  // blocking HTTP - own worker task on ESP32, the power limit is polled there as well
+  openhabSink.setPoll(getPowerSetDataFromOpenHab, OPENHAB_LIMIT_POLL_MS);
+  openhabSink.begin(deliverToOpenhab, nullptr, true);
+  serialSink.begin(deliverToSerial);
+}
+
+// inverter values from the snapshot of the main DTU - meter and inverter values of the same version
+void zeroExportControl(const MeterPowerValue &meterValue, const dtuSnapshot &dtuState)
+{
+  // control only with a running connection and a valid limit read back from the inverter
+  if (!dtuState.data.uptodate || dtuState.connection.dtuConnectState != DTU_STATE_CONNECTED || dtuState.data.powerLimit > 100)
+    return;
+
+  if (!zeroExportController.isInitialized())
+    zeroExportController.reset(dtuState.data.powerLimit);
+
+  uint8_t newLimit = 0;
+  if (zeroExportController.addMeterValue(meterValue.power, dtuState.data.grid.power, dtuState.telemetry.receivedMillis, meterValue.receivedMillis, newLimit))
+  {
+    Serial.println("ZeroExport:\t meter: " + String(meterValue.power, 0) + " W -> set new power limit from " + String(dtuState.data.powerLimitSet) + " % to " + String(newLimit) + " %");
+    dtuGlobalData.powerLimitSetUpdate = true;
+    // direct command to the DTU - without waiting for the next 1s task (marks the change)
+    dtuInterface.setPowerLimit(newLimit);
+  }
+}
+
+// zero export with the meter attached to the DTU - meter and inverter values come with the same RealDataNew response
+void zeroExportFromDtuMeter()
+{
+  static uint32_t lastMeterUpdate = 0;
+  const dtuSnapshot &dtuState = getLoopState();
+  const DTUTelemetryTable &telemetry = dtuState.telemetry;
+  if (telemetry.getMeterCount() == 0 || telemetry.meterLastUpdate[0] == lastMeterUpdate)
+    return;
+  lastMeterUpdate = telemetry.meterLastUpdate[0];
+  MeterPowerValue meterValue;
+  meterValue.power = telemetry.meterPower[0];
+  // received with the RealDataNew response - not the time of this check
+  meterValue.receivedMillis = telemetry.receivedMillis;
+  meterValue.update = true;
+  zeroExportControl(meterValue, dtuState);
+}
+
+// zero export with a meter from MQTT
+void zeroExportFromMqttMeter(const MeterPowerValue &meterValue)
+{
+  zeroExportControl(meterValue, getLoopState());
 }
-// }
 
 // ****
 
@@ -805,12 +1125,61 @@ void setup()
     userConfig.dtuUpdateTime = 31; // fix for corrupted config data - defaults to 31 sec
   Serial.print(F("\nsetup - set dtu update cycle to user defined value: "));
   Serial.println(String(userConfig.dtuUpdateTime) + " seconds");
+  // fix for config data without adaptive update settings
+  if (userConfig.dtuUpdateTimeMin < 1)
+    userConfig.dtuUpdateTimeMin = DTU_POLL_MIN_INTERVAL;
+  if (userConfig.dtuUpdateAdaptive && userConfig.dtuUpdateTimeMin < DTU_POLL_MIN_INTERVAL)
+    Serial.println("setup - WARNING adaptive dtu update cycle down to " + String(userConfig.dtuUpdateTimeMin) + " s - below " + String(DTU_POLL_MIN_INTERVAL) + " s the DTU may hang");
+  if (userConfig.dtuUpdateTimeMax < userConfig.dtuUpdateTimeMin)
+    userConfig.dtuUpdateTimeMax = max(userConfig.dtuUpdateTimeMin, 60u);
+  Serial.println("setup - adaptive dtu update cycle: " + String(userConfig.dtuUpdateAdaptive) + " - range: " + String(userConfig.dtuUpdateTimeMin) + " ... " + String(userConfig.dtuUpdateTimeMax) + " seconds");
+  // fix for config data without reconnect/ heartbeat settings
+  if (userConfig.dtuReconnectMaxDelay < 1)
+    userConfig.dtuReconnectMaxDelay = 60;
+  if (userConfig.dtuHeartbeatMaxMissed < 1)
+    userConfig.dtuHeartbeatMaxMissed = 3;
+  if (userConfig.dtuHeartbeatInterval == 0)
+    userConfig.dtuHeartbeatInterval = DTU_HEARTBEAT_INTERVAL;
+  if (userConfig.dtuHeartbeatInterval <= DTU_HEARTBEAT_RETRY_INTERVAL)
+    userConfig.dtuHeartbeatInterval = DTU_HEARTBEAT_RETRY_INTERVAL + 1;
+  if (userConfig.dtuHeartbeatInterval < DTU_HEARTBEAT_INTERVAL)
+    Serial.println("setup - WARNING dtu heartbeat every " + String(userConfig.dtuHeartbeatInterval) + " s - below " + String(DTU_HEARTBEAT_INTERVAL) + " s the DTU may hang");
+  // fix for config data without refresh time of unchanged values
+  if (userConfig.dtuUnchangedRefresh < 1)
+    userConfig.dtuUnchangedRefresh = DTU_FINGERPRINT_REFRESH_SECONDS;
+  // max. length of the learned cloud pause
+  if (userConfig.dtuCloudPauseTime < DTU_CLOUD_PAUSE_MIN_SECONDS)
+    userConfig.dtuCloudPauseTime = 40;
+
+  // fix for config data without zero export settings
+  if (String(userConfig.zeroExportMeterTopic) == "null")
+    userConfig.zeroExportMeterTopic[0] = '\0';
+  if (userConfig.zeroExportInverterPower == 0)
+    userConfig.zeroExportInverterPower = 800;
+  if (userConfig.zeroExportMaxStep == 0)
+    userConfig.zeroExportMaxStep = 100;
+  if (userConfig.zeroExportMinCommandTime == 0)
+    userConfig.zeroExportMinCommandTime = ZERO_EXPORT_MIN_COMMAND_SECONDS;
+  if (userConfig.zeroExportMinCommandTime < ZERO_EXPORT_MIN_COMMAND_SECONDS)
+    Serial.println("setup - WARNING zero export: power limit commands every " + String(userConfig.zeroExportMinCommandTime) + " s - below " + String(ZERO_EXPORT_MIN_COMMAND_SECONDS) + " s the DTU may hang");
+  if (userConfig.zeroExportKp == 0 && userConfig.zeroExportKi == 0)
+  {
+    userConfig.zeroExportKp = 0.3;
+    userConfig.zeroExportKi = 0.5;
+  }
 
   // setting startup for dtu cloud pause
   dtuConnection.preventCloudErrors = userConfig.dtuCloudPauseActive;
 
   // delay for startup background tasks in ESP
   delay(2000);
+
+  // from now on the display is only drawn from snapshots - on ESP32 in the render task
+  displayRenderer.begin(userConfig.displayConnected, &displayOLED, &displayTFT);
+
+  addOutputSinks();
+  addEventSubscribers();
+  addLoopTasks();
 }
 
 // after startup or reconnect with wifi
@@ -840,11 +1209,18 @@ void startServices()
     dtuWebServer.start();
 
     if (!userConfig.remoteDisplayActive)
+    {
+      // LittleFS is mounted by the config manager
+      dtuInterface.beginEnergyHistory("/dayEnergy.bin");
       dtuInterface.setup(userConfig.dtuHostIpDomain);
+      dtuSite.setup(userConfig.dtuSiteHosts);
+    }
 
     mqttHandler.setConfiguration(userConfig.mqttBrokerIpDomain, userConfig.mqttBrokerPort, userConfig.mqttBrokerUser, userConfig.mqttBrokerPassword, userConfig.mqttUseTLS, (platformData.espUniqueName).c_str(), userConfig.mqttBrokerMainTopic, userConfig.mqttHAautoDiscoveryON, ((platformData.dtuGatewayIP).toString()).c_str());
     mqttHandler.setup();
     mqttHandler.setRemoteDisplayData(userConfig.remoteDisplayActive);
+    if (userConfig.zeroExportActive && !userConfig.remoteDisplayActive)
+      mqttHandler.setMeterPowerTopic(userConfig.zeroExportMeterTopic);
   }
   else
   {
@@ -954,6 +1330,7 @@ void getSerialCommand(String cmd, String value)
   {
     Serial.print(F("'setPower' to "));
     dtuGlobalData.powerLimitSet = val;
+    dtuInterface.markChanged();
     Serial.print(String(dtuGlobalData.powerLimitSet));
   }
   else if (cmd == "getDataAuto")
@@ -1035,6 +1412,7 @@ void getSerialCommand(String cmd, String value)
       dtuConnection.preventCloudErrors = false;
       Serial.print(F(" 'OFF' "));
     }
+    dtuInterface.markChanged();
   }
   else if (cmd == "resetToFactory")
   {
@@ -1064,6 +1442,21 @@ void getSerialCommand(String cmd, String value)
       dtuInterface.requestRestartDevice();
     }
   }
+  else if (cmd == "getTasks")
+  {
+    Serial.println(F("'getTasks' - runtime of the scheduled tasks"));
+    taskScheduler.printStats();
+    dtuEventBus.printStats();
+    OutputSink::printStats();
+    if (val == 1)
+    {
+      taskScheduler.resetStats();
+      dtuEventBus.resetStats();
+      for (uint8_t i = 0; i < OutputSink::getCount(); i++)
+        OutputSink::get(i).resetStats();
+      Serial.print(F(" statistics reset"));
+    }
+  }
   else if (cmd == "selectDisplay")
   {
     Serial.print(F(" selected Display"));
@@ -1089,273 +1482,284 @@ void getSerialCommand(String cmd, String value)
   Serial.print(F("\n"));
 }
 
-// main
+// main loop tasks - run by the task scheduler
 
-void loop()
+// display snapshot every 50ms = 20Hz - drawn by the render task (ESP32) or right away (ESP8266)
+void displayTask(void *arg)
 {
-  unsigned long currentMillis = millis();
-  // skip all tasks if update is running
-  if (updateInfo.updateState != UPDATE_STATE_IDLE)
+  // reboot screen
+  if (platformData.rebootRequested)
   {
-    if (updateInfo.updateState == UPDATE_STATE_PREPARE)
-    {
-      // dtuInterface.disconnect(DTU_STATE_STOPPED);
-      dtuInterface.flushConnection();
-      mqttHandler.stopConnection();
-      if (userConfig.displayConnected == 0)
-        displayOLED.drawUpdateMode("update running ...");
-      else if (userConfig.displayConnected == 1)
-        displayTFT.drawUpdateMode("update running ...");
-      updateInfo.updateState = UPDATE_STATE_INSTALLING;
-    }
-    if (updateInfo.updateState == UPDATE_STATE_DONE)
-    {
-      if (userConfig.displayConnected == 0)
-        displayOLED.drawUpdateMode("update done", "rebooting ...");
-      else if (userConfig.displayConnected == 1)
-        displayTFT.drawUpdateMode("update done", "rebooting ...");
-      updateInfo.updateState = UPDATE_STATE_RESTART;
-    }
-    return;
+    String countdown = "in " + String(platformData.rebootRequestedInSec) + " s";
+    displayRenderer.publishMessage("rebooting ...", countdown.c_str());
   }
-  // check for wifi networks scan results
-  scanNetworksResult();
-
-#if defined(ESP8266)
-  // serving domain name
-  MDNS.update();
-#endif
-
-  // runner for mqttClient to hold a already etablished connection
-  if (userConfig.mqttActive && WiFi.status() == WL_CONNECTED)
-    mqttHandler.loop();
-
-  // 50ms task
-  if (currentMillis - previousMillis50ms >= interval50ms)
+  // reboot screen
+  else if (platformData.rebootStarted)
+  {
+    displayRenderer.publishMessage("rebooting ...", "now");
+  }
+  // normal screen
+  else if (!userConfig.wifiAPstart)
   {
-    previousMillis50ms = currentMillis;
-    // -------->
+    // copy of the DTU data only if a new version was published
+    const dtuSnapshot &dtuState = getLoopState();
+
+    displaySnapshot &snapshot = displayRenderer.beginSnapshot();
+    snapshot.screen = DISPLAY_SCREEN_NORMAL;
+    strlcpy(snapshot.formattedTime, timeClient.getFormattedTime().c_str(), sizeof(snapshot.formattedTime));
+    snapshot.version = platformData.fwVersion;
+    snapshot.currentNTPtime = platformData.currentNTPtime;
+    snapshot.gridPower = dtuState.data.grid.power;
+    snapshot.dailyEnergy = dtuState.data.grid.dailyEnergy;
+    snapshot.totalEnergy = dtuState.data.grid.totalEnergy;
+    snapshot.powerLimit = dtuState.data.powerLimit;
+    snapshot.rssiGW = dtuState.data.wifi_rssi_gateway;
+    snapshot.rssiDTU = dtuState.data.dtuRssi;
+    snapshot.dtuConnectState = dtuState.connection.dtuConnectState;
+    snapshot.dtuConnectionOnline = dtuState.connection.dtuConnectionOnline;
+    displayRenderer.publish();
+  }
+}
 
-    // reboot screen
-    if (platformData.rebootRequested)
-    {
-      if (userConfig.displayConnected == 0)
-        displayOLED.drawUpdateMode("rebooting ...", "in " + String(platformData.rebootRequestedInSec) + " s");
-      else if (userConfig.displayConnected == 1)
-        displayTFT.drawUpdateMode("rebooting ...", "in " + String(platformData.rebootRequestedInSec) + " s");
-    }
-    // reboot screen
-    else if (platformData.rebootStarted)
-    {
-      if (userConfig.displayConnected == 0)
-        displayOLED.drawUpdateMode("rebooting ...", "now");
-      else if (userConfig.displayConnected == 1)
-        displayTFT.drawUpdateMode("rebooting ...", "now");
-    }
-    // normal screen
-    else if (!userConfig.wifiAPstart)
-    {
-      // display tasks every 50ms = 20Hz
-      if (userConfig.displayConnected == 0)
-        displayOLED.renderScreen(timeClient.getFormattedTime(), String(platformData.fwVersion));
-      else if (userConfig.displayConnected == 1)
-        displayTFT.renderScreen(timeClient.getFormattedTime(), String(platformData.fwVersion));
-    }
+void controlTask(void *arg)
+{
+  // led blink code only 5 min after startup
+  if ((platformData.currentNTPtime - platformData.dtuGWstarttime) < 300)
+  {
+    blinkCodeTask();
+  }
+  // turn the LED off only if OLED or TFT with ESP8266 is connected
+  // ESP32 has an overlapping LED with the SCK pin of the SPI interface for the TFT
+  else if (userConfig.displayConnected == 0 || (userConfig.displayConnected == 1 && !platformData.esp32))
+  {
+    digitalWrite(LED_BLINK, LED_BLINK_OFF);
   }
 
-  // 100ms task
-  if (currentMillis - previousMillis100ms >= interval100ms)
+  serialInputTask();
+
+  if (userConfig.mqttActive)
   {
-    previousMillis100ms = currentMillis;
-    // -------->
-    // led blink code only 5 min after startup
-    if ((platformData.currentNTPtime - platformData.dtuGWstarttime) < 300)
-    {
-      blinkCodeTask();
-    }
-    // turn the LED off only if OLED or TFT with ESP8266 is connected
-    // ESP32 has an overlapping LED with the SCK pin of the SPI interface for the TFT
-    else if (userConfig.displayConnected == 0 || (userConfig.displayConnected == 1 && !platformData.esp32))
+    // getting powerlimitSet over MQTT, only on demand
+    PowerLimitSet lastSetting = mqttHandler.getPowerLimitSet();
+    if (lastSetting.update == true)
     {
-      digitalWrite(LED_BLINK, LED_BLINK_OFF);
+      dtuGlobalData.powerLimitSet = lastSetting.setValue;
+      dtuGlobalData.powerLimitSetUpdate = true;
+      dtuInterface.markChanged();
+      Serial.println("\nMQTT: changed powerset value to '" + String(dtuGlobalData.powerLimitSet) + "'");
     }
 
-    serialInputTask();
+    MeterPowerValue meterValue = mqttHandler.getMeterPower();
+    if (meterValue.update && userConfig.zeroExportActive && !userConfig.remoteDisplayActive)
+      zeroExportFromMqttMeter(meterValue);
 
-    if (userConfig.mqttActive)
+    if(dtuGlobalData.powerLimitSetUpdate) {
+      mqttHandler.publishStandardData("inverter_PowerLimitSet", String(dtuGlobalData.powerLimitSet));
+      // postMessageToOpenhab(String(userConfig.openItemPrefix) + "_PowerLimitSet", (String)dtuGlobalData.powerLimit);
+      dtuGlobalData.powerLimitSetUpdate = false;
+    }
+  
+    RemoteInverterData remoteData = mqttHandler.getRemoteInverterData();
+    if (remoteData.updateReceived == true)
     {
-      // getting powerlimitSet over MQTT, only on demand
-      PowerLimitSet lastSetting = mqttHandler.getPowerLimitSet();
-      if (lastSetting.update == true)
-      {
-        dtuGlobalData.powerLimitSet = lastSetting.setValue;
-        dtuGlobalData.powerLimitSetUpdate = true;
-        Serial.println("\nMQTT: changed powerset value to '" + String(dtuGlobalData.powerLimitSet) + "'");
-      }
-      if(dtuGlobalData.powerLimitSetUpdate) {
-        mqttHandler.publishStandardData("inverter_PowerLimitSet", String(dtuGlobalData.powerLimitSet));
-        // postMessageToOpenhab(String(userConfig.openItemPrefix) + "_PowerLimitSet", (String)dtuGlobalData.powerLimit);
-        dtuGlobalData.powerLimitSetUpdate = false;
-      }
-    
-      RemoteInverterData remoteData = mqttHandler.getRemoteInverterData();
-      if (remoteData.updateReceived == true)
-      {
-        dtuGlobalData.grid.power = remoteData.grid.power;
-        dtuGlobalData.grid.current = remoteData.grid.current;
-        dtuGlobalData.grid.voltage = remoteData.grid.voltage;
-        dtuGlobalData.grid.dailyEnergy = remoteData.grid.dailyEnergy;
-        dtuGlobalData.grid.totalEnergy = remoteData.grid.totalEnergy;
-
-        dtuGlobalData.pv0.power = remoteData.pv0.power;
-        dtuGlobalData.pv0.current = remoteData.pv0.current;
-        dtuGlobalData.pv0.voltage = remoteData.pv0.voltage;
-        dtuGlobalData.pv0.dailyEnergy = remoteData.pv0.dailyEnergy;
-        dtuGlobalData.pv0.totalEnergy = remoteData.pv0.totalEnergy;
-
-        dtuGlobalData.pv1.power = remoteData.pv1.power;
-        dtuGlobalData.pv1.current = remoteData.pv1.current;
-        dtuGlobalData.pv1.voltage = remoteData.pv1.voltage;
-        dtuGlobalData.pv1.dailyEnergy = remoteData.pv1.dailyEnergy;
-        dtuGlobalData.pv1.totalEnergy = remoteData.pv1.totalEnergy;
-
-        dtuGlobalData.inverterTemp = remoteData.inverterTemp;
-        dtuGlobalData.powerLimit = remoteData.powerLimit;
-        dtuGlobalData.dtuRssi = remoteData.dtuRssi;
-
-        dtuConnection.dtuActiveOffToCloudUpdate = remoteData.cloudPause;
-        dtuConnection.dtuConnectionOnline = remoteData.dtuConnectionOnline;
-
-        dtuConnection.dtuConnectState = remoteData.dtuConnectState;
-        dtuGlobalData.lastRespTimestamp = remoteData.respTimestamp;
-        dtuGlobalData.currentTimestamp = remoteData.respTimestamp; // setting the local counter
-        Serial.println("\nMQTT: changed remote inverter data");
-      }
+      dtuGlobalData.grid.power = remoteData.grid.power;
+      dtuGlobalData.grid.current = remoteData.grid.current;
+      dtuGlobalData.grid.voltage = remoteData.grid.voltage;
+      dtuGlobalData.grid.dailyEnergy = remoteData.grid.dailyEnergy;
+      dtuGlobalData.grid.totalEnergy = remoteData.grid.totalEnergy;
+
+      dtuGlobalData.pv0.power = remoteData.pv0.power;
+      dtuGlobalData.pv0.current = remoteData.pv0.current;
+      dtuGlobalData.pv0.voltage = remoteData.pv0.voltage;
+      dtuGlobalData.pv0.dailyEnergy = remoteData.pv0.dailyEnergy;
+      dtuGlobalData.pv0.totalEnergy = remoteData.pv0.totalEnergy;
+
+      dtuGlobalData.pv1.power = remoteData.pv1.power;
+      dtuGlobalData.pv1.current = remoteData.pv1.current;
+      dtuGlobalData.pv1.voltage = remoteData.pv1.voltage;
+      dtuGlobalData.pv1.dailyEnergy = remoteData.pv1.dailyEnergy;
+      dtuGlobalData.pv1.totalEnergy = remoteData.pv1.totalEnergy;
+
+      dtuGlobalData.inverterTemp = remoteData.inverterTemp;
+      dtuGlobalData.powerLimit = remoteData.powerLimit;
+      dtuGlobalData.dtuRssi = remoteData.dtuRssi;
+
+      dtuConnection.dtuActiveOffToCloudUpdate = remoteData.cloudPause;
+      dtuConnection.dtuConnectionOnline = remoteData.dtuConnectionOnline;
+
+      dtuConnection.dtuConnectState = remoteData.dtuConnectState;
+      dtuGlobalData.lastRespTimestamp = remoteData.respTimestamp;
+      dtuGlobalData.currentTimestamp = remoteData.respTimestamp; // setting the local counter
+      dtuInterface.markChanged();
+      dtuInterface.publishSnapshot();
+      Serial.println("\nMQTT: changed remote inverter data");
     }
+  }
 
-    platformData.currentNTPtime = timeClient.getEpochTime() < (12 * 60 * 60) ? (12 * 60 * 60) : timeClient.getEpochTime();
-    platformData.currentNTPtimeFormatted = timeClient.getFormattedTime();
-  }
-
-  // short task
-  if (currentMillis - previousMillisShort >= (intervalShort * 1000))
-  {
-    // Serial.printf("\n>>>>> %02is task - state --> ", int(intervalShort));
-    // Serial.print("local: " + getTimeStringByTimestamp(dtuGlobalData.currentTimestamp));
-    // Serial.print(" --- NTP: " + timeClient.getFormattedTime() + " --- currentMillis " + String(currentMillis) + " --- ");
-    previousMillisShort = currentMillis;
-    // Serial.print(F("free mem: "));
-    // Serial.print(ESP.getFreeHeap());
-    // Serial.print(F(" - heap fragm: "));
-    // Serial.print(ESP.getHeapFragmentation());
-    // Serial.print(F(" - max free block size: "));
-    // Serial.print(ESP.getMaxFreeBlockSize());
-    // Serial.print(F(" - free cont stack: "));
-    // Serial.print(ESP.getFreeContStack());
-    // Serial.print(F(" \n"));
-    dtuGlobalData.currentTimestamp++;
-    // -------->
-
-    if (!userConfig.wifiAPstart)
+  platformData.currentNTPtime = timeClient.getEpochTime() < (12 * 60 * 60) ? (12 * 60 * 60) : timeClient.getEpochTime();
+  platformData.currentNTPtimeFormatted = timeClient.getFormattedTime();
+}
+
+void secondTask(void *arg)
+{
+  // Serial.print(F("free mem: "));
+  // Serial.print(ESP.getFreeHeap());
+  // Serial.print(F(" - heap fragm: "));
+  // Serial.print(ESP.getHeapFragmentation());
+  // Serial.print(F(" - max free block size: "));
+  // Serial.print(ESP.getMaxFreeBlockSize());
+  // Serial.print(F(" - free cont stack: "));
+  // Serial.print(ESP.getFreeContStack());
+  // Serial.print(F(" \n"));
+  // local time only - published with the next change of the DTU data
+  dtuGlobalData.currentTimestamp++;
+  dtuSite.tick();
+  // -------->
+
+  if (!userConfig.wifiAPstart)
+  {
+    if (globalControls.wifiSwitch)
+      checkWifiTask();
+    else
     {
-      if (globalControls.wifiSwitch)
-        checkWifiTask();
-      else
-      {
-        // stopping connection to DTU before go wifi offline
-        dtuInterface.disconnect(DTU_STATE_OFFLINE);
-        WiFi.disconnect();
-      }
+      // stopping connection to DTU before go wifi offline
+      dtuInterface.disconnect(DTU_STATE_OFFLINE);
+      WiFi.disconnect();
     }
+  }
 
-    if (WiFi.status() == WL_CONNECTED)
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    // new DTU values reach the APIs as events - see addEventSubscribers()
+    if (dtuConnection.dtuActiveOffToCloudUpdate)
+      blinkCode = BLINK_PAUSE_CLOUD_UPDATE;
+
+    // polled by the openhab sink worker - see addOutputSinks()
+    if (userConfig.openhabActive && !userConfig.remoteDisplayActive)
+      applyPowerSetFromOpenHab();
+
+    // no meter topic set - use the meter attached to the DTU
+    if (userConfig.zeroExportActive && userConfig.zeroExportMeterTopic[0] == '\0' && !userConfig.remoteDisplayActive)
+      zeroExportFromDtuMeter();
+
+    // direct request of new powerLimit
+    if (dtuGlobalData.powerLimitSet != dtuGlobalData.powerLimit &&
+        dtuGlobalData.powerLimitSet != 101 &&
+        dtuGlobalData.uptodate &&
+        dtuConnection.dtuConnectState == DTU_STATE_CONNECTED &&
+        !userConfig.remoteDisplayActive)
     {
-      if (dtuGlobalData.updateReceived)
-      {
-        Serial.print(F("---> got update from DTU - APIs will be updated"));
-        Serial.println(" --- wifi rssi: " + String(dtuGlobalData.dtuRssi) + " % (DTU -> cloud) - " + String(dtuGlobalData.wifi_rssi_gateway) + " % (client -> local wifi)");
-        updateDataToApis();
-        dtuGlobalData.updateReceived = false;
-      }
-
-      if (dtuConnection.dtuActiveOffToCloudUpdate)
-        blinkCode = BLINK_PAUSE_CLOUD_UPDATE;
-
-      if (userConfig.openhabActive && !userConfig.remoteDisplayActive)
-        getPowerSetDataFromOpenHab();
-
-      // direct request of new powerLimit
-      if (dtuGlobalData.powerLimitSet != dtuGlobalData.powerLimit &&
-          dtuGlobalData.powerLimitSet != 101 &&
-          dtuGlobalData.uptodate &&
-          dtuConnection.dtuConnectState == DTU_STATE_CONNECTED &&
-          !userConfig.remoteDisplayActive)
+      // nothing to do if the same limit is already on the way - tracked until GetConfig shows it
+      if (dtuInterface.setPowerLimit(dtuGlobalData.powerLimitSet))
       {
         Serial.println("----- ----- set new power limit from " + String(dtuGlobalData.powerLimit) + " % to " + String(dtuGlobalData.powerLimitSet) + " % ----- ----- ");
-        dtuInterface.setPowerLimit(dtuGlobalData.powerLimitSet);
         // set next normal request in 5 seconds from now on, only if last data updated within last 2 times of user setted update rate
-        if (dtuGlobalData.currentTimestamp - dtuGlobalData.lastRespTimestamp < (userConfig.dtuUpdateTime * 2))
-          platformData.dtuNextUpdateCounterSeconds = dtuGlobalData.currentTimestamp - userConfig.dtuUpdateTime + 5;
+        if (dtuGlobalData.currentTimestamp - dtuGlobalData.lastRespTimestamp < (dtuInterface.getUpdateInterval() * 2u))
+          dtuInterface.requestDataUpdateIn(5);
       }
     }
-
-    // if (updateInfo.updateInfoRequested)
-    // {
-    //   getUpdateInfo();
-    // }
   }
 
-  // CHANGE to 1 second timer increment
-  currentMillis = dtuGlobalData.currentTimestamp;
+  // if (updateInfo.updateInfoRequested)
+  // {
+  //   getUpdateInfo();
+  // }
+}
 
-  // 5s task
-  if (currentMillis - previousMillis5000ms >= interval5000ms)
-  {
-    Serial.printf(">>>>> %02is task - state --> ", int(interval5000ms));
-    Serial.print("local: " + dtuInterface.getTimeStringByTimestamp(dtuGlobalData.currentTimestamp));
-    Serial.println(" --- NTP: " + timeClient.getFormattedTime() + " ---> dtuConnState: " + String(dtuConnection.dtuConnectState));
+void statusTask(void *arg)
+{
+  Serial.printf(">>>>> %02is task - state --> ", int(TASK_STATUS_PERIOD_MS / 1000));
+  Serial.print("local: " + dtuInterface.getTimeStringByTimestamp(dtuGlobalData.currentTimestamp));
+  Serial.println(" --- NTP: " + timeClient.getFormattedTime() + " ---> dtuConnState: " + String(dtuConnection.dtuConnectState));
 
-    previousMillis5000ms = currentMillis;
-    // -------->
-    // -----------------------------------------
-    if (WiFi.status() == WL_CONNECTED)
+  // -----------------------------------------
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    // get current RSSI to AP
+    int wifiPercent = 2 * (WiFi.RSSI() + 100);
+    if (wifiPercent > 100)
+      wifiPercent = 100;
+    if (dtuGlobalData.wifi_rssi_gateway != uint32_t(wifiPercent))
     {
-      // get current RSSI to AP
-      int wifiPercent = 2 * (WiFi.RSSI() + 100);
-      if (wifiPercent > 100)
-        wifiPercent = 100;
       dtuGlobalData.wifi_rssi_gateway = wifiPercent;
-      // Serial.print(" --- RSSI to AP: '" + String(WiFi.SSID()) + "': " + String(dtuGlobalData.wifi_rssi_gateway) + " %");
+      dtuInterface.markChanged();
     }
+    // Serial.print(" --- RSSI to AP: '" + String(WiFi.SSID()) + "': " + String(dtuGlobalData.wifi_rssi_gateway) + " %");
   }
+}
 
-  // mid task
-  if (currentMillis - platformData.dtuNextUpdateCounterSeconds >= userConfig.dtuUpdateTime)
-  {
-    Serial.printf(">>>>> %02is task - state --> ", int(userConfig.dtuUpdateTime));
-    Serial.print("local: " + dtuInterface.getTimeStringByTimestamp(dtuGlobalData.currentTimestamp));
-    Serial.println(" --- NTP: " + timeClient.getFormattedTime() + "\n");
+// requesting data from DTU if the (adaptive) poll time is reached
+void dtuPollTask(void *arg)
+{
+  if (!dtuInterface.checkDataUpdateDue())
+    return;
+  Serial.printf(">>>>> %02is task - state --> ", int(dtuInterface.getUpdateInterval()));
+  Serial.print("local: " + dtuInterface.getTimeStringByTimestamp(dtuGlobalData.currentTimestamp));
+  Serial.println(" --- NTP: " + timeClient.getFormattedTime() + "\n");
 
-    platformData.dtuNextUpdateCounterSeconds = currentMillis;
-    // -------->
+  // requesting data from DTU
+  if (WiFi.status() == WL_CONNECTED && !userConfig.remoteDisplayActive)
+    dtuInterface.getDataUpdate();
+}
 
-    // requesting data from DTU
-    if (WiFi.status() == WL_CONNECTED && !userConfig.remoteDisplayActive)
-      dtuInterface.getDataUpdate();
+void ntpTask(void *arg)
+{
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    timeClient.update();
   }
+}
 
-  // long task
-  if (currentMillis - previousMillisLong >= intervalLong)
-  {
-    // Serial.printf("\n>>>>> %02is task - state --> ", int(interval5000ms));
-    // Serial.print("local: " + getTimeStringByTimestamp(dtuGlobalData.currentTimestamp));
-    // Serial.print(" --- NTP: " + timeClient.getFormattedTime() + " --- currentMillis " + String(currentMillis) + " --- ");
+void addLoopTasks()
+{
+  // period, phase - the DTU poll runs right after the second tick that may make it due
+  loopTasks[0] = taskScheduler.addTask("display", displayTask, nullptr, TASK_DISPLAY_PERIOD_MS);
+  loopTasks[1] = taskScheduler.addTask("control", controlTask, nullptr, TASK_CONTROL_PERIOD_MS);
+  loopTasks[2] = taskScheduler.addTask("second", secondTask, nullptr, TASK_SECOND_PERIOD_MS);
+  loopTasks[3] = taskScheduler.addTask("status", statusTask, nullptr, TASK_STATUS_PERIOD_MS);
+  loopTasks[4] = taskScheduler.addTask("dtuPoll", dtuPollTask, nullptr, TASK_SECOND_PERIOD_MS, 5);
+  loopTasks[5] = taskScheduler.addTask("ntp", ntpTask, nullptr, TASK_NTP_PERIOD_MS, TASK_NTP_PERIOD_MS);
+}
 
-    previousMillisLong = currentMillis;
-    // -------->
-    if (WiFi.status() == WL_CONNECTED)
+// main
+
+void loop()
+{
+  // jobs of the DTU connections and the web server keep running while an update is installed
+  taskScheduler.run();
+
+  // skip all tasks if update is running
+  if (updateInfo.updateState != UPDATE_STATE_IDLE)
+  {
+    if (updateInfo.updateState == UPDATE_STATE_PREPARE)
+    {
+      for (uint8_t i = 0; i < LOOP_TASK_COUNT; i++)
+        taskScheduler.disable(loopTasks[i]);
+      // dtuInterface.disconnect(DTU_STATE_STOPPED);
+      dtuInterface.flushConnection();
+      mqttHandler.stopConnection();
+      displayRenderer.publishMessage("update running ...");
+      updateInfo.updateState = UPDATE_STATE_INSTALLING;
+    }
+    if (updateInfo.updateState == UPDATE_STATE_DONE)
     {
-      timeClient.update();
+      displayRenderer.publishMessage("update done", "rebooting ...");
+      updateInfo.updateState = UPDATE_STATE_RESTART;
     }
+    return;
   }
-}
\ No newline at end of file
+  // new values/ state changes of the DTUs to the subscribed outputs
+  dtuEventBus.dispatch();
+
+  // check for wifi networks scan results
+  scanNetworksResult();
+
+#if defined(ESP8266)
+  // serving domain name
+  MDNS.update();
+#endif
+
+  // runner for mqttClient to hold a already etablished connection
+  if (userConfig.mqttActive && WiFi.status() == WL_CONNECTED)
+    mqttHandler.loop();
+}
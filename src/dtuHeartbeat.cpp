@@ -0,0 +1,68 @@
+#include "dtuHeartbeat.h"
+
+static const uint32_t rttBounds[DTU_HEARTBEAT_RTT_BUCKETS] = DTU_HEARTBEAT_RTT_BOUNDS;
+
+void DTUHeartbeat::reset()
+{
+    awaiting = false;
+    armed = false;
+    stats.missedInRow = 0;
+}
+
+void DTUHeartbeat::startBeat()
+{
+    if (awaiting)
+    {
+        stats.missed++;
+        if (stats.missedInRow < 0xFF)
+            stats.missedInRow++;
+        Serial.println("DTUheartbeat:\t beat missed - " + String(stats.missedInRow) + " in a row");
+    }
+    awaiting = true;
+    sentAt = 0;
+}
+
+void DTUHeartbeat::beatSent(unsigned long now)
+{
+    sentAt = now;
+    stats.sent++;
+}
+
+boolean DTUHeartbeat::beatAnswered(unsigned long now)
+{
+    if (!awaiting || sentAt == 0)
+        return false;
+    awaiting = false;
+    armed = true;
+    stats.missedInRow = 0;
+    stats.answered++;
+
+    uint32_t rtt = now - sentAt;
+    stats.lastRttMs = rtt;
+    if (stats.answered == 1 || rtt < stats.minRttMs)
+        stats.minRttMs = rtt;
+    if (rtt > stats.maxRttMs)
+        stats.maxRttMs = rtt;
+    stats.sumRttMs += rtt;
+    for (uint8_t i = 0; i < DTU_HEARTBEAT_RTT_BUCKETS; i++)
+    {
+        if (rtt <= rttBounds[i])
+        {
+            stats.rttHistogram[i]++;
+            break;
+        }
+    }
+    return true;
+}
+
+boolean DTUHeartbeat::isLinkDead(uint8_t maxMissed) const
+{
+    return armed && maxMissed > 0 && stats.missedInRow >= maxMissed;
+}
+
+uint32_t DTUHeartbeat::getBucketBound(uint8_t bucket)
+{
+    if (bucket >= DTU_HEARTBEAT_RTT_BUCKETS)
+        return 0;
+    return rttBounds[bucket];
+}
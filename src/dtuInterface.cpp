@@ -1,10 +1,21 @@
 #include "dtuInterface.h"
 #include <Arduino.h>
 
+// 16 bit command id of the response to a request - the DTU answers 0xa3 xx with 0xa2 xx (cloud commands 0x23 xx with 0x22 xx)
+static constexpr uint16_t responseId(const byte (&request)[2])
+{
+    return uint16_t(((request[0] - 1) << 8) | request[1]);
+}
+
 struct connectionControl dtuConnection;
 struct inverterData dtuGlobalData;
 
-DTUInterface::DTUInterface(const char *server, uint16_t port) : serverIP(server), serverPort(port), client(nullptr) {}
+DTUInterface::DTUInterface(const char *server, uint16_t port, inverterData *data, connectionControl *connection)
+    : serverIP(server), serverPort(port), client(nullptr), dtuData(data), dtuConn(connection)
+{
+    pollScheduler.setConnectionControl(connection);
+    timerWheel.setCallback(DTUInterface::onTimerStatic, this);
+}
 
 DTUInterface::~DTUInterface()
 {
@@ -20,7 +31,7 @@ void DTUInterface::setup(const char *server)
     // Serial.println(F("DTUinterface:\t setup ... check client ..."));
     if (!client)
     {
-        dtuGlobalData.currentTimestamp = 0;
+        dtuData->currentTimestamp = 0;
         // Serial.println(F("DTUinterface:\t no client - setup new client"));
         client = new AsyncClient();
         if (client)
@@ -31,16 +42,34 @@ void DTUInterface::setup(const char *server)
             client->onDisconnect(onDisconnect, this);
             client->onError(onError, this);
             client->onData(onDataReceived, this);
-
-            initializeCRC();
         }
-        loopTimer.attach(5, DTUInterface::dtuLoopStatic, this);
+        addTasks();
+        cloudPauseLearner.setMaxSeconds(userConfig.dtuCloudPauseTime);
+        dtuConn->cloudPauseSeconds = cloudPauseLearner.getPauseSeconds();
+        // offline is reported if no connection comes up at all
+        scheduleTimer(DTU_TIMER_OFFLINE_GRACE, DTU_OFFLINE_GRACE_MS);
+    }
+}
+
+void DTUInterface::addTasks()
+{
+    // the task slots are kept - setup() runs again after a flush
+    if (loopTask != TASK_SCHEDULER_NO_TASK)
+    {
+        taskScheduler.runIn(loopTask, 5000);
+        taskScheduler.runIn(txRxTask, 500);
+        return;
     }
+    loopTask = taskScheduler.addTask("dtuLoop", DTUInterface::dtuLoopStatic, this, 5000, 5000);
+    txRxTask = taskScheduler.addTask("dtuTxRx", DTUInterface::txRxStatic, this, 500, 500);
+    keepAliveTask = taskScheduler.addTask("dtuHeartbeat", DTUInterface::keepAliveStatic, this, userConfig.dtuHeartbeatInterval * 1000UL, 0, 0, false);
+    // one shot - armed to the next deadline of the timer wheel
+    timerWheelTask = taskScheduler.addTask("dtuTimerWheel", DTUInterface::timerWheelStatic, this, 0, 0, 100, false);
 }
 
 void DTUInterface::connect()
 {
-    if (client && !client->connected() && !dtuConnection.dtuActiveOffToCloudUpdate)
+    if (client && !client->connected() && !dtuConn->dtuActiveOffToCloudUpdate)
     {
         Serial.println("DTUinterface:\t client not connected with DTU! try to connect (server: " + String(serverIP) + " - port: " + String(serverPort) + ") ...");
         if (client->connect(serverIP, serverPort))
@@ -50,6 +79,9 @@ void DTUInterface::connect()
         else
         {
             Serial.println(F("DTUinterface:\t connection attempt failed..."));
+            // no error callback follows - plan the next attempt here
+            handleConnectionEvent(DTU_EV_CONNECT_FAILED);
+            scheduleReconnect();
         }
     }
 }
@@ -59,9 +91,14 @@ void DTUInterface::disconnect(uint8_t tgtState)
     // Serial.println(F("DTUinterface:\t disconnect request - try to disconnect from DTU ..."));
     if (client && client->connected())
     {
+        // planned states are entered before closing - the disconnect callback must not override them
+        if (tgtState == DTU_STATE_CLOUD_PAUSE)
+            handleConnectionEvent(DTU_EV_CLOUD_PAUSE);
+        else if (tgtState == DTU_STATE_STOPPED)
+            handleConnectionEvent(DTU_EV_STOP);
         client->close(true);
-        dtuConnection.dtuConnectState = tgtState;
-        // dtuGlobalData.dtuRssi = 0;
+        handleConnectionEvent(DTU_EV_DISCONNECTED);
+        // dtuData->dtuRssi = 0;
         Serial.println(F("DTUinterface:\t disconnect request - DTU connection closed"));
         if (tgtState == DTU_STATE_STOPPED)
         {
@@ -69,45 +106,67 @@ void DTUInterface::disconnect(uint8_t tgtState)
             Serial.println(F("DTUinterface:\t with freeing memory"));
         }
     }
-    else if (dtuConnection.dtuConnectState != DTU_STATE_CLOUD_PAUSE && tgtState != DTU_STATE_STOPPED)
+    else if (dtuConn->dtuConnectState != DTU_STATE_CLOUD_PAUSE && tgtState != DTU_STATE_STOPPED)
     {
         Serial.println(F("DTUinterface:\t disconnect request - no DTU connection to close"));
     }
+    publishSnapshot();
 }
 
 void DTUInterface::getDataUpdate()
 {
-    if (!dtuConnection.dtuActiveOffToCloudUpdate)
+    if (!dtuConn->dtuActiveOffToCloudUpdate)
     {
         if (client->connected())
-            writeReqRealDataNew();
+        {
+            // real data and config (for power limit) are requested together as one poll cycle
+            requestQueue.enqueue(DTU_REQ_REALDATANEW);
+            requestQueue.enqueue(DTU_REQ_GETCONFIG);
+            requestQueue.startPollCycle();
+            processRequestQueue();
+        }
         else
         {
-            dtuGlobalData.uptodate = false;
+            dtuData->uptodate = false;
+            snapshotDirty = true;
             Serial.println(F("DTUinterface:\t getDataUpdate - ERROR - not connected to DTU!"));
             // handleError(DTU_ERROR_NO_TIME);
         }
     }
 }
 
+boolean DTUInterface::checkDataUpdateDue()
+{
+    return pollScheduler.checkPollDue(dtuData->currentTimestamp);
+}
+
+void DTUInterface::requestDataUpdateIn(uint16_t seconds)
+{
+    pollScheduler.pollIn(dtuData->currentTimestamp, seconds);
+}
+
 void DTUInterface::setServer(const char *server)
 {
     serverIP = server;
     disconnect(DTU_STATE_OFFLINE);
 }
 
-void DTUInterface::setPowerLimit(int limit)
+boolean DTUInterface::setPowerLimit(int limit)
 {
-    dtuGlobalData.powerLimitSet = limit;
-    if (client->connected())
-    {
-        Serial.println("DTUinterface:\t try to set setPowerLimit: " + String(limit) + " %");
-        writeReqCommand(limit);
-    }
-    else
+    dtuData->powerLimitSet = limit;
+    snapshotDirty = true;
+    if (!client->connected())
     {
         Serial.println(F("DTUinterface:\t try to setPowerLimit - client not connected."));
+        return false;
     }
+    // same limit already sent and not yet effective - retries are done by the command tracker
+    if (!commandTracker.request(limit, millis()))
+        return false;
+    Serial.println("DTUinterface:\t try to set setPowerLimit: " + String(limit) + " %");
+    requestQueue.enqueue(DTU_REQ_COMMAND, limit);
+    processRequestQueue();
+    return true;
 }
 
 void DTUInterface::requestRestartDevice()
@@ -115,7 +174,8 @@ void DTUInterface::requestRestartDevice()
     if (client->connected())
     {
         Serial.println(F("DTUinterface:\t requestRestartDevice - send command to DTU ..."));
-        writeCommandRestartDevice();
+        requestQueue.enqueue(DTU_REQ_RESTARTDEVICE);
+        processRequestQueue();
     }
     else
     {
@@ -127,116 +187,378 @@ void DTUInterface::requestRestartDevice()
 
 void DTUInterface::dtuLoop()
 {
-    txrxStateObserver();
-    dtuConnectionObserver();
-
-    // check if cloud pause is active to prevent cloud errors
-    if (dtuConnection.preventCloudErrors)
-        cloudPauseActiveControl();
-    else
-        dtuConnection.dtuActiveOffToCloudUpdate = false;
+    // supervision only - connection state changes are driven by events and the timer wheel
+    checkCloudPause();
 
     // check for last data received
     checkingForLastDataReceived();
 
-    // check if we are in a cloud pause period
-    if (dtuConnection.dtuActiveOffToCloudUpdate)
+    // disconnected without a planned attempt (startup, wifi back) - start the retry sequence
+    if (!dtuConn->dtuActiveOffToCloudUpdate && dtuConn->dtuConnectState != DTU_STATE_STOPPED && dtuConn->dtuConnectState != DTU_STATE_TRY_RECONNECT)
     {
-        if (client->connected())
-            disconnect(DTU_STATE_CLOUD_PAUSE);
+        if ((!client || !client->connected()) && WiFi.status() == WL_CONNECTED)
+            scheduleReconnect();
     }
-    else if (dtuConnection.dtuConnectState != DTU_STATE_STOPPED)
+}
+
+void DTUInterface::checkCloudPause()
+{
+    // check if cloud pause is active to prevent cloud errors
+    if (!dtuConn->preventCloudErrors)
     {
-        // Check if we are in a pause period and if 60 seconds have passed
-        if (dtuConnection.dtuConnectRetriesLong > 0)
+        if (dtuConn->dtuActiveOffToCloudUpdate)
         {
-            if (millis() - dtuConnection.pauseStartTime < 60000)
-                return; // Still in pause period, exit the function early
-            else
-                dtuConnection.dtuConnectRetriesLong = 0; // Pause period has ended, reset long retry counter
+            dtuConn->dtuActiveOffToCloudUpdate = false;
+            snapshotDirty = true;
         }
+        timerWheel.cancel(DTU_TIMER_CLOUD_PAUSE);
+        return;
+    }
+    cloudPauseActiveControl();
+    if (dtuConn->dtuActiveOffToCloudUpdate)
+    {
+        if (client->connected())
+            disconnect(DTU_STATE_CLOUD_PAUSE);
+        if (!timerWheel.isScheduled(DTU_TIMER_RECONNECT))
+            armCloudPauseReconnect();
+    }
+    else if (!timerWheel.isScheduled(DTU_TIMER_CLOUD_PAUSE))
+    {
+        scheduleCloudPause();
+    }
+}
 
-        // Proceed if not preventing cloud errors and if disconnected but WiFi is connected
-        if ((!client || !client->connected()) && WiFi.status() == WL_CONNECTED)
+void DTUInterface::scheduleCloudPause()
+{
+    uint32_t untilStart = (DTU_CLOUD_PAUSE_START_IN_QUARTER + 900 - dtuData->currentTimestamp % 900) % 900;
+    // local DTU time is counted in seconds - re-check one second later if the window is not reached yet
+    scheduleTimer(DTU_TIMER_CLOUD_PAUSE, (untilStart > 0 ? untilStart : 1) * 1000UL);
+}
+
+void DTUInterface::scheduleReconnect()
+{
+    if (timerWheel.isScheduled(DTU_TIMER_RECONNECT) || dtuConn->dtuActiveOffToCloudUpdate || dtuConn->dtuConnectState == DTU_STATE_STOPPED)
+        return;
+    uint32_t delayMs = reconnectPolicy.nextDelay(userConfig.dtuReconnectMaxDelay * 1000UL);
+    Serial.println("DTUinterface:\t scheduleReconnect - next attempt in " + String(delayMs) + " ms");
+    scheduleTimer(DTU_TIMER_RECONNECT, delayMs);
+}
+
+void DTUInterface::armCloudPauseReconnect()
+{
+    // reconnect exactly at the end of the pause window
+    uint32_t pauseEnd = lastSwOff + dtuConn->cloudPauseSeconds + 1;
+    uint32_t remaining = (pauseEnd > dtuData->currentTimestamp) ? pauseEnd - dtuData->currentTimestamp : 0;
+    Serial.println("DTUinterface:\t armCloudPauseReconnect - reconnect in " + String(remaining) + " s");
+    scheduleTimer(DTU_TIMER_RECONNECT, remaining * 1000UL);
+}
+
+void DTUInterface::reconnect()
+{
+    if (dtuConn->dtuActiveOffToCloudUpdate)
+    {
+        if (dtuData->currentTimestamp + 1 < lastSwOff + dtuConn->cloudPauseSeconds)
         {
-            // If not currently in phase for waiting to connect, attempt to connect
-            if (dtuConnection.dtuConnectState != DTU_STATE_TRY_RECONNECT)
-            {
-                // Increment short retry counter and attempt to connect
-                dtuConnection.dtuConnectRetriesShort += 1;
-                if (dtuConnection.dtuConnectRetriesShort <= 5)
-                {
-                    Serial.println("DTUinterface:\t dtuLoop - try to connect ... short: " + String(dtuConnection.dtuConnectRetriesShort) + " - long: " + String(dtuConnection.dtuConnectRetriesLong));
-                    dtuConnection.dtuConnectState = DTU_STATE_TRY_RECONNECT;
-                    connect(); // Attempt to connect
-                }
-                else
-                {
-                    Serial.println("DTUinterface:\t dtuLoop - PAUSE ... short: " + String(dtuConnection.dtuConnectRetriesShort) + " - long: " + String(dtuConnection.dtuConnectRetriesLong));
-                    dtuConnection.dtuConnectState = DTU_STATE_OFFLINE;
-                    // Exceeded 5 attempts, initiate pause period
-                    dtuConnection.dtuConnectRetriesShort = 0; // Reset short retry counter
-                    dtuConnection.dtuConnectRetriesLong = 1;  // Indicate pause period has started
-                    dtuConnection.pauseStartTime = millis();  // Record start time of pause
-                }
-            }
+            // backoff attempt within the pause - wait for its end instead
+            armCloudPauseReconnect();
+            return;
         }
+        Serial.println(F("DTUinterface:\t reconnect - cloud pause ended - switch ''ON'' DTU server connection"));
+        endCloudPause();
+        // planned reconnect - no backoff from earlier failures
+        reconnectPolicy.reset();
+        scheduleCloudPause();
     }
+    if (dtuConn->dtuConnectState == DTU_STATE_STOPPED || WiFi.status() != WL_CONNECTED)
+        return;
+    if (!client || client->connected())
+        return;
+    reconnectPolicy.attemptStarted(millis());
+    Serial.println("DTUinterface:\t reconnect - attempt " + String(reconnectPolicy.getStats().attempts));
+    handleConnectionEvent(DTU_EV_CONNECT_START);
+    connect();
+}
+
+void DTUInterface::endCloudPause()
+{
+    dtuConn->dtuActiveOffToCloudUpdate = false;
+    // the first connect and data after the pause show if the DTU was still busy with the upload
+    cloudPauseLearner.pauseEnded(millis());
+    emitEvent(DTU_EVENT_CLOUD_PAUSE_END);
+}
+
+void DTUInterface::handleConnectionEvent(uint8_t event)
+{
+    uint8_t lastState = dtuConn->dtuConnectState;
+    if (!connectionFsm.handleEvent(event, dtuConn->dtuConnectState, millis()))
+        return;
+
+    if (event == DTU_EV_CONNECT_FAILED || event == DTU_EV_CONNECT_TIMEOUT || (event == DTU_EV_ERROR && lastState == DTU_STATE_TRY_RECONNECT))
+        cloudPauseLearner.connectFailed();
+    cloudPauseLearner.setOnline(dtuConn->dtuConnectState == DTU_STATE_CONNECTED, millis());
+
+    // timeouts bound to the new state
+    if (dtuConn->dtuConnectState == DTU_STATE_TRY_RECONNECT)
+        scheduleTimer(DTU_TIMER_CONNECT_TIMEOUT, DTU_CONNECT_TIMEOUT_MS);
+    else
+        timerWheel.cancel(DTU_TIMER_CONNECT_TIMEOUT);
+    updateOnlineState(lastState);
+    emitEvent(DTU_EVENT_STATE_CHANGE, dtuConn->dtuConnectState);
 }
 
-void DTUInterface::txrxStateObserver()
+void DTUInterface::updateOnlineState(uint8_t lastState)
 {
-    // check current txrx state and set seen at time and check for timeout
-    if (dtuConnection.dtuTxRxState != dtuConnection.dtuTxRxStateLast)
+    // summary of connection state - offline is only reported after a grace time
+    boolean online = dtuConn->dtuConnectState == DTU_STATE_CONNECTED || dtuConn->dtuConnectState == DTU_STATE_CLOUD_PAUSE;
+    boolean wasOnline = lastState == DTU_STATE_CONNECTED || lastState == DTU_STATE_CLOUD_PAUSE;
+    if (online)
     {
-        Serial.println("DTUinterface:\t stateObserver - change from " + String(dtuConnection.dtuTxRxStateLast) + " to " + String(dtuConnection.dtuTxRxState) + " - difference: " + String(millis() - dtuConnection.dtuTxRxStateLastChange) + " ms");
-        dtuConnection.dtuTxRxStateLast = dtuConnection.dtuTxRxState;
-        dtuConnection.dtuTxRxStateLastChange = millis();
+        timerWheel.cancel(DTU_TIMER_OFFLINE_GRACE);
+        dtuConn->dtuConnectionOnline = true;
     }
-    else if (millis() - dtuConnection.dtuTxRxStateLastChange > 15000 && dtuConnection.dtuTxRxState != DTU_TXRX_STATE_IDLE)
+    else if (wasOnline)
     {
-        Serial.println(F("DTUinterface:\t stateObserver - timeout - reset txrx state to DTU_TXRX_STATE_IDLE"));
-        dtuConnection.dtuTxRxState = DTU_TXRX_STATE_IDLE;
+        scheduleTimer(DTU_TIMER_OFFLINE_GRACE, DTU_OFFLINE_GRACE_MS);
     }
 }
 
-void DTUInterface::dtuConnectionObserver()
+void DTUInterface::setTxRxState(uint8_t state)
+{
+    if (dtuConn->dtuTxRxState == state)
+        return;
+    connectionFsm.traceTxRx(dtuConn->dtuTxRxState, state, millis());
+    snapshotDirty = true;
+    dtuConn->dtuTxRxStateLast = dtuConn->dtuTxRxState;
+    dtuConn->dtuTxRxStateLastChange = millis();
+    dtuConn->dtuTxRxState = state;
+}
+
+void DTUInterface::publishSnapshot()
 {
-    boolean currentOnlineOfflineState = false;
-    if (dtuConnection.dtuConnectState == DTU_STATE_CONNECTED || dtuConnection.dtuConnectState == DTU_STATE_CLOUD_PAUSE)
+    // nothing written since the last publish - readers keep the version they have
+    if (!snapshotDirty)
+        return;
+    snapshotDirty = false;
+#if defined(ESP32)
+    portENTER_CRITICAL(&snapshotMux);
+#endif
+    dtuSnapshot &back = snapshot.beginWrite();
+    back.data = *dtuData;
+    back.connection = *dtuConn;
+    back.telemetry = telemetry;
+    back.command = commandTracker;
+    snapshot.publish();
+    uint8_t events = pendingEvents;
+    pendingEvents = 0;
+    int32_t values[DTU_EVENT_TYPES];
+    uint32_t origins[DTU_EVENT_TYPES];
+    memcpy(values, pendingValues, sizeof(values));
+    memcpy(origins, pendingOrigins, sizeof(origins));
+#if defined(ESP32)
+    portEXIT_CRITICAL(&snapshotMux);
+#endif
+    // the events of this version - in the order of the types
+    for (uint8_t type = 0; type < DTU_EVENT_TYPES; type++)
     {
-        currentOnlineOfflineState = true;
+        if (events & DTU_EVENT_MASK(type))
+            dtuEventBus.post(type, this, values[type], origins[type]);
     }
-    else if (dtuConnection.dtuConnectState == DTU_STATE_OFFLINE || dtuConnection.dtuConnectState == DTU_STATE_TRY_RECONNECT || dtuConnection.dtuConnectState == DTU_STATE_STOPPED || dtuConnection.dtuConnectState == DTU_STATE_CONNECT_ERROR || dtuConnection.dtuConnectState == DTU_STATE_DTU_REBOOT)
+}
+
+void DTUInterface::emitEvent(uint8_t type, int32_t value, uint32_t originUs)
+{
+    // an event always comes with a change - posted with the next publish
+    snapshotDirty = true;
+#if defined(ESP32)
+    portENTER_CRITICAL(&snapshotMux);
+#endif
+    // the same type twice before the publish - one event with the last value and the first origin
+    if (!(pendingEvents & DTU_EVENT_MASK(type)))
+        pendingOrigins[type] = (originUs != 0) ? originUs : micros();
+    pendingValues[type] = value;
+    pendingEvents |= DTU_EVENT_MASK(type);
+#if defined(ESP32)
+    portEXIT_CRITICAL(&snapshotMux);
+#endif
+}
+
+void DTUInterface::persistEnergyHistory()
+{
+    if (energyHistory.isSavePending())
+        energyHistory.save();
+}
+
+void DTUInterface::scheduleTimer(uint8_t timerId, uint32_t delayMs)
+{
+    timerWheel.schedule(timerId, millis(), delayMs);
+    armTimerWheel();
+}
+
+void DTUInterface::armTimerWheel()
+{
+    // the wheel can be armed from any task - a stale delay must not overwrite a newer deadline
+#if defined(ESP32)
+    portENTER_CRITICAL(&timerArmMux);
+#endif
+    uint32_t nextDelay = timerWheel.getNextDelay(millis());
+    if (nextDelay == DTU_TIMER_WHEEL_NO_DEADLINE)
+        taskScheduler.disable(timerWheelTask);
+    else
+        taskScheduler.runIn(timerWheelTask, nextDelay);
+#if defined(ESP32)
+    portEXIT_CRITICAL(&timerArmMux);
+#endif
+}
+
+void DTUInterface::timerWheelStatic(void *instance)
+{
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(instance);
+    if (dtuInterface)
     {
-        currentOnlineOfflineState = false;
+        dtuInterface->timerWheel.advance(millis());
+        dtuInterface->armTimerWheel();
+        dtuInterface->publishSnapshot();
     }
+}
 
-    if (currentOnlineOfflineState != lastOnlineOfflineState)
+void DTUInterface::onTimerStatic(void *context, uint8_t timerId)
+{
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(context);
+    if (dtuInterface)
     {
-        Serial.println("DTUinterface:\t setOverallOnlineOfflineState - change from " + String(lastOnlineOfflineState) + " to " + String(dtuConnection.dtuConnectionOnline));
-        lastOnlineOfflineChange = millis();
-        lastOnlineOfflineState = currentOnlineOfflineState;
+        dtuInterface->onTimer(timerId);
     }
+}
 
-    // summary of connection state
-    if (currentOnlineOfflineState)
+void DTUInterface::onTimer(uint8_t timerId)
+{
+    switch (timerId)
     {
-        dtuConnection.dtuConnectionOnline = true;
+    case DTU_TIMER_RECONNECT:
+        reconnect();
+        break;
+    case DTU_TIMER_CONNECT_TIMEOUT:
+        Serial.println("DTUinterface:\t connect attempt without answer after " + String(DTU_CONNECT_TIMEOUT_MS) + " ms - abort");
+        handleConnectionEvent(DTU_EV_CONNECT_TIMEOUT);
+        if (client)
+            client->close(true);
+        scheduleReconnect();
+        break;
+    case DTU_TIMER_OFFLINE_GRACE:
+        Serial.println("DTUinterface:\t connection offline for " + String(DTU_OFFLINE_GRACE_MS / 1000) + " s - current conn state: " + String(dtuConn->dtuConnectState));
+        dtuConn->dtuConnectionOnline = false;
+        emitEvent(DTU_EVENT_STATE_CHANGE, dtuConn->dtuConnectState);
+        break;
+    case DTU_TIMER_CLOUD_PAUSE:
+        checkCloudPause();
+        break;
+    case DTU_TIMER_COMMAND:
+        checkCommandRetry();
+        break;
     }
-    else if (millis() - lastOnlineOfflineChange > 90000 && currentOnlineOfflineState == false)
+}
+
+void DTUInterface::checkCommandRetry()
+{
+    // retry count and state of the command tracker
+    snapshotDirty = true;
+    if (commandTracker.checkRetry(millis()))
     {
-        Serial.print(F("DTUinterface:\t setOverallOnlineOfflineState - timeout - reset online offline state"));
-        Serial.println(" - difference: " + String((millis() - lastOnlineOfflineChange)/1000,3) + " ms - current conn state: " + String(dtuConnection.dtuConnectState));
-        dtuConnection.dtuConnectionOnline = false;
+        if (client && client->connected())
+        {
+            requestQueue.enqueue(DTU_REQ_COMMAND, commandTracker.getTarget());
+            processRequestQueue();
+        }
+        else
+        {
+            commandTracker.connectionLost();
+        }
+        return;
     }
+    // acked - ask for the current limit until it is effective
+    if (commandTracker.getState() == DTU_CMD_STATE_ACKED)
+        requestQueue.enqueue(DTU_REQ_GETCONFIG);
+    uint32_t timeout = commandTracker.getTimeout(millis());
+    if (timeout > 0)
+        scheduleTimer(DTU_TIMER_COMMAND, timeout < DTU_CMD_ACK_TIMEOUT_MS ? timeout : DTU_CMD_ACK_TIMEOUT_MS);
 }
 
-void DTUInterface::dtuLoopStatic(DTUInterface *dtuInterface)
+void DTUInterface::processRequestQueue()
 {
+    // every request has its own timeout - give the next one a chance if the DTU does not answer
+    if (requestQueue.checkTimeout() && requestQueue.getActiveCount() == 0)
+        setTxRxState(DTU_TXRX_STATE_IDLE);
+
+    if (!client || !client->connected())
+        return;
+
+    // write requests back-to-back - the responses are routed by their command id
+    while (requestQueue.getActiveCount() < DTU_REQ_PIPELINE_DEPTH)
+    {
+        uint8_t param = 0;
+        uint8_t type = requestQueue.next(param);
+        if (type == DTU_REQ_NONE)
+            return;
+
+        requestQueue.startRequest(type);
+        boolean sent = false;
+        switch (type)
+        {
+        case DTU_REQ_REALDATANEW:
+            sent = writeReqRealDataNew();
+            break;
+        case DTU_REQ_GETCONFIG:
+            sent = writeReqGetConfig();
+            break;
+        case DTU_REQ_APPGETHISTPOWER:
+            sent = writeReqAppGetHistPower();
+            break;
+        case DTU_REQ_COMMAND:
+            sent = writeReqCommand(param);
+            break;
+        case DTU_REQ_RESTARTDEVICE:
+            sent = writeCommandRestartDevice();
+            break;
+        case DTU_REQ_HEARTBEAT:
+            sent = writeReqHeartbeat();
+            break;
+        }
+        if (!sent)
+            requestQueue.finishRequest(type);
+    }
+}
+
+requestTemplateStats DTUInterface::getRequestTemplateStats() const
+{
+    requestTemplateStats total;
+    const requestTemplateStats *stats[] = {&realDataNewTemplate.getStats(), &getConfigTemplate.getStats(), &appGetHistPowerTemplate.getStats(), &heartbeatTemplate.getStats()};
+    for (const requestTemplateStats *s : stats)
+    {
+        total.patched += s->patched;
+        total.encoded += s->encoded;
+    }
+    return total;
+}
+
+void DTUInterface::txRxStatic(void *instance)
+{
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(instance);
+    if (dtuInterface)
+    {
+        dtuInterface->processReceived();
+        dtuInterface->processRequestQueue();
+        // all frames received so far are decoded - readers see the new values at once
+        dtuInterface->publishSnapshot();
+    }
+}
+
+void DTUInterface::dtuLoopStatic(void *instance)
+{
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(instance);
     if (dtuInterface)
     {
         dtuInterface->dtuLoop();
+        dtuInterface->publishSnapshot();
     }
 }
 
@@ -244,9 +566,22 @@ void DTUInterface::keepAlive()
 {
     if (client && client->connected())
     {
-        const char *keepAliveMsg = "\0"; // minimal message
-        client->write(keepAliveMsg, strlen(keepAliveMsg));
-        // Serial.println(F("DTUinterface:\t keepAlive message sent."));
+        heartbeat.startBeat();
+        if (heartbeat.isLinkDead(userConfig.dtuHeartbeatMaxMissed))
+        {
+            // the link is gone without the TCP stack noticing it - closing starts the reconnect sequence
+            Serial.println("DTUinterface:\t keepAlive - " + String(heartbeat.getStats().missedInRow) + " heartbeats missed - closing dead connection");
+            heartbeat.countDeadLink();
+            heartbeat.reset();
+            handleConnectionEvent(DTU_EV_LINK_DEAD);
+            client->close(true);
+            return;
+        }
+        // last beat missed - check again soon instead of waiting the full interval
+        if (heartbeat.getStats().missedInRow > 0)
+            taskScheduler.runIn(keepAliveTask, DTU_HEARTBEAT_RETRY_INTERVAL * 1000UL);
+        requestQueue.enqueue(DTU_REQ_HEARTBEAT);
+        processRequestQueue();
     }
     else
     {
@@ -254,11 +589,13 @@ void DTUInterface::keepAlive()
     }
 }
 
-void DTUInterface::keepAliveStatic(DTUInterface *dtuInterface)
+void DTUInterface::keepAliveStatic(void *instance)
 {
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(instance);
     if (dtuInterface)
     {
         dtuInterface->keepAlive();
+        dtuInterface->publishSnapshot();
     }
 }
 
@@ -266,7 +603,12 @@ void DTUInterface::flushConnection()
 {
     Serial.println(F("DTUinterface:\t Flushing connection and instance..."));
 
-    loopTimer.detach();
+    taskScheduler.disable(loopTask);
+    taskScheduler.disable(txRxTask);
+    taskScheduler.disable(keepAliveTask);
+    taskScheduler.disable(timerWheelTask);
+    for (uint8_t i = 0; i < DTU_TIMER_WHEEL_MAX_TIMERS; i++)
+        timerWheel.cancel(i);
     Serial.println(F("DTUinterface:\t All timers stopped."));
 
     // Disconnect if connected
@@ -283,108 +625,214 @@ void DTUInterface::flushConnection()
         client = nullptr;
         Serial.println(F("DTUinterface:\t Client memory freed."));
     }
+    // bytes and events of the closed connection
+    rxQueue.clear();
 
     // Reset connection control and global data
-    memset(&dtuConnection, 0, sizeof(dtuConnection));
-    memset(&dtuGlobalData, 0, sizeof(dtuGlobalData));
+    memset(dtuConn, 0, sizeof(*dtuConn));
+    memset(dtuData, 0, sizeof(*dtuData));
+    snapshotDirty = true;
+    publishSnapshot();
     Serial.println(F("DTUinterface:\t Connection control and global data reset."));
 }
 
-// event driven methods
+// event driven methods - the async TCP callbacks only hand over to the tx/rx task in the loop
+
 void DTUInterface::onConnect(void *arg, AsyncClient *c)
 {
-    // Connection established
-    dtuConnection.dtuConnectState = DTU_STATE_CONNECTED;
-    // DTUInterface *conn = static_cast<DTUInterface *>(arg);
-    Serial.println(F("DTUinterface:\t connected to DTU"));
     DTUInterface *dtuInterface = static_cast<DTUInterface *>(arg);
     if (dtuInterface)
     {
-        Serial.println(F("DTUinterface:\t starting keep-alive timer..."));
-        dtuInterface->keepAliveTimer.attach(10, DTUInterface::keepAliveStatic, dtuInterface);
+        dtuInterface->rxQueue.putEvent(DTU_RX_EV_CONNECTED);
+        taskScheduler.runIn(dtuInterface->txRxTask, 0);
     }
-    // initiate next data update immediately (at startup or re-connect)
-    platformData.dtuNextUpdateCounterSeconds = dtuGlobalData.currentTimestamp - userConfig.dtuUpdateTime + 5;
 }
 
 void DTUInterface::onDisconnect(void *arg, AsyncClient *c)
 {
-    // Connection lost
-    Serial.println(F("DTUinterface:\t disconnected from DTU"));
-    dtuConnection.dtuConnectState = DTU_STATE_OFFLINE;
-    // dtuGlobalData.dtuRssi = 0;
     DTUInterface *dtuInterface = static_cast<DTUInterface *>(arg);
     if (dtuInterface)
     {
-        // Serial.println(F("DTUinterface:\t stopping keep-alive timer..."));
-        dtuInterface->keepAliveTimer.detach();
+        dtuInterface->rxQueue.putEvent(DTU_RX_EV_DISCONNECTED);
+        taskScheduler.runIn(dtuInterface->txRxTask, 0);
     }
 }
 
 void DTUInterface::onError(void *arg, AsyncClient *c, int8_t error)
 {
-    // Connection error
+    // the client can be gone when the loop handles the error
     String errorStr = c->errorToString(error);
     Serial.println("DTUinterface:\t DTU Connection error: " + errorStr + " (" + String(error) + ")");
-    dtuConnection.dtuConnectState = DTU_STATE_CONNECT_ERROR;
-    dtuGlobalData.dtuRssi = 0;
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(arg);
+    if (dtuInterface)
+    {
+        dtuInterface->rxQueue.putEvent(DTU_RX_EV_ERROR, error);
+        taskScheduler.runIn(dtuInterface->txRxTask, 0);
+    }
 }
 
-void DTUInterface::handleError(uint8_t errorState)
+void DTUInterface::onDataReceived(void *arg, AsyncClient *client, void *data, size_t len)
 {
-    if (client->connected())
+    DTUInterface *dtuInterface = static_cast<DTUInterface *>(arg);
+    if (dtuInterface)
     {
-        dtuConnection.dtuErrorState = errorState;
-        dtuConnection.dtuConnectState = DTU_STATE_DTU_REBOOT;
-        Serial.print(F("DTUinterface:\t DTU Connection --- ERROR - try with reboot of DTU - error state: "));
-        Serial.println(errorState);
-        writeCommandRestartDevice();
-        dtuGlobalData.dtuResetRequested = dtuGlobalData.dtuResetRequested + 1;
-        // disconnect(dtuConnection.dtuConnectState);
+        if (dtuInterface->rxQueue.putData(static_cast<const uint8_t *>(data), len) < len)
+            dtuInterface->rxOverflow = true;
+        taskScheduler.runIn(dtuInterface->txRxTask, 0);
     }
 }
 
-// Callback method to handle incoming data
-void DTUInterface::onDataReceived(void *arg, AsyncClient *client, void *data, size_t len)
+void DTUInterface::processReceived()
 {
-    txrxStateObserver();
-    DTUInterface *dtuInterface = static_cast<DTUInterface *>(arg);
-    // first 10 bytes are header or similar and actual data starts from the 11th byte
-    pb_istream_t istream = pb_istream_from_buffer(static_cast<uint8_t *>(data) + 10, len - 10);
+    if (rxOverflow)
+    {
+        rxOverflow = false;
+        Serial.println("DTUinterface:\t receive buffer full - " + String(rxQueue.getStats().droppedBytes) + " bytes dropped so far");
+    }
+    // bytes and connection events in the order they were received
+    receiveEvent event;
+    for (;;)
+    {
+        // TCP segments can contain a part of a frame or several frames - parsed in place in the receive queue
+        uint32_t limit;
+        boolean eventPending = rxQueue.getStreamPos(limit);
+        dtuFrameHeader header;
+        pb_istream_t istream;
+        while (frameAssembler.nextFrame(header, istream, limit))
+        {
+            handleFrame(header, istream);
+            frameAssembler.releaseFrame();
+        }
+        if (!eventPending)
+            break;
+        // a partial frame before a connection event is never completed
+        frameAssembler.discard(limit);
+        if (!rxQueue.takeEvent(event))
+            break;
+        handleReceiveEvent(event);
+    }
+    if (requestQueue.getActiveCount() == 0)
+        setTxRxState(DTU_TXRX_STATE_IDLE);
+}
 
-    switch (dtuConnection.dtuTxRxState)
+void DTUInterface::handleReceiveEvent(const receiveEvent &event)
+{
+    snapshotDirty = true;
+    switch (event.type)
     {
-    case DTU_TXRX_STATE_WAIT_REALDATANEW:
-        dtuInterface->readRespRealDataNew(istream);
-        // if real data received, then request config for powerlimit
-        dtuInterface->writeReqGetConfig();
-        break;
-    case DTU_TXRX_STATE_WAIT_APPGETHISTPOWER:
-        dtuInterface->readRespAppGetHistPower(istream);
+    case DTU_RX_EV_CONNECTED:
+        Serial.println(F("DTUinterface:\t connected to DTU"));
+        handleConnectionEvent(DTU_EV_CONNECTED);
+        reconnectPolicy.connected(millis());
+        cloudPauseLearner.connected(millis());
+        Serial.println(F("DTUinterface:\t starting heartbeat timer..."));
+        heartbeat.reset();
+        taskScheduler.runIn(keepAliveTask, userConfig.dtuHeartbeatInterval * 1000UL);
+        // initiate next data update immediately (at startup or re-connect)
+        pollScheduler.pollIn(dtuData->currentTimestamp, 5);
+        // fill the gap in the power curve since the last connection
+        historyBackfillPending = true;
         break;
-    case DTU_TXRX_STATE_WAIT_GETCONFIG:
-        dtuInterface->readRespGetConfig(istream);
+    case DTU_RX_EV_DISCONNECTED:
+        Serial.println(F("DTUinterface:\t disconnected from DTU"));
+        handleConnectionEvent(DTU_EV_DISCONNECTED);
+        // dtuData->dtuRssi = 0;
+        // Serial.println(F("DTUinterface:\t stopping keep-alive timer..."));
+        taskScheduler.disable(keepAliveTask);
+        // pending requests are outdated with the next connection
+        requestQueue.clear();
+        commandTracker.connectionLost();
+        setTxRxState(DTU_TXRX_STATE_IDLE);
+        scheduleReconnect();
         break;
-    case DTU_TXRX_STATE_WAIT_COMMAND:
-        dtuInterface->readRespCommand(istream);
-        // get updated power setting
-        dtuInterface->writeReqGetConfig();
+    case DTU_RX_EV_ERROR:
+        handleConnectionEvent(DTU_EV_ERROR);
+        dtuData->dtuRssi = 0;
+        scheduleReconnect();
         break;
-    case DTU_TXRX_STATE_WAIT_RESTARTDEVICE:
-        dtuInterface->readRespCommandRestartDevice(istream);
+    }
+}
+
+void DTUInterface::handleError(uint8_t errorState)
+{
+    if (client->connected())
+    {
+        dtuConn->dtuErrorState = errorState;
+        snapshotDirty = true;
+        handleConnectionEvent(DTU_EV_REBOOT);
+        Serial.print(F("DTUinterface:\t DTU Connection --- ERROR - try with reboot of DTU - error state: "));
+        Serial.println(errorState);
+        requestQueue.enqueue(DTU_REQ_RESTARTDEVICE);
+        // called while decoding a response - sent by the tx/rx task right after it
+        taskScheduler.runIn(txRxTask, 0);
+        dtuData->dtuResetRequested = dtuData->dtuResetRequested + 1;
+        // disconnect(dtuConn->dtuConnectState);
+    }
+}
+
+void DTUInterface::handleFrame(const dtuFrameHeader &header, pb_istream_t &istream)
+{
+    // every response can change data, telemetry or command state
+    snapshotDirty = true;
+    // responses are routed by the full command id of the frame - any other id is unsolicited
+    switch ((uint16_t(header.cmdHigh) << 8) | header.cmdLow)
+    {
+    case responseId(CMD_REAL_RES_DTO):
+        if (!requestQueue.finishRequest(DTU_REQ_REALDATANEW))
+            break;
+        readRespRealDataNew(istream);
+        return;
+    case responseId(CMD_HB_RES_DTO):
+        if (!requestQueue.finishRequest(DTU_REQ_HEARTBEAT))
+            break;
+        // the response content (DTU time) is not needed - only the round trip counts
+        heartbeat.beatAnswered(millis());
+        return;
+    case responseId(CMD_GET_CONFIG):
+        if (!requestQueue.finishRequest(DTU_REQ_GETCONFIG))
+            break;
+        readRespGetConfig(istream);
+        return;
+    case responseId(CMD_APP_GET_HIST_POWER_RES):
+        if (!requestQueue.finishRequest(DTU_REQ_APPGETHISTPOWER))
+            break;
+        readRespAppGetHistPower(istream);
+        return;
+    case responseId(CMD_COMMAND_RES_DTO):
+    case responseId(CMD_CLOUD_COMMAND_RES_DTO): // restart - the action tells which request is answered
+    {
+        CommandReqDTO commandreqdto = CommandReqDTO_init_default;
+        if (!pb_decode(&istream, &CommandReqDTO_msg, &commandreqdto))
+        {
+            Serial.println("DTUinterface:\t handleFrame - failed to decode command response: " + String(PB_GET_ERROR(&istream)));
+            break;
+        }
+        boolean isRestart = requestQueue.isActive(DTU_REQ_RESTARTDEVICE) && (commandreqdto.action == CMD_ACTION_DTU_REBOOT || !requestQueue.isActive(DTU_REQ_COMMAND));
+        if (isRestart && requestQueue.finishRequest(DTU_REQ_RESTARTDEVICE))
+        {
+            readRespCommandRestartDevice(commandreqdto);
+            return;
+        }
+        if (requestQueue.finishRequest(DTU_REQ_COMMAND))
+        {
+            readRespCommand(commandreqdto);
+            return;
+        }
         break;
+    }
     default:
-        Serial.println(F("DTUinterface:\t onDataReceived - no valid or known state"));
         break;
     }
+    requestQueue.countUnsolicited();
+    Serial.printf("DTUinterface:\t handleFrame - unsolicited or unknown frame - cmd: %02X %02X - length: %i\n", header.cmdHigh, header.cmdLow, header.length);
 }
 
-// output data methods
+// output data methods - from a published snapshot
 
-void DTUInterface::printDataAsTextToSerial()
+void DTUInterface::printDataAsTextToSerial(const dtuSnapshot &dtuState)
 {
-    Serial.print("power limit (set): " + String(dtuGlobalData.powerLimit) + " % (" + String(dtuGlobalData.powerLimitSet) + " %) --- ");
-    Serial.print("inverter temp: " + String(dtuGlobalData.inverterTemp) + " °C \n");
+    Serial.print("power limit (set): " + String(dtuState.data.powerLimit) + " % (" + String(dtuState.data.powerLimitSet) + " %) --- ");
+    Serial.print("inverter temp: " + String(dtuState.data.inverterTemp) + " °C \n");
 
     Serial.print(F(" \t |_____current____|_____voltage___|_____power_____|________daily______|_____total_____|\n"));
     // 12341234 |1234 current  |1234 voltage  |1234 power1234|12341234daily 1234|12341234total 1234|
@@ -392,56 +840,56 @@ void DTUInterface::printDataAsTextToSerial()
     // pvO 1234 |1234 123456 A |1234 123456 V |1234 123456 W |1234 12345678 kWh |1234 12345678 kWh |
     // pvI 1234 |1234 123456 A |1234 123456 V |1234 123456 W |1234 12345678 kWh |1234 12345678 kWh |
     Serial.print(F("grid\t"));
-    Serial.printf(" |\t %6.2f A", dtuGlobalData.grid.current);
-    Serial.printf(" |\t %6.2f V", dtuGlobalData.grid.voltage);
-    Serial.printf(" |\t %6.2f W", dtuGlobalData.grid.power);
-    Serial.printf(" |\t %8.3f kWh", dtuGlobalData.grid.dailyEnergy);
-    Serial.printf(" |\t %8.3f kWh |\n", dtuGlobalData.grid.totalEnergy);
+    Serial.printf(" |\t %6.2f A", dtuState.data.grid.current);
+    Serial.printf(" |\t %6.2f V", dtuState.data.grid.voltage);
+    Serial.printf(" |\t %6.2f W", dtuState.data.grid.power);
+    Serial.printf(" |\t %8.3f kWh", dtuState.data.grid.dailyEnergy);
+    Serial.printf(" |\t %8.3f kWh |\n", dtuState.data.grid.totalEnergy);
 
     Serial.print(F("pv0\t"));
-    Serial.printf(" |\t %6.2f A", dtuGlobalData.pv0.current);
-    Serial.printf(" |\t %6.2f V", dtuGlobalData.pv0.voltage);
-    Serial.printf(" |\t %6.2f W", dtuGlobalData.pv0.power);
-    Serial.printf(" |\t %8.3f kWh", dtuGlobalData.pv0.dailyEnergy);
-    Serial.printf(" |\t %8.3f kWh |\n", dtuGlobalData.pv0.totalEnergy);
+    Serial.printf(" |\t %6.2f A", dtuState.data.pv0.current);
+    Serial.printf(" |\t %6.2f V", dtuState.data.pv0.voltage);
+    Serial.printf(" |\t %6.2f W", dtuState.data.pv0.power);
+    Serial.printf(" |\t %8.3f kWh", dtuState.data.pv0.dailyEnergy);
+    Serial.printf(" |\t %8.3f kWh |\n", dtuState.data.pv0.totalEnergy);
 
     Serial.print(F("pv1\t"));
-    Serial.printf(" |\t %6.2f A", dtuGlobalData.pv1.current);
-    Serial.printf(" |\t %6.2f V", dtuGlobalData.pv1.voltage);
-    Serial.printf(" |\t %6.2f W", dtuGlobalData.pv1.power);
-    Serial.printf(" |\t %8.3f kWh", dtuGlobalData.pv1.dailyEnergy);
-    Serial.printf(" |\t %8.3f kWh |\n", dtuGlobalData.pv1.totalEnergy);
+    Serial.printf(" |\t %6.2f A", dtuState.data.pv1.current);
+    Serial.printf(" |\t %6.2f V", dtuState.data.pv1.voltage);
+    Serial.printf(" |\t %6.2f W", dtuState.data.pv1.power);
+    Serial.printf(" |\t %8.3f kWh", dtuState.data.pv1.dailyEnergy);
+    Serial.printf(" |\t %8.3f kWh |\n", dtuState.data.pv1.totalEnergy);
 }
 
-void DTUInterface::printDataAsJsonToSerial()
+void DTUInterface::printDataAsJsonToSerial(const dtuSnapshot &dtuState)
 {
     Serial.print(F("\nJSONObject:"));
     JsonDocument doc;
 
-    doc["timestamp"] = dtuGlobalData.respTimestamp;
-    doc["uptodate"] = dtuGlobalData.uptodate;
-    doc["dtuRssi"] = dtuGlobalData.dtuRssi;
-    doc["powerLimit"] = dtuGlobalData.powerLimit;
-    doc["powerLimitSet"] = dtuGlobalData.powerLimitSet;
-    doc["inverterTemp"] = dtuGlobalData.inverterTemp;
-
-    doc["grid"]["current"] = dtuGlobalData.grid.current;
-    doc["grid"]["voltage"] = dtuGlobalData.grid.voltage;
-    doc["grid"]["power"] = dtuGlobalData.grid.power;
-    doc["grid"]["dailyEnergy"] = dtuGlobalData.grid.dailyEnergy;
-    doc["grid"]["totalEnergy"] = dtuGlobalData.grid.totalEnergy;
-
-    doc["pv0"]["current"] = dtuGlobalData.pv0.current;
-    doc["pv0"]["voltage"] = dtuGlobalData.pv0.voltage;
-    doc["pv0"]["power"] = dtuGlobalData.pv0.power;
-    doc["pv0"]["dailyEnergy"] = dtuGlobalData.pv0.dailyEnergy;
-    doc["pv0"]["totalEnergy"] = dtuGlobalData.pv0.totalEnergy;
-
-    doc["pv1"]["current"] = dtuGlobalData.pv1.current;
-    doc["pv1"]["voltage"] = dtuGlobalData.pv1.voltage;
-    doc["pv1"]["power"] = dtuGlobalData.pv1.power;
-    doc["pv1"]["dailyEnergy"] = dtuGlobalData.pv1.dailyEnergy;
-    doc["pv1"]["totalEnergy"] = dtuGlobalData.pv1.totalEnergy;
+    doc["timestamp"] = dtuState.data.respTimestamp;
+    doc["uptodate"] = dtuState.data.uptodate;
+    doc["dtuRssi"] = dtuState.data.dtuRssi;
+    doc["powerLimit"] = dtuState.data.powerLimit;
+    doc["powerLimitSet"] = dtuState.data.powerLimitSet;
+    doc["inverterTemp"] = dtuState.data.inverterTemp;
+
+    doc["grid"]["current"] = dtuState.data.grid.current;
+    doc["grid"]["voltage"] = dtuState.data.grid.voltage;
+    doc["grid"]["power"] = dtuState.data.grid.power;
+    doc["grid"]["dailyEnergy"] = dtuState.data.grid.dailyEnergy;
+    doc["grid"]["totalEnergy"] = dtuState.data.grid.totalEnergy;
+
+    doc["pv0"]["current"] = dtuState.data.pv0.current;
+    doc["pv0"]["voltage"] = dtuState.data.pv0.voltage;
+    doc["pv0"]["power"] = dtuState.data.pv0.power;
+    doc["pv0"]["dailyEnergy"] = dtuState.data.pv0.dailyEnergy;
+    doc["pv0"]["totalEnergy"] = dtuState.data.pv0.totalEnergy;
+
+    doc["pv1"]["current"] = dtuState.data.pv1.current;
+    doc["pv1"]["voltage"] = dtuState.data.pv1.voltage;
+    doc["pv1"]["power"] = dtuState.data.pv1.power;
+    doc["pv1"]["dailyEnergy"] = dtuState.data.pv1.dailyEnergy;
+    doc["pv1"]["totalEnergy"] = dtuState.data.pv1.totalEnergy;
     serializeJson(doc, Serial);
 }
 
@@ -462,244 +910,161 @@ String DTUInterface::getTimeStringByTimestamp(unsigned long timestamp)
     return String(buf);
 }
 
-void DTUInterface::initializeCRC()
-{
-    // CRC
-    crc.setInitial(CRC16_MODBUS_INITIAL);
-    crc.setPolynome(CRC16_MODBUS_POLYNOME);
-    crc.setReverseIn(CRC16_MODBUS_REV_IN);
-    crc.setReverseOut(CRC16_MODBUS_REV_OUT);
-    crc.setXorOut(CRC16_MODBUS_XOR_OUT);
-    crc.restart();
-    // Serial.println(F("DTUinterface:\t CRC initialized"));
-}
-
 void DTUInterface::checkingForLastDataReceived()
 {
     // check if last data received - currentTimestamp + 5 sec (to debounce async current timestamp) - lastRespTimestamp > 3 min
-    if (((dtuGlobalData.currentTimestamp + 5) - dtuGlobalData.lastRespTimestamp) > (3 * 60) && dtuGlobalData.grid.voltage > 0 && dtuConnection.dtuErrorState != DTU_ERROR_LAST_SEND) // dtuGlobalData.grid.voltage > 0 indicates dtu/ inverter was working
+    if (((dtuData->currentTimestamp + 5) - dtuData->lastRespTimestamp) > (3 * 60) && dtuData->grid.voltage > 0 && dtuConn->dtuErrorState != DTU_ERROR_LAST_SEND) // dtuData->grid.voltage > 0 indicates dtu/ inverter was working
     {
-        dtuGlobalData.grid.power = 0;
-        dtuGlobalData.grid.current = 0;
-        dtuGlobalData.grid.voltage = 0;
-
-        dtuGlobalData.pv0.power = 0;
-        dtuGlobalData.pv0.current = 0;
-        dtuGlobalData.pv0.voltage = 0;
-
-        dtuGlobalData.pv1.power = 0;
-        dtuGlobalData.pv1.current = 0;
-        dtuGlobalData.pv1.voltage = 0;
-
-        dtuGlobalData.dtuRssi = 0;
-
-        dtuConnection.dtuErrorState = DTU_ERROR_LAST_SEND;
-        dtuConnection.dtuActiveOffToCloudUpdate = false;
-        dtuConnection.dtuConnectState = DTU_STATE_OFFLINE;
-        dtuGlobalData.updateReceived = true;
-        Serial.println("DTUinterface:\t checkingForLastDataReceived >>>>> TIMEOUT 5 min for DTU -> NIGHT - send zero values +++ currentTimestamp: " + String(dtuGlobalData.currentTimestamp) + " - lastRespTimestamp: " + String(dtuGlobalData.lastRespTimestamp));
+        dtuData->grid.power = 0;
+        dtuData->grid.current = 0;
+        dtuData->grid.voltage = 0;
+
+        dtuData->pv0.power = 0;
+        dtuData->pv0.current = 0;
+        dtuData->pv0.voltage = 0;
+
+        dtuData->pv1.power = 0;
+        dtuData->pv1.current = 0;
+        dtuData->pv1.voltage = 0;
+
+        dtuData->dtuRssi = 0;
+        // the next response has to be converted again
+        changeFingerprint.invalidate();
+
+        dtuConn->dtuErrorState = DTU_ERROR_LAST_SEND;
+        dtuConn->dtuActiveOffToCloudUpdate = false;
+        handleConnectionEvent(DTU_EV_DATA_TIMEOUT);
+        emitEvent(DTU_EVENT_NEW_SAMPLE);
+        Serial.println("DTUinterface:\t checkingForLastDataReceived >>>>> TIMEOUT 5 min for DTU -> NIGHT - send zero values +++ currentTimestamp: " + String(dtuData->currentTimestamp) + " - lastRespTimestamp: " + String(dtuData->lastRespTimestamp));
     }
 }
 
 /**
  * @brief Checks for data updates and performs necessary actions.
  *
- * This function checks for hanging values on the DTU side and updates the grid voltage history.
+ * This function checks for hanging values on the DTU side with the fingerprint history of the responses.
  * It also checks if the response timestamp has changed and updates the local time if necessary.
  * If there is a response time error, it stops the connection to the DTU.
  */
 void DTUInterface::checkingDataUpdate()
 {
-    // checking for hanging values on DTU side
-    // fill grid voltage history
-    gridVoltHist[gridVoltCnt++] = dtuGlobalData.grid.voltage;
-    if (gridVoltCnt > 9)
-        gridVoltCnt = 0;
-
-    bool gridVoltValueHanging = true;
-    // Serial.println(F("DTUinterface:\t GridV check"));
-    // compare all values in history with the first value - if all are equal, then the value is hanging
-    for (uint8_t i = 1; i < 10; i++)
-    {
-        // Serial.println("DTUinterface:\t --> " + String(i) + " compare : " + String(gridVoltHist[i]) + " V - with: " + String(gridVoltHist[0]) + " V");
-        if (gridVoltHist[i] != gridVoltHist[0])
-        {
-            gridVoltValueHanging = false;
-            break;
-        }
-    }
-    // Serial.println("DTUinterface:\t GridV check result: " + String(gridVoltValueHanging));
-    if (gridVoltValueHanging)
+    // checking for hanging values on DTU side - the last responses carried exactly the same values
+    if (changeFingerprint.isHanging())
     {
-        Serial.println(F("DTUinterface:\t checkingDataUpdate -> grid voltage observer found hanging value (DTU_ERROR_DATA_NO_CHANGE) - try to reboot DTU"));
+        Serial.println(F("DTUinterface:\t checkingDataUpdate -> fingerprint observer found hanging values (DTU_ERROR_DATA_NO_CHANGE) - try to reboot DTU"));
         handleError(DTU_ERROR_DATA_NO_CHANGE);
-        dtuGlobalData.uptodate = false;
+        dtuData->uptodate = false;
     }
 
     // check for up-to-date - last response timestamp have to not equal the current response timestamp
-    if ((dtuGlobalData.lastRespTimestamp != dtuGlobalData.respTimestamp) && (dtuGlobalData.respTimestamp != 0))
+    if ((dtuData->lastRespTimestamp != dtuData->respTimestamp) && (dtuData->respTimestamp != 0))
     {
-        dtuGlobalData.uptodate = true;
-        dtuConnection.dtuErrorState = DTU_ERROR_NO_ERROR;
+        dtuData->uptodate = true;
+        dtuConn->dtuErrorState = DTU_ERROR_NO_ERROR;
         // sync local time (in seconds) to DTU time, only if abbrevation about 3 seconds
-        if (abs((int(dtuGlobalData.respTimestamp) - int(dtuGlobalData.currentTimestamp))) > 3)
+        if (abs((int(dtuData->respTimestamp) - int(dtuData->currentTimestamp))) > 3)
         {
-            dtuGlobalData.currentTimestamp = dtuGlobalData.respTimestamp;
+            dtuData->currentTimestamp = dtuData->respTimestamp;
             Serial.print(F("DTUinterface:\t checkingDataUpdate ---> synced local time with DTU time\n"));
         }
     }
     else
     {
-        dtuGlobalData.uptodate = false;
+        dtuData->uptodate = false;
         Serial.println(F("DTUinterface:\t checkingDataUpdate -> (DTU_ERROR_NO_TIME) - try to reboot DTU"));
         // stopping connection to DTU when response time error - try with reconnec
         handleError(DTU_ERROR_NO_TIME);
     }
-    dtuGlobalData.lastRespTimestamp = dtuGlobalData.respTimestamp;
+    dtuData->lastRespTimestamp = dtuData->respTimestamp;
+}
+
+void DTUInterface::updateDecodeStats(uint32_t decodeUs, boolean decoded)
+{
+    decodeStats.decodes++;
+    if (!decoded)
+        decodeStats.errors++;
+    decodeStats.lastDecodeUs = decodeUs;
+    if (decodeUs > decodeStats.maxDecodeUs)
+        decodeStats.maxDecodeUs = decodeUs;
+#if defined(ESP32)
+    // the decode runs in the loop task (processReceived) - its high water mark (bytes on ESP32) covers
+    // everything the loop ran so far, so it is a lower bound of the free stack during the decode
+    uint32_t stackFree = uxTaskGetStackHighWaterMark(NULL);
+    if (decodeStats.minLoopStackFree == 0 || stackFree < decodeStats.minLoopStackFree)
+        decodeStats.minLoopStackFree = stackFree;
+#endif
 }
 
 // protocol buffer methods
 
-void DTUInterface::writeReqRealDataNew()
+boolean DTUInterface::writeReqRealDataNew()
 {
-    uint8_t buffer[200];
-    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
-
     RealDataNewResDTO realdatanewresdto = RealDataNewResDTO_init_default;
     realdatanewresdto.offset = DTU_TIME_OFFSET;
-    realdatanewresdto.time = int32_t(dtuGlobalData.currentTimestamp);
-    bool status = pb_encode(&stream, RealDataNewResDTO_fields, &realdatanewresdto);
+    realdatanewresdto.time = int32_t(dtuData->currentTimestamp);
 
-    if (!status)
+    size_t frameLen = realDataNewTemplate.encode(realdatanewresdto, dtuData->currentTimestamp, txBuffer, sizeof(txBuffer));
+    if (frameLen == 0)
     {
         Serial.println(F("DTUinterface:\t writeReqRealDataNew - failed to encode"));
-        return;
-    }
-
-    // Serial.println(F("DTUinterface:\t writeReqRealDataNew --- encoded: "));
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        // Serial.printf("%02X", buffer[i]);
-        crc.add(buffer[i]);
-    }
-
-    uint8_t header[10];
-    header[0] = 0x48;
-    header[1] = 0x4d;
-    header[2] = 0xa3;
-    header[3] = 0x11; // RealDataNew = 0x11
-    header[4] = 0x00;
-    header[5] = 0x01;
-    header[6] = (crc.calc() >> 8) & 0xFF;
-    header[7] = (crc.calc()) & 0xFF;
-    header[8] = ((stream.bytes_written + 10) >> 8) & 0xFF; // suggest parentheses around '+' inside '>>' [-Wparentheses]
-    header[9] = (stream.bytes_written + 10) & 0xFF;        // warning: suggest parentheses around '+' in operand of '&' [-Wparentheses]
-    crc.restart();
-
-    uint8_t message[10 + stream.bytes_written];
-    for (int i = 0; i < 10; i++)
-    {
-        message[i] = header[i];
-    }
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        message[i + 10] = buffer[i];
+        return false;
     }
 
-    // Serial.print(F("\nRequest: "));
-    // for (int i = 0; i < 10 + stream.bytes_written; i++)
-    // {
-    //   Serial.print(message[i]);
-    // }
-    // Serial.println("");
-
     // Serial.println(F("DTUinterface:\t writeReqRealDataNew --- send request to DTU ..."));
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_WAIT_REALDATANEW;
-    client->write((const char *)message, 10 + stream.bytes_written);
-
-    // readRespRealDataNew(locTimeSec);
+    setTxRxState(DTU_TXRX_STATE_WAIT_REALDATANEW);
+    client->write((const char *)txBuffer, frameLen);
+    return true;
 }
 
 void DTUInterface::readRespRealDataNew(pb_istream_t istream)
 {
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_IDLE;
-    RealDataNewReqDTO realdatanewreqdto = RealDataNewReqDTO_init_default;
-
-    SGSMO gridData = SGSMO_init_zero;
-    PvMO pvData0 = PvMO_init_zero;
-    PvMO pvData1 = PvMO_init_zero;
-
-    pb_decode(&istream, &RealDataNewReqDTO_msg, &realdatanewreqdto);
-    Serial.println("DTUinterface:\t RealDataNew  - got remote (" + String(realdatanewreqdto.timestamp) + "):\t" + getTimeStringByTimestamp(realdatanewreqdto.timestamp));
-    if (realdatanewreqdto.timestamp != 0)
-    {
-        dtuGlobalData.respTimestamp = uint32_t(realdatanewreqdto.timestamp);
-        // dtuGlobalData.updateReceived = true; // not needed here - everytime both request (realData and getConfig) will be set
-        dtuConnection.dtuErrorState = DTU_ERROR_NO_ERROR;
-
-        // Serial.printf("\nactive-power: %i", realdatanewreqdto.active_power);
-        // Serial.printf("\ncumulative power: %i", realdatanewreqdto.cumulative_power);
-        // Serial.printf("\nfirmware_version: %i", realdatanewreqdto.firmware_version);
-        // Serial.printf("\ndtu_power: %i", realdatanewreqdto.dtu_power);
-        // Serial.printf("\ndtu_daily_energy: %i\n", realdatanewreqdto.dtu_daily_energy);
-
-        gridData = realdatanewreqdto.sgs_data[0];
-        pvData0 = realdatanewreqdto.pv_data[0];
-        pvData1 = realdatanewreqdto.pv_data[1];
-
-        // Serial.printf("\ngridData data count:\t %i\n ", realdatanewreqdto.sgs_data_count);
-
-        // Serial.printf("\ngridData reactive_power:\t %f W", calcValue(gridData.reactive_power));
-        // Serial.printf("\ngridData active_power:\t %f W", calcValue(gridData.active_power));
-        // Serial.printf("\ngridData voltage:\t %f V", calcValue(gridData.voltage));
-        // Serial.printf("\ngridData current:\t %f A", calcValue(gridData.current, 100));
-        // Serial.printf("\ngridData frequency:\t %f Hz", calcValue(gridData.frequency, 100));
-        // Serial.printf("\ngridData link_status:\t %i", gridData.link_status);
-        // Serial.printf("\ngridData power_factor:\t %f", calcValue(gridData.power_factor));
-        // Serial.printf("\ngridData power_limit:\t %i %%", gridData.power_limit);
-        // Serial.printf("\ngridData temperature:\t %f C", calcValue(gridData.temperature));
-        // Serial.printf("\ngridData warning_number:\t %i\n", gridData.warning_number);
-
-        dtuGlobalData.grid.current = calcValue(gridData.current, 100);
-        dtuGlobalData.grid.voltage = calcValue(gridData.voltage);
-        dtuGlobalData.grid.power = calcValue(gridData.active_power);
-        dtuGlobalData.inverterTemp = calcValue(gridData.temperature);
-
-        // Serial.printf("\npvData data count:\t %i\n", realdatanewreqdto.pv_data_count);
-        // Serial.printf("\npvData 0 current:\t %f A", calcValue(pvData0.current, 100));
-        // Serial.printf("\npvData 0 voltage:\t %f V", calcValue(pvData0.voltage));
-        // Serial.printf("\npvData 0 power:  \t %f W", calcValue(pvData0.power));
-        // Serial.printf("\npvData 0 energy_daily:\t %f kWh", calcValue(pvData0.energy_daily, 1000));
-        // Serial.printf("\npvData 0 energy_total:\t %f kWh", calcValue(pvData0.energy_total, 1000));
-        // Serial.printf("\npvData 0 port_number:\t %i\n", pvData0.port_number);
-
-        dtuGlobalData.pv0.current = calcValue(pvData0.current, 100);
-        dtuGlobalData.pv0.voltage = calcValue(pvData0.voltage);
-        dtuGlobalData.pv0.power = calcValue(pvData0.power);
-        dtuGlobalData.pv0.dailyEnergy = calcValue(pvData0.energy_daily, 1000);
-        if (pvData0.energy_total != 0)
+    // only the consumed fields are extracted while walking the stream - no full RealDataNewReqDTO on the stack
+    // first pass without the telemetry table - values and fingerprint only
+    realDataValues values;
+    unsigned long decodeStart = micros();
+    sampleDecodeUs = decodeStart;
+    boolean decoded = DTURealDataDecoder::decode(istream, values);
+    unsigned long decodeUs = micros() - decodeStart;
+    if (!decoded)
+        Serial.println(F("DTUinterface:\t RealDataNew  - decode failed - using values read so far"));
+
+    Serial.println("DTUinterface:\t RealDataNew  - got remote (" + String(values.timestamp) + "):\t" + getTimeStringByTimestamp(values.timestamp));
+    if (values.timestamp != 0)
+    {
+        // age of the meter/ inverter values for the zero export - the DTU time has only seconds
+        telemetry.receivedMillis = millis();
+        dtuData->respTimestamp = uint32_t(values.timestamp);
+        // a repeated timestamp after the cloud pause - DTU is still busy with the upload
+        cloudPauseLearner.dataReceived(millis(), dtuData->respTimestamp != dtuData->lastRespTimestamp);
+        // the next planned poll/ pause uses the learned length
+        dtuConn->cloudPauseSeconds = cloudPauseLearner.getPauseSeconds();
+        // no new sample event here - it follows with the GetConfig response of the same poll
+        dtuConn->dtuErrorState = DTU_ERROR_NO_ERROR;
+
+        // same values as the last response - nothing to convert, the telemetry table keeps its values
+        if (changeFingerprint.addRealData(values.fingerprint))
         {
-            dtuGlobalData.pv0.totalEnergy = calcValue(pvData0.energy_total, 1000);
+            convertRealData(values);
+            // second pass over the same frame for the telemetry table - values are read again, no copy on the stack
+            unsigned long tableStart = micros();
+            values = realDataValues();
+            if (frameAssembler.rewindFrame(istream))
+                DTURealDataDecoder::decode(istream, values, &telemetry);
+            decodeUs += micros() - tableStart;
         }
+        else
+            Serial.println(F("DTUinterface:\t RealDataNew  - values unchanged"));
 
-        // Serial.printf("\npvData 1 current:\t %f A", calcValue(pvData1.current, 100));
-        // Serial.printf("\npvData 1 voltage:\t %f V", calcValue(pvData1.voltage));
-        // Serial.printf("\npvData 1 power:  \t %f W", calcValue(pvData1.power));
-        // Serial.printf("\npvData 1 energy_daily:\t %f kWh", calcValue(pvData1.energy_daily, 1000));
-        // Serial.printf("\npvData 1 energy_total:\t %f kWh", calcValue(pvData1.energy_total, 1000));
-        // Serial.printf("\npvData 1 port_number:\t %i", pvData1.port_number);
-
-        dtuGlobalData.pv1.current = calcValue(pvData1.current, 100);
-        dtuGlobalData.pv1.voltage = calcValue(pvData1.voltage);
-        dtuGlobalData.pv1.power = calcValue(pvData1.power);
-        dtuGlobalData.pv1.dailyEnergy = calcValue(pvData1.energy_daily, 1000);
-        if (pvData0.energy_total != 0)
+        // adapt the poll interval to the change rate of the power values
+        pollScheduler.addSample(dtuData->respTimestamp, dtuData->grid.power, dtuData->pv0.power, dtuData->pv1.power);
+        powerHistory.addLiveSample(dtuData->respTimestamp, dtuData->grid.power);
+        // with a valid time on DTU side the history can be requested
+        if (historyBackfillPending)
         {
-            dtuGlobalData.pv1.totalEnergy = calcValue(pvData1.energy_total, 1000);
+            historyBackfillPending = false;
+            requestQueue.enqueue(DTU_REQ_APPGETHISTPOWER);
         }
-
-        dtuGlobalData.grid.dailyEnergy = dtuGlobalData.pv0.dailyEnergy + dtuGlobalData.pv1.dailyEnergy;
-        dtuGlobalData.grid.totalEnergy = dtuGlobalData.pv0.totalEnergy + dtuGlobalData.pv1.totalEnergy;
+        energyHistory.addLiveEnergy(dtuData->respTimestamp, dtuData->grid.dailyEnergy);
 
         // checking for hanging values on DTU side and set control state
         checkingDataUpdate();
@@ -709,171 +1074,123 @@ void DTUInterface::readRespRealDataNew(pb_istream_t istream)
         Serial.println(F("DTUinterface:\t readRespRealDataNew -> got timestamp == 0 (DTU_ERROR_NO_TIME) - try to reboot DTU"));
         handleError(DTU_ERROR_NO_TIME);
     }
+    updateDecodeStats(decodeUs, decoded);
 }
 
-void DTUInterface::writeReqAppGetHistPower()
+void DTUInterface::convertRealData(const realDataValues &values)
 {
-    uint8_t buffer[200];
-    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
-    AppGetHistPowerResDTO appgethistpowerres = AppGetHistPowerResDTO_init_default;
-    appgethistpowerres.offset = DTU_TIME_OFFSET;
-    appgethistpowerres.requested_time = int32_t(dtuGlobalData.currentTimestamp);
-    bool status = pb_encode(&stream, AppGetHistPowerResDTO_fields, &appgethistpowerres);
-
-    if (!status)
+    const realDataGrid &gridData = values.grid;
+    const realDataPv &pvData0 = values.pv[0];
+    const realDataPv &pvData1 = values.pv[1];
+
+    dtuData->grid.current = calcValue(gridData.current, 100);
+    dtuData->grid.voltage = calcValue(gridData.voltage);
+    dtuData->grid.power = calcValue(gridData.activePower);
+    dtuData->inverterTemp = calcValue(gridData.temperature);
+
+    dtuData->pv0.current = calcValue(pvData0.current, 100);
+    dtuData->pv0.voltage = calcValue(pvData0.voltage);
+    dtuData->pv0.power = calcValue(pvData0.power);
+    dtuData->pv0.dailyEnergy = calcValue(pvData0.energyDaily, 1000);
+    if (pvData0.energyTotal != 0)
     {
-        Serial.println(F("DTUinterface:\t writeReqAppGetHistPower - failed to encode"));
-        return;
+        dtuData->pv0.totalEnergy = calcValue(pvData0.energyTotal, 1000);
     }
 
-    // Serial.print(F("\nencoded: "));
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
+    dtuData->pv1.current = calcValue(pvData1.current, 100);
+    dtuData->pv1.voltage = calcValue(pvData1.voltage);
+    dtuData->pv1.power = calcValue(pvData1.power);
+    dtuData->pv1.dailyEnergy = calcValue(pvData1.energyDaily, 1000);
+    if (pvData0.energyTotal != 0)
     {
-        // Serial.printf("%02X", buffer[i]);
-        crc.add(buffer[i]);
+        dtuData->pv1.totalEnergy = calcValue(pvData1.energyTotal, 1000);
     }
 
-    uint8_t header[10];
-    header[0] = 0x48;
-    header[1] = 0x4d;
-    header[2] = 0xa3;
-    header[3] = 0x15; // AppGetHistPowerRes = 0x15
-    header[4] = 0x00;
-    header[5] = 0x01;
-    header[6] = (crc.calc() >> 8) & 0xFF;
-    header[7] = (crc.calc()) & 0xFF;
-    header[8] = ((stream.bytes_written + 10) >> 8) & 0xFF; // suggest parentheses around '+' in operand of '&'
-    header[9] = (stream.bytes_written + 10) & 0xFF;        // suggest parentheses around '+' in operand of '&'
-    crc.restart();
+    dtuData->grid.dailyEnergy = dtuData->pv0.dailyEnergy + dtuData->pv1.dailyEnergy;
+    dtuData->grid.totalEnergy = dtuData->pv0.totalEnergy + dtuData->pv1.totalEnergy;
+}
 
-    uint8_t message[10 + stream.bytes_written];
-    for (int i = 0; i < 10; i++)
-    {
-        message[i] = header[i];
-    }
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
+boolean DTUInterface::writeReqAppGetHistPower()
+{
+    AppGetHistPowerResDTO appgethistpowerres = AppGetHistPowerResDTO_init_default;
+    appgethistpowerres.offset = DTU_TIME_OFFSET;
+    appgethistpowerres.requested_time = int32_t(dtuData->currentTimestamp);
+
+    size_t frameLen = appGetHistPowerTemplate.encode(appgethistpowerres, dtuData->currentTimestamp, txBuffer, sizeof(txBuffer));
+    if (frameLen == 0)
     {
-        message[i + 10] = buffer[i];
+        Serial.println(F("DTUinterface:\t writeReqAppGetHistPower - failed to encode"));
+        return false;
     }
 
-    // Serial.print(F("\nRequest: "));
-    // for (int i = 0; i < 10 + stream.bytes_written; i++)
-    // {
-    //   Serial.print(message[i]);
-    // }
-    // Serial.println("");
-
-    //     dtuClient.write(message, 10 + stream.bytes_written);
-
     Serial.println(F("DTUinterface:\t writeReqAppGetHistPower --- send request to DTU ..."));
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_WAIT_APPGETHISTPOWER;
-    client->write((const char *)message, 10 + stream.bytes_written);
-    //     readRespAppGetHistPower();
+    setTxRxState(DTU_TXRX_STATE_WAIT_APPGETHISTPOWER);
+    client->write((const char *)txBuffer, frameLen);
+    return true;
 }
 
 void DTUInterface::readRespAppGetHistPower(pb_istream_t istream)
 {
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_IDLE;
     AppGetHistPowerReqDTO appgethistpowerreqdto = AppGetHistPowerReqDTO_init_default;
 
-    pb_decode(&istream, &AppGetHistPowerReqDTO_msg, &appgethistpowerreqdto);
-
-    dtuGlobalData.grid.dailyEnergy = calcValue(appgethistpowerreqdto.daily_energy, 1000);
-    dtuGlobalData.grid.totalEnergy = calcValue(appgethistpowerreqdto.total_energy, 1000);
-
-    // Serial.printf("\n\n start_time: %i", appgethistpowerreqdto.start_time);
-    // Serial.printf(" | step_time: %i", appgethistpowerreqdto.step_time);
-    // Serial.printf(" | absolute_start: %i", appgethistpowerreqdto.absolute_start);
-    // Serial.printf(" | long_term_start: %i", appgethistpowerreqdto.long_term_start);
-    // Serial.printf(" | request_time: %i", appgethistpowerreqdto.request_time);
-    // Serial.printf(" | offset: %i", appgethistpowerreqdto.offset);
-
-    // Serial.printf("\naccess_point: %i", appgethistpowerreqdto.access_point);
-    // Serial.printf(" | control_point: %i", appgethistpowerreqdto.control_point);
-    // Serial.printf(" | daily_energy: %i", appgethistpowerreqdto.daily_energy);
+    if (!pb_decode(&istream, &AppGetHistPowerReqDTO_msg, &appgethistpowerreqdto))
+    {
+        decodeStats.histPowerErrors++;
+        Serial.println("DTUinterface:\t readRespAppGetHistPower - failed to decode: " + String(PB_GET_ERROR(&istream)));
+        return;
+    }
 
-    // Serial.printf(" | relative_power: %f", calcValue(appgethistpowerreqdto.relative_power));
+    dtuData->grid.dailyEnergy = calcValue(appgethistpowerreqdto.daily_energy, 1000);
+    dtuData->grid.totalEnergy = calcValue(appgethistpowerreqdto.total_energy, 1000);
 
-    // Serial.printf(" | serial_number: %lld", appgethistpowerreqdto.serial_number);
+    // merge the intraday curve - only gaps without live data are filled
+    uint32_t startTime = appgethistpowerreqdto.start_time != 0 ? appgethistpowerreqdto.start_time : appgethistpowerreqdto.absolute_start;
+    uint16_t filled = powerHistory.mergeHistory(startTime, appgethistpowerreqdto.step_time, appgethistpowerreqdto.power_array, appgethistpowerreqdto.power_array_count);
+    // the daily energy of the next response has to be taken again
+    changeFingerprint.invalidate();
+    Serial.println("DTUinterface:\t AppGetHistPower - got " + String(appgethistpowerreqdto.power_array_count) + " values from " + getTimeStringByTimestamp(startTime) + " (step: " + String(appgethistpowerreqdto.step_time) + " s) - filled " + String(filled) + " gaps");
+}
 
-    // Serial.printf(" | total_energy: %f kWh", calcValue(appgethistpowerreqdto.total_energy, 1000));
-    // Serial.printf(" | warning_number: %i\n", appgethistpowerreqdto.warning_number);
+boolean DTUInterface::writeReqHeartbeat()
+{
+    HBResDTO hbres = HBResDTO_init_default;
+    hbres.offset = DTU_TIME_OFFSET;
+    hbres.time = int32_t(dtuData->currentTimestamp);
 
-    // Serial.printf("\n power data count: %i\n", appgethistpowerreqdto.power_array_count);
-    // int starttimeApp = appgethistpowerreqdto.absolute_start;
-    // for (unsigned int i = 0; i < appgethistpowerreqdto.power_array_count; i++)
-    // {
-    //   float histPowerValue = float(appgethistpowerreqdto.power_array[i]) / 10;
-    //   Serial.printf("%i (%s) - power data: %f W (%i)\n", i, getTimeStringByTimestamp(starttimeApp), histPowerValue, appgethistpowerreqdto.power_array[i]);
-    //   starttime = starttime + appgethistpowerreqdto.step_time;
-    // }
+    size_t frameLen = heartbeatTemplate.encode(hbres, dtuData->currentTimestamp, txBuffer, sizeof(txBuffer));
+    if (frameLen == 0)
+    {
+        Serial.println(F("DTUinterface:\t writeReqHeartbeat - failed to encode"));
+        return false;
+    }
 
-    // Serial.printf("\nsn: %lld, relative_power: %i, total_energy: %i, daily_energy: %i, warning_number: %i\n", appgethistpowerreqdto.serial_number, appgethistpowerreqdto.relative_power, appgethistpowerreqdto.total_energy, appgethistpowerreqdto.daily_energy,appgethistpowerreqdto.warning_number);
+    setTxRxState(DTU_TXRX_STATE_WAIT_HEARTBEAT);
+    client->write((const char *)txBuffer, frameLen);
+    heartbeat.beatSent(millis());
+    return true;
 }
 
-void DTUInterface::writeReqGetConfig()
+boolean DTUInterface::writeReqGetConfig()
 {
-    uint8_t buffer[200];
-    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
-
     GetConfigResDTO getconfigresdto = GetConfigResDTO_init_default;
     getconfigresdto.offset = DTU_TIME_OFFSET;
-    getconfigresdto.time = int32_t(dtuGlobalData.currentTimestamp);
-    bool status = pb_encode(&stream, GetConfigResDTO_fields, &getconfigresdto);
+    getconfigresdto.time = int32_t(dtuData->currentTimestamp);
 
-    if (!status)
+    size_t frameLen = getConfigTemplate.encode(getconfigresdto, dtuData->currentTimestamp, txBuffer, sizeof(txBuffer));
+    if (frameLen == 0)
     {
         Serial.println(F("DTUinterface:\t writeReqGetConfig - failed to encode"));
-        return;
-    }
-
-    // Serial.print(F("\nencoded: "));
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        // Serial.printf("%02X", buffer[i]);
-        crc.add(buffer[i]);
-    }
-
-    uint8_t header[10];
-    header[0] = 0x48;
-    header[1] = 0x4d;
-    header[2] = 0xa3;
-    header[3] = 0x09; // GetConfig = 0x09
-    header[4] = 0x00;
-    header[5] = 0x01;
-    header[6] = (crc.calc() >> 8) & 0xFF;
-    header[7] = (crc.calc()) & 0xFF;
-    header[8] = ((stream.bytes_written + 10) >> 8) & 0xFF; // suggest parentheses around '+' inside '>>' [-Wparentheses]
-    header[9] = (stream.bytes_written + 10) & 0xFF;        // warning: suggest parentheses around '+' in operand of '&' [-Wparentheses]
-    crc.restart();
-
-    uint8_t message[10 + stream.bytes_written];
-    for (int i = 0; i < 10; i++)
-    {
-        message[i] = header[i];
-    }
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        message[i + 10] = buffer[i];
+        return false;
     }
 
-    // Serial.print(F("\nRequest: "));
-    // for (int i = 0; i < 10 + stream.bytes_written; i++)
-    // {
-    //   Serial.print(message[i]);
-    // }
-    // Serial.println("");
-
-    //     client->write(message, 10 + stream.bytes_written);
     // Serial.println(F("DTUinterface:\t writeReqGetConfig --- send request to DTU ..."));
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_WAIT_GETCONFIG;
-    client->write((const char *)message, 10 + stream.bytes_written);
-    //     readRespGetConfig();
+    setTxRxState(DTU_TXRX_STATE_WAIT_GETCONFIG);
+    client->write((const char *)txBuffer, frameLen);
+    return true;
 }
 
 void DTUInterface::readRespGetConfig(pb_istream_t istream)
 {
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_IDLE;
     GetConfigReqDTO getconfigreqdto = GetConfigReqDTO_init_default;
 
     pb_decode(&istream, &GetConfigReqDTO_msg, &getconfigreqdto);
@@ -886,19 +1203,29 @@ void DTUInterface::readRespGetConfig(pb_istream_t istream)
 
     Serial.println("DTUinterface:\t GetConfig    - got remote (" + String(getconfigreqdto.request_time) + "):\t" + getTimeStringByTimestamp(getconfigreqdto.request_time));
 
-    if (getconfigreqdto.request_time != 0 && dtuConnection.dtuErrorState == DTU_ERROR_NO_TIME)
+    if (getconfigreqdto.request_time != 0 && dtuConn->dtuErrorState == DTU_ERROR_NO_TIME)
     {
-        dtuGlobalData.respTimestamp = uint32_t(getconfigreqdto.request_time);
+        dtuData->respTimestamp = uint32_t(getconfigreqdto.request_time);
         Serial.println(F(" --> redundant remote time takeover to local"));
     }
 
     int powerLimit = int(calcValue(getconfigreqdto.limit_power_mypower));
 
-    dtuGlobalData.powerLimit = ((powerLimit != 0) ? powerLimit : dtuGlobalData.powerLimit);
-    dtuGlobalData.dtuRssi = getconfigreqdto.wifi_rssi;
-    // no update if still init value
-    if (dtuGlobalData.powerLimit != 254)
-        dtuGlobalData.updateReceived = true;
+    dtuData->powerLimit = ((powerLimit != 0) ? powerLimit : dtuData->powerLimit);
+    if (powerLimit != 0)
+    {
+        commandTracker.limitReported(uint8_t(powerLimit), millis());
+        if (commandTracker.getState() != DTU_CMD_STATE_ACKED)
+            timerWheel.cancel(DTU_TIMER_COMMAND);
+    }
+    dtuData->dtuRssi = getconfigreqdto.wifi_rssi;
+    // no update if still init value - and none if nothing changed until the refresh time is reached
+    uint32_t configFingerprint = DTUChangeFingerprint::add(DTU_FINGERPRINT_OFFSET, int32_t(dtuData->powerLimit));
+    configFingerprint = DTUChangeFingerprint::add(configFingerprint, int32_t(dtuData->dtuRssi));
+    if (dtuData->powerLimit != 254 && changeFingerprint.checkForward(configFingerprint, dtuData->currentTimestamp, userConfig.dtuUnchangedRefresh))
+        emitEvent(DTU_EVENT_NEW_SAMPLE, 0, sampleDecodeUs);
+    // a GetConfig without RealDataNew before (e.g. after a limit command) counts from now
+    sampleDecodeUs = 0;
 }
 
 boolean DTUInterface::writeReqCommand(uint8_t setPercent)
@@ -906,7 +1233,7 @@ boolean DTUInterface::writeReqCommand(uint8_t setPercent)
     if (!client->connected())
         return false;
     // prepare powerLimit
-    // uint8_t setPercent = dtuGlobalData.powerLimitSet;
+    // uint8_t setPercent = dtuData->powerLimitSet;
     uint16_t limitLevel = setPercent * 10;
     if (limitLevel > 1000)
     { // reducing to 2 % -> 100%
@@ -917,15 +1244,11 @@ boolean DTUInterface::writeReqCommand(uint8_t setPercent)
         limitLevel = 20;
     }
 
-    // request message
-    uint8_t buffer[200];
-    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
-
     CommandResDTO commandresdto = CommandResDTO_init_default;
-    commandresdto.time = int32_t(dtuGlobalData.currentTimestamp);
+    commandresdto.time = int32_t(dtuData->currentTimestamp);
     commandresdto.action = CMD_ACTION_LIMIT_POWER;
     commandresdto.package_nub = 1;
-    commandresdto.tid = int32_t(dtuGlobalData.currentTimestamp);
+    commandresdto.tid = int32_t(dtuData->currentTimestamp);
 
     const int bufferSize = 61;
     char dataArray[bufferSize];
@@ -934,74 +1257,40 @@ boolean DTUInterface::writeReqCommand(uint8_t setPercent)
     dataString.toCharArray(dataArray, bufferSize);
     strcpy(commandresdto.data, dataArray);
 
-    bool status = pb_encode(&stream, CommandResDTO_fields, &commandresdto);
-
-    if (!status)
+    size_t frameLen = CommandRequest::encode(commandresdto, txBuffer, sizeof(txBuffer));
+    if (frameLen == 0)
     {
         Serial.println(F("DTUinterface:\t writeReqCommand - failed to encode"));
         return false;
     }
 
-    // Serial.print(F("\nencoded: "));
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        // Serial.printf("%02X", buffer[i]);
-        crc.add(buffer[i]);
-    }
-
-    uint8_t header[10];
-    header[0] = 0x48;
-    header[1] = 0x4d;
-    header[2] = 0xa3;
-    header[3] = 0x05; // Command = 0x05
-    header[4] = 0x00;
-    header[5] = 0x01;
-    header[6] = (crc.calc() >> 8) & 0xFF;
-    header[7] = (crc.calc()) & 0xFF;
-    header[8] = ((stream.bytes_written + 10) >> 8) & 0xFF; // suggest parentheses around '+' inside '>>' [-Wparentheses]
-    header[9] = (stream.bytes_written + 10) & 0xFF;        // warning: suggest parentheses around '+' in operand of '&' [-Wparentheses]
-    crc.restart();
-
-    uint8_t message[10 + stream.bytes_written];
-    for (int i = 0; i < 10; i++)
-    {
-        message[i] = header[i];
-    }
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        message[i + 10] = buffer[i];
-    }
-
-    // Serial.print(F("\nRequest: "));
-    // for (int i = 0; i < 10 + stream.bytes_written; i++)
-    // {
-    //   Serial.print(message[i]);
-    // }
-    // Serial.println("");
-
-    //     dtuClient.write(message, 10 + stream.bytes_written);
     Serial.println(F("DTUinterface:\t writeReqCommand --- send request to DTU ..."));
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_WAIT_COMMAND;
-    client->write((const char *)message, 10 + stream.bytes_written);
-    //     if (!readRespCommand())
-    //         return false;
+    setTxRxState(DTU_TXRX_STATE_WAIT_COMMAND);
+    client->write((const char *)txBuffer, frameLen);
+    commandTracker.sent(commandresdto.tid, millis());
+    snapshotDirty = true;
+    scheduleTimer(DTU_TIMER_COMMAND, DTU_CMD_ACK_TIMEOUT_MS);
     return true;
 }
 
-boolean DTUInterface::readRespCommand(pb_istream_t istream)
+boolean DTUInterface::readRespCommand(const CommandReqDTO &commandreqdto)
 {
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_IDLE;
-    // CommandReqDTO commandreqdto = CommandReqDTO_init_default;
-
-    // pb_decode(&istream, &GetConfigReqDTO_msg, &commandreqdto);
-
-    // Serial.print(" --> DTUInterface::readRespCommand - got remote: " + getTimeStringByTimestamp(commandreqdto.time));
-    // Serial.printf("\ncommand req action: %i", commandreqdto.action);
-    // Serial.printf("\ncommand req: %s", commandreqdto.dtu_sn);
-    // Serial.printf("\ncommand req: %i", commandreqdto.err_code);
-    // Serial.printf("\ncommand req: %i", commandreqdto.package_now);
-    // Serial.printf("\ncommand req: %i", int(commandreqdto.tid));
-    // Serial.printf("\ncommand req time: %i", commandreqdto.time);
+    Serial.println("DTUinterface:\t readRespCommand - action: " + String(commandreqdto.action) + " - err_code: " + String(commandreqdto.err_code) + " - tid: " + String(int32_t(commandreqdto.tid)));
+    if (!commandTracker.acked(commandreqdto.tid, commandreqdto.err_code, millis()))
+        return false;
+    if (commandTracker.getState() == DTU_CMD_STATE_ACKED)
+    {
+        emitEvent(DTU_EVENT_LIMIT_ACK, commandTracker.getTarget());
+        // get updated power setting
+        requestQueue.enqueue(DTU_REQ_GETCONFIG);
+        // GetConfig is repeated with this interval until the limit is effective
+        scheduleTimer(DTU_TIMER_COMMAND, DTU_CMD_ACK_TIMEOUT_MS);
+    }
+    else
+    {
+        // rejected - retry right away or give up
+        checkCommandRetry();
+    }
     return true;
 }
 
@@ -1013,76 +1302,29 @@ boolean DTUInterface::writeCommandRestartDevice()
         return false;
     }
 
-    // request message
-    uint8_t buffer[200];
-    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
-
     CommandResDTO commandresdto = CommandResDTO_init_default;
     // commandresdto.time = int32_t(locTimeSec);
 
     commandresdto.action = CMD_ACTION_DTU_REBOOT;
     commandresdto.package_nub = 1;
-    commandresdto.tid = int32_t(dtuGlobalData.currentTimestamp);
-
-    bool status = pb_encode(&stream, CommandResDTO_fields, &commandresdto);
+    commandresdto.tid = int32_t(dtuData->currentTimestamp);
 
-    if (!status)
+    size_t frameLen = RestartDeviceRequest::encode(commandresdto, txBuffer, sizeof(txBuffer));
+    if (frameLen == 0)
     {
         Serial.println(F("DTUinterface:\t writeCommandRestartDevice - failed to encode"));
         return false;
     }
 
-    // Serial.print(F("\nencoded: "));
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        // Serial.printf("%02X", buffer[i]);
-        crc.add(buffer[i]);
-    }
-
-    uint8_t header[10];
-    header[0] = 0x48;
-    header[1] = 0x4d;
-    header[2] = 0x23; // Command = 0x03 - CMD_CLOUD_COMMAND_RES_DTO = b"\x23\x05"   => 0x23
-    header[3] = 0x05; // Command = 0x05                                             => 0x05
-    header[4] = 0x00;
-    header[5] = 0x01;
-    header[6] = (crc.calc() >> 8) & 0xFF;
-    header[7] = (crc.calc()) & 0xFF;
-    header[8] = ((stream.bytes_written + 10) >> 8) & 0xFF; // suggest parentheses around '+' inside '>>' [-Wparentheses]
-    header[9] = (stream.bytes_written + 10) & 0xFF;        // warning: suggest parentheses around '+' in operand of '&' [-Wparentheses]
-    crc.restart();
-
-    uint8_t message[10 + stream.bytes_written];
-    for (int i = 0; i < 10; i++)
-    {
-        message[i] = header[i];
-    }
-    for (unsigned int i = 0; i < stream.bytes_written; i++)
-    {
-        message[i + 10] = buffer[i];
-    }
-
-    // Serial.print(F("\nRequest: "));
-    // for (int i = 0; i < 10 + stream.bytes_written; i++)
-    // {
-    //   Serial.print(message[i]);
-    // }
-    // Serial.println("");
-
     Serial.println(F("DTUinterface:\t writeCommandRestartDevice --- send request to DTU ..."));
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_WAIT_RESTARTDEVICE;
-    client->write((const char *)message, 10 + stream.bytes_written);
+    setTxRxState(DTU_TXRX_STATE_WAIT_RESTARTDEVICE);
+    client->write((const char *)txBuffer, frameLen);
     return true;
 }
 
-boolean DTUInterface::readRespCommandRestartDevice(pb_istream_t istream)
+boolean DTUInterface::readRespCommandRestartDevice(const CommandReqDTO &commandreqdto)
 {
-    dtuConnection.dtuTxRxState = DTU_TXRX_STATE_IDLE;
-    CommandReqDTO commandreqdto = CommandReqDTO_init_default;
-
     Serial.print("DTUinterface:\t -readRespCommandRestartDevice - got remote: " + getTimeStringByTimestamp(commandreqdto.time));
-
-    pb_decode(&istream, &GetConfigReqDTO_msg, &commandreqdto);
     Serial.printf("\ncommand req action: %i", commandreqdto.action);
     Serial.printf("\ncommand req: %s", commandreqdto.dtu_sn);
     Serial.printf("\ncommand req: %i", commandreqdto.err_code);
@@ -1096,28 +1338,31 @@ boolean DTUInterface::cloudPauseActiveControl()
 {
     // check current DTU time
     UnixTime stamp(1);
-    stamp.getDateTime(dtuGlobalData.currentTimestamp);
+    stamp.getDateTime(dtuData->currentTimestamp);
 
     int min = stamp.minute;
     int sec = stamp.second;
 
-    if (sec >= 40 && (min == 59 || min == 14 || min == 29 || min == 44) && !dtuConnection.dtuActiveOffToCloudUpdate)
+    if (sec >= 40 && (min == 59 || min == 14 || min == 29 || min == 44) && !dtuConn->dtuActiveOffToCloudUpdate)
     {
         Serial.printf("\n\n<<< dtuCloudPauseActiveControl >>> --- ");
         Serial.printf("local time: %02i.%02i. - %02i:%02i:%02i ", stamp.day, stamp.month, stamp.hour, stamp.minute, stamp.second);
         Serial.print(F("----> switch ''OFF'' DTU server connection to upload data from DTU to Cloud\n\n"));
-        lastSwOff = dtuGlobalData.currentTimestamp;
-        dtuConnection.dtuActiveOffToCloudUpdate = true;
-        dtuGlobalData.updateReceived = true; // update at start of pause
+        lastSwOff = dtuData->currentTimestamp;
+        dtuConn->dtuActiveOffToCloudUpdate = true;
+        cloudPauseLearner.pauseStarted(millis());
+        emitEvent(DTU_EVENT_CLOUD_PAUSE_START);
+        emitEvent(DTU_EVENT_NEW_SAMPLE); // update at start of pause
+        changeFingerprint.invalidate();  // and with the first response after it
     }
-    else if (dtuGlobalData.currentTimestamp > lastSwOff + DTU_CLOUD_UPLOAD_SECONDS && dtuConnection.dtuActiveOffToCloudUpdate)
+    else if (dtuData->currentTimestamp > lastSwOff + dtuConn->cloudPauseSeconds && dtuConn->dtuActiveOffToCloudUpdate)
     {
         Serial.printf("\n\n<<< dtuCloudPauseActiveControl >>> --- ");
         Serial.printf("local time: %02i.%02i. - %02i:%02i:%02i ", stamp.day, stamp.month, stamp.hour, stamp.minute, stamp.second);
         Serial.print(F("----> switch ''ON'' DTU server connection after upload data from DTU to Cloud\n\n"));
         // // reset request timer - starting 10s (give some time to get a connection (~3 s needed)) after prevention with a new request
-        // platformData.dtuNextUpdateCounterSeconds = dtuGlobalData.currentTimestamp - 5;
-        dtuConnection.dtuActiveOffToCloudUpdate = false;
+        // platformData.dtuNextUpdateCounterSeconds = dtuData->currentTimestamp - 5;
+        endCloudPause();
     }
-    return dtuConnection.dtuActiveOffToCloudUpdate;
+    return dtuConn->dtuActiveOffToCloudUpdate;
 }
\ No newline at end of file
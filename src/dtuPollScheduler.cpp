@@ -0,0 +1,93 @@
+#include "dtuPollScheduler.h"
+#include "dtuInterface.h"
+
+void DTUPollScheduler::addSample(uint32_t timestamp, float gridPower, float pvPower0, float pvPower1)
+{
+    // ignore repeated timestamps - no new measurement on DTU side
+    if (lastSampleTime != 0 && timestamp > lastSampleTime)
+    {
+        float delta = fabsf(gridPower - lastGridPower);
+        delta = max(delta, fabsf(pvPower0 - lastPvPower0));
+        delta = max(delta, fabsf(pvPower1 - lastPvPower1));
+        float rate = delta / (timestamp - lastSampleTime);
+        // smoothing - react fast, but not on a single outlier only
+        powerRate = 0.5f * powerRate + 0.5f * rate;
+    }
+    if (timestamp > lastSampleTime)
+    {
+        lastSampleTime = timestamp;
+        lastGridPower = gridPower;
+        lastPvPower0 = pvPower0;
+        lastPvPower1 = pvPower1;
+    }
+
+    updateInterval();
+    // a faster interval takes effect already for the current cycle
+    if (lastPoll != 0)
+    {
+        uint32_t plannedPoll = planAroundCloudPause(lastPoll + interval);
+        if (plannedPoll < nextPoll)
+            nextPoll = plannedPoll;
+    }
+}
+
+boolean DTUPollScheduler::checkPollDue(uint32_t now)
+{
+    if (nextPoll == 0)
+        nextPoll = now;
+    if (now < nextPoll)
+        return false;
+
+    updateInterval();
+    lastPoll = now;
+    nextPoll = planAroundCloudPause(now + interval);
+    return true;
+}
+
+void DTUPollScheduler::pollIn(uint32_t now, uint16_t seconds)
+{
+    nextPoll = planAroundCloudPause(now + seconds);
+}
+
+void DTUPollScheduler::updateInterval()
+{
+    if (!userConfig.dtuUpdateAdaptive)
+    {
+        interval = userConfig.dtuUpdateTime;
+        return;
+    }
+
+    uint16_t minInterval = userConfig.dtuUpdateTimeMin;
+    uint16_t maxInterval = userConfig.dtuUpdateTimeMax;
+    float target = powerRate > 0 ? DTU_POLL_TARGET_DELTA_W / powerRate : maxInterval;
+    if (target < minInterval)
+        target = minInterval;
+    if (target > maxInterval)
+        target = maxInterval;
+
+    // shorten immediately - lengthen by max. 25 % per poll
+    if (target < interval)
+        interval = uint16_t(target);
+    else
+        interval = min(uint16_t(target), uint16_t(interval + interval / 4 + 1));
+
+    if (interval < minInterval)
+        interval = minInterval;
+}
+
+uint32_t DTUPollScheduler::planAroundCloudPause(uint32_t plannedPoll)
+{
+    if (!connection || !connection->preventCloudErrors)
+        return plannedPoll;
+
+    // position of the planned poll relative to the start of the next/ current cloud pause window
+    uint32_t sincePauseStart = (plannedPoll + 900 - DTU_CLOUD_PAUSE_START_IN_QUARTER) % 900;
+    if (sincePauseStart >= connection->cloudPauseSeconds)
+        return plannedPoll;
+
+    uint32_t pauseStart = plannedPoll - sincePauseStart;
+    // poll right before the pause, if that keeps the min interval to the last poll - otherwise after the pause
+    if (pauseStart - DTU_POLL_PAUSE_MARGIN_BEFORE >= lastPoll + userConfig.dtuUpdateTimeMin)
+        return pauseStart - DTU_POLL_PAUSE_MARGIN_BEFORE;
+    return pauseStart + connection->cloudPauseSeconds + DTU_POLL_PAUSE_MARGIN_AFTER;
+}
@@ -0,0 +1,97 @@
+#include "dtuPowerHistory.h"
+
+DTUPowerHistory::DTUPowerHistory()
+{
+    memset(slotNumber, 0, sizeof(slotNumber));
+    memset(slotPower, 0, sizeof(slotPower));
+    memset(slotLiveCount, 0, sizeof(slotLiveCount));
+}
+
+void DTUPowerHistory::addLiveSample(uint32_t timestamp, float power)
+{
+    uint32_t slot = timestamp / DTU_HISTORY_SLOT_SECONDS;
+    uint16_t index = slot % DTU_HISTORY_SLOTS;
+
+    version.beginWrite();
+    if (slotNumber[index] != slot || slotLiveCount[index] == 0)
+    {
+        // new slot (or only a history value so far) - live data wins
+        slotNumber[index] = slot;
+        slotPower[index] = toSlotPower(power);
+        slotLiveCount[index] = 1;
+    }
+    else if (slotLiveCount[index] < 255)
+    {
+        // running mean of all samples within the slot
+        uint8_t count = slotLiveCount[index];
+        slotPower[index] = (uint32_t(slotPower[index]) * count + toSlotPower(power)) / (count + 1);
+        slotLiveCount[index] = count + 1;
+    }
+
+    if (slot > newestSlot)
+        newestSlot = slot;
+    stats.liveSamples++;
+    version.endWrite();
+}
+
+uint16_t DTUPowerHistory::mergeHistory(uint32_t startTime, uint32_t stepTime, const int32_t *powerArray, size_t count, int32_t divider)
+{
+    if (startTime == 0 || stepTime == 0 || count == 0)
+        return 0;
+
+    uint16_t filled = 0;
+    uint32_t lastSlot = 0;
+    version.beginWrite();
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t timestamp = startTime + i * stepTime;
+        uint32_t slot = timestamp / DTU_HISTORY_SLOT_SECONDS;
+        // keep the window - don't overwrite newer data with history of more than one day ago
+        if (newestSlot >= DTU_HISTORY_SLOTS && slot <= newestSlot - DTU_HISTORY_SLOTS)
+            continue;
+
+        uint16_t index = slot % DTU_HISTORY_SLOTS;
+        if (slotNumber[index] == slot && slotLiveCount[index] > 0)
+            continue; // live data available
+        // with a step time shorter than the slot only the first sample of the slot is taken
+        if (slot == lastSlot)
+            continue;
+        lastSlot = slot;
+
+        slotNumber[index] = slot;
+        slotPower[index] = toSlotPower(float(powerArray[i]) / divider);
+        slotLiveCount[index] = 0;
+        filled++;
+
+        if (slot > newestSlot)
+            newestSlot = slot;
+    }
+
+    stats.backfillRuns++;
+    stats.backfilledSlots += filled;
+    stats.lastBackfill = startTime + (count - 1) * stepTime;
+    version.endWrite();
+    return filled;
+}
+
+boolean DTUPowerHistory::getSample(uint16_t index, uint32_t &timestamp, float &power) const
+{
+    if (index >= DTU_HISTORY_SLOTS || newestSlot < uint32_t(DTU_HISTORY_SLOTS - 1 - index))
+        return false;
+    uint32_t slot = newestSlot - (DTU_HISTORY_SLOTS - 1 - index);
+    uint16_t ringIndex = slot % DTU_HISTORY_SLOTS;
+    if (slot == 0 || slotNumber[ringIndex] != slot)
+        return false;
+    timestamp = slot * DTU_HISTORY_SLOT_SECONDS;
+    power = slotPower[ringIndex] / 10.0f;
+    return true;
+}
+
+uint16_t DTUPowerHistory::toSlotPower(float power)
+{
+    if (power <= 0)
+        return 0;
+    if (power >= 6553.5f)
+        return 65535;
+    return uint16_t(power * 10 + 0.5f);
+}
@@ -0,0 +1,358 @@
+#include "dtuRealDataDecoder.h"
+
+boolean DTURealDataDecoder::decode(pb_istream_t &stream, realDataValues &values, DTUTelemetryTable *table)
+{
+    pb_wire_type_t wireType;
+    uint32_t tag;
+    bool eof;
+    while (pb_decode_tag(&stream, &wireType, &tag, &eof))
+    {
+        boolean ok = true;
+        if (tag == RealDataNewReqDTO_timestamp_tag)
+        {
+            ok = decodeInt32(stream, wireType, values.timestamp);
+        }
+        else if ((tag == RealDataNewReqDTO_sgs_data_tag || tag == RealDataNewReqDTO_tgs_data_tag) && wireType == PB_WT_STRING)
+        {
+            pb_istream_t substream;
+            if (!pb_make_string_substream(&stream, &substream))
+                return false;
+            realDataGrid grid;
+            if (tag == RealDataNewReqDTO_sgs_data_tag)
+                ok = decodeGrid(substream, grid);
+            else
+                ok = decodeThreePhaseGrid(substream, grid);
+            ok = pb_close_string_substream(&stream, &substream) && ok;
+            values.fingerprint = fingerprint(values.fingerprint, grid);
+            if (ok && table != nullptr)
+                updateTelemetry(*table, grid, uint32_t(values.timestamp));
+            if (tag == RealDataNewReqDTO_sgs_data_tag && values.gridCount == 0)
+            {
+                values.grid = grid;
+                values.gridCount++;
+            }
+        }
+        else if (tag == RealDataNewReqDTO_pv_data_tag && wireType == PB_WT_STRING)
+        {
+            pb_istream_t substream;
+            if (!pb_make_string_substream(&stream, &substream))
+                return false;
+            realDataPv pv;
+            ok = decodePv(substream, pv);
+            ok = pb_close_string_substream(&stream, &substream) && ok;
+            values.fingerprint = fingerprint(values.fingerprint, pv);
+            if (ok && table != nullptr)
+                updateTelemetry(*table, pv, uint32_t(values.timestamp));
+            if (values.pvCount < DTU_REALDATA_PV_PORTS)
+                values.pv[values.pvCount++] = pv;
+        }
+        else if (tag == RealDataNewReqDTO_meter_data_tag && wireType == PB_WT_STRING)
+        {
+            pb_istream_t substream;
+            if (!pb_make_string_substream(&stream, &substream))
+                return false;
+            realDataMeter meter;
+            ok = decodeMeter(substream, meter);
+            ok = pb_close_string_substream(&stream, &substream) && ok;
+            values.fingerprint = fingerprint(values.fingerprint, meter);
+            if (ok && table != nullptr)
+                updateTelemetry(*table, meter, uint32_t(values.timestamp));
+        }
+        else
+        {
+            ok = pb_skip_field(&stream, wireType);
+        }
+        if (!ok)
+            return false;
+    }
+    // end of stream is the regular end of the message
+    return eof;
+}
+
+boolean DTURealDataDecoder::decodeGrid(pb_istream_t &stream, realDataGrid &grid)
+{
+    pb_wire_type_t wireType;
+    uint32_t tag;
+    bool eof;
+    while (pb_decode_tag(&stream, &wireType, &tag, &eof))
+    {
+        boolean ok;
+        switch (tag)
+        {
+        case SGSMO_serial_number_tag:
+            ok = decodeSerial(stream, wireType, grid.serial);
+            break;
+        case SGSMO_voltage_tag:
+            ok = decodeInt32(stream, wireType, grid.voltage);
+            break;
+        case SGSMO_frequency_tag:
+            ok = decodeInt32(stream, wireType, grid.frequency);
+            break;
+        case SGSMO_active_power_tag:
+            ok = decodeInt32(stream, wireType, grid.activePower);
+            break;
+        case SGSMO_current_tag:
+            ok = decodeInt32(stream, wireType, grid.current);
+            break;
+        case SGSMO_temperature_tag:
+            ok = decodeInt32(stream, wireType, grid.temperature);
+            break;
+        case SGSMO_power_limit_tag:
+            ok = decodeInt32(stream, wireType, grid.powerLimit);
+            break;
+        default:
+            ok = pb_skip_field(&stream, wireType);
+            break;
+        }
+        if (!ok)
+            return false;
+    }
+    return eof;
+}
+
+boolean DTURealDataDecoder::decodeThreePhaseGrid(pb_istream_t &stream, realDataGrid &grid)
+{
+    grid.phases = DTU_INVERTER_THREE_PHASE;
+    int32_t phaseCurrent = 0;
+    pb_wire_type_t wireType;
+    uint32_t tag;
+    bool eof;
+    while (pb_decode_tag(&stream, &wireType, &tag, &eof))
+    {
+        boolean ok;
+        switch (tag)
+        {
+        case TGSMO_serial_number_tag:
+            ok = decodeSerial(stream, wireType, grid.serial);
+            break;
+        case TGSMO_voltage_phase_A_tag:
+            ok = decodeInt32(stream, wireType, grid.voltage);
+            break;
+        case TGSMO_frequency_tag:
+            ok = decodeInt32(stream, wireType, grid.frequency);
+            break;
+        case TGSMO_active_power_tag:
+            ok = decodeInt32(stream, wireType, grid.activePower);
+            break;
+        case TGSMO_current_phase_A_tag:
+        case TGSMO_current_phase_B_tag:
+        case TGSMO_current_phase_C_tag:
+            phaseCurrent = 0;
+            ok = decodeInt32(stream, wireType, phaseCurrent);
+            grid.current += phaseCurrent;
+            break;
+        case TGSMO_temperature_tag:
+            ok = decodeInt32(stream, wireType, grid.temperature);
+            break;
+        default:
+            ok = pb_skip_field(&stream, wireType);
+            break;
+        }
+        if (!ok)
+            return false;
+    }
+    return eof;
+}
+
+boolean DTURealDataDecoder::decodePv(pb_istream_t &stream, realDataPv &pv)
+{
+    pb_wire_type_t wireType;
+    uint32_t tag;
+    bool eof;
+    while (pb_decode_tag(&stream, &wireType, &tag, &eof))
+    {
+        boolean ok;
+        switch (tag)
+        {
+        case PvMO_serial_number_tag:
+            ok = decodeSerial(stream, wireType, pv.serial);
+            break;
+        case PvMO_port_number_tag:
+            ok = decodeInt32(stream, wireType, pv.port);
+            break;
+        case PvMO_voltage_tag:
+            ok = decodeInt32(stream, wireType, pv.voltage);
+            break;
+        case PvMO_current_tag:
+            ok = decodeInt32(stream, wireType, pv.current);
+            break;
+        case PvMO_power_tag:
+            ok = decodeInt32(stream, wireType, pv.power);
+            break;
+        case PvMO_energy_total_tag:
+            ok = decodeInt32(stream, wireType, pv.energyTotal);
+            break;
+        case PvMO_energy_daily_tag:
+            ok = decodeInt32(stream, wireType, pv.energyDaily);
+            break;
+        default:
+            ok = pb_skip_field(&stream, wireType);
+            break;
+        }
+        if (!ok)
+            return false;
+    }
+    return eof;
+}
+
+boolean DTURealDataDecoder::decodeMeter(pb_istream_t &stream, realDataMeter &meter)
+{
+    pb_wire_type_t wireType;
+    uint32_t tag;
+    bool eof;
+    while (pb_decode_tag(&stream, &wireType, &tag, &eof))
+    {
+        boolean ok;
+        switch (tag)
+        {
+        case MeterMO_device_type_tag:
+            ok = decodeInt32(stream, wireType, meter.deviceType);
+            break;
+        case MeterMO_serial_number_tag:
+            ok = decodeSerial(stream, wireType, meter.serial);
+            break;
+        case MeterMO_phase_total_power_tag:
+            ok = decodeInt32(stream, wireType, meter.totalPower);
+            break;
+        case MeterMO_phase_A_power_tag:
+        case MeterMO_phase_B_power_tag:
+        case MeterMO_phase_C_power_tag:
+            ok = decodeInt32(stream, wireType, meter.phasePower[tag - MeterMO_phase_A_power_tag]);
+            break;
+        case MeterMO_power_factor_total_tag:
+            ok = decodeInt32(stream, wireType, meter.powerFactor);
+            break;
+        case MeterMO_energy_total_power_tag:
+            ok = decodeInt32(stream, wireType, meter.energyExport);
+            break;
+        case MeterMO_energy_total_consumed_tag:
+            ok = decodeInt32(stream, wireType, meter.energyImport);
+            break;
+        case MeterMO_fault_code_tag:
+            ok = decodeInt32(stream, wireType, meter.faultCode);
+            break;
+        case MeterMO_voltage_phase_A_tag:
+        case MeterMO_voltage_phase_B_tag:
+        case MeterMO_voltage_phase_C_tag:
+            ok = decodeInt32(stream, wireType, meter.phaseVoltage[tag - MeterMO_voltage_phase_A_tag]);
+            break;
+        case MeterMO_current_phase_A_tag:
+        case MeterMO_current_phase_B_tag:
+        case MeterMO_current_phase_C_tag:
+            ok = decodeInt32(stream, wireType, meter.phaseCurrent[tag - MeterMO_current_phase_A_tag]);
+            break;
+        default:
+            // per phase energy and power factor are not used
+            ok = pb_skip_field(&stream, wireType);
+            break;
+        }
+        if (!ok)
+            return false;
+    }
+    return eof;
+}
+
+boolean DTURealDataDecoder::decodeInt32(pb_istream_t &stream, pb_wire_type_t wireType, int32_t &value)
+{
+    if (wireType != PB_WT_VARINT)
+        return pb_skip_field(&stream, wireType);
+    // negative int32 are sent sign extended to 64 bit
+    uint64_t raw;
+    if (!pb_decode_varint(&stream, &raw))
+        return false;
+    value = int32_t(raw);
+    return true;
+}
+
+boolean DTURealDataDecoder::decodeSerial(pb_istream_t &stream, pb_wire_type_t wireType, uint64_t &serial)
+{
+    if (wireType != PB_WT_VARINT)
+        return pb_skip_field(&stream, wireType);
+    return pb_decode_varint(&stream, &serial);
+}
+
+uint32_t DTURealDataDecoder::fingerprint(uint32_t hash, const realDataGrid &grid)
+{
+    hash = DTUChangeFingerprint::add(hash, grid.serial);
+    hash = DTUChangeFingerprint::add(hash, uint32_t(grid.phases));
+    hash = DTUChangeFingerprint::add(hash, grid.voltage);
+    hash = DTUChangeFingerprint::add(hash, grid.frequency);
+    hash = DTUChangeFingerprint::add(hash, grid.activePower);
+    hash = DTUChangeFingerprint::add(hash, grid.current);
+    hash = DTUChangeFingerprint::add(hash, grid.temperature);
+    return DTUChangeFingerprint::add(hash, grid.powerLimit);
+}
+
+uint32_t DTURealDataDecoder::fingerprint(uint32_t hash, const realDataPv &pv)
+{
+    hash = DTUChangeFingerprint::add(hash, pv.serial);
+    hash = DTUChangeFingerprint::add(hash, pv.port);
+    hash = DTUChangeFingerprint::add(hash, pv.voltage);
+    hash = DTUChangeFingerprint::add(hash, pv.current);
+    hash = DTUChangeFingerprint::add(hash, pv.power);
+    hash = DTUChangeFingerprint::add(hash, pv.energyTotal);
+    return DTUChangeFingerprint::add(hash, pv.energyDaily);
+}
+
+uint32_t DTURealDataDecoder::fingerprint(uint32_t hash, const realDataMeter &meter)
+{
+    hash = DTUChangeFingerprint::add(hash, meter.serial);
+    hash = DTUChangeFingerprint::add(hash, meter.totalPower);
+    for (uint8_t phase = 0; phase < DTU_TELEMETRY_METER_PHASES; phase++)
+    {
+        hash = DTUChangeFingerprint::add(hash, meter.phasePower[phase]);
+        hash = DTUChangeFingerprint::add(hash, meter.phaseVoltage[phase]);
+        hash = DTUChangeFingerprint::add(hash, meter.phaseCurrent[phase]);
+    }
+    hash = DTUChangeFingerprint::add(hash, meter.powerFactor);
+    hash = DTUChangeFingerprint::add(hash, meter.energyExport);
+    hash = DTUChangeFingerprint::add(hash, meter.energyImport);
+    return DTUChangeFingerprint::add(hash, meter.faultCode);
+}
+
+void DTURealDataDecoder::updateTelemetry(DTUTelemetryTable &table, const realDataGrid &grid, uint32_t timestamp)
+{
+    telemetryInverterValues inverter;
+    inverter.serial = grid.serial;
+    inverter.phases = grid.phases;
+    inverter.voltage = grid.voltage / 10.0f;
+    inverter.current = grid.current / 100.0f;
+    inverter.power = grid.activePower / 10.0f;
+    inverter.frequency = grid.frequency / 100.0f;
+    inverter.temperature = grid.temperature / 10.0f;
+    inverter.powerLimit = grid.powerLimit / 10.0f;
+    table.updateInverter(inverter, timestamp);
+}
+
+void DTURealDataDecoder::updateTelemetry(DTUTelemetryTable &table, const realDataPv &pv, uint32_t timestamp)
+{
+    telemetryPortValues port;
+    port.serial = pv.serial;
+    // out of range - port 0 is dropped (and counted) by the table, a truncated number could hit a valid port
+    port.port = (pv.port >= 1 && pv.port <= DTU_TELEMETRY_PORTS_PER_INVERTER) ? uint8_t(pv.port) : 0;
+    port.voltage = pv.voltage / 10.0f;
+    port.current = pv.current / 100.0f;
+    port.power = pv.power / 10.0f;
+    port.energyDaily = pv.energyDaily / 1000.0f;
+    port.energyTotal = pv.energyTotal / 1000.0f;
+    table.updatePort(port, timestamp);
+}
+
+void DTURealDataDecoder::updateTelemetry(DTUTelemetryTable &table, const realDataMeter &meter, uint32_t timestamp)
+{
+    telemetryMeterValues values;
+    values.serial = meter.serial;
+    values.deviceType = meter.deviceType;
+    values.power = meter.totalPower / 10.0f;
+    for (uint8_t phase = 0; phase < DTU_TELEMETRY_METER_PHASES; phase++)
+    {
+        values.phasePower[phase] = meter.phasePower[phase] / 10.0f;
+        values.phaseVoltage[phase] = meter.phaseVoltage[phase] / 10.0f;
+        values.phaseCurrent[phase] = meter.phaseCurrent[phase] / 100.0f;
+    }
+    values.powerFactor = meter.powerFactor / 1000.0f;
+    values.energyExport = meter.energyExport / 100.0f;
+    values.energyImport = meter.energyImport / 100.0f;
+    values.faultCode = meter.faultCode;
+    table.updateMeter(values, timestamp);
+}
@@ -0,0 +1,116 @@
+#include "dtuReceiveQueue.h"
+
+#if defined(ESP32)
+#define RX_LOCK() portENTER_CRITICAL(&queueMux)
+#define RX_UNLOCK() portEXIT_CRITICAL(&queueMux)
+#else
+// ESP8266 - async callbacks and loop do not run concurrently
+#define RX_LOCK()
+#define RX_UNLOCK()
+#endif
+
+size_t DTUReceiveQueue::putData(const uint8_t *data, size_t len)
+{
+    RX_LOCK();
+    size_t free = DTU_RX_BUFFER_SIZE - fill;
+    size_t taken = len < free ? len : free;
+    size_t tail = (head + fill) % DTU_RX_BUFFER_SIZE;
+    size_t first = DTU_RX_BUFFER_SIZE - tail;
+    if (first > taken)
+        first = taken;
+    memcpy(buffer + tail, data, first);
+    memcpy(buffer, data + first, taken - first);
+    fill += taken;
+    writePos += taken;
+    stats.bytes += taken;
+    stats.droppedBytes += len - taken;
+    if (fill > stats.maxFill)
+        stats.maxFill = fill;
+    RX_UNLOCK();
+    return taken;
+}
+
+void DTUReceiveQueue::putEvent(uint8_t type, int8_t error)
+{
+    RX_LOCK();
+    if (eventCount == DTU_RX_EVENT_QUEUE_SIZE)
+    {
+        // keep the newest - the last event tells the current state of the connection
+        eventHead = (eventHead + 1) % DTU_RX_EVENT_QUEUE_SIZE;
+        eventCount--;
+        stats.droppedEvents++;
+    }
+    receiveEvent &event = events[(eventHead + eventCount) % DTU_RX_EVENT_QUEUE_SIZE];
+    event.type = type;
+    event.error = error;
+    event.streamPos = writePos;
+    eventCount++;
+    stats.events++;
+    RX_UNLOCK();
+}
+
+boolean DTUReceiveQueue::takeEvent(receiveEvent &event)
+{
+    RX_LOCK();
+    // the bytes received before the event have to be read first
+    boolean available = eventCount > 0 && events[eventHead].streamPos == readPos;
+    if (available)
+    {
+        event = events[eventHead];
+        eventHead = (eventHead + 1) % DTU_RX_EVENT_QUEUE_SIZE;
+        eventCount--;
+    }
+    RX_UNLOCK();
+    return available;
+}
+
+boolean DTUReceiveQueue::getStreamPos(uint32_t &pos) const
+{
+    RX_LOCK();
+    // not beyond the next event - its bytes belong to the state after it
+    boolean eventPending = eventCount > 0;
+    pos = eventPending ? events[eventHead].streamPos : writePos;
+    RX_UNLOCK();
+    return eventPending;
+}
+
+size_t DTUReceiveQueue::available(uint32_t limit) const
+{
+    RX_LOCK();
+    size_t len = limit - readPos;
+    if (len > fill)
+        len = fill;
+    RX_UNLOCK();
+    return len;
+}
+
+size_t DTUReceiveQueue::peek(size_t offset, size_t len, const uint8_t *&data) const
+{
+    // head is moved by the loop only and the bytes are below the fill level - no lock needed
+    size_t start = (head + offset) % DTU_RX_BUFFER_SIZE;
+    size_t first = DTU_RX_BUFFER_SIZE - start;
+    data = buffer + start;
+    return len < first ? len : first;
+}
+
+void DTUReceiveQueue::consume(size_t len)
+{
+    RX_LOCK();
+    if (len > fill)
+        len = fill;
+    head = (head + len) % DTU_RX_BUFFER_SIZE;
+    fill -= len;
+    readPos += len;
+    RX_UNLOCK();
+}
+
+void DTUReceiveQueue::clear()
+{
+    RX_LOCK();
+    head = 0;
+    fill = 0;
+    readPos = writePos;
+    eventHead = 0;
+    eventCount = 0;
+    RX_UNLOCK();
+}
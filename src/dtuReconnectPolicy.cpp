@@ -0,0 +1,50 @@
+#include "dtuReconnectPolicy.h"
+
+uint32_t DTUReconnectPolicy::nextDelay(uint32_t maxDelayMs)
+{
+    uint32_t delayMs = maxDelayMs;
+    // 2^step would overflow long before - cap reached anyway
+    if (backoffStep < 20)
+        delayMs = min(uint32_t(DTU_RECONNECT_BASE_DELAY_MS) << backoffStep, maxDelayMs);
+    if (delayMs < maxDelayMs)
+        backoffStep++;
+
+    delayMs = delayMs / 2 + uint32_t(random(delayMs / 2 + 1));
+    stats.currentDelayMs = delayMs;
+    return delayMs;
+}
+
+void DTUReconnectPolicy::reset()
+{
+    backoffStep = 0;
+    attemptsSinceConnect = 0;
+    stats.currentDelayMs = 0;
+}
+
+void DTUReconnectPolicy::attemptStarted(unsigned long now)
+{
+    if (attemptsSinceConnect == 0)
+        firstAttemptAt = now;
+    if (attemptsSinceConnect < 0xFF)
+        attemptsSinceConnect++;
+    lastAttemptAt = now;
+    stats.attempts++;
+}
+
+void DTUReconnectPolicy::connected(unsigned long now)
+{
+    stats.connects++;
+    stats.lastAttempts = attemptsSinceConnect;
+    if (attemptsSinceConnect > stats.maxAttempts)
+        stats.maxAttempts = attemptsSinceConnect;
+    if (attemptsSinceConnect > 0)
+    {
+        stats.lastConnectMs = now - lastAttemptAt;
+        if (stats.lastConnectMs > stats.maxConnectMs)
+            stats.maxConnectMs = stats.lastConnectMs;
+        stats.lastOutageMs = now - firstAttemptAt;
+        if (stats.lastOutageMs > stats.maxOutageMs)
+            stats.maxOutageMs = stats.lastOutageMs;
+    }
+    reset();
+}
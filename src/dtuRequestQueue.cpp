@@ -0,0 +1,216 @@
+#include "dtuRequestQueue.h"
+#include "dtuHeartbeat.h"
+
+#if defined(ESP32)
+#define QUEUE_LOCK() portENTER_CRITICAL(&queueMux)
+#define QUEUE_UNLOCK() portEXIT_CRITICAL(&queueMux)
+#else
+// ESP8266 - async callbacks and loop do not run concurrently
+#define QUEUE_LOCK()
+#define QUEUE_UNLOCK()
+#endif
+
+// order in which waiting requests are sent - commands preempt polling
+// heartbeats are sent right after commands to keep their round trip time free of queueing delay
+static const uint8_t requestPriority[] = {DTU_REQ_RESTARTDEVICE, DTU_REQ_COMMAND, DTU_REQ_HEARTBEAT, DTU_REQ_REALDATANEW, DTU_REQ_GETCONFIG, DTU_REQ_APPGETHISTPOWER};
+
+boolean DTURequestQueue::enqueue(uint8_t type, uint8_t param)
+{
+    if (type == DTU_REQ_NONE || type >= DTU_REQ_COUNT)
+        return false;
+
+    QUEUE_LOCK();
+    queuedRequest &request = requests[type];
+    request.param = param;
+    if (request.pending)
+    {
+        stats.coalesced++;
+        QUEUE_UNLOCK();
+        return false;
+    }
+    request.enqueuedAt = millis();
+    request.pending = true;
+    stats.enqueued++;
+
+    stats.depth = getDepth();
+    if (stats.depth > stats.maxDepth)
+        stats.maxDepth = stats.depth;
+    QUEUE_UNLOCK();
+    return true;
+}
+
+uint8_t DTURequestQueue::next(uint8_t &param)
+{
+    uint8_t type = DTU_REQ_NONE;
+    QUEUE_LOCK();
+    for (uint8_t i = 0; i < sizeof(requestPriority); i++)
+    {
+        queuedRequest &request = requests[requestPriority[i]];
+        // the response of the same type could not be told apart - wait until it is finished
+        if (request.pending && !active[requestPriority[i]])
+        {
+            request.pending = false;
+            param = request.param;
+
+            stats.lastWaitMs = millis() - request.enqueuedAt;
+            if (stats.lastWaitMs > stats.maxWaitMs)
+                stats.maxWaitMs = stats.lastWaitMs;
+            stats.sumWaitMs += stats.lastWaitMs;
+            stats.sent++;
+            stats.depth = getDepth();
+            type = requestPriority[i];
+            break;
+        }
+    }
+    QUEUE_UNLOCK();
+    return type;
+}
+
+void DTURequestQueue::clear()
+{
+    QUEUE_LOCK();
+    for (uint8_t i = 0; i < DTU_REQ_COUNT; i++)
+    {
+        requests[i].pending = false;
+        active[i] = false;
+    }
+    pollCycleRunning = false;
+    stats.depth = 0;
+    QUEUE_UNLOCK();
+}
+
+void DTURequestQueue::startRequest(uint8_t type)
+{
+    if (type >= DTU_REQ_COUNT)
+        return;
+    QUEUE_LOCK();
+    active[type] = true;
+    activeSince[type] = millis();
+    QUEUE_UNLOCK();
+}
+
+boolean DTURequestQueue::finishRequest(uint8_t type)
+{
+    QUEUE_LOCK();
+    boolean wasActive = isActive(type);
+    if (wasActive)
+    {
+        active[type] = false;
+        checkPollCycle();
+    }
+    QUEUE_UNLOCK();
+    return wasActive;
+}
+
+boolean DTURequestQueue::checkTimeout()
+{
+    uint32_t waited[DTU_REQ_COUNT] = {0};
+    boolean timeout = false;
+    QUEUE_LOCK();
+    for (uint8_t i = 0; i < DTU_REQ_COUNT; i++)
+    {
+        if (active[i] && millis() - activeSince[i] >= getTimeout(i))
+        {
+            waited[i] = millis() - activeSince[i];
+            active[i] = false;
+            stats.timeouts++;
+            timeout = true;
+        }
+    }
+    if (timeout)
+    {
+        // a lost response ends the cycle without a valid measurement
+        pollCycleRunning = false;
+    }
+    QUEUE_UNLOCK();
+
+    for (uint8_t i = 0; i < DTU_REQ_COUNT && timeout; i++)
+    {
+        if (waited[i] > 0)
+            Serial.println("DTUqueue:\t timeout for request " + String(getName(i)) + " after " + String(waited[i]) + " ms");
+    }
+    return timeout;
+}
+
+uint8_t DTURequestQueue::getActiveCount() const
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < DTU_REQ_COUNT; i++)
+    {
+        if (active[i])
+            count++;
+    }
+    return count;
+}
+
+void DTURequestQueue::startPollCycle()
+{
+    QUEUE_LOCK();
+    pollCycleRunning = true;
+    pollCycleStart = millis();
+    QUEUE_UNLOCK();
+}
+
+void DTURequestQueue::checkPollCycle()
+{
+    if (!pollCycleRunning)
+        return;
+    if (requests[DTU_REQ_REALDATANEW].pending || requests[DTU_REQ_GETCONFIG].pending || active[DTU_REQ_REALDATANEW] || active[DTU_REQ_GETCONFIG])
+        return;
+
+    pollCycleRunning = false;
+    stats.lastPollCycleMs = millis() - pollCycleStart;
+    if (stats.lastPollCycleMs > stats.maxPollCycleMs)
+        stats.maxPollCycleMs = stats.lastPollCycleMs;
+}
+
+uint8_t DTURequestQueue::getDepth() const
+{
+    uint8_t depth = 0;
+    for (uint8_t i = 0; i < DTU_REQ_COUNT; i++)
+    {
+        if (requests[i].pending)
+            depth++;
+    }
+    return depth;
+}
+
+uint16_t DTURequestQueue::getTimeout(uint8_t type)
+{
+    switch (type)
+    {
+    case DTU_REQ_REALDATANEW:
+    case DTU_REQ_GETCONFIG:
+    case DTU_REQ_COMMAND:
+        return 5000;
+    case DTU_REQ_HEARTBEAT:
+        // must be answered before the next beat is due - also after a miss
+        return DTU_HEARTBEAT_RETRY_INTERVAL * 1000 - 1000;
+    case DTU_REQ_APPGETHISTPOWER:
+    case DTU_REQ_RESTARTDEVICE:
+        return 10000;
+    default:
+        return 15000;
+    }
+}
+
+const char *DTURequestQueue::getName(uint8_t type)
+{
+    switch (type)
+    {
+    case DTU_REQ_REALDATANEW:
+        return "RealDataNew";
+    case DTU_REQ_GETCONFIG:
+        return "GetConfig";
+    case DTU_REQ_APPGETHISTPOWER:
+        return "AppGetHistPower";
+    case DTU_REQ_COMMAND:
+        return "Command";
+    case DTU_REQ_RESTARTDEVICE:
+        return "RestartDevice";
+    case DTU_REQ_HEARTBEAT:
+        return "Heartbeat";
+    default:
+        return "none";
+    }
+}
@@ -0,0 +1,115 @@
+#include "dtuSite.h"
+
+DTUSite dtuSite;
+
+void DTUSite::setup(const char *hostList)
+{
+    // already running - e.g. services restarted after wifi reconnect
+    if (count > 0)
+        return;
+    String list = String(hostList);
+    int start = 0;
+    while (start < int(list.length()) && count < DTU_SITE_MAX_DTUS - 1)
+    {
+        int end = list.indexOf(',', start);
+        if (end < 0)
+            end = list.length();
+        String host = list.substring(start, end);
+        host.trim();
+        start = end + 1;
+        if (host.length() == 0)
+            continue;
+
+        host.toCharArray(hosts[count], DTU_SITE_HOST_LENGTH);
+        connection[count].preventCloudErrors = userConfig.dtuCloudPauseActive;
+        dtus[count] = new DTUInterface(hosts[count], 10081, &data[count], &connection[count]);
+        dtus[count]->setup(hosts[count]);
+        Serial.println("DTUsite:\t setup DTU " + String(count + 1) + " - host: '" + String(hosts[count]) + "'");
+        count++;
+    }
+    if (start < int(list.length()))
+        Serial.println("DTUsite:\t max. number of DTUs reached (" + String(DTU_SITE_MAX_DTUS) + ") - ignoring: '" + list.substring(start) + "'");
+}
+
+void DTUSite::tick()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        // local time only - published with the next change of the DTU
+        data[i].currentTimestamp++;
+        if (dtus[i]->checkDataUpdateDue())
+            dtus[i]->getDataUpdate();
+    }
+}
+
+const char *DTUSite::getHost(uint8_t index) const
+{
+    if (index == 0 || index > count)
+        return userConfig.dtuHostIpDomain;
+    return hosts[index - 1];
+}
+
+const DTUInterface &DTUSite::getDtu(uint8_t index) const
+{
+    if (index == 0 || index > count)
+        return dtuInterface;
+    return *dtus[index - 1];
+}
+
+uint32_t DTUSite::readSnapshotData(uint8_t index, inverterData &copy) const
+{
+    return getDtu(index).readSnapshotData(copy);
+}
+
+uint32_t DTUSite::readSnapshotConnection(uint8_t index, connectionControl &copy) const
+{
+    return getDtu(index).readSnapshotConnection(copy);
+}
+
+const requestQueueStats &DTUSite::getRequestQueueStats(uint8_t index) const
+{
+    if (index == 0 || index > count)
+        return dtuInterface.getRequestQueueStats();
+    return dtus[index - 1]->getRequestQueueStats();
+}
+
+uint16_t DTUSite::getUpdateInterval(uint8_t index) const
+{
+    if (index == 0 || index > count)
+        return dtuInterface.getUpdateInterval();
+    return dtus[index - 1]->getUpdateInterval();
+}
+
+int8_t DTUSite::getIndex(const DTUInterface *source) const
+{
+    if (source == &dtuInterface)
+        return 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (source == dtus[i])
+            return i + 1;
+    }
+    return -1;
+}
+
+siteTotals DTUSite::getTotals() const
+{
+    siteTotals totals;
+    for (uint8_t i = 0; i < getCount(); i++)
+    {
+        // called in the loop and the web server - only the small blocks on the stack
+        inverterData dtuData;
+        connectionControl dtuConn;
+        getDtu(i).readSnapshotData(dtuData);
+        getDtu(i).readSnapshotConnection(dtuConn);
+        totals.dtuCount++;
+        if (dtuConn.dtuConnectionOnline)
+            totals.dtusOnline++;
+        // power -1 - no value received yet
+        if (dtuData.grid.power > 0)
+            totals.power += dtuData.grid.power;
+        totals.dailyEnergy += dtuData.grid.dailyEnergy;
+        totals.totalEnergy += dtuData.grid.totalEnergy;
+    }
+    return totals;
+}
@@ -0,0 +1,164 @@
+#include "dtuTelemetry.h"
+
+#define DTU_TELEMETRY_HASH_SIZE (DTU_TELEMETRY_MAX_INVERTERS * 2)
+
+DTUTelemetryTable::DTUTelemetryTable()
+{
+    reset();
+}
+
+void DTUTelemetryTable::reset()
+{
+    inverterCount = 0;
+    meterCount = 0;
+    memset(serialHash, DTU_TELEMETRY_NO_INDEX, sizeof(serialHash));
+    memset(inverterSerial, 0, sizeof(inverterSerial));
+    memset(inverterLastUpdate, 0, sizeof(inverterLastUpdate));
+    memset(portLastUpdate, 0, sizeof(portLastUpdate));
+    memset(meterLastUpdate, 0, sizeof(meterLastUpdate));
+    receivedMillis = 0;
+}
+
+uint8_t DTUTelemetryTable::hashBucket(uint64_t serial)
+{
+    // the last digits of the serial differ most between inverters
+    return uint8_t((uint32_t(serial) ^ uint32_t(serial >> 32)) % DTU_TELEMETRY_HASH_SIZE);
+}
+
+uint8_t DTUTelemetryTable::findInverter(uint64_t serial) const
+{
+    uint8_t bucket = hashBucket(serial);
+    for (uint8_t probe = 0; probe < DTU_TELEMETRY_HASH_SIZE; probe++)
+    {
+        uint8_t index = serialHash[bucket];
+        if (index == DTU_TELEMETRY_NO_INDEX)
+            return DTU_TELEMETRY_NO_INDEX;
+        if (inverterSerial[index] == serial)
+            return index;
+        bucket = (bucket + 1) % DTU_TELEMETRY_HASH_SIZE;
+    }
+    return DTU_TELEMETRY_NO_INDEX;
+}
+
+uint8_t DTUTelemetryTable::addInverter(uint64_t serial)
+{
+    uint8_t index = findInverter(serial);
+    if (index != DTU_TELEMETRY_NO_INDEX)
+        return index;
+    if (inverterCount >= DTU_TELEMETRY_MAX_INVERTERS)
+        return DTU_TELEMETRY_NO_INDEX;
+
+    // hash has twice the size of the inverter budget - there is always a free bucket
+    uint8_t bucket = hashBucket(serial);
+    while (serialHash[bucket] != DTU_TELEMETRY_NO_INDEX)
+        bucket = (bucket + 1) % DTU_TELEMETRY_HASH_SIZE;
+
+    index = inverterCount++;
+    serialHash[bucket] = index;
+    inverterSerial[index] = serial;
+    inverterPhases[index] = DTU_INVERTER_SINGLE_PHASE;
+    inverterVoltage[index] = 0;
+    inverterCurrent[index] = 0;
+    inverterPower[index] = 0;
+    inverterFrequency[index] = 0;
+    inverterTemperature[index] = 0;
+    inverterPowerLimit[index] = 0;
+    Serial.println("DTUtelemetry:\t new inverter " + serialToString(serial) + " - index: " + String(index));
+    return index;
+}
+
+boolean DTUTelemetryTable::updateInverter(const telemetryInverterValues &values, uint32_t timestamp)
+{
+    uint8_t index = addInverter(values.serial);
+    if (index == DTU_TELEMETRY_NO_INDEX)
+    {
+        droppedEntries++;
+        return false;
+    }
+    inverterPhases[index] = values.phases;
+    inverterVoltage[index] = values.voltage;
+    inverterCurrent[index] = values.current;
+    inverterPower[index] = values.power;
+    inverterFrequency[index] = values.frequency;
+    inverterTemperature[index] = values.temperature;
+    inverterPowerLimit[index] = values.powerLimit;
+    inverterLastUpdate[index] = timestamp > 0 ? timestamp : 1; // 0 - never seen
+    return true;
+}
+
+boolean DTUTelemetryTable::updatePort(const telemetryPortValues &values, uint32_t timestamp)
+{
+    if (values.port < 1 || values.port > DTU_TELEMETRY_PORTS_PER_INVERTER)
+    {
+        droppedEntries++;
+        return false;
+    }
+    uint8_t index = addInverter(values.serial);
+    if (index == DTU_TELEMETRY_NO_INDEX)
+    {
+        droppedEntries++;
+        return false;
+    }
+    uint8_t slot = index * DTU_TELEMETRY_PORTS_PER_INVERTER + values.port - 1;
+    portVoltage[slot] = values.voltage;
+    portCurrent[slot] = values.current;
+    portPower[slot] = values.power;
+    portEnergyDaily[slot] = values.energyDaily;
+    // total energy is not always sent - keep the last value
+    if (values.energyTotal != 0)
+        portEnergyTotal[slot] = values.energyTotal;
+    else if (portLastUpdate[slot] == 0)
+        portEnergyTotal[slot] = 0;
+    portLastUpdate[slot] = timestamp > 0 ? timestamp : 1; // 0 - never seen
+    return true;
+}
+
+boolean DTUTelemetryTable::updateMeter(const telemetryMeterValues &values, uint32_t timestamp)
+{
+    uint8_t index = 0;
+    while (index < meterCount && meterSerial[index] != values.serial)
+        index++;
+    if (index == meterCount)
+    {
+        if (meterCount >= DTU_TELEMETRY_MAX_METERS)
+        {
+            droppedEntries++;
+            return false;
+        }
+        meterCount++;
+        meterSerial[index] = values.serial;
+        Serial.println("DTUtelemetry:\t new meter " + serialToString(values.serial) + " - index: " + String(index));
+    }
+    meterDeviceType[index] = values.deviceType;
+    meterPower[index] = values.power;
+    for (uint8_t phase = 0; phase < DTU_TELEMETRY_METER_PHASES; phase++)
+    {
+        uint8_t slot = index * DTU_TELEMETRY_METER_PHASES + phase;
+        meterPhasePower[slot] = values.phasePower[phase];
+        meterPhaseVoltage[slot] = values.phaseVoltage[phase];
+        meterPhaseCurrent[slot] = values.phaseCurrent[phase];
+    }
+    meterPowerFactor[index] = values.powerFactor;
+    meterEnergyExport[index] = values.energyExport;
+    meterEnergyImport[index] = values.energyImport;
+    meterFaultCode[index] = values.faultCode;
+    meterLastUpdate[index] = timestamp > 0 ? timestamp : 1; // 0 - never seen
+    return true;
+}
+
+uint8_t DTUTelemetryTable::getPortIndex(uint8_t inverter, uint8_t port) const
+{
+    if (inverter >= inverterCount || port >= DTU_TELEMETRY_PORTS_PER_INVERTER)
+        return DTU_TELEMETRY_NO_INDEX;
+    uint8_t slot = inverter * DTU_TELEMETRY_PORTS_PER_INVERTER + port;
+    if (portLastUpdate[slot] == 0)
+        return DTU_TELEMETRY_NO_INDEX;
+    return slot;
+}
+
+String DTUTelemetryTable::serialToString(uint64_t serial)
+{
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%04lX%08lX", (unsigned long)(serial >> 32), (unsigned long)(serial & 0xFFFFFFFF));
+    return String(buffer);
+}
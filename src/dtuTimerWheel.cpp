@@ -0,0 +1,130 @@
+#include "dtuTimerWheel.h"
+
+#if defined(ESP32)
+#define WHEEL_LOCK() portENTER_CRITICAL(&wheelMux)
+#define WHEEL_UNLOCK() portEXIT_CRITICAL(&wheelMux)
+#else
+// ESP8266 - async callbacks and loop do not run concurrently
+#define WHEEL_LOCK()
+#define WHEEL_UNLOCK()
+#endif
+
+DTUTimerWheel::DTUTimerWheel()
+{
+    memset(slotHead, DTU_TIMER_WHEEL_NONE, sizeof(slotHead));
+}
+
+void DTUTimerWheel::setCallback(TimerWheelCallback callback, void *context)
+{
+    this->callback = callback;
+    callbackContext = context;
+}
+
+void DTUTimerWheel::schedule(uint8_t timerId, unsigned long now, uint32_t delayMs)
+{
+    if (timerId >= DTU_TIMER_WHEEL_MAX_TIMERS)
+        return;
+    WHEEL_LOCK();
+    if (timers[timerId].scheduled)
+        unlink(timerId);
+    // nothing pending - the slots before now do not need to be walked again
+    boolean idle = true;
+    for (uint8_t i = 0; i < DTU_TIMER_WHEEL_MAX_TIMERS; i++)
+        idle = idle && !timers[i].scheduled;
+    if (idle)
+        lastAdvance = now;
+
+    wheelTimer &timer = timers[timerId];
+    timer.deadline = now + delayMs;
+    timer.scheduled = true;
+    uint8_t slot = slotOf(timer.deadline);
+    timer.next = slotHead[slot];
+    slotHead[slot] = timerId;
+    WHEEL_UNLOCK();
+}
+
+void DTUTimerWheel::cancel(uint8_t timerId)
+{
+    if (timerId >= DTU_TIMER_WHEEL_MAX_TIMERS)
+        return;
+    WHEEL_LOCK();
+    if (timers[timerId].scheduled)
+        unlink(timerId);
+    WHEEL_UNLOCK();
+}
+
+boolean DTUTimerWheel::isScheduled(uint8_t timerId) const
+{
+    return timerId < DTU_TIMER_WHEEL_MAX_TIMERS && timers[timerId].scheduled;
+}
+
+void DTUTimerWheel::unlink(uint8_t timerId)
+{
+    wheelTimer &timer = timers[timerId];
+    uint8_t *link = &slotHead[slotOf(timer.deadline)];
+    while (*link != DTU_TIMER_WHEEL_NONE)
+    {
+        if (*link == timerId)
+        {
+            *link = timer.next;
+            break;
+        }
+        link = &timers[*link].next;
+    }
+    timer.next = DTU_TIMER_WHEEL_NONE;
+    timer.scheduled = false;
+}
+
+void DTUTimerWheel::advance(unsigned long now)
+{
+    // slots passed since the last call - after a full revolution every slot was passed
+    WHEEL_LOCK();
+    uint32_t passedSlots = ((now >> DTU_TIMER_WHEEL_SLOT_SHIFT) - (lastAdvance >> DTU_TIMER_WHEEL_SLOT_SHIFT)) + 1;
+    if (passedSlots > DTU_TIMER_WHEEL_SLOTS)
+        passedSlots = DTU_TIMER_WHEEL_SLOTS;
+    lastAdvance = now;
+
+    // collect first, fire afterwards - callbacks may reschedule into the walked slots
+    uint8_t expired[DTU_TIMER_WHEEL_MAX_TIMERS];
+    uint8_t expiredCount = 0;
+    uint8_t slot = slotOf(now);
+    for (uint32_t i = 0; i < passedSlots; i++)
+    {
+        uint8_t timerId = slotHead[slot];
+        while (timerId != DTU_TIMER_WHEEL_NONE)
+        {
+            uint8_t next = timers[timerId].next;
+            if (long(now - timers[timerId].deadline) >= 0)
+            {
+                unlink(timerId);
+                expired[expiredCount++] = timerId;
+            }
+            timerId = next;
+        }
+        slot = (slot + DTU_TIMER_WHEEL_SLOTS - 1) % DTU_TIMER_WHEEL_SLOTS;
+    }
+    WHEEL_UNLOCK();
+
+    for (uint8_t i = 0; i < expiredCount; i++)
+    {
+        if (callback)
+            callback(callbackContext, expired[i]);
+    }
+}
+
+uint32_t DTUTimerWheel::getNextDelay(unsigned long now) const
+{
+    uint32_t nextDelay = DTU_TIMER_WHEEL_NO_DEADLINE;
+    WHEEL_LOCK();
+    for (uint8_t i = 0; i < DTU_TIMER_WHEEL_MAX_TIMERS; i++)
+    {
+        if (!timers[i].scheduled)
+            continue;
+        long remaining = long(timers[i].deadline - now);
+        uint32_t delayMs = remaining > 0 ? uint32_t(remaining) : 0;
+        if (delayMs < nextDelay)
+            nextDelay = delayMs;
+    }
+    WHEEL_UNLOCK();
+    return nextDelay;
+}
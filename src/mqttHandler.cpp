@@ -46,6 +46,12 @@ void MQTTHandler::subscribedMessageArrived(char *topic, byte *payload, unsigned
             instance->lastPowerLimitSet.setValue = setLimit;
             instance->lastPowerLimitSet.update = true;
         }
+        else if (instance->meterPowerTopic.length() > 0 && String(topic) == instance->meterPowerTopic)
+        {
+            instance->lastMeterPower.power = incommingMessage.toFloat();
+            instance->lastMeterPower.receivedMillis = millis();
+            instance->lastMeterPower.update = true;
+        }
         else
         {
             // Serial.println("MQTT: received message for topic: " + String(topic) + " - value: " + incommingMessage);
@@ -126,6 +132,13 @@ PowerLimitSet MQTTHandler::getPowerLimitSet()
     return lastSetting;
 }
 
+MeterPowerValue MQTTHandler::getMeterPower()
+{
+    MeterPowerValue lastValue = lastMeterPower;
+    lastMeterPower.update = false;
+    return lastValue;
+}
+
 RemoteInverterData MQTTHandler::getRemoteInverterData()
 {
     RemoteInverterData lastReceive = lastRemoteInverterData;
@@ -281,6 +294,8 @@ boolean MQTTHandler::initiateDiscoveryMessages(bool autoDiscoveryRemove)
 
             publishDiscoveryMessage("inverter_PowerLimit", "power limit", "%", autoDiscoveryRemove, NULL, "power_factor"); //"mdi:car-speed-limiter"
             publishDiscoveryMessage("inverter_PowerLimitSet", "power limit set", "%", autoDiscoveryRemove, "mdi:car-speed-limiter", "power_factor");
+            publishDiscoveryMessage("inverter_PowerLimitAckMs", "power limit ack latency", "ms", autoDiscoveryRemove, "mdi:timer-outline", "duration", true);
+            publishDiscoveryMessage("inverter_PowerLimitEffectiveMs", "power limit effective latency", "ms", autoDiscoveryRemove, "mdi:timer-outline", "duration", true);
 
             publishDiscoveryMessage("inverter_Temp", "Inverter temperature", "°C", autoDiscoveryRemove, NULL, "temperature", true); //"mdi:thermometer"
             publishDiscoveryMessage("inverter_WifiRSSI", "WiFi strength", "%", autoDiscoveryRemove, "mdi:wifi", NULL, true);
@@ -367,6 +382,11 @@ void MQTTHandler::reconnect()
                 topic = "homeassistant/number/" + instance->mqttMainTopicPath + "/inverter_PowerLimitSet/set";
                 client.subscribe(topic.c_str());
                 Serial.println("MQTT:\t\t subscribe to: " + topic);
+                if (meterPowerTopic.length() > 0)
+                {
+                    client.subscribe(meterPowerTopic.c_str());
+                    Serial.println("MQTT:\t\t subscribe to: " + meterPowerTopic);
+                }
 
                 // Publish MQTT auto-discovery messages at every new connection, if enabled
                 initiateDiscoveryMessages();
@@ -462,6 +482,12 @@ void MQTTHandler::setRemoteDisplayData(boolean remoteDisplayActive)
     instance->lastRemoteInverterData.remoteDisplayActive = remoteDisplayActive;
 }
 
+void MQTTHandler::setMeterPowerTopic(const char *meterTopic)
+{
+    meterPowerTopic = meterTopic;
+    Serial.println("MQTT:\t\t ... set meter power topic to: '" + meterPowerTopic + "'");
+}
+
 // Setter method to combine all settings
 void MQTTHandler::setConfiguration(const char *broker, int port, const char *user, const char *password, bool useTLS, const char *sensorUniqueName, const char *mainTopicPath, bool autoDiscovery, const char *ipAddress)
 {
@@ -0,0 +1,294 @@
+#include "outputSink.h"
+
+OutputSink *OutputSink::sinks[OUTPUT_SINK_MAX];
+uint8_t OutputSink::sinkCount = 0;
+
+#if defined(ESP32)
+#define SINK_LOCK() portENTER_CRITICAL(&queueMux)
+#define SINK_UNLOCK() portEXIT_CRITICAL(&queueMux)
+#else
+// ESP8266 - enqueue and delivery in the loop context
+#define SINK_LOCK()
+#define SINK_UNLOCK()
+#endif
+
+OutputSink::OutputSink(const char *name, uint8_t policy) : name(name), policy(policy)
+{
+}
+
+void OutputSink::begin(outputSinkWorker worker, void *context, boolean ownTask)
+{
+    if (this->worker != nullptr)
+        return;
+    if (sinkCount >= OUTPUT_SINK_MAX)
+    {
+        Serial.println("SINK:\t\t no free sink slot for '" + String(name) + "' (max. " + String(OUTPUT_SINK_MAX) + ")");
+        return;
+    }
+    sinks[sinkCount++] = this;
+    this->worker = worker;
+    this->context = context;
+#if defined(ESP32)
+    if (ownTask)
+    {
+        BaseType_t created = xTaskCreate(taskWorker, name, OUTPUT_SINK_STACK, this, OUTPUT_SINK_PRIORITY, &taskHandle);
+        this->ownTask = (created == pdPASS);
+        if (!this->ownTask)
+            Serial.println("SINK:\t\t " + String(name) + " - worker task could not be created - delivering in the loop");
+    }
+#endif
+    if (!this->ownTask)
+    {
+        loopTaskId = taskScheduler.addTask(name, loopWorker, this, 0, 0, 0, false);
+        // first poll
+        arm();
+    }
+}
+
+void OutputSink::setPoll(outputSinkPoll poll, uint32_t intervalMs)
+{
+    this->poll = poll;
+    pollIntervalMs = intervalMs;
+}
+
+boolean OutputSink::enqueue(const dtuEvent &event)
+{
+    if (worker == nullptr)
+        return false;
+    boolean dropped = false;
+    SINK_LOCK();
+    stats.enqueued++;
+    boolean coalesced = false;
+    if (policy == OUTPUT_SINK_POLICY_COALESCE)
+    {
+        for (uint8_t i = 0; i < queueCount; i++)
+        {
+            outputSinkItem &item = queue[(queueHead + i) % OUTPUT_SINK_QUEUE_SIZE];
+            if (item.event.type != event.type || item.event.source != event.source)
+                continue;
+            // latest value wins - the enqueue time stays, the lag shows how long the sink is behind
+            item.event = event;
+            stats.coalesced++;
+            coalesced = true;
+            break;
+        }
+    }
+    if (!coalesced)
+    {
+        if (queueCount == OUTPUT_SINK_QUEUE_SIZE)
+        {
+            queueHead = (queueHead + 1) % OUTPUT_SINK_QUEUE_SIZE;
+            queueCount--;
+            stats.dropped++;
+            dropped = true;
+        }
+        outputSinkItem &item = queue[(queueHead + queueCount) % OUTPUT_SINK_QUEUE_SIZE];
+        item.event = event;
+        item.enqueuedMs = millis();
+        queueCount++;
+        if (queueCount > stats.maxQueued)
+            stats.maxQueued = queueCount;
+    }
+    SINK_UNLOCK();
+
+#if defined(ESP32)
+    if (ownTask)
+    {
+        xTaskNotifyGive(taskHandle);
+        return !dropped;
+    }
+#endif
+    arm();
+    return !dropped;
+}
+
+boolean OutputSink::takeNext(outputSinkItem &item)
+{
+    SINK_LOCK();
+    boolean available = queueCount > 0;
+    if (available)
+    {
+        item = queue[queueHead];
+        queueHead = (queueHead + 1) % OUTPUT_SINK_QUEUE_SIZE;
+        queueCount--;
+    }
+    SINK_UNLOCK();
+    return available;
+}
+
+// one step of the worker - the due poll or the next event, false if there is nothing to do
+boolean OutputSink::work()
+{
+    if (getPauseRemaining() > 0)
+        return false;
+    if (poll != nullptr && getPollRemaining() == 0)
+    {
+        pollTarget();
+        return true;
+    }
+    if (queueCount > 0)
+    {
+        deliverNext();
+        return true;
+    }
+    return false;
+}
+
+void OutputSink::deliverNext()
+{
+    outputSinkItem item;
+    if (!takeNext(item))
+        return;
+
+    uint32_t lag = millis() - item.enqueuedMs;
+    uint32_t start = micros();
+    boolean delivered = worker(item.event, context);
+    uint32_t end = micros();
+
+    uint32_t runtime = end - start;
+    uint32_t latency = end - item.event.originUs;
+    stats.lastLagMs = lag;
+    if (lag > stats.maxLagMs)
+        stats.maxLagMs = lag;
+    stats.lastRunUs = runtime;
+    if (runtime > stats.maxRunUs)
+        stats.maxRunUs = runtime;
+    stats.busyUs += runtime;
+    if (!delivered)
+    {
+        // the event is lost - the next one brings newer values anyway
+        stats.failed++;
+        pause();
+        return;
+    }
+    stats.delivered++;
+    stats.lastLatencyUs = latency;
+    if (latency > stats.maxLatencyUs)
+        stats.maxLatencyUs = latency;
+}
+
+void OutputSink::pollTarget()
+{
+    lastPollMs = millis();
+    uint32_t start = micros();
+    boolean reached = poll(context);
+    uint32_t runtime = micros() - start;
+
+    stats.polls++;
+    stats.busyUs += runtime;
+    if (!reached)
+    {
+        stats.pollsFailed++;
+        pause();
+    }
+}
+
+void OutputSink::reportFailure()
+{
+    pause();
+#if defined(ESP32)
+    if (ownTask)
+        xTaskNotifyGive(taskHandle);
+#endif
+}
+
+void OutputSink::pause()
+{
+    if (getPauseRemaining() == 0)
+    {
+        stats.pauses++;
+        Serial.println("SINK:\t\t " + String(name) + " - target not reachable - pause for " + String(OUTPUT_SINK_RETRY_MS / 1000) + " s");
+    }
+    pausedUntil = (millis() + OUTPUT_SINK_RETRY_MS) | 1;
+}
+
+uint32_t OutputSink::getPauseRemaining() const
+{
+    uint32_t until = pausedUntil;
+    if (until == 0)
+        return 0;
+    int32_t remaining = int32_t(until - millis());
+    return remaining > 0 ? uint32_t(remaining) : 0;
+}
+
+uint32_t OutputSink::getPollRemaining() const
+{
+    uint32_t elapsed = millis() - lastPollMs;
+    return elapsed >= pollIntervalMs ? 0 : pollIntervalMs - elapsed;
+}
+
+// time until the worker has something to do - OUTPUT_SINK_IDLE if it waits for an event
+uint32_t OutputSink::getIdleMs() const
+{
+    uint32_t pauseMs = getPauseRemaining();
+    uint32_t idleMs = queueCount > 0 ? pauseMs : OUTPUT_SINK_IDLE;
+    if (poll != nullptr)
+    {
+        uint32_t pollMs = max(getPollRemaining(), pauseMs);
+        if (pollMs < idleMs)
+            idleMs = pollMs;
+    }
+    return idleMs;
+}
+
+boolean OutputSink::isAvailable() const
+{
+    return getPauseRemaining() == 0;
+}
+
+void OutputSink::arm()
+{
+    // next delivery right away - or at the end of the pause, the next poll at its time
+    uint32_t idleMs = getIdleMs();
+    if (idleMs != OUTPUT_SINK_IDLE)
+        taskScheduler.runIn(loopTaskId, idleMs);
+}
+
+void OutputSink::loopWorker(void *instance)
+{
+    OutputSink *sink = static_cast<OutputSink *>(instance);
+    // one event or poll per run - the other loop jobs and sinks get their turn in between
+    sink->work();
+    sink->arm();
+}
+
+#if defined(ESP32)
+void OutputSink::taskWorker(void *instance)
+{
+    OutputSink *sink = static_cast<OutputSink *>(instance);
+    for (;;)
+    {
+        if (sink->work())
+            continue;
+        // woken by enqueue() - or at the end of the pause/ at the next poll
+        uint32_t idleMs = sink->getIdleMs();
+        ulTaskNotifyTake(pdTRUE, idleMs == OUTPUT_SINK_IDLE ? portMAX_DELAY : pdMS_TO_TICKS(idleMs));
+    }
+}
+#endif
+
+void OutputSink::resetStats()
+{
+    SINK_LOCK();
+    stats = outputSinkStats();
+    SINK_UNLOCK();
+}
+
+void OutputSink::printStats()
+{
+    for (uint8_t i = 0; i < sinkCount; i++)
+    {
+        const OutputSink &sink = *sinks[i];
+        const outputSinkStats &stats = sink.stats;
+        Serial.printf("SINK:\t\t %-8s %s queued: %u in: %7lu out: %7lu coalesced: %6lu dropped: %5lu failed: %5lu polls: %7lu failed: %5lu lag max: %6lu ms latency max: %8lu us\n",
+                      sink.name, sink.ownTask ? "task" : "loop", sink.queueCount, (unsigned long)stats.enqueued,
+                      (unsigned long)stats.delivered, (unsigned long)stats.coalesced, (unsigned long)stats.dropped,
+                      (unsigned long)stats.failed, (unsigned long)stats.polls, (unsigned long)stats.pollsFailed,
+                      (unsigned long)stats.maxLagMs, (unsigned long)stats.maxLatencyUs);
+    }
+}
+
+const char *OutputSink::getPolicyName(uint8_t policy)
+{
+    return policy == OUTPUT_SINK_POLICY_COALESCE ? "coalesce" : "dropOldest";
+}
@@ -0,0 +1,115 @@
+#include "zeroExportController.h"
+#include "Config.h"
+
+ZeroExportController zeroExportController;
+
+void ZeroExportController::reset(uint8_t currentLimit)
+{
+    if (currentLimit > 100)
+        currentLimit = 100;
+    output = float(currentLimit) * userConfig.zeroExportInverterPower / 100.0f;
+    lastError = 0;
+    lastError2 = 0;
+    lastLimit = currentLimit;
+    initialized = true;
+    Serial.println("ZeroExport:\t reset controller output to " + String(output, 0) + " W (" + String(currentLimit) + " %)");
+}
+
+boolean ZeroExportController::addMeterValue(float meterPower, float inverterPower, unsigned long inverterMillis, unsigned long receivedMillis, uint8_t &newLimit)
+{
+    stats.meterUpdates++;
+    float error = meterPower - userConfig.zeroExportTarget;
+    updateTrackingError(error);
+
+    float dt = 1.0f;
+    if (lastMeterMillis != 0)
+        dt = constrain((receivedMillis - lastMeterMillis) / 1000.0f, 0.1f, 10.0f);
+    lastMeterMillis = receivedMillis;
+
+    if (!initialized)
+        return false;
+
+    // anti windup - don't plan far above what the inverter really delivers (e.g. low sun)
+    // only with a recent inverter power taken after the last command - older values show the old limit
+    float maxStep = userConfig.zeroExportMaxStep;
+    if (inverterPower >= 0 && output > inverterPower + maxStep)
+    {
+        boolean current = inverterMillis != 0 && long(receivedMillis - inverterMillis) <= ZERO_EXPORT_INVERTER_MAX_AGE_MS &&
+                          (lastCommandMillis == 0 || long(inverterMillis - lastCommandMillis) > 0);
+        if (current)
+            output = inverterPower + maxStep;
+        else
+            stats.clampSkipped++;
+    }
+
+    if (fabsf(error) <= userConfig.zeroExportDeadband)
+    {
+        stats.heldByDeadband++;
+        lastError2 = lastError;
+        lastError = error;
+        return false;
+    }
+
+    // incremental form - output changes by P of error change, I of error and D of error curvature
+    float delta = userConfig.zeroExportKp * (error - lastError) +
+                  userConfig.zeroExportKi * error * dt +
+                  userConfig.zeroExportKd * (error - 2 * lastError + lastError2) / dt;
+    lastError2 = lastError;
+    lastError = error;
+
+    delta = constrain(delta, -maxStep, maxStep);
+    output = constrain(output + delta, 0.0f, float(userConfig.zeroExportInverterPower));
+    stats.outputPower = output;
+
+    // round up - rather a few watts import than export
+    int limit = int(ceilf(output * 100.0f / userConfig.zeroExportInverterPower));
+    limit = constrain(limit, ZERO_EXPORT_MIN_LIMIT, 100);
+    if (limit == lastLimit)
+        return false;
+
+    unsigned long now = millis();
+    if (lastCommandMillis != 0 && now - lastCommandMillis < userConfig.zeroExportMinCommandTime * 1000UL)
+    {
+        stats.heldByRateLimit++;
+        return false;
+    }
+
+    lastCommandMillis = now;
+    lastLimit = limit;
+    newLimit = limit;
+    commandMeterMillis = receivedMillis;
+    commandPending = true;
+
+    stats.commands++;
+    return true;
+}
+
+void ZeroExportController::commandAcked(uint8_t limit, unsigned long ackMillis)
+{
+    // ack of a limit set by others (web, MQTT) or of an older command
+    if (!commandPending || limit != lastLimit)
+        return;
+    commandPending = false;
+    stats.acked++;
+    stats.lastLatencyMs = ackMillis - commandMeterMillis;
+    stats.sumLatencyMs += stats.lastLatencyMs;
+    if (stats.lastLatencyMs > stats.maxLatencyMs)
+        stats.maxLatencyMs = stats.lastLatencyMs;
+}
+
+boolean ZeroExportController::isActive(unsigned long now) const
+{
+    return initialized && lastMeterMillis != 0 && now - lastMeterMillis < ZERO_EXPORT_METER_TIMEOUT_MS;
+}
+
+void ZeroExportController::updateTrackingError(float error)
+{
+    float absError = fabsf(error);
+    stats.trackingError = error;
+    if (stats.meterUpdates == 1)
+        stats.trackingErrorAvg = absError;
+    else
+        stats.trackingErrorAvg = 0.9f * stats.trackingErrorAvg + 0.1f * absError;
+    if (absError > stats.trackingErrorMax)
+        stats.trackingErrorMax = absError;
+}
@@ -0,0 +1,139 @@
+// Host simulation of DTUCloudPauseLearner - a DTU that uploads to the cloud for a random time
+// (12 ... 25 s) at every quarter hour and refuses connections meanwhile, the gateway reconnects
+// with DTUReconnectPolicy (backoff from 1 s, default cap of 60 s). One simulated day with the fixed pause of 40 s and one with the learned pause,
+// reports the data availability of both and the learned pause lengths. The learned window - the
+// pauses after the first one that ended while the DTU was busy - has to cover the upload time on
+// average and may end in a busy DTU at most every fourth time:
+//
+//   g++ -std=c++17 -O2 -Itest/host/stub -Iinclude test/host/cloud_pause_sim.cpp src/dtuCloudPauseLearner.cpp src/dtuReconnectPolicy.cpp -o cloud_pause_sim
+//   ./cloud_pause_sim [days]
+//
+// (from the repository root - exits with 1 if learning does not pay off or the learned window is off)
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "dtuCloudPauseLearner.h"
+#include "dtuReconnectPolicy.h"
+
+#define SIM_QUARTER_MS (15 * 60 * 1000UL)
+#define SIM_PAUSE_MAX_SECONDS 40
+#define SIM_UPLOAD_MIN_MS 12000
+#define SIM_UPLOAD_MAX_MS 25000
+#define SIM_RECONNECT_MAX_MS 60000 // dtu.reconnectMaxDelay
+#define SIM_RESPONSE_MS 300 // connect until the first RealDataNew response
+#define SIM_BUSY_SHARE_MAX 0.25f
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, uint32_t n)
+{
+  if (ok)
+    return;
+  printf("FAILED - %s (%u)\n", what, n);
+  failures++;
+}
+
+struct simResult
+{
+  float availability = 0;
+  uint32_t pauses = 0;
+  uint32_t busyPauses = 0;
+  uint32_t pauseSum = 0;
+  uint16_t pauseMin = 0xFFFF;
+  uint16_t pauseMax = 0;
+  // learned window - from the first busy pause on
+  uint32_t windowPauses = 0;
+  uint32_t windowSum = 0;
+  uint16_t windowMin = 0xFFFF;
+  uint16_t windowMax = 0;
+  uint16_t finalPause = 0;
+};
+
+static simResult simulate(uint32_t days, bool learn)
+{
+  std::mt19937 rng(3);
+  srand(5);
+  DTUCloudPauseLearner learner;
+  DTUReconnectPolicy reconnectPolicy;
+  learner.setMaxSeconds(SIM_PAUSE_MAX_SECONDS);
+  simResult result;
+
+  // first quarter starts online - the pause begins 20 s before the quarter hour
+  unsigned long now = 1;
+  learner.setOnline(true, now);
+  for (uint32_t quarter = 0; quarter < days * 96; quarter++)
+  {
+    unsigned long pauseStart = (quarter + 1) * SIM_QUARTER_MS - 20000;
+    unsigned long uploadEnd = pauseStart + SIM_UPLOAD_MIN_MS + rng() % (SIM_UPLOAD_MAX_MS - SIM_UPLOAD_MIN_MS);
+    uint16_t pauseSeconds = learn ? learner.getPauseSeconds() : SIM_PAUSE_MAX_SECONDS;
+
+    now = pauseStart;
+    learner.setOnline(false, now);
+    learner.pauseStarted(now);
+    now += pauseSeconds * 1000UL;
+    learner.pauseEnded(now);
+    // planned reconnect - refused while the upload runs
+    reconnectPolicy.reset();
+    reconnectPolicy.attemptStarted(now);
+    while (now < uploadEnd)
+    {
+      learner.connectFailed();
+      now += reconnectPolicy.nextDelay(SIM_RECONNECT_MAX_MS);
+      reconnectPolicy.attemptStarted(now);
+    }
+    reconnectPolicy.connected(now);
+    learner.connected(now);
+    learner.setOnline(true, now);
+    now += SIM_RESPONSE_MS;
+    learner.dataReceived(now, true);
+
+    result.pauseSum += pauseSeconds;
+    result.pauseMin = pauseSeconds < result.pauseMin ? pauseSeconds : result.pauseMin;
+    result.pauseMax = pauseSeconds > result.pauseMax ? pauseSeconds : result.pauseMax;
+    if (learner.getStats().busyPauses > 0)
+    {
+      result.windowPauses++;
+      result.windowSum += pauseSeconds;
+      result.windowMin = pauseSeconds < result.windowMin ? pauseSeconds : result.windowMin;
+      result.windowMax = pauseSeconds > result.windowMax ? pauseSeconds : result.windowMax;
+    }
+  }
+  now = days * 96 * SIM_QUARTER_MS;
+  result.availability = learner.getDataAvailability(now);
+  result.pauses = learner.getStats().pauses;
+  result.busyPauses = learner.getStats().busyPauses;
+  result.finalPause = learner.getPauseSeconds();
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t days = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1;
+  simResult fixed = simulate(days, false);
+  simResult learned = simulate(days, true);
+  printf("fixed pause:   %2u s - data availability %.2f %%\n", SIM_PAUSE_MAX_SECONDS, fixed.availability * 100);
+  printf("learned pause: %2u ... %2u s (mean %.1f s) - data availability %.2f %% - %u of %u pauses ended while the DTU was busy\n",
+         learned.pauseMin, learned.pauseMax, float(learned.pauseSum) / learned.pauses, learned.availability * 100,
+         learned.busyPauses, learned.pauses);
+  float windowMean = learned.windowPauses > 0 ? float(learned.windowSum) / learned.windowPauses : 0;
+  printf("learned window: %2u ... %2u s (mean %.1f s) over %u pauses, last %u s - upload %u ... %u s\n",
+         learned.windowMin, learned.windowMax, windowMean, learned.windowPauses, learned.finalPause,
+         SIM_UPLOAD_MIN_MS / 1000, SIM_UPLOAD_MAX_MS / 1000);
+  check(learned.availability > fixed.availability, "learned availability above the fixed pause", uint32_t(learned.availability * 10000));
+  check(learned.pauseMin >= DTU_CLOUD_PAUSE_MIN_SECONDS, "pause below the minimum", learned.pauseMin);
+  check(learned.pauseMax <= SIM_PAUSE_MAX_SECONDS, "pause above dtu.cloudPauseTime", learned.pauseMax);
+  check(learned.windowPauses > 0 && learned.windowPauses < learned.pauses, "pauses in the learned window", learned.windowPauses);
+  check(learned.windowMin >= SIM_UPLOAD_MIN_MS / 1000, "learned window below the shortest upload", learned.windowMin);
+  check(windowMean >= SIM_UPLOAD_MIN_MS / 1000 && windowMean <= SIM_UPLOAD_MAX_MS / 1000 + DTU_CLOUD_PAUSE_MARGIN_SECONDS,
+        "mean of the learned window outside of the upload time", uint32_t(windowMean));
+  check(learned.finalPause >= DTU_CLOUD_PAUSE_MIN_SECONDS && learned.finalPause <= SIM_PAUSE_MAX_SECONDS, "last learned pause", learned.finalPause);
+  check(learned.busyPauses <= learned.pauses * SIM_BUSY_SHARE_MAX, "busy pauses", learned.busyPauses);
+  if (failures > 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
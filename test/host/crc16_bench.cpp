@@ -0,0 +1,99 @@
+// Host benchmark of DTUCRC16 against a bit wise CRC16/MODBUS as the generic CRC16 class of the
+// robtillaart/CRC library computes it (polynome 0x8005, input and output reflected per byte/
+// result, init 0xFFFF). Both are checked against the CRC16/MODBUS check value and each other on
+// random frames, then timed over payloads of typical DTU frame sizes:
+//
+//   g++ -std=c++17 -O2 -Itest/host/stub -Iinclude test/host/crc16_bench.cpp src/dtuCRC16.cpp -o crc16_bench
+//   ./crc16_bench [rounds]
+//
+// (from the repository root - exits with 1 if the results differ)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "dtuCRC16.h"
+
+static uint8_t reverse8(uint8_t in)
+{
+  uint8_t out = 0;
+  for (uint8_t i = 0; i < 8; i++)
+    out = uint8_t((out << 1) | ((in >> i) & 1));
+  return out;
+}
+
+static uint16_t reverse16(uint16_t in)
+{
+  return uint16_t((reverse8(uint8_t(in)) << 8) | reverse8(uint8_t(in >> 8)));
+}
+
+// bit by bit with the reflection of every byte - the way of the generic library class
+static uint16_t bitwiseCRC16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= uint16_t(reverse8(data[i])) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x8005) : uint16_t(crc << 1);
+  }
+  return reverse16(crc);
+}
+
+template <typename F>
+static double nsPerByte(F calc, const std::vector<std::vector<uint8_t>> &frames, uint32_t rounds, uint32_t &sink)
+{
+  size_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    for (const std::vector<uint8_t> &frame : frames)
+    {
+      sink += calc(frame.data(), frame.size());
+      bytes += frame.size();
+    }
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / bytes;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t rounds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  if (DTUCRC16::calc(check, sizeof(check)) != 0x4B37 || bitwiseCRC16(check, sizeof(check)) != 0x4B37)
+  {
+    printf("FAILED - check value 0x4B37: table 0x%04X bitwise 0x%04X\n", DTUCRC16::calc(check, sizeof(check)), bitwiseCRC16(check, sizeof(check)));
+    return 1;
+  }
+
+  // request payloads are a few bytes, responses up to some hundred
+  std::mt19937 rng(7);
+  std::vector<std::vector<uint8_t>> frames;
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    std::vector<uint8_t> frame(4 + rng() % 400);
+    for (uint8_t &b : frame)
+      b = uint8_t(rng());
+    if (DTUCRC16::calc(frame.data(), frame.size()) != bitwiseCRC16(frame.data(), frame.size()))
+    {
+      printf("FAILED - results differ for a frame of %zu bytes\n", frame.size());
+      return 1;
+    }
+    // in chunks - as over the wrap around of the frame assembler ring
+    size_t split = rng() % frame.size();
+    if (DTUCRC16::calc(frame.data() + split, frame.size() - split, DTUCRC16::calc(frame.data(), split)) != bitwiseCRC16(frame.data(), frame.size()))
+    {
+      printf("FAILED - chunked result differs for a frame of %zu bytes\n", frame.size());
+      return 1;
+    }
+    frames.push_back(frame);
+  }
+
+  uint32_t sink = 0;
+  double table = nsPerByte([](const uint8_t *d, size_t l) { return DTUCRC16::calc(d, l); }, frames, rounds, sink);
+  double bitwise = nsPerByte(bitwiseCRC16, frames, rounds / 10 + 1, sink);
+  printf("table: %.2f ns/byte - bitwise: %.2f ns/byte - %.1fx (%u)\n", table, bitwise, bitwise / table, sink & 1);
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,420 @@
+// Host scale simulation of a site with several DTUs - the loop side of every DTU connection (receive
+// queue, frame assembler, request queue with the pipelined RealDataNew/ GetConfig pair, telemetry
+// table) against simulated DTUs on a virtual clock. Each DTU answers after a random WLAN round trip
+// (20 ... 250 ms), works on its requests one after the other, cuts its responses into random TCP
+// segments and loses 1 % of them. All DTUs are polled at the same time (worst case for the loop).
+// With a pipeline depth of 1 the requests go out one after the other as before the pipelining.
+// Reports the poll cycle per DTU, the site round until the last DTU answered, the loop cpu time
+// per round, the memory of the per DTU state and the heap used in the loop path:
+//
+//   g++ -std=c++17 -O2 -Itest/host/stub -Iinclude test/host/dtu_site_scale_sim.cpp src/dtuReceiveQueue.cpp src/dtuFrameAssembler.cpp src/dtuCRC16.cpp src/dtuRequestQueue.cpp src/dtuHeartbeat.cpp src/dtuTelemetry.cpp -o dtu_site_scale_sim
+//   ./dtu_site_scale_sim [dtus] [minutes] [pipeline depth]
+//
+// (from the repository root - exits with 1 on a lost or rejected frame, a dropped byte or a heap leak)
+// Not covered on the host: the async TCP client, the nanopb decode and the free heap of the ESP32 -
+// /api/info.json shows freeHeap and the per DTU poll cycle (requestQueue) on the device.
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <vector>
+#include <Arduino.h>
+#include "dtuConst.h"
+#include "dtuReceiveQueue.h"
+#include "dtuFrameAssembler.h"
+#include "dtuRequestQueue.h"
+#include "dtuTelemetry.h"
+
+#define SIM_MAX_DTUS 16
+#define SIM_POLL_INTERVAL_MS 10000 // dtu.updateTimeMin below its default of 31 s - worst case load of the loop
+#define SIM_TASK_PERIOD_MS 100     // timeouts are checked by the periodic jobs of the loop
+#define SIM_RTT_MIN_MS 20
+#define SIM_RTT_MAX_MS 250
+#define SIM_LOSS_PER_MILLE 10
+#define SIM_MSS 1460
+#define SIM_INVERTERS 4 // per DTU - DTU-Pro with 2-port inverters
+#define SIM_PORTS 2
+
+// heap use of the loop path only - the simulated DTUs allocate their segments outside
+static bool countHeap = false;
+static uint64_t heapAllocations = 0;
+static int64_t heapLiveBytes = 0;
+
+// every block starts with its counted size - aligned like the block itself
+#define SIM_HEAP_HEADER alignof(std::max_align_t)
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+  uint8_t *block = static_cast<uint8_t *>(malloc(size + SIM_HEAP_HEADER));
+  if (block == nullptr)
+    throw std::bad_alloc();
+  size_t counted = countHeap ? size : 0;
+  memcpy(block, &counted, sizeof(counted));
+  if (countHeap)
+  {
+    heapAllocations++;
+    heapLiveBytes += int64_t(size);
+  }
+  return block + SIM_HEAP_HEADER;
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept
+{
+  if (ptr == nullptr)
+    return;
+  uint8_t *block = static_cast<uint8_t *>(ptr) - SIM_HEAP_HEADER;
+  size_t counted;
+  memcpy(&counted, block, sizeof(counted));
+  heapLiveBytes -= int64_t(counted);
+  free(block);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+static constexpr uint16_t responseId(const byte (&request)[2])
+{
+  return uint16_t(((request[0] - 1) << 8) | request[1]);
+}
+
+struct simSegment
+{
+  uint32_t at = 0;
+  std::vector<uint8_t> bytes;
+};
+
+// the DTU - answers one request after the other
+struct simDtu
+{
+  uint32_t busyUntil = 0;
+  uint32_t lost = 0;
+  std::deque<simSegment> segments; // in order of arrival
+};
+
+// state of one DTU connection in the loop - as in DTUInterface
+struct simGateway
+{
+  DTUReceiveQueue rx;
+  DTUFrameAssembler assembler{rx};
+  DTURequestQueue queue;
+  DTUTelemetryTable telemetry;
+  boolean due = false;
+  boolean gotRealData = false;
+  boolean gotConfig = false;
+  boolean roundDone = true;
+  boolean roundLost = false;
+  uint32_t doneAt = 0;
+};
+
+static std::mt19937 rng(11);
+static uint8_t pipelineDepth = DTU_REQ_PIPELINE_DEPTH;
+
+static uint32_t randomBetween(uint32_t low, uint32_t high)
+{
+  return low + rng() % (high - low + 1);
+}
+
+// response frame of the DTU - random payload with a valid header, cut into TCP segments
+static void respond(simDtu &dtu, const byte (&request)[2], size_t payloadLen, uint32_t now, uint32_t workMs)
+{
+  // the DTU side - not part of the heap use of the loop
+  bool counting = countHeap;
+  countHeap = false;
+  std::vector<uint8_t> frame(DTU_FRAME_HEADER_SIZE + payloadLen);
+  for (size_t i = DTU_FRAME_HEADER_SIZE; i < frame.size(); i++)
+    frame[i] = uint8_t(rng());
+  uint16_t crc = DTUCRC16::calc(frame.data() + DTU_FRAME_HEADER_SIZE, payloadLen);
+  uint16_t cmd = responseId(request);
+  const uint8_t header[DTU_FRAME_HEADER_SIZE] = {0x48, 0x4d, uint8_t(cmd >> 8), uint8_t(cmd), 0x00, 0x01,
+                                                 uint8_t(crc >> 8), uint8_t(crc), uint8_t(frame.size() >> 8), uint8_t(frame.size())};
+  memcpy(frame.data(), header, DTU_FRAME_HEADER_SIZE);
+
+  if (rng() % 1000 < SIM_LOSS_PER_MILLE)
+  {
+    dtu.lost++;
+    countHeap = counting;
+    return;
+  }
+  uint32_t at = std::max(now + randomBetween(SIM_RTT_MIN_MS, SIM_RTT_MAX_MS), dtu.busyUntil) + workMs;
+  dtu.busyUntil = at;
+  for (size_t pos = 0; pos < frame.size();)
+  {
+    // mostly one segment per frame - split on a busy WLAN
+    size_t len = rng() % 4 == 0 ? randomBetween(1, SIM_MSS) : SIM_MSS;
+    len = std::min(len, frame.size() - pos);
+    simSegment segment;
+    segment.at = at;
+    segment.bytes.assign(frame.begin() + pos, frame.begin() + pos + len);
+    dtu.segments.push_back(segment);
+    pos += len;
+    at += randomBetween(0, 3);
+  }
+  dtu.busyUntil = at;
+  countHeap = counting;
+}
+
+// the values are not decoded (no nanopb on the host) - the payload bytes fill the table instead
+static void storeRealData(simGateway &gw, pb_istream_t &istream)
+{
+  uint8_t payload[DTU_FRAME_MAX_LENGTH];
+  size_t len = istream.bytes_left;
+  if (!pb_read(&istream, payload, len) || len < SIM_INVERTERS * SIM_PORTS)
+    return;
+  for (uint8_t i = 0; i < SIM_INVERTERS; i++)
+  {
+    telemetryInverterValues inverter;
+    inverter.serial = 0x116180000000ULL + i;
+    inverter.power = payload[i];
+    gw.telemetry.updateInverter(inverter, millis() / 1000);
+    for (uint8_t port = 1; port <= SIM_PORTS; port++)
+    {
+      telemetryPortValues values;
+      values.serial = inverter.serial;
+      values.port = port;
+      values.power = payload[i * SIM_PORTS + port - 1];
+      gw.telemetry.updatePort(values, millis() / 1000);
+    }
+  }
+}
+
+// DTUInterface::handleFrame - routed by the command id of the response
+static void handleFrame(simGateway &gw, const dtuFrameHeader &header, pb_istream_t &istream)
+{
+  switch ((uint16_t(header.cmdHigh) << 8) | header.cmdLow)
+  {
+  case responseId(CMD_REAL_RES_DTO):
+    if (!gw.queue.finishRequest(DTU_REQ_REALDATANEW))
+    {
+      gw.queue.countUnsolicited();
+      return;
+    }
+    storeRealData(gw, istream);
+    gw.gotRealData = true;
+    break;
+  case responseId(CMD_GET_CONFIG):
+    if (!gw.queue.finishRequest(DTU_REQ_GETCONFIG))
+    {
+      gw.queue.countUnsolicited();
+      return;
+    }
+    gw.gotConfig = true;
+    break;
+  default:
+    gw.queue.countUnsolicited();
+    return;
+  }
+  if (!gw.roundDone && gw.gotRealData && gw.gotConfig)
+  {
+    gw.roundDone = true;
+    gw.doneAt = millis();
+  }
+}
+
+// DTUInterface::processReceived
+static void processReceived(simGateway &gw)
+{
+  uint32_t limit;
+  gw.rx.getStreamPos(limit);
+  dtuFrameHeader header;
+  pb_istream_t istream;
+  while (gw.assembler.nextFrame(header, istream, limit))
+  {
+    handleFrame(gw, header, istream);
+    gw.assembler.releaseFrame();
+  }
+}
+
+// DTUInterface::processRequestQueue - requests written back-to-back
+static void processRequestQueue(simGateway &gw, simDtu &dtu)
+{
+  if (gw.queue.checkTimeout() && !gw.roundDone)
+  {
+    gw.roundDone = true;
+    gw.roundLost = true;
+  }
+  while (gw.queue.getActiveCount() < pipelineDepth)
+  {
+    uint8_t param = 0;
+    uint8_t type = gw.queue.next(param);
+    if (type == DTU_REQ_NONE)
+      return;
+    gw.queue.startRequest(type);
+    if (type == DTU_REQ_REALDATANEW)
+      respond(dtu, CMD_REAL_RES_DTO, randomBetween(300, 700), millis(), randomBetween(10, 40));
+    else
+      respond(dtu, CMD_GET_CONFIG, randomBetween(120, 180), millis(), 5);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 8;
+  uint32_t minutes = argc > 2 ? strtoul(argv[2], nullptr, 10) : 60;
+  pipelineDepth = argc > 3 ? uint8_t(atoi(argv[3])) : DTU_REQ_PIPELINE_DEPTH;
+  if (count < 1 || count > SIM_MAX_DTUS || pipelineDepth < 1 || pipelineDepth > DTU_REQ_PIPELINE_DEPTH)
+  {
+    printf("1 ... %u DTUs, pipeline depth 1 ... %u\n", SIM_MAX_DTUS, DTU_REQ_PIPELINE_DEPTH);
+    return 1;
+  }
+  hostVirtualClock = true;
+  hostMillis = 1;
+
+  std::vector<simGateway> gateways(count);
+  std::vector<simDtu> dtus(count);
+
+  uint32_t rounds = 0;
+  uint32_t lostRounds = 0;
+  uint64_t cycleSumMs = 0;
+  uint32_t cycleMaxMs = 0;
+  uint64_t siteSumMs = 0;
+  uint32_t siteMaxMs = 0;
+  uint64_t cpuSumUs = 0;
+  uint32_t cpuMaxUs = 0;
+  uint32_t roundStart = 0;
+  uint32_t roundCpuUs = 0;
+  boolean roundOpen = false;
+
+  uint32_t end = minutes * 60000UL;
+  for (uint32_t now = 1; now <= end; now++)
+  {
+    hostMillis = now;
+    // async TCP side - received segments are handed over to the loop
+    for (uint32_t i = 0; i < count; i++)
+    {
+      while (!dtus[i].segments.empty() && dtus[i].segments.front().at <= now)
+      {
+        const simSegment &segment = dtus[i].segments.front();
+        if (gateways[i].rx.putData(segment.bytes.data(), segment.bytes.size()) < segment.bytes.size())
+          printf("receive queue of DTU %u full\n", i);
+        gateways[i].due = true;
+        dtus[i].segments.pop_front();
+      }
+    }
+
+    // no poll in the last interval - every request is answered or timed out at the end
+    boolean pollDue = now % SIM_POLL_INTERVAL_MS == 0 && now + SIM_POLL_INTERVAL_MS <= end;
+    if (pollDue && roundOpen)
+      printf("round not finished after %u ms\n", SIM_POLL_INTERVAL_MS);
+    boolean periodic = now % SIM_TASK_PERIOD_MS == 0;
+
+    // loop side - the tx/rx task of every DTU with work
+    uint32_t start = micros();
+    boolean worked = false;
+    countHeap = true;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      simGateway &gw = gateways[i];
+      if (pollDue)
+      {
+        gw.queue.enqueue(DTU_REQ_REALDATANEW);
+        gw.queue.enqueue(DTU_REQ_GETCONFIG);
+        gw.queue.startPollCycle();
+        gw.gotRealData = false;
+        gw.gotConfig = false;
+        gw.roundDone = false;
+        gw.roundLost = false;
+        gw.due = true;
+      }
+      if (!gw.due && !periodic)
+        continue;
+      gw.due = false;
+      worked = true;
+      processReceived(gw);
+      processRequestQueue(gw, dtus[i]);
+    }
+    countHeap = false;
+    if (worked)
+      roundCpuUs += micros() - start;
+
+    if (pollDue)
+    {
+      roundStart = now;
+      roundOpen = true;
+    }
+    if (!roundOpen)
+      continue;
+    boolean allDone = true;
+    boolean anyLost = false;
+    uint32_t lastDone = roundStart;
+    for (const simGateway &gw : gateways)
+    {
+      allDone = allDone && gw.roundDone;
+      anyLost = anyLost || gw.roundLost;
+      if (gw.roundDone && !gw.roundLost && gw.doneAt > lastDone)
+        lastDone = gw.doneAt;
+    }
+    if (!allDone)
+      continue;
+
+    roundOpen = false;
+    rounds++;
+    cpuSumUs += roundCpuUs;
+    cpuMaxUs = std::max(cpuMaxUs, roundCpuUs);
+    roundCpuUs = 0;
+    for (const simGateway &gw : gateways)
+    {
+      if (gw.roundLost)
+        continue;
+      cycleSumMs += gw.doneAt - roundStart;
+      cycleMaxMs = std::max(cycleMaxMs, gw.doneAt - roundStart);
+    }
+    // a lost response ends the round with the request timeout - counted apart
+    if (anyLost)
+    {
+      lostRounds++;
+      continue;
+    }
+    siteSumMs += lastDone - roundStart;
+    siteMaxMs = std::max(siteMaxMs, lastDone - roundStart);
+  }
+
+  uint32_t lost = 0;
+  uint32_t timeouts = 0;
+  uint32_t unsolicited = 0;
+  uint32_t rejected = 0;
+  uint32_t droppedBytes = 0;
+  uint16_t rxMaxFill = 0;
+  uint32_t queueMaxCycle = 0;
+  uint32_t cycles = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    lost += dtus[i].lost;
+    timeouts += gateways[i].queue.getStats().timeouts;
+    unsolicited += gateways[i].queue.getStats().unsolicited;
+    rejected += gateways[i].assembler.getStats().framesRejected;
+    droppedBytes += gateways[i].rx.getStats().droppedBytes;
+    rxMaxFill = std::max(rxMaxFill, gateways[i].rx.getStats().maxFill);
+    queueMaxCycle = std::max(queueMaxCycle, gateways[i].queue.getStats().maxPollCycleMs);
+  }
+  cycles = rounds * count - lost;
+  size_t stateBytes = sizeof(DTUReceiveQueue) + sizeof(DTUFrameAssembler) + sizeof(DTURequestQueue) + sizeof(DTUTelemetryTable);
+  uint32_t siteRounds = rounds - lostRounds;
+
+  printf("DTUs: %u - poll every %u s - %u rounds (%u min simulated) - RTT %u ... %u ms, %.1f %% of the responses lost\n",
+         count, SIM_POLL_INTERVAL_MS / 1000, rounds, minutes, SIM_RTT_MIN_MS, SIM_RTT_MAX_MS, SIM_LOSS_PER_MILLE / 10.0);
+  printf("state per DTU (rx queue %zu + frame assembler %zu + request queue %zu + telemetry %zu): %zu bytes - all DTUs: %zu bytes\n",
+         sizeof(DTUReceiveQueue), sizeof(DTUFrameAssembler), sizeof(DTURequestQueue), sizeof(DTUTelemetryTable), stateBytes, stateBytes * count);
+  printf("poll cycle per DTU (RealDataNew + GetConfig, pipeline depth %u): mean %.0f ms max %u ms (request queue: %u ms)\n",
+         pipelineDepth, cycles > 0 ? double(cycleSumMs) / cycles : 0.0, cycleMaxMs, queueMaxCycle);
+  printf("site round (poll until the last DTU answered): mean %.0f ms max %u ms - %u rounds with a lost response (request timeout)\n",
+         siteRounds > 0 ? double(siteSumMs) / siteRounds : 0.0, siteMaxMs, lostRounds);
+  printf("loop cpu per round: mean %.0f us max %u us (%.1f us per DTU)\n",
+         rounds > 0 ? double(cpuSumUs) / rounds : 0.0, cpuMaxUs, rounds > 0 ? double(cpuSumUs) / rounds / count : 0.0);
+  printf("receive queue max fill: %u bytes (of %u) dropped: %u - rejected frames: %u - lost responses: %u timeouts: %u unsolicited: %u\n",
+         rxMaxFill, DTU_RX_BUFFER_SIZE, droppedBytes, rejected, lost, timeouts, unsolicited);
+  printf("heap in the loop path: %llu allocations (log lines) - %lld bytes still allocated\n",
+         (unsigned long long)heapAllocations, (long long)heapLiveBytes);
+
+  if (droppedBytes > 0 || rejected > 0 || unsolicited > 0 || timeouts != lost || heapLiveBytes != 0 || rounds == 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,112 @@
+// Host benchmark of DTUFrameAssembler - a stream of valid DTU frames (random payload lengths) is
+// cut into random TCP segments (1 byte up to one MSS) and put into the receive queue, the assembler
+// parses them in place. Every payload is read back like nanopb does and compared. Every 16th frame can be preceded by garbage
+// to exercise the resync. Reports frames and MB per second:
+//
+//   g++ -std=c++17 -O2 -Itest/host/stub -Iinclude test/host/frame_assembler_bench.cpp src/dtuReceiveQueue.cpp src/dtuFrameAssembler.cpp src/dtuCRC16.cpp -o frame_assembler_bench
+//   ./frame_assembler_bench [frames] [garbage 0/1]
+//
+// (from the repository root - exits with 1 if a frame is lost, changed or rejected)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "dtuFrameAssembler.h"
+
+#define BENCH_MSS 1460
+#define BENCH_MAX_PAYLOAD 600
+
+static void appendFrame(std::vector<uint8_t> &stream, std::mt19937 &rng, uint16_t cmd)
+{
+  size_t payloadLen = 8 + rng() % BENCH_MAX_PAYLOAD;
+  std::vector<uint8_t> payload(payloadLen);
+  for (uint8_t &b : payload)
+    b = uint8_t(rng());
+  uint16_t crc = DTUCRC16::calc(payload.data(), payloadLen);
+  uint16_t length = uint16_t(payloadLen + DTU_FRAME_HEADER_SIZE);
+  uint8_t header[DTU_FRAME_HEADER_SIZE] = {0x48, 0x4d, uint8_t(cmd >> 8), uint8_t(cmd), 0x00, 0x01,
+                                           uint8_t(crc >> 8), uint8_t(crc), uint8_t(length >> 8), uint8_t(length)};
+  stream.insert(stream.end(), header, header + DTU_FRAME_HEADER_SIZE);
+  stream.insert(stream.end(), payload.begin(), payload.end());
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t frames = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+  bool garbage = argc > 2 && atoi(argv[2]) != 0;
+  std::mt19937 rng(42);
+
+  // the stream and the expected payloads are built first - only the assembler is timed
+  std::vector<uint8_t> stream;
+  std::vector<size_t> payloadStart;
+  std::vector<uint16_t> payloadLength;
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    if (garbage && i % 16 == 0)
+    {
+      // no "HM" in it - otherwise the garbage could form a (rejected) header
+      for (uint32_t n = rng() % 64; n > 0; n--)
+        stream.push_back(uint8_t(0x50 + rng() % 16));
+    }
+    payloadStart.push_back(stream.size() + DTU_FRAME_HEADER_SIZE);
+    appendFrame(stream, rng, 0xa311);
+    payloadLength.push_back(uint16_t(stream.size() - payloadStart.back()));
+  }
+  std::vector<size_t> segments;
+  for (size_t pos = 0; pos < stream.size();)
+  {
+    size_t len = std::min(size_t(1 + rng() % BENCH_MSS), stream.size() - pos);
+    segments.push_back(len);
+    pos += len;
+  }
+
+  static DTUReceiveQueue queue;
+  static DTUFrameAssembler assembler(queue);
+  uint8_t payload[BENCH_MAX_PAYLOAD + 8];
+  uint32_t received = 0;
+  uint32_t broken = 0;
+  size_t pos = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t segment : segments)
+  {
+    const uint8_t *data = stream.data() + pos;
+    pos += segment;
+    while (segment > 0)
+    {
+      // the loop lags behind - a segment larger than the free space is put in parts
+      size_t taken = queue.putData(data, segment);
+      data += taken;
+      segment -= taken;
+
+      uint32_t limit;
+      queue.getStreamPos(limit);
+      dtuFrameHeader header;
+      pb_istream_t istream;
+      while (assembler.nextFrame(header, istream, limit))
+      {
+        size_t len = istream.bytes_left;
+        if (received >= frames || len != payloadLength[received] || !pb_read(&istream, payload, len) ||
+            memcmp(payload, stream.data() + payloadStart[received], len) != 0)
+          broken++;
+        received++;
+        assembler.releaseFrame();
+      }
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  const frameAssemblerStats &stats = assembler.getStats();
+  printf("frames: %u in %zu segments (%.1f MB) - received: %u broken: %u rejected: %u resync bytes: %u max fill: %u (of %u)\n",
+         frames, segments.size(), stream.size() / 1e6, received, broken, stats.framesRejected, stats.resyncBytes,
+         queue.getStats().maxFill, DTU_RX_BUFFER_SIZE);
+  printf("%.0f frames/s - %.1f MB/s\n", received / seconds, stream.size() / seconds / 1e6);
+  if (received != frames || broken > 0 || stats.framesRejected > 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,225 @@
+// Host measurement of stack use and time of the RealDataNew decode - before: pb_decode into the
+// generated RealDataNewReqDTO as the old readRespRealDataNew did it, after: the streaming
+// DTURealDataDecoder. Each decode runs on an own thread with a painted stack, the used bytes are
+// the painted bytes that got overwritten minus those of an empty thread. Frames:
+//  - one single phase inverter with 2 ports (HMS-800W-2T) - the frame the old decode was made for
+//  - the full telemetry budget (8 three-phase inverters, 32 ports, 2 meters) - only the streaming
+//    decode, the generated struct holds at most 4 PvMO and fails on it
+// The numbers are x86-64 frames - the Xtensa ABI of the ESP32 uses more stack per call, on the
+// device the loop task high water mark is in /api/info.json (dtuDecode.loopStackFreeBytes).
+//
+// needs the real nanopb and the code generated from include/proto - both are in .pio after one
+// PlatformIO build of the esp32 environment (pio run -e esp32):
+//
+//   g++ -std=c++17 -O2 -pthread -I.pio/libdeps/esp32/Nanopb -I.pio/build/esp32/nanopb/generated-src -Itest/host/stub -Iinclude test/host/realdata_decode_stack_test.cpp src/dtuRealDataDecoder.cpp src/dtuTelemetry.cpp src/dtuChangeFingerprint.cpp .pio/build/esp32/nanopb/generated-src/RealtimeDataNew.pb.c .pio/libdeps/esp32/Nanopb/pb_decode.c .pio/libdeps/esp32/Nanopb/pb_common.c -o realdata_decode_stack_test
+//   ./realdata_decode_stack_test [rounds]
+//
+// (from the repository root - nanopb before the stub directory, exits with 1 on a failure)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <vector>
+#include "dtuRealDataDecoder.h"
+
+#define TEST_SERIAL_BASE 0x116180212345ULL
+#define TEST_STACK_SIZE (256 * 1024)
+#define TEST_STACK_PATTERN 0xA5
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, uint32_t n)
+{
+  if (ok)
+    return;
+  printf("FAILED - %s (%u)\n", what, n);
+  failures++;
+}
+
+static void putVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back(uint8_t(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(uint8_t(value));
+}
+
+static void putInt(std::vector<uint8_t> &out, uint32_t field, int64_t value)
+{
+  putVarint(out, uint64_t(field) << 3);
+  putVarint(out, uint64_t(value));
+}
+
+static void putBytes(std::vector<uint8_t> &out, uint32_t field, const std::vector<uint8_t> &bytes)
+{
+  putVarint(out, (uint64_t(field) << 3) | 2);
+  putVarint(out, bytes.size());
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// SGSMO/ TGSMO - fields 1 ... 20 (SGSMO ends at 13 and 20)
+static std::vector<uint8_t> encodeGrid(uint64_t serial, uint32_t lastField)
+{
+  std::vector<uint8_t> grid;
+  putInt(grid, 1, int64_t(serial));
+  for (uint32_t field = 2; field <= lastField; field++)
+    putInt(grid, field, 2300 + field);
+  return grid;
+}
+
+static std::vector<uint8_t> encodePv(uint64_t serial, int32_t port)
+{
+  std::vector<uint8_t> pv;
+  putInt(pv, 1, int64_t(serial));
+  putInt(pv, 2, port);
+  for (uint32_t field = 3; field <= 8; field++)
+    putInt(pv, field, 3100 + field);
+  return pv;
+}
+
+static std::vector<uint8_t> encodeMeter(uint64_t serial)
+{
+  std::vector<uint8_t> meter;
+  putInt(meter, 1, 1);
+  putInt(meter, 2, int64_t(serial));
+  for (uint32_t field = 3; field <= 25; field++)
+    putInt(meter, field, 1200 + field);
+  return meter;
+}
+
+// RealDataNew payload without the frame header
+static std::vector<uint8_t> encodePayload(bool fullBudget)
+{
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> deviceSerial = {'4', '1', '4', '1', '8', '0', '2', '1', '2', '3', '4', '5'};
+  putBytes(payload, 1, deviceSerial);
+  putInt(payload, 2, 1700000000);
+  if (!fullBudget)
+  {
+    putBytes(payload, 9, encodeGrid(TEST_SERIAL_BASE, 13));
+    putBytes(payload, 11, encodePv(TEST_SERIAL_BASE, 1));
+    putBytes(payload, 11, encodePv(TEST_SERIAL_BASE, 2));
+    return payload;
+  }
+  for (uint32_t meter = 0; meter < DTU_TELEMETRY_MAX_METERS; meter++)
+    putBytes(payload, 6, encodeMeter(TEST_SERIAL_BASE + 0x100 + meter));
+  for (uint32_t inverter = 0; inverter < DTU_TELEMETRY_MAX_INVERTERS; inverter++)
+    putBytes(payload, 10, encodeGrid(TEST_SERIAL_BASE + inverter, 20));
+  for (uint32_t inverter = 0; inverter < DTU_TELEMETRY_MAX_INVERTERS; inverter++)
+    for (int32_t port = 1; port <= DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+      putBytes(payload, 11, encodePv(TEST_SERIAL_BASE + inverter, port));
+  return payload;
+}
+
+struct decodeJob
+{
+  const std::vector<uint8_t> *payload;
+  DTUTelemetryTable *table;
+  bool decoded;
+};
+
+static void *runNothing(void *)
+{
+  return nullptr;
+}
+
+// the old readRespRealDataNew - full generated struct on the stack
+static void *runOldDecode(void *arg)
+{
+  decodeJob *job = static_cast<decodeJob *>(arg);
+  RealDataNewReqDTO realdatanewreqdto = RealDataNewReqDTO_init_default;
+  pb_istream_t stream = pb_istream_from_buffer(job->payload->data(), job->payload->size());
+  job->decoded = pb_decode(&stream, RealDataNewReqDTO_fields, &realdatanewreqdto) && realdatanewreqdto.timestamp != 0;
+  return nullptr;
+}
+
+static void *runStreamDecode(void *arg)
+{
+  decodeJob *job = static_cast<decodeJob *>(arg);
+  realDataValues values;
+  pb_istream_t stream = pb_istream_from_buffer(job->payload->data(), job->payload->size());
+  job->decoded = DTURealDataDecoder::decode(stream, values, job->table) && values.timestamp != 0;
+  return nullptr;
+}
+
+// bytes of the painted stack the thread has written to
+static size_t stackUsed(void *(*run)(void *), void *arg)
+{
+  static uint8_t stack[TEST_STACK_SIZE] __attribute__((aligned(64)));
+  memset(stack, TEST_STACK_PATTERN, sizeof(stack));
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack, sizeof(stack));
+  pthread_t thread;
+  if (pthread_create(&thread, &attr, run, arg) != 0)
+  {
+    printf("FAILED - pthread_create\n");
+    exit(1);
+  }
+  pthread_join(thread, nullptr);
+  pthread_attr_destroy(&attr);
+  size_t untouched = 0;
+  while (untouched < sizeof(stack) && stack[untouched] == TEST_STACK_PATTERN)
+    untouched++;
+  return sizeof(stack) - untouched;
+}
+
+template <typename F>
+static double usPerDecode(F decode, uint32_t rounds)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+    decode();
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t rounds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+  std::vector<uint8_t> small = encodePayload(false);
+  std::vector<uint8_t> full = encodePayload(true);
+  DTUTelemetryTable table;
+
+  decodeJob oldJob = {&small, nullptr, false};
+  decodeJob streamJob = {&small, &table, false};
+  decodeJob fullJob = {&full, &table, false};
+  // one run of each first - the lazy binding of library functions on the first call needs several kB
+  // of stack and would be counted to the decode
+  runOldDecode(&oldJob);
+  runStreamDecode(&fullJob);
+  stackUsed(runNothing, nullptr);
+
+  size_t threadBase = stackUsed(runNothing, nullptr);
+  size_t oldStack = stackUsed(runOldDecode, &oldJob) - threadBase;
+  check(oldJob.decoded, "generated struct decode", 0);
+  size_t streamStack = stackUsed(runStreamDecode, &streamJob) - threadBase;
+  check(streamJob.decoded, "streaming decode", 0);
+  size_t fullStack = stackUsed(runStreamDecode, &fullJob) - threadBase;
+  check(fullJob.decoded, "streaming decode of the full budget", 0);
+  check(table.getInverterCount() == DTU_TELEMETRY_MAX_INVERTERS, "inverters of the full budget", table.getInverterCount());
+
+  double oldUs = usPerDecode([&]()
+                             { runOldDecode(&oldJob); },
+                             rounds);
+  double streamUs = usPerDecode([&]()
+                                { runStreamDecode(&streamJob); },
+                                rounds);
+  double fullUs = usPerDecode([&]()
+                              { runStreamDecode(&fullJob); },
+                              rounds / 10);
+
+  printf("RealDataNewReqDTO: %zu bytes (thread base %zu bytes of stack)\n", sizeof(RealDataNewReqDTO), threadBase);
+  printf("1 inverter/ 2 ports (%zu bytes): generated struct %zu bytes of stack %.2f us - streaming %zu bytes of stack %.2f us\n",
+         small.size(), oldStack, oldUs, streamStack, streamUs);
+  printf("full budget (%zu bytes): streaming %zu bytes of stack %.2f us\n", full.size(), fullStack, fullUs);
+  if (failures > 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
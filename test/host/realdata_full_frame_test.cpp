@@ -0,0 +1,212 @@
+// Host test of a RealDataNew response with the full telemetry budget - 8 three-phase inverters with
+// 4 ports and 2 meters, every field set. The frame is encoded here field by field (protobuf wire
+// format), cut into TCP segments and put into the receive queue, the frame assembler hands it to
+// DTURealDataDecoder which fills the telemetry table. Two variants:
+//  - every varint at its max. length (ports 0x7FFFFFFF) - the frame has to be exactly
+//    DTU_FRAME_MAX_LENGTH long and is accepted, the out of range ports are counted as dropped
+//  - valid ports 1 ... 4 - all inverters, ports and meters land in the table, only one more PvMO
+//    with port 257 (port 1 after a cast to uint8_t) is dropped instead of overwriting port 1
+// Each frame is decoded twice like in DTUInterface - without the table for the fingerprint, then the
+// rewound frame with the table - both passes have to give the same fingerprint.
+//
+// needs the real nanopb and the code generated from include/proto - both are in .pio after one
+// PlatformIO build of the esp32 environment (pio run -e esp32):
+//
+//   g++ -std=c++17 -O2 -I.pio/libdeps/esp32/Nanopb -I.pio/build/esp32/nanopb/generated-src -Itest/host/stub -Iinclude test/host/realdata_full_frame_test.cpp src/dtuRealDataDecoder.cpp src/dtuTelemetry.cpp src/dtuChangeFingerprint.cpp src/dtuReceiveQueue.cpp src/dtuFrameAssembler.cpp src/dtuCRC16.cpp .pio/libdeps/esp32/Nanopb/pb_decode.c .pio/libdeps/esp32/Nanopb/pb_common.c -o realdata_full_frame_test
+//   ./realdata_full_frame_test
+//
+// (from the repository root - nanopb before the stub directory, exits with 1 on a failure)
+
+#include <cstdio>
+#include <vector>
+#include "dtuFrameAssembler.h"
+#include "dtuRealDataDecoder.h"
+
+#define TEST_SERIAL_BASE 0x116180212345ULL // 12 hex digits - 7 bytes as varint
+#define TEST_MAX_INT32 0x7FFFFFFF
+#define TEST_SEGMENT 536 // default MSS without options - a full frame needs several segments
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, uint32_t n)
+{
+  if (ok)
+    return;
+  printf("FAILED - %s (%u)\n", what, n);
+  failures++;
+}
+
+static void putVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back(uint8_t(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(uint8_t(value));
+}
+
+// int32/ int64 - negative values are sign extended to 10 bytes
+static void putInt(std::vector<uint8_t> &out, uint32_t field, int64_t value)
+{
+  putVarint(out, uint64_t(field) << 3);
+  putVarint(out, uint64_t(value));
+}
+
+static void putBytes(std::vector<uint8_t> &out, uint32_t field, const std::vector<uint8_t> &bytes)
+{
+  putVarint(out, (uint64_t(field) << 3) | 2);
+  putVarint(out, bytes.size());
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// TGSMO - fields 1 ... 20, reactive power (11), power factor (15) and temperature (16) negative
+static std::vector<uint8_t> encodeGrid(uint64_t serial)
+{
+  std::vector<uint8_t> grid;
+  putInt(grid, 1, int64_t(serial));
+  for (uint32_t field = 2; field <= 20; field++)
+    putInt(grid, field, (field == 11 || field == 15 || field == 16) ? -1 : TEST_MAX_INT32);
+  return grid;
+}
+
+// PvMO - fields 1 ... 8
+static std::vector<uint8_t> encodePv(uint64_t serial, int32_t port)
+{
+  std::vector<uint8_t> pv;
+  putInt(pv, 1, int64_t(serial));
+  putInt(pv, 2, port);
+  for (uint32_t field = 3; field <= 8; field++)
+    putInt(pv, field, TEST_MAX_INT32);
+  return pv;
+}
+
+// MeterMO - fields 1 ... 25, total/ phase power (3 ... 6) and power factor (7) negative - export
+static std::vector<uint8_t> encodeMeter(uint64_t serial)
+{
+  std::vector<uint8_t> meter;
+  putInt(meter, 1, TEST_MAX_INT32);
+  putInt(meter, 2, int64_t(serial));
+  for (uint32_t field = 3; field <= 25; field++)
+    putInt(meter, field, field <= 7 ? -1 : TEST_MAX_INT32);
+  return meter;
+}
+
+static std::vector<uint8_t> encodeFrame(bool validPorts)
+{
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> deviceSerial = {'4', '1', '4', '1', '8', '0', '2', '1', '2', '3', '4', '5'};
+  putBytes(payload, 1, deviceSerial);
+  for (uint32_t field = 2; field <= 5; field++)
+    putInt(payload, field, TEST_MAX_INT32);
+  for (uint32_t meter = 0; meter < DTU_TELEMETRY_MAX_METERS; meter++)
+    putBytes(payload, 6, encodeMeter(TEST_SERIAL_BASE + 0x100 + meter));
+  for (uint32_t inverter = 0; inverter < DTU_TELEMETRY_MAX_INVERTERS; inverter++)
+    putBytes(payload, 10, encodeGrid(TEST_SERIAL_BASE + inverter));
+  for (uint32_t inverter = 0; inverter < DTU_TELEMETRY_MAX_INVERTERS; inverter++)
+    for (int32_t port = 1; port <= DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+      putBytes(payload, 11, encodePv(TEST_SERIAL_BASE + inverter, validPorts ? port : TEST_MAX_INT32));
+  if (validPorts)
+  {
+    std::vector<uint8_t> pv;
+    putInt(pv, 1, int64_t(TEST_SERIAL_BASE));
+    putInt(pv, 2, 257);
+    putInt(pv, 5, 0);
+    putBytes(payload, 11, pv);
+  }
+  putInt(payload, 12, int64_t(TEST_SERIAL_BASE));
+  putInt(payload, 13, int64_t(TEST_SERIAL_BASE));
+
+  uint16_t crc = DTUCRC16::calc(payload.data(), payload.size());
+  uint16_t length = uint16_t(payload.size() + DTU_FRAME_HEADER_SIZE);
+  std::vector<uint8_t> frame = {0x48, 0x4d, 0xa3, 0x11, 0x00, 0x01, uint8_t(crc >> 8), uint8_t(crc), uint8_t(length >> 8), uint8_t(length)};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  return frame;
+}
+
+// receive queue, frame assembler and decoder as in DTUInterface::processReceived - first pass for the
+// fingerprint, second pass over the rewound frame for the table
+static bool receive(const std::vector<uint8_t> &frame, DTUTelemetryTable &table, realDataValues &values)
+{
+  static DTUReceiveQueue queue;
+  static DTUFrameAssembler assembler(queue);
+  bool decoded = false;
+  uint32_t frames = 0;
+  for (size_t pos = 0; pos < frame.size(); pos += TEST_SEGMENT)
+  {
+    size_t len = std::min(size_t(TEST_SEGMENT), frame.size() - pos);
+    check(queue.putData(frame.data() + pos, len) == len, "segment dropped by the receive queue", uint32_t(pos));
+
+    uint32_t limit;
+    queue.getStreamPos(limit);
+    dtuFrameHeader header;
+    pb_istream_t istream;
+    while (assembler.nextFrame(header, istream, limit))
+    {
+      frames++;
+      realDataValues firstPass;
+      DTURealDataDecoder::decode(istream, firstPass);
+      check(assembler.rewindFrame(istream), "rewind of the frame", frames);
+      decoded = DTURealDataDecoder::decode(istream, values, &table);
+      check(firstPass.fingerprint == values.fingerprint, "fingerprint without and with table", frames);
+      assembler.releaseFrame();
+    }
+  }
+  check(frames == 1, "frames handed out", frames);
+  check(assembler.getStats().framesRejected == 0, "frames rejected", assembler.getStats().framesRejected);
+  check(queue.getStats().droppedBytes == 0, "bytes dropped", queue.getStats().droppedBytes);
+  return decoded;
+}
+
+int main()
+{
+  // every varint at its max. length - the bound of the buffers
+  std::vector<uint8_t> maxFrame = encodeFrame(false);
+  check(maxFrame.size() == DTU_FRAME_MAX_LENGTH, "max. frame length", uint32_t(maxFrame.size()));
+  DTUTelemetryTable maxTable;
+  realDataValues maxValues;
+  check(receive(maxFrame, maxTable, maxValues), "decode of the max. frame", 0);
+  check(maxTable.getInverterCount() == DTU_TELEMETRY_MAX_INVERTERS, "inverters of the max. frame", maxTable.getInverterCount());
+  check(maxTable.getMeterCount() == DTU_TELEMETRY_MAX_METERS, "meters of the max. frame", maxTable.getMeterCount());
+  // 0x7FFFFFFF would be port 255 after a cast to uint8_t
+  check(maxTable.getDroppedEntries() == DTU_TELEMETRY_MAX_PORTS, "out of range ports dropped", maxTable.getDroppedEntries());
+
+  // valid ports - the full table
+  std::vector<uint8_t> frame = encodeFrame(true);
+  DTUTelemetryTable table;
+  realDataValues values;
+  check(receive(frame, table, values), "decode of the full frame", 0);
+  check(values.timestamp == TEST_MAX_INT32, "timestamp", uint32_t(values.timestamp));
+  check(table.getInverterCount() == DTU_TELEMETRY_MAX_INVERTERS, "inverters", table.getInverterCount());
+  check(table.getMeterCount() == DTU_TELEMETRY_MAX_METERS, "meters", table.getMeterCount());
+  check(table.getDroppedEntries() == 1, "dropped entries (port 257)", table.getDroppedEntries());
+  uint32_t ports = 0;
+  for (uint8_t inverter = 0; inverter < DTU_TELEMETRY_MAX_INVERTERS; inverter++)
+  {
+    check(table.inverterSerial[inverter] == TEST_SERIAL_BASE + inverter, "inverter serial", inverter);
+    check(table.inverterPhases[inverter] == DTU_INVERTER_THREE_PHASE, "inverter phases", inverter);
+    check(table.inverterTemperature[inverter] == -0.1f, "negative temperature", inverter);
+    for (uint8_t port = 0; port < DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+    {
+      uint8_t slot = table.getPortIndex(inverter, port);
+      if (slot == DTU_TELEMETRY_NO_INDEX)
+        continue;
+      ports++;
+      check(table.portPower[slot] == TEST_MAX_INT32 / 10.0f, "port power", slot);
+    }
+  }
+  check(ports == DTU_TELEMETRY_MAX_PORTS, "ports", ports);
+  check(table.meterPower[0] == -0.1f && table.meterPower[1] == -0.1f, "meter power (export)", 0);
+
+  printf("RealDataNew with %u inverters, %u ports, %u meters: max. frame %zu bytes (DTU_FRAME_MAX_LENGTH %u) - with valid ports %zu bytes\n",
+         DTU_TELEMETRY_MAX_INVERTERS, DTU_TELEMETRY_MAX_PORTS, DTU_TELEMETRY_MAX_METERS, maxFrame.size(), DTU_FRAME_MAX_LENGTH, frame.size());
+  printf("receive buffer %u bytes - max. frame + GetConfig response %u bytes\n",
+         DTU_RX_BUFFER_SIZE, DTU_FRAME_MAX_LENGTH + DTU_FRAME_CONFIG_MAX_LENGTH);
+  if (failures > 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
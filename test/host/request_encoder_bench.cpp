@@ -0,0 +1,175 @@
+// Host benchmark of the request encoder DtuRequest<> against the writers it replaced. The old
+// writers encoded into a local buffer of 200 bytes, ran the CRC bit wise over it (generic CRC16
+// class of robtillaart/CRC), built the header in an own array and copied header and payload into
+// a third array for the client. DtuRequest<>::encode writes the payload behind the header into the
+// tx buffer and fills the header in place. Every request type is encoded by both for a set of
+// timestamps and limits (varint lengths 1 ... 5) and has to give the same bytes, then both are
+// timed with the RealDataNew request.
+//
+// needs the real nanopb and the code generated from include/proto - both are in .pio after one
+// PlatformIO build of the esp32 environment (pio run -e esp32):
+//
+//   g++ -std=c++17 -O2 -I.pio/libdeps/esp32/Nanopb -I.pio/build/esp32/nanopb/generated-src -Itest/host/stub -Iinclude test/host/request_encoder_bench.cpp src/dtuCRC16.cpp .pio/build/esp32/nanopb/generated-src/RealtimeDataNew.pb.c .pio/build/esp32/nanopb/generated-src/AppGetHistPower.pb.c .pio/build/esp32/nanopb/generated-src/GetConfig.pb.c .pio/build/esp32/nanopb/generated-src/CommandPB.pb.c .pio/build/esp32/nanopb/generated-src/APPHeartbeatPB.pb.c .pio/libdeps/esp32/Nanopb/pb_encode.c .pio/libdeps/esp32/Nanopb/pb_decode.c .pio/libdeps/esp32/Nanopb/pb_common.c -o request_encoder_bench
+//   ./request_encoder_bench [rounds]
+//
+// (from the repository root - nanopb before the stub directory, exits with 1 if a frame differs)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "dtuRequest.h"
+
+#define TEST_TIME_OFFSET 28800 // DTU_TIME_OFFSET of dtuInterface.h
+
+static int failures = 0;
+
+static uint8_t reverse8(uint8_t in)
+{
+  uint8_t out = 0;
+  for (uint8_t i = 0; i < 8; i++)
+    out = uint8_t((out << 1) | ((in >> i) & 1));
+  return out;
+}
+
+// CRC16/MODBUS bit by bit as the generic class of the CRC library - see crc16_bench.cpp
+static uint16_t bitwiseCRC16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= uint16_t(reverse8(data[i])) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x8005) : uint16_t(crc << 1);
+  }
+  return uint16_t((reverse8(uint8_t(crc)) << 8) | reverse8(uint8_t(crc >> 8)));
+}
+
+// the writers before DtuRequest<> - encode buffer, header array and the copy of both for the client
+static size_t oldWriter(const pb_msgdesc_t *fields, const void *src, uint8_t cmdHigh, uint8_t cmdLow, uint8_t *out)
+{
+  uint8_t buffer[200];
+  pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+  if (!pb_encode(&stream, fields, src))
+    return 0;
+
+  uint16_t crc16 = bitwiseCRC16(buffer, stream.bytes_written);
+  uint8_t header[10];
+  header[0] = 0x48;
+  header[1] = 0x4d;
+  header[2] = cmdHigh;
+  header[3] = cmdLow;
+  header[4] = 0x00;
+  header[5] = 0x01;
+  header[6] = (crc16 >> 8) & 0xFF;
+  header[7] = crc16 & 0xFF;
+  header[8] = ((stream.bytes_written + 10) >> 8) & 0xFF;
+  header[9] = (stream.bytes_written + 10) & 0xFF;
+
+  uint8_t message[10 + stream.bytes_written];
+  for (int i = 0; i < 10; i++)
+    message[i] = header[i];
+  for (unsigned int i = 0; i < stream.bytes_written; i++)
+    message[i + 10] = buffer[i];
+  memcpy(out, message, 10 + stream.bytes_written);
+  return 10 + stream.bytes_written;
+}
+
+template <typename Request, typename MsgType>
+static void compare(const char *name, const MsgType &message, const pb_msgdesc_t *fields, uint8_t cmdHigh, uint8_t cmdLow, uint32_t value)
+{
+  uint8_t oldFrame[DTU_TX_BUFFER_SIZE];
+  uint8_t txBuffer[DTU_TX_BUFFER_SIZE];
+  size_t oldLen = oldWriter(fields, &message, cmdHigh, cmdLow, oldFrame);
+  size_t len = Request::encode(message, txBuffer, sizeof(txBuffer));
+  if (oldLen > 0 && len == oldLen && memcmp(oldFrame, txBuffer, len) == 0)
+    return;
+  printf("FAILED - %s (%u): old writer %zu bytes, DtuRequest %zu bytes\n", name, value, oldLen, len);
+  failures++;
+}
+
+static RealDataNewResDTO realDataNew(uint32_t time)
+{
+  RealDataNewResDTO message = RealDataNewResDTO_init_default;
+  message.offset = TEST_TIME_OFFSET;
+  message.time = int32_t(time);
+  return message;
+}
+
+static CommandResDTO limitCommand(uint32_t time, uint16_t limitLevel)
+{
+  CommandResDTO message = CommandResDTO_init_default;
+  message.time = int32_t(time);
+  message.action = CMD_ACTION_LIMIT_POWER;
+  message.package_nub = 1;
+  message.tid = int32_t(time);
+  snprintf(message.data, sizeof(message.data), "A:%u,B:0,C:0\r", limitLevel);
+  return message;
+}
+
+template <typename F>
+static double nsPerFrame(F encode, uint32_t rounds, uint32_t &sink)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+    sink += encode(1700000000 + r);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t rounds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+  // varint of 1 ... 5 bytes, 0 is not encoded at all
+  const uint32_t times[] = {0, 1, 0x7F, 0x80, 0x3FFF, 0x4000, 0x1FFFFF, 0x200000, 0xFFFFFFF, 0x10000000, 1700000000, 0x7FFFFFFF};
+  for (uint32_t time : times)
+  {
+    compare<RealDataNewRequest>("RealDataNew", realDataNew(time), RealDataNewResDTO_fields, 0xa3, 0x11, time);
+
+    AppGetHistPowerResDTO histPower = AppGetHistPowerResDTO_init_default;
+    histPower.offset = TEST_TIME_OFFSET;
+    histPower.requested_time = time;
+    compare<AppGetHistPowerRequest>("AppGetHistPower", histPower, AppGetHistPowerResDTO_fields, 0xa3, 0x15, time);
+
+    GetConfigResDTO getConfig = GetConfigResDTO_init_default;
+    getConfig.offset = TEST_TIME_OFFSET;
+    getConfig.time = time;
+    compare<GetConfigRequest>("GetConfig", getConfig, GetConfigResDTO_fields, 0xa3, 0x09, time);
+
+    CommandResDTO restart = CommandResDTO_init_default;
+    restart.action = CMD_ACTION_DTU_REBOOT;
+    restart.package_nub = 1;
+    restart.tid = int32_t(time);
+    compare<RestartDeviceRequest>("RestartDevice", restart, CommandResDTO_fields, 0x23, 0x05, time);
+  }
+  // limit 2 ... 100 % - the data string changes its length with the limit
+  for (uint16_t limitLevel = 20; limitLevel <= 1000; limitLevel += 10)
+    compare<CommandRequest>("Command", limitCommand(1700000000, limitLevel), CommandResDTO_fields, 0xa3, 0x05, limitLevel);
+
+  uint32_t sink = 0;
+  uint8_t txBuffer[DTU_TX_BUFFER_SIZE];
+  double oldNs = nsPerFrame([&](uint32_t time)
+                            { RealDataNewResDTO message = realDataNew(time);
+                              return uint32_t(oldWriter(RealDataNewResDTO_fields, &message, 0xa3, 0x11, txBuffer)); },
+                            rounds, sink);
+  double newNs = nsPerFrame([&](uint32_t time)
+                            { return uint32_t(RealDataNewRequest::encode(realDataNew(time), txBuffer, sizeof(txBuffer))); },
+                            rounds, sink);
+  double oldCommandNs = nsPerFrame([&](uint32_t time)
+                                   { CommandResDTO message = limitCommand(time, 500);
+                                     return uint32_t(oldWriter(CommandResDTO_fields, &message, 0xa3, 0x05, txBuffer)); },
+                                   rounds / 4, sink);
+  double newCommandNs = nsPerFrame([&](uint32_t time)
+                                   { return uint32_t(CommandRequest::encode(limitCommand(time, 500), txBuffer, sizeof(txBuffer))); },
+                                   rounds / 4, sink);
+
+  printf("%zu timestamps x 4 requests + %u limits compared (sink %u)\n", sizeof(times) / sizeof(times[0]), (1000 - 20) / 10 + 1, sink);
+  printf("RealDataNew: old writer %.1f ns/frame, DtuRequest %.1f ns/frame (%.2fx)\n", oldNs, newNs, oldNs / newNs);
+  printf("Command:     old writer %.1f ns/frame, DtuRequest %.1f ns/frame (%.2fx)\n", oldCommandNs, newCommandNs, oldCommandNs / newCommandNs);
+  if (failures > 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
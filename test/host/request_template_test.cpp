@@ -0,0 +1,146 @@
+// Host test of the cached request frames (DtuRequestTemplate). A series of requests is sent through
+// each template with the time counting across the varint boundaries 0x7F/ 0x80 (1 -> 2 bytes),
+// 2^21 (3 -> 4 bytes) and 2^28 (4 -> 5 bytes) - every frame has to be byte identical to a fresh
+// pb_encode of the same message (DtuRequest<>::encode), the template has to encode again exactly
+// once per length change and patch all other requests. Time 0 is not encoded by nanopb at all and
+// must not be cached. Afterwards the patched frame is timed against the full encode.
+//
+// needs the real nanopb and the code generated from include/proto - both are in .pio after one
+// PlatformIO build of the esp32 environment (pio run -e esp32):
+//
+//   g++ -std=c++17 -O2 -I.pio/libdeps/esp32/Nanopb -I.pio/build/esp32/nanopb/generated-src -Itest/host/stub -Iinclude test/host/request_template_test.cpp src/dtuCRC16.cpp .pio/build/esp32/nanopb/generated-src/RealtimeDataNew.pb.c .pio/build/esp32/nanopb/generated-src/AppGetHistPower.pb.c .pio/build/esp32/nanopb/generated-src/GetConfig.pb.c .pio/build/esp32/nanopb/generated-src/CommandPB.pb.c .pio/build/esp32/nanopb/generated-src/APPHeartbeatPB.pb.c .pio/libdeps/esp32/Nanopb/pb_encode.c .pio/libdeps/esp32/Nanopb/pb_decode.c .pio/libdeps/esp32/Nanopb/pb_common.c -o request_template_test
+//   ./request_template_test [rounds]
+//
+// (from the repository root - nanopb before the stub directory, exits with 1 on a failure)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "dtuRequest.h"
+
+#define TEST_TIME_OFFSET 28800 // DTU_TIME_OFFSET of dtuInterface.h
+#define TEST_STEPS 4           // requests on each side of a boundary
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, uint32_t n)
+{
+  if (ok)
+    return;
+  printf("FAILED - %s (%u)\n", what, n);
+  failures++;
+}
+
+// the request messages as the writers of DTUInterface fill them
+static RealDataNewResDTO realDataNew(uint32_t time)
+{
+  RealDataNewResDTO message = RealDataNewResDTO_init_default;
+  message.offset = TEST_TIME_OFFSET;
+  message.time = int32_t(time);
+  return message;
+}
+
+static AppGetHistPowerResDTO appGetHistPower(uint32_t time)
+{
+  AppGetHistPowerResDTO message = AppGetHistPowerResDTO_init_default;
+  message.offset = TEST_TIME_OFFSET;
+  message.requested_time = time;
+  return message;
+}
+
+static GetConfigResDTO getConfig(uint32_t time)
+{
+  GetConfigResDTO message = GetConfigResDTO_init_default;
+  message.offset = TEST_TIME_OFFSET;
+  message.time = time;
+  return message;
+}
+
+static HBResDTO heartbeat(uint32_t time)
+{
+  HBResDTO message = HBResDTO_init_default;
+  message.offset = TEST_TIME_OFFSET;
+  message.time = int32_t(time);
+  return message;
+}
+
+// sends the times through the template and compares every frame with the full encode
+template <typename Template, typename Request, typename MsgType>
+static void checkTemplate(const char *name, MsgType (*fill)(uint32_t), const uint32_t *times, size_t count, uint32_t expectedEncodes)
+{
+  Template requestTemplate;
+  uint8_t txBuffer[DTU_TX_BUFFER_SIZE];
+  uint8_t fresh[DTU_TX_BUFFER_SIZE];
+  for (size_t i = 0; i < count; i++)
+  {
+    MsgType message = fill(times[i]);
+    size_t len = requestTemplate.encode(message, times[i], txBuffer, sizeof(txBuffer));
+    size_t freshLen = Request::encode(message, fresh, sizeof(fresh));
+    if (len == 0 || len != freshLen || memcmp(txBuffer, fresh, len) != 0)
+    {
+      printf("FAILED - %s: frame for time 0x%X differs from pb_encode (%zu/ %zu bytes)\n", name, times[i], len, freshLen);
+      failures++;
+    }
+  }
+  const requestTemplateStats &stats = requestTemplate.getStats();
+  check(stats.encoded == expectedEncodes, name, stats.encoded);
+  check(stats.encoded + stats.patched == count, name, stats.patched);
+}
+
+template <typename F>
+static double nsPerFrame(F encode, uint32_t rounds, uint32_t &sink)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+    sink += encode(1700000000 + r);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t rounds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+  // 0 (not in the frame), then counting over the three boundaries - one encode per varint length
+  const uint32_t boundaries[] = {0x80, 0x200000, 0x10000000};
+  uint32_t times[1 + 3 * 2 * TEST_STEPS];
+  size_t count = 0;
+  times[count++] = 0;
+  for (uint32_t boundary : boundaries)
+    for (uint32_t time = boundary - TEST_STEPS; time < boundary + TEST_STEPS; time++)
+      times[count++] = time;
+  // encoded: time 0, 0x7C (1 byte), 0x80 (2), 0x1FFFFC (3), 0x200000 (4), 0x10000000 (5) - 0x0FFFFFFC is
+  // still 4 bytes and patched
+  uint32_t expectedEncodes = 6;
+
+  checkTemplate<RealDataNewTemplate, RealDataNewRequest>("RealDataNew", realDataNew, times, count, expectedEncodes);
+  checkTemplate<AppGetHistPowerTemplate, AppGetHistPowerRequest>("AppGetHistPower", appGetHistPower, times, count, expectedEncodes);
+  checkTemplate<GetConfigTemplate, GetConfigRequest>("GetConfig", getConfig, times, count, expectedEncodes);
+  checkTemplate<HeartbeatTemplate, HeartbeatRequest>("Heartbeat", heartbeat, times, count, expectedEncodes);
+
+  // after invalidate() the next request is encoded again
+  RealDataNewTemplate requestTemplate;
+  uint8_t txBuffer[DTU_TX_BUFFER_SIZE];
+  requestTemplate.encode(realDataNew(1700000000), 1700000000, txBuffer, sizeof(txBuffer));
+  requestTemplate.invalidate();
+  requestTemplate.encode(realDataNew(1700000001), 1700000001, txBuffer, sizeof(txBuffer));
+  check(requestTemplate.getStats().encoded == 2, "encode after invalidate()", requestTemplate.getStats().encoded);
+
+  uint32_t sink = 0;
+  double encodeNs = nsPerFrame([&](uint32_t time)
+                               { return uint32_t(RealDataNewRequest::encode(realDataNew(time), txBuffer, sizeof(txBuffer))); },
+                               rounds, sink);
+  double templateNs = nsPerFrame([&](uint32_t time)
+                                 { return uint32_t(requestTemplate.encode(realDataNew(time), time, txBuffer, sizeof(txBuffer))); },
+                                 rounds, sink);
+
+  printf("%zu requests per template over the varint boundaries 0x80, 2^21, 2^28 - identical to pb_encode (sink %u)\n", count, sink);
+  printf("RealDataNew: full encode %.1f ns/frame, template %.1f ns/frame (%.2fx) - %u patched, %u encoded\n",
+         encodeNs, templateNs, encodeNs / templateNs, requestTemplate.getStats().patched, requestTemplate.getStats().encoded);
+  if (failures > 0)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,76 @@
+// Host stress test of SnapshotHandoff - one writer thread, one reader thread.
+// Every snapshot is filled with its own number, the reader checks that each taken snapshot is
+// complete (all words equal) and newer than the last one. Run it with ThreadSanitizer:
+//
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -pthread -Iinclude test/host/snapshot_handoff_tsan.cpp -o snapshot_handoff_tsan
+//   ./snapshot_handoff_tsan [snapshots]
+//
+// (from the repository root - exits with 1 on a torn or out of order snapshot)
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "base/snapshotHandoff.h"
+
+#define SNAPSHOT_WORDS 16
+
+struct testSnapshot
+{
+  uint32_t number = 0;
+  uint32_t words[SNAPSHOT_WORDS] = {0};
+};
+
+int main(int argc, char *argv[])
+{
+  uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000;
+  SnapshotHandoff<testSnapshot> handoff;
+  std::atomic<bool> done{false};
+
+  std::thread writer([&]() {
+    for (uint32_t n = 1; n <= count; n++)
+    {
+      testSnapshot &snapshot = handoff.beginWrite();
+      snapshot.number = n;
+      for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++)
+        snapshot.words[i] = n;
+      handoff.publish();
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  uint32_t torn = 0;
+  uint32_t outOfOrder = 0;
+  uint32_t last = 0;
+  for (;;)
+  {
+    // the last snapshot must be taken after the writer finished
+    bool finished = done.load(std::memory_order_acquire);
+    if (handoff.consume())
+    {
+      const testSnapshot &snapshot = handoff.read();
+      for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++)
+      {
+        if (snapshot.words[i] != snapshot.number)
+        {
+          torn++;
+          break;
+        }
+      }
+      if (snapshot.number <= last)
+        outOfOrder++;
+      last = snapshot.number;
+    }
+    else if (finished)
+      break;
+  }
+  writer.join();
+
+  snapshotHandoffStats stats = handoff.getStats();
+  printf("published: %u consumed: %u overwritten: %u - last: %u torn: %u out of order: %u\n",
+         stats.published, stats.consumed, stats.overwritten, last, torn, outOfOrder);
+  // every published snapshot is either taken by the reader or overwritten
+  bool ok = torn == 0 && outOfOrder == 0 && last == count && stats.published == count &&
+            stats.consumed + stats.overwritten == stats.published;
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Minimal stand-in of the Arduino core for the host tests - only what the platform independent
+// modules (frame assembler, CRC, queues, telemetry, cloud pause learner, reconnect policy) use. Not a port:
+// String is a std::string with the Arduino constructors, Serial prints to stdout.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+class String : public std::string
+{
+public:
+  String() {}
+  String(const char *s) : std::string(s) {}
+  String(const std::string &s) : std::string(s) {}
+  String(char c) : std::string(1, c) {}
+  template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+  String(T value) : std::string(std::to_string(value)) {}
+  String(float value, unsigned int decimals) : std::string(format(value, decimals)) {}
+  String(double value, unsigned int decimals) : std::string(format(value, decimals)) {}
+
+  friend String operator+(const String &a, const String &b) { return concat(a, b); }
+  friend String operator+(const String &a, const char *b) { return concat(a, b); }
+  friend String operator+(const char *a, const String &b) { return concat(a, b); }
+
+private:
+  static String concat(const std::string &a, const std::string &b)
+  {
+    std::string result(a);
+    result.append(b);
+    return String(result);
+  }
+  static std::string format(double value, unsigned int decimals)
+  {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", int(decimals), value);
+    return buffer;
+  }
+};
+
+class HostSerial
+{
+public:
+  void print(const String &s) { fputs(s.c_str(), stdout); }
+  void println(const String &s) { puts(s.c_str()); }
+  void println() { puts(""); }
+  template <typename... Args>
+  void printf(const char *format, Args... args) { ::printf(format, args...); }
+};
+
+inline HostSerial Serial;
+
+inline uint32_t micros()
+{
+  return uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// simulations run on a virtual clock - millis() follows hostMillis then, micros() stays the real
+// time for runtime measurements
+inline bool hostVirtualClock = false;
+inline uint32_t hostMillis = 0;
+
+inline uint32_t millis()
+{
+  if (hostVirtualClock)
+    return hostMillis;
+  return uint32_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline long random(long howBig)
+{
+  return howBig > 0 ? long(rand() % howBig) : 0;
+}
+
+#endif // HOST_ARDUINO_H
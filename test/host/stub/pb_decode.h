@@ -0,0 +1,32 @@
+// Stand-in of the nanopb input stream for the host tests of the frame assembler - the type only,
+// the layout of nanopb 0.4 (pb.h/ pb_decode.h). Tests that decode a message need the real library.
+
+#ifndef HOST_PB_DECODE_H
+#define HOST_PB_DECODE_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef uint8_t pb_byte_t;
+
+struct pb_istream_s
+{
+  bool (*callback)(pb_istream_s *stream, pb_byte_t *buf, size_t count);
+  void *state;
+  size_t bytes_left;
+  const char *errmsg;
+};
+typedef struct pb_istream_s pb_istream_t;
+
+// reads count bytes of the payload - what pb_read() does for a callback stream
+inline bool pb_read(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+  if (count > stream->bytes_left)
+    return false;
+  if (!stream->callback(stream, buf, count))
+    return false;
+  stream->bytes_left -= count;
+  return true;
+}
+
+#endif // HOST_PB_DECODE_H
@@ -0,0 +1,104 @@
+// Host test of DTUTelemetryTable - a DTU-Pro with the full budget of 4-port inverters (serials of
+// real HMS models with similar digits, so the hash has to probe), one inverter more than the
+// budget and ports out of range. Checks that every value lands in its stable slot and the
+// overflow is counted, then times the update of one response and the sum over all ports:
+//
+//   g++ -std=c++17 -O2 -Itest/host/stub -Iinclude test/host/telemetry_table_test.cpp src/dtuTelemetry.cpp -o telemetry_table_test
+//   ./telemetry_table_test [rounds]
+//
+// (from the repository root - exits with 1 on a wrong slot or value)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "dtuTelemetry.h"
+
+#define TEST_SERIAL_BASE 0x114182000000ULL // HMS-2000-4T
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, uint32_t n)
+{
+  if (ok)
+    return;
+  printf("FAILED - %s (%u)\n", what, n);
+  failures++;
+}
+
+static void fillResponse(DTUTelemetryTable &table, uint32_t timestamp, float offset)
+{
+  for (uint32_t i = 0; i < DTU_TELEMETRY_MAX_INVERTERS; i++)
+  {
+    telemetryInverterValues inverter;
+    // only the last digits differ - as on a site with inverters of one delivery
+    inverter.serial = TEST_SERIAL_BASE + i * DTU_TELEMETRY_MAX_INVERTERS * 2;
+    inverter.power = 100 * i + offset;
+    table.updateInverter(inverter, timestamp);
+    for (uint8_t port = 1; port <= DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+    {
+      telemetryPortValues values;
+      values.serial = inverter.serial;
+      values.port = port;
+      values.power = 10 * i + port + offset;
+      table.updatePort(values, timestamp);
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t rounds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+  static DTUTelemetryTable table;
+
+  fillResponse(table, 1, 0);
+  check(table.getInverterCount() == DTU_TELEMETRY_MAX_INVERTERS, "inverter count", table.getInverterCount());
+  for (uint32_t i = 0; i < DTU_TELEMETRY_MAX_INVERTERS; i++)
+  {
+    uint8_t index = table.findInverter(TEST_SERIAL_BASE + i * DTU_TELEMETRY_MAX_INVERTERS * 2);
+    // order of appearance
+    check(index == i, "inverter index", i);
+    check(index != DTU_TELEMETRY_NO_INDEX && table.inverterPower[index] == 100 * i, "inverter power", i);
+    for (uint8_t port = 0; port < DTU_TELEMETRY_PORTS_PER_INVERTER; port++)
+    {
+      uint8_t slot = table.getPortIndex(uint8_t(i), port);
+      check(slot == i * DTU_TELEMETRY_PORTS_PER_INVERTER + port, "port slot", i * 10 + port);
+      check(slot != DTU_TELEMETRY_NO_INDEX && table.portPower[slot] == 10 * i + port + 1, "port power", i * 10 + port);
+    }
+  }
+
+  // over the budget and invalid ports are dropped and counted - the table stays as it is
+  telemetryInverterValues extra;
+  extra.serial = TEST_SERIAL_BASE + 1;
+  check(!table.updateInverter(extra, 2), "inverter over budget accepted", 0);
+  telemetryPortValues badPort;
+  badPort.serial = TEST_SERIAL_BASE;
+  badPort.port = DTU_TELEMETRY_PORTS_PER_INVERTER + 1;
+  check(!table.updatePort(badPort, 2), "port out of range accepted", badPort.port);
+  check(table.findInverter(extra.serial) == DTU_TELEMETRY_NO_INDEX, "inverter over budget found", 0);
+  check(table.getDroppedEntries() == 2, "dropped entries", table.getDroppedEntries());
+  if (failures > 0)
+    return 1;
+
+  // one RealDataNew response of the full budget per round, the outputs read one column
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+    fillResponse(table, r + 3, float(r & 7));
+  double updateNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+  volatile float total = 0;
+  start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    float sum = 0;
+    for (uint8_t slot = 0; slot < DTU_TELEMETRY_MAX_PORTS; slot++)
+      sum += table.portPower[slot];
+    total = total + sum;
+  }
+  double sumNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+  printf("table: %zu bytes for %u inverters/ %u ports - update of a full response: %.0f ns (%.1f ns per entry) - sum of all ports: %.1f ns\n",
+         sizeof(DTUTelemetryTable), DTU_TELEMETRY_MAX_INVERTERS, DTU_TELEMETRY_MAX_PORTS, updateNs,
+         updateNs / (DTU_TELEMETRY_MAX_INVERTERS + DTU_TELEMETRY_MAX_PORTS), sumNs);
+  printf("OK\n");
+  return 0;
+}